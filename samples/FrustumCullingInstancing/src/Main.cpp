@@ -7,6 +7,7 @@
 #include <render/Text.h>
 
 #include <system/Logger.h>
+#include <system/Profiler.h>
 #include <system/Window.h>
 #include <system/WindowEvent.h>
 using namespace Sketch3D;
@@ -140,6 +141,7 @@ int main(int argc, char** argv) {
     Renderer::GetInstance()->CameraLookAt(Vector3(0.0f, 3.0f, 0.0f), Vector3(0.0f, 3.0f, -1.0f));
 
     while (window.IsOpen()) {
+        PROFILE_ZONE("Frame");
         begin = clock();
 
         WindowEvent windowEvent;
@@ -218,6 +220,7 @@ int main(int argc, char** argv) {
         Renderer::GetInstance()->Render();
 
         Text::GetInstance()->Write("FPS: " + to_string(fps), 5, 5);
+        Text::GetInstance()->Write("Render queue allocations: " + to_string(Renderer::GetInstance()->GetNumRenderQueueHeapAllocations()), 5, 35);
 
         Renderer::GetInstance()->EndRender();
 
@@ -237,5 +240,10 @@ int main(int argc, char** argv) {
 
     delete[] nodes;
 
+#ifdef SKETCH_3D_PROFILING
+    Profiler::GetInstance()->SetThreadName("Main");
+    Profiler::GetInstance()->ExportChromeTrace("Sample_FrustumCullingInstancing.json");
+#endif
+
     return 0;
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include <render/Shader.h>
 #include <render/Texture2D.h>
 
+#include <system/Profiler.h>
 #include <system/Window.h>
 #include <system/WindowEvent.h>
 using namespace Sketch3D;
@@ -139,6 +140,8 @@ int main(int argc, char** argv) {
     float maxHeight = 0.15f;
 
     while (window.IsOpen()) {
+        PROFILE_ZONE("Frame");
+
         WindowEvent windowEvent;
         if (window.PollEvents(windowEvent)) {
         }
@@ -187,29 +190,33 @@ int main(int argc, char** argv) {
             }
         }
 #endif
-        for (size_t i = 1; i < NUM_VERTICES - 1; i++) {
-            for (size_t j = 1; j < NUM_VERTICES - 1; j++) {
-                idx = i * NUM_VERTICES + j;
-
-                buffer[idx].z = (buffer2[idx - 1].z + buffer2[idx + 1].z +
-                                 buffer2[(i - 1) * NUM_VERTICES + j].z +
-                                 buffer2[(i + 1) * NUM_VERTICES + j].z) / 2.0f - buffer[idx].z;
-                buffer[idx].z *= damping;
+        {
+            PROFILE_ZONE("Water simulation");
+
+            for (size_t i = 1; i < NUM_VERTICES - 1; i++) {
+                for (size_t j = 1; j < NUM_VERTICES - 1; j++) {
+                    idx = i * NUM_VERTICES + j;
+
+                    buffer[idx].z = (buffer2[idx - 1].z + buffer2[idx + 1].z +
+                                     buffer2[(i - 1) * NUM_VERTICES + j].z +
+                                     buffer2[(i + 1) * NUM_VERTICES + j].z) / 2.0f - buffer[idx].z;
+                    buffer[idx].z *= damping;
+                }
             }
-        }
 
-        for (size_t i = 1; i < NUM_VERTICES - 1; i++) {
-            for (size_t j = 1; j < NUM_VERTICES - 1; j++) {
-                idx = i * NUM_VERTICES + j;
+            for (size_t i = 1; i < NUM_VERTICES - 1; i++) {
+                for (size_t j = 1; j < NUM_VERTICES - 1; j++) {
+                    idx = i * NUM_VERTICES + j;
 
-                surface.normals[idx] = (buffer[idx + 1] - buffer[idx - 1]).Normalized();
+                    surface.normals[idx] = (buffer[idx + 1] - buffer[idx - 1]).Normalized();
+                }
             }
-        }
 
-        buffer2 = surface.vertices;
-        surface.vertices = buffer;
-        buffer = buffer2;
-        waterMesh.UpdateMeshData();
+            buffer2 = surface.vertices;
+            surface.vertices = buffer;
+            buffer = buffer2;
+            waterMesh.UpdateMeshData();
+        }
 
         Renderer::GetInstance()->Clear();
         Renderer::GetInstance()->Render();
@@ -220,5 +227,10 @@ int main(int argc, char** argv) {
 
     delete[] buffer;
 
+#ifdef SKETCH_3D_PROFILING
+    Profiler::GetInstance()->SetThreadName("Main");
+    Profiler::GetInstance()->ExportChromeTrace("Sample_InteractiveWater.json");
+#endif
+
     return 0;
 }
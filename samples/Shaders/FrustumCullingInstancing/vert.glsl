@@ -1,7 +1,11 @@
 #version 330
 
-uniform mat4 viewProjection;
-uniform mat4 view;
+layout(std140) uniform FrameConstants {
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	mat4 transInvView;
+};
 
 layout (location=0) in vec3 in_vertex;
 layout (location=1) in vec3 in_normal;
@@ -1,8 +1,14 @@
 #version 330
 
+layout(std140) uniform FrameConstants {
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	mat4 transInvView;
+};
+
 uniform mat4 modelViewProjection;
 uniform mat4 modelView;
-uniform mat4 view;
 
 layout (location=0) in vec3 in_vertex;
 layout (location=1) in vec3 in_normal;
@@ -1,9 +1,15 @@
 #version 330
 
+layout(std140) uniform FrameConstants {
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	mat4 transInvView;
+};
+
 uniform mat4 modelViewProjection;
 uniform mat4 modelView;
 uniform mat4 model;
-uniform mat4 view;
 uniform mat4 shadowMatrix;
 
 uniform vec3 light_position;
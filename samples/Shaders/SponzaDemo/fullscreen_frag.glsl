@@ -1,7 +1,13 @@
 #version 330
 
+layout(std140) uniform FrameConstants {
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	mat4 transInvView;
+};
+
 uniform mat4 modelView;
-uniform mat4 view;
 
 uniform sampler2D normals;
 uniform sampler2D albedos;
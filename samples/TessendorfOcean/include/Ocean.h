@@ -15,7 +15,6 @@ namespace Sketch3D {
 }
 using namespace Sketch3D;
 
-#include <thread>
 #include <vector>
 using namespace std;
 
@@ -1,9 +1,12 @@
 #include "Ocean.h"
 
 #include <render/Material.h>
+#include <render/Renderer_Common.h>
 #include <render/Renderer.h>
 
+#include <system/JobSystem.h>
 #include <system/Logger.h>
+#include <system/Profiler.h>
 #include <system/Window.h>
 #include <system/WindowEvent.h>
 using namespace Sketch3D;
@@ -27,6 +30,11 @@ int main(int argc, char** argv) {
     renderParameters.depthStencilBits = DEPTH_STENCIL_BITS_D24X8;
 
     Renderer::GetInstance()->Initialize(RENDER_SYSTEM_OPENGL, window, renderParameters);
+
+    // The defaults are kept if there is no config file
+    ConfigFileAttributes_t configFileAttributes;
+    ParseConfigFile("init.cfg", configFileAttributes);
+    JobSystem::GetInstance()->Initialize(configFileAttributes.numWorkerThreads);
     Renderer::GetInstance()->SetClearColor(0.2f, 0.2f, 0.2f);
 
     Ocean ocean(128, 0.001f, Vector2(5.0f, 3.0f), 32.0f);
@@ -35,16 +43,20 @@ int main(int argc, char** argv) {
     clock_t begin, end;
 
     Renderer::GetInstance()->CameraLookAt(Vector3(10.0f, 15.0f, -35.0f), Vector3(0.0f, 1.0f, 0.0f), Vector3::UP);
+    Renderer::GetInstance()->EnableRenderThread(configFileAttributes.useRenderThread);
 
     while (window.IsOpen()) {
+        PROFILE_ZONE("Frame");
         begin = clock();
 
         WindowEvent windowEvent;
         while (window.PollEvents(windowEvent)) {
         }
 
+        // The waves of this frame are evaluated while the render thread draws the previous one, only the upload of
+        // the mesh waits for it
         ocean.EvaluateWaves(t);
-        ocean.PrepareForRender();
+        Renderer::GetInstance()->RunOnRenderThread([&ocean]() { ocean.PrepareForRender(); });
 
         Renderer::GetInstance()->Clear();
         Renderer::GetInstance()->Render();
@@ -56,5 +68,13 @@ int main(int argc, char** argv) {
         t += double(end - begin) / CLOCKS_PER_SEC;
     }
 
+    // The ocean releases its buffers on this thread
+    Renderer::GetInstance()->EnableRenderThread(false);
+
+#ifdef SKETCH_3D_PROFILING
+    Profiler::GetInstance()->SetThreadName("Main");
+    Profiler::GetInstance()->ExportChromeTrace("Sample_Ocean.json");
+#endif
+
     return 0;
 }
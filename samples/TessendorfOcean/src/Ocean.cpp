@@ -4,6 +4,8 @@
 #include "render/Material.h"
 #include "render/Renderer.h"
 #include "render/Shader.h"
+#include "system/JobSystem.h"
+#include "system/Profiler.h"
 using namespace Sketch3D;
 
 #include <string>
@@ -148,72 +150,80 @@ Ocean::~Ocean() {
 }
 
 void Ocean::EvaluateWaves(double t) {
-    Vector2 k;
-    float kLength;
-    size_t index;
-
-    for (int i = 0; i < numberOfPoints_; i++) {
-        k.y = PI * (2.0f * i - numberOfPoints_) / length_;
-
-        for (int j = 0; j < numberOfPoints_; j++) {
-            k.x = PI * (2.0f * j - numberOfPoints_) / length_;
-            kLength = k.Length();
-            index = i * numberOfPoints_ + j;
-
-            hTildeHeight_[index] = ComputeHTilde(t, i, j);
-            hTildeSlopex_[index] = hTildeHeight_[index] * Complex(0.0f, k.x);
-            hTildeSlopez_[index] = hTildeHeight_[index] * Complex(0.0f, k.y);
-
-            if (kLength < EPSILON) {
-                hTildeDx_[index] = Complex(0.0f, 0.0f);
-                hTildeDz_[index] = Complex(0.0f, 0.0f);
-            } else {
-                hTildeDx_[index] = hTildeHeight_[index] * Complex(0.0f, -k.x/kLength);
-                hTildeDz_[index] = hTildeHeight_[index] * Complex(0.0f, -k.y/kLength);
+    PROFILE_ZONE("Ocean::EvaluateWaves");
+
+    JobSystem* jobSystem = JobSystem::GetInstance();
+
+    // The rows are independent, split them between the workers
+    jobSystem->ParallelFor(0, numberOfPoints_, 8, [this, t] (size_t firstRow, size_t lastRow) {
+        Vector2 k;
+        float kLength;
+        size_t index;
+
+        for (int i = (int)firstRow; i < (int)lastRow; i++) {
+            k.y = PI * (2.0f * i - numberOfPoints_) / length_;
+
+            for (int j = 0; j < numberOfPoints_; j++) {
+                k.x = PI * (2.0f * j - numberOfPoints_) / length_;
+                kLength = k.Length();
+                index = i * numberOfPoints_ + j;
+
+                hTildeHeight_[index] = ComputeHTilde(t, i, j);
+                hTildeSlopex_[index] = hTildeHeight_[index] * Complex(0.0f, k.x);
+                hTildeSlopez_[index] = hTildeHeight_[index] * Complex(0.0f, k.y);
+
+                if (kLength < EPSILON) {
+                    hTildeDx_[index] = Complex(0.0f, 0.0f);
+                    hTildeDz_[index] = Complex(0.0f, 0.0f);
+                } else {
+                    hTildeDx_[index] = hTildeHeight_[index] * Complex(0.0f, -k.x/kLength);
+                    hTildeDz_[index] = hTildeHeight_[index] * Complex(0.0f, -k.y/kLength);
+                }
             }
         }
-    }
-
-    // Multi thread the fft passes
-    thread heightThread(&Ocean::FftPassHeight, this);
-    thread slopexThread(&Ocean::FftPassSlopex, this);
-    thread slopezThread(&Ocean::FftPassSlopez, this);
-    thread dxThread(&Ocean::FftPassDx, this);
-    thread dzThread(&Ocean::FftPassDz, this);
+    });
 
-    heightThread.join();
-    slopexThread.join();
-    slopezThread.join();
-    dxThread.join();
-    dzThread.join();
+    // One job per fft pass, each pass having its own scratch buffers
+    JobCounter fftCounter;
+    jobSystem->Run([this] () { FftPassHeight(); }, &fftCounter);
+    jobSystem->Run([this] () { FftPassSlopex(); }, &fftCounter);
+    jobSystem->Run([this] () { FftPassSlopez(); }, &fftCounter);
+    jobSystem->Run([this] () { FftPassDx(); }, &fftCounter);
+    jobSystem->Run([this] () { FftPassDz(); }, &fftCounter);
+    jobSystem->Wait(fftCounter);
 
     // Displace the vertices
-    float lambda = -1.0f;
-    const float signs[] = { 1.0f, -1.0f };
-    float sign;
+    jobSystem->ParallelFor(0, numberOfPoints_, 8, [this] (size_t firstRow, size_t lastRow) {
+        float lambda = -1.0f;
+        const float signs[] = { 1.0f, -1.0f };
+        float sign;
+        size_t index;
 
-    for (int i = 0; i < numberOfPoints_; i++) {
-        for (int j = 0; j < numberOfPoints_; j++) {
-            index = i * numberOfPoints_ + j;
+        for (int i = (int)firstRow; i < (int)lastRow; i++) {
+            for (int j = 0; j < numberOfPoints_; j++) {
+                index = i * numberOfPoints_ + j;
 
-            sign = signs[(i + j) & 1];
+                sign = signs[(i + j) & 1];
 
-            hTildeHeight_[index] *= sign;
-            oceanSurface_.vertices[index].y = hTildeHeight_[index].a;
+                hTildeHeight_[index] *= sign;
+                oceanSurface_.vertices[index].y = hTildeHeight_[index].a;
 
-            hTildeDx_[index] *= sign;
-            hTildeDz_[index] *= sign;
-            oceanSurface_.vertices[index].x = initialPositions_[index].x + hTildeDx_[index].a * lambda;
-            oceanSurface_.vertices[index].z = initialPositions_[index].y + hTildeDz_[index].a * lambda;
+                hTildeDx_[index] *= sign;
+                hTildeDz_[index] *= sign;
+                oceanSurface_.vertices[index].x = initialPositions_[index].x + hTildeDx_[index].a * lambda;
+                oceanSurface_.vertices[index].z = initialPositions_[index].y + hTildeDz_[index].a * lambda;
 
-            hTildeSlopex_[index] *= sign;
-            hTildeSlopez_[index] *= sign;
-            oceanSurface_.normals[index] = Vector3(-hTildeSlopex_[index].a, 1.0f, -hTildeSlopez_[index].a).Normalized();
+                hTildeSlopex_[index] *= sign;
+                hTildeSlopez_[index] *= sign;
+                oceanSurface_.normals[index] = Vector3(-hTildeSlopex_[index].a, 1.0f, -hTildeSlopez_[index].a).Normalized();
+            }
         }
-    }
+    });
 }
 
 void Ocean::PrepareForRender() {
+    PROFILE_ZONE("Ocean::PrepareForRender");
+
     oceanMesh_.UpdateMeshData();
     oceanMaterial_->SetUniformVector3("light_position", Vector3(0.0f, 10.0f, -16.0f));
     oceanMaterial_->SetUniformVector3("ambient_color", Vector3(0.0f, 0.65f, 0.75f));
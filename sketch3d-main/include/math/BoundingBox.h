@@ -0,0 +1,73 @@
+#ifndef SKETCH_3D_BOUNDING_BOX_H
+#define SKETCH_3D_BOUNDING_BOX_H
+
+#include "math/Plane.h"
+#include "math/Vector3.h"
+
+#include "system/Platform.h"
+
+namespace Sketch3D {
+// Forward declaration
+class Sphere;
+
+/**
+ * @class BoundingBox
+ * This class represents an axis aligned bounding box.
+ */
+class SKETCH_3D_API BoundingBox {
+    public:
+        /**
+         * Default constructor. Initializes an empty box at the origin
+         */
+                                BoundingBox();
+
+        /**
+         * Constructor.
+         * @param minimum The corner of the box with the smallest coordinates
+         * @param maximum The corner of the box with the biggest coordinates
+         */
+                                BoundingBox(const Vector3& minimum, const Vector3& maximum);
+
+        /**
+         * Constructor. Initializes the smallest box containing the sphere
+         * @param sphere The sphere to enclose
+         */
+                                BoundingBox(const Sphere& sphere);
+
+        /**
+         * Check if the given plane intersects with the box
+         * @param plane The plane with which to check the intersection
+         * @return The relative position of the object in respect to the plane
+         */
+        RelativePlanePosition_t IntersectsPlane(const Plane& plane) const;
+
+        /**
+         * Check if the given box is completely inside this box
+         * @param box The box to check
+         * @return true if the box is inside, false otherwise
+         */
+        bool                    Contains(const BoundingBox& box) const;
+
+        /**
+         * Returns the smallest box containing both this box and the given one
+         * @param box The box to merge with
+         */
+        BoundingBox             Merged(const BoundingBox& box) const;
+
+        /**
+         * Returns the area of the faces of the box. Used to evaluate how good a box is for a bounding volume hierarchy
+         */
+        float                   GetSurfaceArea() const;
+
+        void                    SetMinimum(const Vector3& minimum);
+        void                    SetMaximum(const Vector3& maximum);
+        const Vector3&          GetMinimum() const;
+        const Vector3&          GetMaximum() const;
+    private:
+        Vector3                 minimum_;   /**< Corner of the box with the smallest coordinates */
+        Vector3                 maximum_;   /**< Corner of the box with the biggest coordinates */
+};
+
+}
+
+#endif
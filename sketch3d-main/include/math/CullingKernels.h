@@ -0,0 +1,76 @@
+#ifndef SKETCH_3D_CULLING_KERNELS_H
+#define SKETCH_3D_CULLING_KERNELS_H
+
+#include "system/Platform.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Sketch3D {
+
+/**
+ * @enum CullingKernelsType_t
+ * The different implementations of the culling kernels
+ */
+enum CullingKernelsType_t {
+    CULLING_KERNELS_SCALAR,
+    CULLING_KERNELS_SSE2,
+    CULLING_KERNELS_AVX
+};
+
+/**
+ * @struct SphereBatch_t
+ * Spheres stored as a structure of arrays, so that the kernels can load the same component of several spheres at once
+ */
+struct SphereBatch_t {
+    const float*    centersX;
+    const float*    centersY;
+    const float*    centersZ;
+    const float*    radii;
+    uint8_t*        planeHints;     /**< For each sphere, the plane that rejected it the last time. It is tested first
+                                         and updated by the kernels. May be nullptr */
+    size_t          numSpheres;
+};
+
+/**
+ * Returns the number of words of the visibility mask of a batch of spheres
+ */
+inline size_t GetNumVisibilityWords(size_t numSpheres) {
+    return (numSpheres + 31) / 32;
+}
+
+/**
+ * @struct CullingKernels_t
+ * Table of functions testing bounding volumes against the planes of a convex volume, usually the view frustum
+ */
+struct CullingKernels_t {
+    CullingKernelsType_t type;
+
+    /**
+     * Test spheres against planes. A sphere is outside if it is completely behind one of the planes, that is if
+     * normal.Dot(center) + distance < -radius, like Sphere::IntersectsPlane
+     * @param planes The planes, stored as 4 floats each: the normal followed by the distance
+     * @param numPlanes The number of planes, at most 255
+     * @param spheres The spheres to test
+     * @param visibility Array of GetNumVisibilityWords(spheres.numSpheres) words. The bit i % 32 of the word i / 32 is
+     * set if the sphere i isn't outside
+     */
+    void    (*cullSpheres)(const float* planes, size_t numPlanes, const SphereBatch_t& spheres, uint32_t* visibility);
+};
+
+/**
+ * Returns the fastest implementation of the culling kernels supported by the cpu. The implementation is selected
+ * the first time that this function is called
+ */
+SKETCH_3D_API const CullingKernels_t&   GetCullingKernels();
+
+/**
+ * Returns a specific implementation of the culling kernels
+ * @param type The implementation to get
+ * @return The implementation, or nullptr if it isn't supported by the cpu or wasn't compiled in
+ */
+SKETCH_3D_API const CullingKernels_t*   GetCullingKernels(CullingKernelsType_t type);
+
+}
+
+#endif
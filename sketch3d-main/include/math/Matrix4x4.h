@@ -1,6 +1,7 @@
 #ifndef SKETCH_3D_MATRIX_4X4_H
 #define SKETCH_3D_MATRIX_4X4_H
 
+#include "math/MatrixKernels.h"
 #include "math/Vector3.h"
 
 #include "system/Common.h"
@@ -63,6 +64,23 @@ class SKETCH_3D_API Matrix4x4
          */
         Matrix4x4               Inverse() const;
 
+        /**
+         * Multiply a matrix with several matrices at once: results[i] = a * matrices[i]
+         * @param a The matrix on the left of all the products
+         * @param matrices The matrices on the right of the products
+         * @param count The number of matrices
+         * @param results The products. May be the same array as matrices
+         */
+        static void             MultiplyBatch(const Matrix4x4& a, const Matrix4x4* matrices, size_t count, Matrix4x4* results);
+
+        /**
+         * Compute the transpose of the inverse of several matrices at once, as required for normal matrices
+         * @param matrices The matrices to invert
+         * @param count The number of matrices
+         * @param results The transposed inverses. May be the same array as matrices
+         */
+        static void             InverseTransposeBatch(const Matrix4x4* matrices, size_t count, Matrix4x4* results);
+
         /**
          * Transform this matrix into a translation matrix
          * @param translation A vector representing the translation
@@ -207,26 +225,7 @@ INLINE Matrix4x4 Matrix4x4::operator-(const Matrix4x4& m) const {
 INLINE Matrix4x4 Matrix4x4::operator*(const Matrix4x4& m) const
 {
     Matrix4x4 mat;
-    mat.data_[0][0] = data_[0][0] * m.data_[0][0] + data_[0][1] * m.data_[1][0] + data_[0][2] * m.data_[2][0] + data_[0][3] * m.data_[3][0];
-    mat.data_[0][1] = data_[0][0] * m.data_[0][1] + data_[0][1] * m.data_[1][1] + data_[0][2] * m.data_[2][1] + data_[0][3] * m.data_[3][1];
-    mat.data_[0][2] = data_[0][0] * m.data_[0][2] + data_[0][1] * m.data_[1][2] + data_[0][2] * m.data_[2][2] + data_[0][3] * m.data_[3][2];
-    mat.data_[0][3] = data_[0][0] * m.data_[0][3] + data_[0][1] * m.data_[1][3] + data_[0][2] * m.data_[2][3] + data_[0][3] * m.data_[3][3];
-
-    mat.data_[1][0] = data_[1][0] * m.data_[0][0] + data_[1][1] * m.data_[1][0] + data_[1][2] * m.data_[2][0] + data_[1][3] * m.data_[3][0];
-    mat.data_[1][1] = data_[1][0] * m.data_[0][1] + data_[1][1] * m.data_[1][1] + data_[1][2] * m.data_[2][1] + data_[1][3] * m.data_[3][1];
-    mat.data_[1][2] = data_[1][0] * m.data_[0][2] + data_[1][1] * m.data_[1][2] + data_[1][2] * m.data_[2][2] + data_[1][3] * m.data_[3][2];
-    mat.data_[1][3] = data_[1][0] * m.data_[0][3] + data_[1][1] * m.data_[1][3] + data_[1][2] * m.data_[2][3] + data_[1][3] * m.data_[3][3];
-
-    mat.data_[2][0] = data_[2][0] * m.data_[0][0] + data_[2][1] * m.data_[1][0] + data_[2][2] * m.data_[2][0] + data_[2][3] * m.data_[3][0];
-    mat.data_[2][1] = data_[2][0] * m.data_[0][1] + data_[2][1] * m.data_[1][1] + data_[2][2] * m.data_[2][1] + data_[2][3] * m.data_[3][1];
-    mat.data_[2][2] = data_[2][0] * m.data_[0][2] + data_[2][1] * m.data_[1][2] + data_[2][2] * m.data_[2][2] + data_[2][3] * m.data_[3][2];
-    mat.data_[2][3] = data_[2][0] * m.data_[0][3] + data_[2][1] * m.data_[1][3] + data_[2][2] * m.data_[2][3] + data_[2][3] * m.data_[3][3];
-
-    mat.data_[3][0] = data_[3][0] * m.data_[0][0] + data_[3][1] * m.data_[1][0] + data_[3][2] * m.data_[2][0] + data_[3][3] * m.data_[3][0];
-    mat.data_[3][1] = data_[3][0] * m.data_[0][1] + data_[3][1] * m.data_[1][1] + data_[3][2] * m.data_[2][1] + data_[3][3] * m.data_[3][1];
-    mat.data_[3][2] = data_[3][0] * m.data_[0][2] + data_[3][1] * m.data_[1][2] + data_[3][2] * m.data_[2][2] + data_[3][3] * m.data_[3][2];
-    mat.data_[3][3] = data_[3][0] * m.data_[0][3] + data_[3][1] * m.data_[1][3] + data_[3][2] * m.data_[2][3] + data_[3][3] * m.data_[3][3];
-
+    GetMatrixKernels().multiply(&data_[0][0], &m.data_[0][0], &mat.data_[0][0]);
     return mat;
 }
 
@@ -260,28 +259,7 @@ INLINE void Matrix4x4::operator-=(const Matrix4x4& m) {
 
 INLINE void Matrix4x4::operator*=(const Matrix4x4& m)
 {
-	Matrix4x4 mat = ZERO;
-    mat.data_[0][0] = data_[0][0] * m.data_[0][0] + data_[0][1] * m.data_[1][0] + data_[0][2] * m.data_[2][0] + data_[0][3] * m.data_[3][0];
-    mat.data_[0][1] = data_[0][0] * m.data_[0][1] + data_[0][1] * m.data_[1][1] + data_[0][2] * m.data_[2][1] + data_[0][3] * m.data_[3][1];
-    mat.data_[0][2] = data_[0][0] * m.data_[0][2] + data_[0][1] * m.data_[1][2] + data_[0][2] * m.data_[2][2] + data_[0][3] * m.data_[3][2];
-    mat.data_[0][3] = data_[0][0] * m.data_[0][3] + data_[0][1] * m.data_[1][3] + data_[0][2] * m.data_[2][3] + data_[0][3] * m.data_[3][3];
-
-    mat.data_[1][0] = data_[1][0] * m.data_[0][0] + data_[1][1] * m.data_[1][0] + data_[1][2] * m.data_[2][0] + data_[1][3] * m.data_[3][0];
-    mat.data_[1][1] = data_[1][0] * m.data_[0][1] + data_[1][1] * m.data_[1][1] + data_[1][2] * m.data_[2][1] + data_[1][3] * m.data_[3][1];
-    mat.data_[1][2] = data_[1][0] * m.data_[0][2] + data_[1][1] * m.data_[1][2] + data_[1][2] * m.data_[2][2] + data_[1][3] * m.data_[3][2];
-    mat.data_[1][3] = data_[1][0] * m.data_[0][3] + data_[1][1] * m.data_[1][3] + data_[1][2] * m.data_[2][3] + data_[1][3] * m.data_[3][3];
-
-    mat.data_[2][0] = data_[2][0] * m.data_[0][0] + data_[2][1] * m.data_[1][0] + data_[2][2] * m.data_[2][0] + data_[2][3] * m.data_[3][0];
-    mat.data_[2][1] = data_[2][0] * m.data_[0][1] + data_[2][1] * m.data_[1][1] + data_[2][2] * m.data_[2][1] + data_[2][3] * m.data_[3][1];
-    mat.data_[2][2] = data_[2][0] * m.data_[0][2] + data_[2][1] * m.data_[1][2] + data_[2][2] * m.data_[2][2] + data_[2][3] * m.data_[3][2];
-    mat.data_[2][3] = data_[2][0] * m.data_[0][3] + data_[2][1] * m.data_[1][3] + data_[2][2] * m.data_[2][3] + data_[2][3] * m.data_[3][3];
-
-    mat.data_[3][0] = data_[3][0] * m.data_[0][0] + data_[3][1] * m.data_[1][0] + data_[3][2] * m.data_[2][0] + data_[3][3] * m.data_[3][0];
-    mat.data_[3][1] = data_[3][0] * m.data_[0][1] + data_[3][1] * m.data_[1][1] + data_[3][2] * m.data_[2][1] + data_[3][3] * m.data_[3][1];
-    mat.data_[3][2] = data_[3][0] * m.data_[0][2] + data_[3][1] * m.data_[1][2] + data_[3][2] * m.data_[2][2] + data_[3][3] * m.data_[3][2];
-    mat.data_[3][3] = data_[3][0] * m.data_[0][3] + data_[3][1] * m.data_[1][3] + data_[3][2] * m.data_[2][3] + data_[3][3] * m.data_[3][3];
-
-    (*this) = mat;
+    GetMatrixKernels().multiply(&data_[0][0], &m.data_[0][0], &data_[0][0]);
 }
 
 INLINE void Matrix4x4::operator*=(float f) {
@@ -0,0 +1,79 @@
+#ifndef SKETCH_3D_MATRIX_KERNELS_H
+#define SKETCH_3D_MATRIX_KERNELS_H
+
+#include "system/Platform.h"
+
+#include <stddef.h>
+
+namespace Sketch3D {
+
+/**
+ * @enum MatrixKernelsType_t
+ * The different implementations of the matrix kernels
+ */
+enum MatrixKernelsType_t {
+    MATRIX_KERNELS_SCALAR,
+    MATRIX_KERNELS_SSE2,
+    MATRIX_KERNELS_AVX
+};
+
+/**
+ * @struct MatrixKernels_t
+ * Table of functions implementing the costly 4x4 matrix operations. The matrices are arrays of 16 floats stored row
+ * after row, like the data of Matrix4x4, and the vectors are arrays of 4 floats. The result may be one of the inputs.
+ */
+struct MatrixKernels_t {
+    MatrixKernelsType_t type;
+
+    /**
+     * result = a * b
+     */
+    void    (*multiply)(const float* a, const float* b, float* result);
+
+    /**
+     * result = transpose(m)
+     */
+    void    (*transpose)(const float* m, float* result);
+
+    /**
+     * result = inverse(m)
+     */
+    void    (*inverse)(const float* m, float* result);
+
+    /**
+     * result = m * v, v being a column vector
+     */
+    void    (*transformVector)(const float* m, const float* v, float* result);
+
+    /**
+     * result = v * m, v being a row vector
+     */
+    void    (*transformRowVector)(const float* v, const float* m, float* result);
+
+    /**
+     * results[i] = a * matrices[i], for count matrices stored one after the other
+     */
+    void    (*multiplyBatch)(const float* a, const float* matrices, size_t count, float* results);
+
+    /**
+     * results[i] = transpose(inverse(matrices[i])), for count matrices stored one after the other
+     */
+    void    (*inverseTransposeBatch)(const float* matrices, size_t count, float* results);
+};
+
+/**
+ * Returns the fastest implementation of the matrix kernels supported by the cpu. The implementation is selected
+ * the first time that this function is called
+ */
+SKETCH_3D_API const MatrixKernels_t&    GetMatrixKernels();
+
+/**
+ * Returns a specific implementation of the matrix kernels
+ * @param type The implementation to get
+ * @return The implementation, or nullptr if it isn't supported by the cpu or wasn't compiled in
+ */
+SKETCH_3D_API const MatrixKernels_t*    GetMatrixKernels(MatrixKernelsType_t type);
+
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef SKETCH_3D_BOUNDING_VOLUME_HIERARCHY_H
+#define SKETCH_3D_BOUNDING_VOLUME_HIERARCHY_H
+
+#include "math/BoundingBox.h"
+#include "math/Sphere.h"
+
+#include "system/Platform.h"
+
+#include <stdint.h>
+#include <vector>
+using namespace std;
+
+namespace Sketch3D {
+// Forward struct declaration
+struct FrustumPlanes_t;
+
+// Forward class declaration
+class Node;
+
+typedef int32_t BvhProxy_t;
+
+const BvhProxy_t INVALID_BVH_PROXY = -1;
+
+/**
+ * @class BoundingVolumeHierarchy
+ * Dynamic tree of axis aligned bounding boxes used to cull the nodes of the scene. Each node is a leaf of the tree
+ * (a proxy) and the inner boxes enclose their two children, so that whole regions of the scene can be rejected or
+ * accepted with a single test.
+ *
+ * The leaves are enlarged by a margin so that a node moving by a small amount doesn't have to be reinserted, and
+ * the tree is kept balanced with rotations when leaves are inserted or removed.
+ */
+class SKETCH_3D_API BoundingVolumeHierarchy {
+    public:
+        /**
+         * Constructor. Creates an empty hierarchy
+         */
+                                BoundingVolumeHierarchy();
+
+        /**
+         * Add a node to the hierarchy
+         * @param boundingSphere The bounding sphere of the node in world space
+         * @param node The node. The hierarchy never dereferences it
+         * @return The proxy representing the node in the hierarchy
+         */
+        BvhProxy_t              CreateProxy(const Sphere& boundingSphere, Node* node);
+
+        /**
+         * Remove a node from the hierarchy
+         * @param proxy The proxy returned by CreateProxy
+         */
+        void                    DestroyProxy(BvhProxy_t proxy);
+
+        /**
+         * Update the bounding sphere of a node. The node is only reinserted if it moved out of its enlarged box
+         * @param proxy The proxy returned by CreateProxy
+         * @param boundingSphere The new bounding sphere of the node in world space
+         * @return true if the node had to be reinserted in the hierarchy
+         */
+        bool                    MoveProxy(BvhProxy_t proxy, const Sphere& boundingSphere);
+
+        /**
+         * Find the nodes that are, at least partially, inside the view frustum. Subtrees completely outside of the
+         * frustum are skipped and the nodes of subtrees completely inside of it are accepted without being tested.
+         * The remaining nodes are tested in batches with the culling kernels, starting with the plane that rejected
+         * them during the previous query. Large batches are split between the threads of the job system
+         * @param frustumPlanes The 6 view frustum planes
+         * @param visibleNodes The visible nodes are appended to this list
+         */
+        void                    Query(const FrustumPlanes_t& frustumPlanes, vector<Node*>& visibleNodes);
+
+        /**
+         * Returns all the nodes of the hierarchy
+         * @param nodes The nodes are appended to this list
+         */
+        void                    GetAllNodes(vector<Node*>& nodes) const;
+
+        /**
+         * Returns the height of the tree, 0 if it only has a leaf. Mostly useful for tests and statistics
+         */
+        int32_t                 GetHeight() const;
+
+        size_t                  GetNumProxies() const { return numProxies_; }
+
+    private:
+        /**
+         * @struct TreeNode_t
+         * A node of the tree. Leaves have no children and hold a node of the scene
+         */
+        struct TreeNode_t {
+            BoundingBox         box;        /**< Box enclosing the children, or the enlarged box of the leaf */
+            Sphere              sphere;     /**< Exact bounding sphere of the leaf */
+            Node*               node;       /**< The scene node of the leaf */
+            int32_t             parent;     /**< Parent in the tree or next free node when not allocated */
+            int32_t             child1;
+            int32_t             child2;
+            int32_t             height;     /**< 0 for the leaves, -1 for the free nodes */
+            uint8_t             planeHint;  /**< Frustum plane that rejected the leaf during the last query */
+
+            bool                IsLeaf() const { return child1 == -1; }
+        };
+
+        vector<TreeNode_t>      nodes_;         /**< Pool of the tree nodes, the tree refers to them by index */
+        int32_t                 root_;          /**< Index of the root of the tree */
+        int32_t                 freeList_;      /**< Index of the first free node of the pool */
+        size_t                  numProxies_;    /**< Number of leaves */
+        vector<pair<int32_t, int>> stack_;  /**< Traversal stack, kept to avoid allocating on each query */
+
+        /**
+         * @struct LeafBatch_t
+         * Leaves intersecting the frustum planes, stored as a structure of arrays for the culling kernels
+         */
+        struct LeafBatch_t {
+            vector<int32_t>     leaves;
+            vector<float>       centersX;
+            vector<float>       centersY;
+            vector<float>       centersZ;
+            vector<float>       radii;
+            vector<uint8_t>     planeHints;
+            vector<uint32_t>    visibility;
+        };
+
+        LeafBatch_t             leafBatch_;     /**< Leaves left to test at the end of a query */
+
+        int32_t                 AllocateNode();
+        void                    FreeNode(int32_t index);
+        void                    InsertLeaf(int32_t leaf);
+        void                    RemoveLeaf(int32_t leaf);
+
+        /**
+         * Refit the boxes and heights from a node up to the root, rebalancing the tree on the way
+         * @param index The first node to refit
+         */
+        void                    Refit(int32_t index);
+
+        /**
+         * Rotate the tree around a node if its children heights differ by more than one
+         * @param index The node to balance
+         * @return The index of the node that replaced it in the tree
+         */
+        int32_t                 Balance(int32_t index);
+
+        /**
+         * Append all the scene nodes of a subtree
+         */
+        void                    CollectNodes(int32_t index, vector<Node*>& nodes) const;
+};
+
+}
+
+#endif
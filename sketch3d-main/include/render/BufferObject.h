@@ -120,8 +120,16 @@ class SKETCH_3D_API BufferObject {
          */
         virtual void            PrepareInstanceBuffers() = 0;
 
+        /**
+         * Returns true if BufferObjectManager::RenderMultiDraw can submit the draws of this buffer object along with
+         * the draws of other buffer objects without preparing its instance buffers. Each draw then reads its model
+         * matrix from the instance attributes, at its base instance
+         */
+        virtual bool            SupportsMultiDraw() const { return false; }
+
         size_t                  GetVertexAttributesBitField() const;
         size_t                  GetId() const;
+        size_t                  GetIndexCount() const;
 
     protected:
         VertexAttributesMap_t   vertexAttributes_;  /**< The vertex attributes to use for the vertex buffer */
@@ -1,15 +1,28 @@
 #ifndef SKETCH_3D_BUFFER_OBJECT_MANAGER_H
 #define SKETCH_3D_BUFFER_OBJECT_MANAGER_H
 
+#include "math/Matrix4x4.h"
+
 #include "render/BufferObject.h"
 
 #include "system/Platform.h"
 
 #include <set>
+#include <vector>
 using namespace std;
 
 namespace Sketch3D {
 
+/**
+ * @struct MultiDrawCommand_t
+ * One of the draws submitted together by BufferObjectManager::RenderMultiDraw
+ */
+struct MultiDrawCommand_t {
+    BufferObject*   bufferObject;
+    size_t          firstInstance;  /**< Index of the model matrix of the first instance */
+    size_t          numInstances;
+};
+
 /**
  * @class BufferObjectManager
  * This class acts as a manager to create and handle buffer objects that are API dependent
@@ -33,8 +46,22 @@ class SKETCH_3D_API BufferObjectManager {
          */
         void                    DeleteBufferObject(BufferObject* bufferObject);
 
+        /**
+         * Draw several buffer objects with the same shader and textures. The model matrix of each instance is read
+         * from the instance attributes, like with BufferObject::RenderInstances, so the draws don't need any uniform
+         * in between and the implementation may submit them all at once. The default implementation draws the buffer
+         * objects one after the other
+         * @param commands The draws, in the order in which to submit them
+         * @param numCommands The number of draws
+         * @param modelMatrices The transposed model matrices of the instances of all the draws
+         */
+        virtual void            RenderMultiDraw(const MultiDrawCommand_t* commands, size_t numCommands, const vector<Matrix4x4>& modelMatrices);
+
     protected:
         set<BufferObject*>      bufferObjects_; /**< Buffer objects allocted by the manager */
+
+    private:
+        vector<Matrix4x4>       drawModelMatrices_; /**< Model matrices of the draw being submitted by the default RenderMultiDraw */
 };
 
 }
@@ -3,6 +3,11 @@
 
 #include "render/Shader.h"
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
 // Forward class declaration
 struct IDirect3DDevice9;
 struct IDirect3DVertexShader9;
@@ -27,16 +32,20 @@ class ShaderDirect3D9 : public Shader {
 
         virtual bool SetSourceFile(const string& vertexFilename, const string& fragmentFilename);
         virtual bool SetSource(const string& vertexSource, const string& fragmentSource);
-        virtual bool SetUniformInt(const string& uniform, int value);
-        virtual bool SetUniformFloat(const string& uniform, float value);
-        virtual bool SetUniformVector2(const string& uniform, float value1, float value2);
-        virtual bool SetUniformVector3(const string& uniform, const Vector3& value);
-        virtual bool SetUniformVector3Array(const string& uniform, const Vector3* values, int arraySize);
-        virtual bool SetUniformVector4(const string& uniform, const Vector4& value);
-        virtual bool SetUniformMatrix3x3(const string& uniform, const Matrix3x3& value);
-        virtual bool SetUniformMatrix4x4(const string& uniform, const Matrix4x4& value);
-        virtual bool SetUniformMatrix4x4Array(const string& uniform, const Matrix4x4* values, int arraySize);
-        virtual bool SetUniformTexture(const string& uniform, const Texture* texture);
+        virtual UniformHandle_t GetUniformHandle(const string& uniform) const;
+
+    protected:
+        virtual void SetUniformIntImpl(UniformHandle_t uniform, int value);
+        virtual void SetUniformFloatImpl(UniformHandle_t uniform, float value);
+        virtual void SetUniformVector2Impl(UniformHandle_t uniform, float value1, float value2);
+        virtual void SetUniformVector3Impl(UniformHandle_t uniform, const Vector3& value);
+        virtual void SetUniformVector3ArrayImpl(UniformHandle_t uniform, const Vector3* values, int arraySize);
+        virtual void SetUniformVector4Impl(UniformHandle_t uniform, const Vector4& value);
+        virtual void SetUniformMatrix3x3Impl(UniformHandle_t uniform, const Matrix3x3& value);
+        virtual void SetUniformMatrix4x4Impl(UniformHandle_t uniform, const Matrix4x4& value);
+        virtual void SetUniformMatrix4x4ArrayImpl(UniformHandle_t uniform, const Matrix4x4* values, int arraySize);
+        virtual void SetUniformTextureImpl(UniformHandle_t uniform, const Texture* texture);
+        virtual size_t GetUniformArrayLength(UniformHandle_t uniform) const;
 
     private:
         IDirect3DDevice9*       device_;
@@ -45,6 +54,26 @@ class ShaderDirect3D9 : public Shader {
         ID3DXConstantTable*     vertexConstants_;
         ID3DXConstantTable*     fragmentConstants_;
 
+        /**
+         * @struct Constant_t
+         * A constant of one of the shaders along with the table in which it lives
+         */
+        struct Constant_t {
+            const char*         handle;
+            ID3DXConstantTable* constantTable;
+            size_t              numElements;    /**< Number of elements of the constant, more than one for arrays */
+        };
+
+        unordered_map<string, UniformHandle_t>  nameToConstants_;   /**< Map of constant names to handle */
+        vector<Constant_t>      constants_;     /**< The constants, indexed by their handle */
+
+        /**
+         * Assign a handle to all the constants of a constant table. Constants that were already found in another
+         * table keep their handle
+         * @param constantTable The table to enumerate
+         */
+        void                    ReflectConstants(ID3DXConstantTable* constantTable);
+
         /**
          * Gets the Direct3D9 filter value for the specified filter
          */
@@ -0,0 +1,56 @@
+#ifndef SKETCH_3D_FRAME_STATISTICS_H
+#define SKETCH_3D_FRAME_STATISTICS_H
+
+#include "system/Platform.h"
+
+#include <stddef.h>
+
+namespace Sketch3D {
+
+/**
+ * @struct FrameStatistics_t
+ * Work submitted by the renderer between StartRender and EndRender, see Renderer::GetFrameStatistics
+ */
+struct FrameStatistics_t {
+    // Submission
+    size_t      numDrawCalls;           /**< Draw calls, including the instanced ones */
+    size_t      numInstancedDrawCalls;
+    size_t      numTriangles;           /**< Triangles drawn, counting each instance */
+    size_t      numVertices;            /**< Vertices submitted, one per index of each instance */
+
+    // State changes
+    size_t      numShaderChanges;
+    size_t      numTextureChanges;      /**< Textures bound to a texture unit, the resident ones aren't counted */
+    size_t      numBufferObjectChanges; /**< Vertex array changes between the draws of the render queues */
+    size_t      numRenderStateChanges;  /**< Render states that reached the device */
+
+    // Uploads
+    size_t      numUniformUploads;      /**< Uniforms that reached the device, the unchanged ones aren't counted */
+    size_t      numUploadedBytes;       /**< Bytes written to the vertex, index, instance and uniform buffers */
+
+    // Render queues
+    size_t      numOpaqueItems;
+    size_t      numTransparentItems;
+    double      cullingTime;            /**< Time spent traversing the scene tree and filling the queues, in milliseconds */
+    double      sortingTime;            /**< Time spent sorting the queues and building their commands, in milliseconds */
+    double      executionTime;          /**< Time spent executing the commands of the queues, in milliseconds */
+};
+
+/**
+ * @class BufferUploadCounter
+ * Counts the bytes that the render systems write to the device buffers. The renderer reads and resets the counter
+ * every frame to fill FrameStatistics_t::numUploadedBytes
+ */
+class SKETCH_3D_API BufferUploadCounter {
+    public:
+        static void         Add(size_t numBytes) { numUploadedBytes_ += numBytes; }
+        static size_t       GetNumUploadedBytes() { return numUploadedBytes_; }
+        static void         Reset() { numUploadedBytes_ = 0; }
+
+    private:
+        static size_t       numUploadedBytes_;
+};
+
+}
+
+#endif
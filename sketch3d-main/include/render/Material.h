@@ -1,6 +1,7 @@
 #ifndef SKETCH_3D_MATERIAL_H
 #define SKETCH_3D_MATERIAL_H
 
+#include "render/RenderState.h"
 #include "render/Shader.h"
 
 #include "system/Platform.h"
@@ -22,12 +23,62 @@ enum TransluencyType_t {
     TRANSLUENCY_TYPE_ADDITIVE
 };
 
+/**
+ * @enum MaterialParameterType_t
+ * The types of values that a material can pass to its shader
+ */
+enum MaterialParameterType_t {
+    MATERIAL_PARAMETER_INT,
+    MATERIAL_PARAMETER_FLOAT,
+    MATERIAL_PARAMETER_VECTOR2,
+    MATERIAL_PARAMETER_VECTOR3,
+    MATERIAL_PARAMETER_VECTOR3_ARRAY,
+    MATERIAL_PARAMETER_VECTOR4,
+    MATERIAL_PARAMETER_MATRIX3X3,
+    MATERIAL_PARAMETER_MATRIX4X4,
+    MATERIAL_PARAMETER_MATRIX4X4_ARRAY,
+    MATERIAL_PARAMETER_TEXTURE
+};
+
+/**
+ * @struct MaterialParameter_t
+ * A uniform of the material, compiled against the material's shader
+ */
+struct MaterialParameter_t {
+    MaterialParameterType_t type;
+    UniformHandle_t         handle;     /**< Handle of the uniform in the material's shader */
+    size_t                  offset;     /**< Offset of the value in the parameter data, or in the textures for a texture */
+    size_t                  size;       /**< Number of floats of the value, 0 for a texture */
+    size_t                  version;    /**< Version of the material when the value was last changed */
+};
+
+/**
+ * @struct MaterialState_t
+ * Everything that is read to apply a material. It points either to the buffers of the material or to copies of them,
+ * so that a copy taken on one frame can be applied while the material is changed for the next one
+ */
+struct MaterialState_t {
+    Shader*                     shader;
+    RenderStateBlockHandle_t    renderStateBlock;
+    size_t                      version;
+    const MaterialParameter_t*  parameters;
+    size_t                      numParameters;
+    const float*                parameterData;      /**< The values of all the uniforms except the textures */
+    size_t                      numParameterData;
+    const Texture* const*       textures;
+    size_t                      numTextures;
+};
+
 /**
  * @class Material
  * This class defines a material to use on a mesh. It gives has a shader that
  * will be run to render the mesh as well as a set of general material
  * properties that will be pass to the shader to control how the mesh will be
  * rendered.
+ *
+ * The uniforms of the material are compiled against its shader as they are set: their handles are resolved once and
+ * their values are packed in a flat buffer. Each change bumps the version of the material, so that a material that is
+ * applied again only has to upload the uniforms that changed in between.
  */
 class SKETCH_3D_API Material {
 	public:
@@ -42,9 +93,32 @@ class SKETCH_3D_API Material {
          */
         bool                            ApplyMaterial() const;
 
+        /**
+         * Apply the uniforms that changed since the material was last applied to its shader. The textures are always
+         * applied since other draw calls may have bound their texture unit to another texture
+         * @param appliedVersion The version of the material when it was last applied
+         * @return false if the material couldn't apply its uniform, true otherwise
+         */
+        bool                            ApplyMaterial(size_t appliedVersion) const;
+
+        /**
+         * Apply the uniforms of a material's state that changed since it was last applied to its shader
+         * @param state The state of the material, as returned by GetState or copied from it
+         * @param appliedVersion The version of the material when it was last applied, 0 to apply all the uniforms
+         * @return false if the material couldn't apply its uniform, true otherwise
+         */
+        static bool                     ApplyMaterialState(const MaterialState_t& state, size_t appliedVersion);
+
         void		                    SetShader(Shader* shader);
         void                            SetTransluencyType(TransluencyType_t type);
 
+        /**
+         * Set the render states used to draw with this material
+         * @param renderStateBlock A block created by the render state cache, or INVALID_RENDER_STATE_BLOCK to draw with
+         * the render states set on the renderer
+         */
+        void                            SetRenderStateBlock(RenderStateBlockHandle_t renderStateBlock) { renderStateBlock_ = renderStateBlock; }
+
         // UNIFORM SETTERS
         void	                        SetUniformInt(const string& uniform, int value);
         void	                        SetUniformFloat(const string& uniform, float value);
@@ -60,21 +134,54 @@ class SKETCH_3D_API Material {
 		Shader*		                    GetShader() const;
         TransluencyType_t               GetTransluencyType() const;
 
+        /**
+         * Returns the id of the material, given in creation order so that it is the same from one run to the next
+         */
+        size_t                          GetId() const { return id_; }
+        RenderStateBlockHandle_t        GetRenderStateBlock() const { return renderStateBlock_; }
+
+        /**
+         * Returns the version of the material, which changes each time one of its uniforms or its shader changes
+         */
+        size_t                          GetVersion() const { return version_; }
+
+        const vector<MaterialParameter_t>& GetParameters() const { return parameters_; }
+
+        /**
+         * Returns the state of the material. It points to the buffers of the material, which are only valid until one
+         * of its uniforms is set
+         */
+        MaterialState_t                 GetState() const;
+
 	private:
+        size_t                          id_;        /**< Id of the material */
+        static size_t                   nextAvailableId_;
 		Shader*		                    shader_;	/**< Shader used by the material */
         TransluencyType_t               transluencyType_;   /**< The transluency type for this material */
+        RenderStateBlockHandle_t        renderStateBlock_;  /**< Render states of the material, invalid to use the renderer's */
+        size_t                          version_;
 
         // List of uniforms to set during rendering with this material
-        map<string, int>                intUniforms_;
-        map<string, float>              floatUniforms_;
-        map<string, Vector2>            vector2Uniforms_;
-        map<string, Vector3>            vector3Uniforms_;
-        map<string, vector<Vector3>>    vector3ArrayUniforms_;
-        map<string, Vector4>            vector4Uniforms_;
-        map<string, Matrix3x3>          matrix3x3Uniforms_;
-        map<string, Matrix4x4>          matrix4x4Uniforms_;
-        map<string, vector<Matrix4x4>>  matrix4x4ArrayUniforms_;
-        map<string, const Texture*>     textureUniforms_;
+        vector<MaterialParameter_t>     parameters_;
+        vector<string>                  parameterNames_;    /**< Name of each uniform, indexed like parameters_ */
+        map<string, size_t>             parameterIndices_;  /**< Index of each uniform in parameters_ */
+        vector<float>                   parameterData_;     /**< The values of all the uniforms except the textures */
+        vector<const Texture*>          textures_;
+
+        /**
+         * Returns the storage of a uniform's value, creating the uniform or resizing its storage if required, and
+         * bumps the version of the uniform
+         * @param uniform The name of the uniform
+         * @param type The type of the uniform
+         * @param size The number of floats of the value, 0 for a texture
+         */
+        MaterialParameter_t&            PrepareParameter(const string& uniform, MaterialParameterType_t type, size_t size);
+
+        /**
+         * Copy the value of a uniform in the parameter data
+         */
+        void                            SetParameterData(const string& uniform, MaterialParameterType_t type, const void* data,
+                                                         size_t size);
 };
 
 }
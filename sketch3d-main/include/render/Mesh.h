@@ -143,6 +143,23 @@ class SKETCH_3D_API Mesh {
 		 */
         void					        GetRenderInfo(BufferObject**& bufferObjects, vector<SurfaceTriangles_t*>& surfaces) const;
 
+        /**
+         * Returns the number of surfaces (sub-meshes) of the mesh
+         */
+        size_t                          GetNumSurfaces() const;
+
+        /**
+         * Returns the surface at the specified index
+         * @param index The index of the surface. Must be smaller than GetNumSurfaces()
+         */
+        SurfaceTriangles_t*             GetSurface(size_t index) const;
+
+        /**
+         * Returns the buffer object of the surface at the specified index
+         * @param index The index of the surface. Must be smaller than GetNumSurfaces()
+         */
+        BufferObject*                   GetBufferObject(size_t index) const;
+
         const Sphere&                   GetBoundingSphere() const;
         const VertexAttributesMap_t&    GetVertexAttributes() const;
         size_t                          GetVertexAttributesBitField() const;
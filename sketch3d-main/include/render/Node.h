@@ -5,6 +5,8 @@
 #include "math/Quaternion.h"
 #include "math/Vector3.h"
 
+#include "render/BoundingVolumeHierarchy.h"
+
 #include "system/Platform.h"
 
 #include <map>
@@ -12,13 +14,10 @@
 using namespace std;
 
 namespace Sketch3D {
-// Forward struct declaration
-struct FrustumPlanes_t;
-
 // Forward class declaration
 class Material;
 class Mesh;
-class RenderQueue;
+class SceneTree;
 
 /**
  * @class Node
@@ -196,15 +195,25 @@ class SKETCH_3D_API Node {
         bool                useInstancing_; /**< If set to true, the node will use instanced rendering */
         bool                isStatic_;      /**< If set to true, the node will be batched with other static nodes */
 
-		/**
-		 * This function sends the data required for the rendering.
-         * @param frustumPlanes The 6 view frustum planes to cull nodes
-         * @param useFrustumCulling If set to true, the frustum planes will be used to cull this node
-         * @param opaqueRenderQueue The render queue to use for drawing opaque objects
-         * @param transparentRenderQueue The render queue to use for drawing transparent objects
-		 */
-		void                Render(const FrustumPlanes_t& frustumPlanes, bool useFrustumCulling, RenderQueue& opaqueRenderQueue,
-                                   RenderQueue& transparentRenderQueue);
+        SceneTree*          sceneTree_;     /**< The scene tree to which the node belongs, nullptr if none */
+        BvhProxy_t          cullingProxy_;  /**< Proxy of the node in the culling hierarchy of the scene tree */
+        bool                isBoundsDirty_; /**< Is the node waiting for its bounds to be updated in the scene tree? */
+
+        /**
+         * Set the scene tree of this node and of all its children
+         * @param sceneTree The scene tree, nullptr if the node doesn't belong to one
+         */
+        void                AttachToSceneTree(SceneTree* sceneTree);
+
+        /**
+         * Remove this node and all its children from their scene tree
+         */
+        void                DetachFromSceneTree();
+
+        /**
+         * Signal to the scene tree that the bounds of this node and of its children have to be updated
+         */
+        void                MarkBoundsDirty();
 };
 
 }
@@ -0,0 +1,26 @@
+#ifndef SKETCH_3D_BUFFER_OBJECT_MANAGER_NULL_H
+#define SKETCH_3D_BUFFER_OBJECT_MANAGER_NULL_H
+
+#include "render/BufferObjectManager.h"
+
+namespace Sketch3D {
+
+// Forward declaration
+class RenderCommandLog;
+
+/**
+ * @class BufferObjectManagerNull
+ * Null implementation of the buffer object manager
+ */
+class BufferObjectManagerNull : public BufferObjectManager {
+    public:
+                                BufferObjectManagerNull(RenderCommandLog* commandLog);
+        virtual BufferObject*   CreateBufferObject(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage=BUFFER_USAGE_STATIC);
+
+    private:
+        RenderCommandLog*       commandLog_;    /**< Log given to the created buffer objects */
+};
+
+}
+
+#endif
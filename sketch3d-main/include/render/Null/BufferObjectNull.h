@@ -0,0 +1,40 @@
+#ifndef SKETCH_3D_BUFFER_OBJECT_NULL_H
+#define SKETCH_3D_BUFFER_OBJECT_NULL_H
+
+#include "render/BufferObject.h"
+
+namespace Sketch3D {
+
+// Forward declaration
+class RenderCommandLog;
+
+/**
+ * @class BufferObjectNull
+ * Buffer object of the null render system. The data isn't kept, only the counts needed to record the draws
+ */
+class BufferObjectNull : public BufferObject {
+    public:
+                                    BufferObjectNull(RenderCommandLog* commandLog, const VertexAttributesMap_t& vertexAttributes,
+                                                     BufferUsage_t usage=BUFFER_USAGE_STATIC);
+        virtual                    ~BufferObjectNull();
+        virtual void                Render();
+        virtual void                RenderInstances(const vector<Matrix4x4>& modelMatrices);
+        virtual BufferObjectError_t SetVertexData(const vector<float>& vertexData, int presentVertexAttributes);
+        virtual BufferObjectError_t AppendVertexData(const vector<float>& vertexData, int presentVertexAttributes);
+        virtual BufferObjectError_t SetIndexData(unsigned short* indexData, size_t numIndex);
+        virtual BufferObjectError_t AppendIndexData(unsigned short* indexData, size_t numIndex);
+        virtual void                PrepareInstanceBuffers();
+
+        /**
+         * The static buffer objects can be drawn together, like the ones that the OpenGL render system stores in a
+         * geometry pool
+         */
+        virtual bool                SupportsMultiDraw() const { return usage_ == BUFFER_USAGE_STATIC; }
+
+    private:
+        RenderCommandLog*           commandLog_;    /**< Log in which the draws are recorded */
+};
+
+}
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef SKETCH_3D_RENDER_COMMAND_LOG_H
+#define SKETCH_3D_RENDER_COMMAND_LOG_H
+
+#include "system/Platform.h"
+
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace Sketch3D {
+
+/**
+ * @enum RecordedCommandType_t
+ * The type of the commands recorded by the null render system. The meaning of the object id and of the arguments
+ * of a command depends on its type:
+ *  - CLEAR: arguments[0] is the ClearBuffer_t bit field;
+ *  - SET_VIEWPORT: arguments are x, y, width and height;
+ *  - BIND_FRAMEBUFFER: the object is 0 for the screen, 1 for a render texture. arguments[0] and arguments[1] are its size;
+ *  - BIND_SHADER: the object is the id of the shader, RECORDED_NULL_OBJECT when unbinding;
+ *  - BIND_TEXTURE: the object is the id of the texture, arguments[0] is the texture unit;
+ *  - SET_UNIFORM: the object is the id of the shader, arguments[0] is the uniform handle, arguments[1] the RecordedUniformType_t,
+ *    arguments[2] the size of an array or the value of an int;
+ *  - SET_RENDER_STATE: the object is a RecordedRenderState_t, the arguments are the new values of the state;
+ *  - DRAW: the object is the id of the buffer object, arguments[0] is the number of indices;
+ *  - DRAW_INSTANCED: same as DRAW, arguments[1] is the number of instances;
+ *  - PRESENT: no object or argument
+ */
+enum RecordedCommandType_t {
+    RECORDED_COMMAND_CLEAR,
+    RECORDED_COMMAND_SET_VIEWPORT,
+    RECORDED_COMMAND_BIND_FRAMEBUFFER,
+    RECORDED_COMMAND_BIND_SHADER,
+    RECORDED_COMMAND_BIND_TEXTURE,
+    RECORDED_COMMAND_SET_UNIFORM,
+    RECORDED_COMMAND_SET_FRAME_CONSTANTS,
+    RECORDED_COMMAND_SET_RENDER_STATE,
+    RECORDED_COMMAND_DRAW,
+    RECORDED_COMMAND_DRAW_INSTANCED,
+    RECORDED_COMMAND_PRESENT,
+    NUM_RECORDED_COMMANDS
+};
+
+/**
+ * @enum RecordedUniformType_t
+ * The type of the value set by a RECORDED_COMMAND_SET_UNIFORM command
+ */
+enum RecordedUniformType_t {
+    RECORDED_UNIFORM_INT,
+    RECORDED_UNIFORM_FLOAT,
+    RECORDED_UNIFORM_VECTOR2,
+    RECORDED_UNIFORM_VECTOR3,
+    RECORDED_UNIFORM_VECTOR3_ARRAY,
+    RECORDED_UNIFORM_VECTOR4,
+    RECORDED_UNIFORM_MATRIX3X3,
+    RECORDED_UNIFORM_MATRIX4X4,
+    RECORDED_UNIFORM_MATRIX4X4_ARRAY,
+    RECORDED_UNIFORM_TEXTURE
+};
+
+/**
+ * @enum RecordedRenderState_t
+ * The render state changed by a RECORDED_COMMAND_SET_RENDER_STATE command
+ */
+enum RecordedRenderState_t {
+    RECORDED_RENDER_STATE_DEPTH_TEST,
+    RECORDED_RENDER_STATE_DEPTH_WRITE,
+    RECORDED_RENDER_STATE_COLOR_WRITE,
+    RECORDED_RENDER_STATE_BLENDING,
+    RECORDED_RENDER_STATE_DEPTH_COMPARISON_FUNC,
+    RECORDED_RENDER_STATE_CULLING_METHOD,
+    RECORDED_RENDER_STATE_BLENDING_EQUATION,
+    RECORDED_RENDER_STATE_BLENDING_FACTOR,
+    RECORDED_RENDER_STATE_FILL_MODE
+};
+
+const size_t RECORDED_NULL_OBJECT = (size_t)-1;
+
+/**
+ * @struct RecordedCommand_t
+ * A single command recorded by the null render system
+ */
+struct RecordedCommand_t {
+    RecordedCommandType_t   type;
+    size_t                  objectId;       /**< The object on which the command applies */
+    size_t                  arguments[4];   /**< The arguments of the command, unused ones are set to 0 */
+};
+
+/**
+ * @class RenderCommandLog
+ * Records the commands that the null render system would have sent to the GPU. The log keeps its memory when it
+ * is cleared, so recording a frame doesn't allocate once the log has grown to the size of a frame.
+ */
+class SKETCH_3D_API RenderCommandLog {
+    public:
+        /**
+         * Constructor. The recording is enabled
+         */
+                                            RenderCommandLog();
+
+        /**
+         * Record a command at the end of the log. Does nothing if the recording is disabled
+         * @param type The type of the command
+         * @param objectId The object on which the command applies
+         * @param argument0 First argument of the command
+         * @param argument1 Second argument of the command
+         * @param argument2 Third argument of the command
+         * @param argument3 Fourth argument of the command
+         */
+        void                                Record(RecordedCommandType_t type, size_t objectId=RECORDED_NULL_OBJECT, size_t argument0=0,
+                                                   size_t argument1=0, size_t argument2=0, size_t argument3=0);
+
+        /**
+         * Remove all the commands from the log
+         */
+        void                                Clear();
+
+        /**
+         * Enable or disable the recording. Disabling it is useful to measure the cost of the renderer alone
+         * @param enabled If true, the commands are recorded
+         */
+        void                                SetEnabled(bool enabled);
+
+        /**
+         * Returns the number of commands of a given type in the log
+         * @param type The type of command to count
+         */
+        size_t                              CountCommands(RecordedCommandType_t type) const;
+
+        /**
+         * Returns the log in a human readable form, one command per line. Useful to compare against golden files
+         */
+        string                              ToString() const;
+
+        const vector<RecordedCommand_t>&    GetCommands() const { return commands_; }
+        bool                                IsEnabled() const { return enabled_; }
+
+    private:
+        vector<RecordedCommand_t>           commands_;  /**< The recorded commands */
+        bool                                enabled_;   /**< Is the recording enabled? */
+};
+
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef SKETCH_3D_RENDER_STATE_CACHE_NULL_H
+#define SKETCH_3D_RENDER_STATE_CACHE_NULL_H
+
+#include "render/RenderStateCache.h"
+
+namespace Sketch3D {
+
+// Forward declaration
+class RenderCommandLog;
+
+/**
+ * @class RenderStateCacheNull
+ * Null implementation of the RenderStateCache. The state changes that reach the device are recorded
+ */
+class RenderStateCacheNull : public RenderStateCache {
+    public:
+                            RenderStateCacheNull(RenderCommandLog* commandLog);
+        virtual            ~RenderStateCacheNull();
+
+    protected:
+        virtual void        EnableDepthTestImpl();
+        virtual void        EnableDepthWriteImpl();
+        virtual void        EnableColorWriteImpl();
+        virtual void        EnableBlendingImpl();
+        virtual void        SetDepthComparisonFuncImpl();
+        virtual void        SetCullingMethodImpl();
+        virtual void        SetBlendingEquationImpl();
+        virtual void        SetBlendingFactorImpl();
+        virtual void        SetRenderFillModeImpl();
+
+    private:
+        RenderCommandLog*   commandLog_;    /**< Log in which the state changes are recorded */
+};
+
+}
+
+#endif
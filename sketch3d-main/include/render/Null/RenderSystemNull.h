@@ -0,0 +1,58 @@
+#ifndef SKETCH_3D_RENDER_SYSTEM_NULL_H
+#define SKETCH_3D_RENDER_SYSTEM_NULL_H
+
+#include "render/RenderSystem.h"
+
+#include "render/Null/RenderCommandLog.h"
+
+namespace Sketch3D {
+
+/**
+ * @class RenderSystemNull
+ * Render system that doesn't create a window nor a context. Instead of talking to a GPU, it records the binds,
+ * uniform sets, state changes and draws in a command log that can be inspected. This allows the renderer to be
+ * benchmarked and tested on the CPU alone.
+ *
+ * The log isn't cleared automatically, call GetCommandLog().Clear() between the frames to inspect.
+ */
+class SKETCH_3D_API RenderSystemNull : public RenderSystem {
+	public:
+        /**
+         * Constructor
+         * @param width The width of the surface that the render system pretends to draw on
+         * @param height The height of the surface that the render system pretends to draw on
+         */
+                                    RenderSystemNull(unsigned int width, unsigned int height);
+		virtual                    ~RenderSystemNull();
+		virtual bool                Initialize(const RenderParameters_t& renderParameters);
+		virtual void                SetClearColor(float red, float green, float blue, float alpha=1.0f);
+		virtual void                Clear(int buffer) const;
+        virtual void                StartRender();
+		virtual void                EndRender();
+        virtual void                PresentFrame();
+        virtual Matrix4x4           OrthoProjection(float left, float right, float top, float bottom, float nearPlane, float farPlane) const;
+        virtual Matrix4x4           PerspectiveProjection(float left, float right, float top, float bottom, float nearPlane, float farPlane) const;
+        virtual void                SetViewport(size_t x, size_t y, size_t width, size_t height);
+        virtual Shader*             CreateShader();
+        virtual Texture2D*          CreateTexture2D() const;
+        virtual Texture3D*          CreateTexture3D() const;
+        virtual RenderTexture*      CreateRenderTexture(unsigned int width, unsigned int height, TextureFormat_t format);
+        virtual void                BindScreenBuffer() const;
+        virtual void                BindShader(const Shader* shader);
+        virtual FrustumPlanes_t     ExtractViewFrustumPlanes(const Matrix4x4& viewProjection) const;
+
+        RenderCommandLog&           GetCommandLog() { return commandLog_; }
+        const RenderCommandLog&     GetCommandLog() const { return commandLog_; }
+
+	private:
+        mutable RenderCommandLog    commandLog_;        /**< The commands recorded so far */
+
+        virtual void                QueryDeviceCapabilities();
+        virtual void                CreateTextShader();
+        virtual void                SetFrameConstantsImpl();
+        virtual void                BindTextureImpl(const Texture* texture, size_t textureUnit, bool isResident);
+};
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef SKETCH_3D_RENDER_TEXTURE_NULL_H
+#define SKETCH_3D_RENDER_TEXTURE_NULL_H
+
+#include "render/RenderTexture.h"
+
+#include <vector>
+using namespace std;
+
+namespace Sketch3D {
+
+// Forward declaration
+class RenderCommandLog;
+
+/**
+ * @class RenderTextureNull
+ * Render texture of the null render system. Binding it is recorded in the command log
+ */
+class RenderTextureNull : public RenderTexture {
+    public:
+        /**
+         * Constructor
+         * @param commandLog The log in which the binds are recorded
+         * @param width The width of the render texture
+         * @param height The height of the render texture
+         * @param format The format of the render texture
+         */
+                            RenderTextureNull(RenderCommandLog* commandLog, unsigned int width, unsigned int height, TextureFormat_t format);
+
+        virtual            ~RenderTextureNull();
+        virtual bool        AddDepthBuffer();
+        virtual Texture2D*  CreateTexture2D() const;
+        virtual Texture2D*  CreateDepthBufferTexture() const;
+        virtual bool        AttachTextureToDepthBuffer(Texture2D* texture);
+        virtual bool        AttachTextures(const vector<Texture2D*>& textures);
+        virtual void        Bind() const;
+
+    private:
+        RenderCommandLog*   commandLog_;    /**< Log in which the binds are recorded */
+
+        static int          numGeneratedTextures_;
+};
+
+}
+
+#endif
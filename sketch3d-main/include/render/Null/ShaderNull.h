@@ -0,0 +1,72 @@
+#ifndef SKETCH_3D_SHADER_NULL_H
+#define SKETCH_3D_SHADER_NULL_H
+
+#include "render/Shader.h"
+
+#include <unordered_map>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace Sketch3D {
+
+// Forward declaration
+class RenderCommandLog;
+
+/**
+ * @class ShaderNull
+ * Shader of the null render system. Nothing is compiled: the uniforms are found by looking for their declaration in
+ * the GLSL source and the uniform sets are recorded in the command log
+ */
+class ShaderNull : public Shader {
+	public:
+		                        ShaderNull(RenderCommandLog* commandLog);
+        virtual                ~ShaderNull();
+
+        virtual bool            SetSourceFile(const string& vertexFilename, const string& fragmentFilename);
+        virtual bool            SetSource(const string& vertexSource, const string& fragmentSource);
+        virtual UniformHandle_t GetUniformHandle(const string& uniform) const;
+
+        /**
+         * Returns the name of a uniform from its handle
+         * @param uniform A valid handle
+         */
+        const string&           GetUniformName(UniformHandle_t uniform) const { return uniformNames_[uniform]; }
+
+    protected:
+        virtual void            SetUniformIntImpl(UniformHandle_t uniform, int value);
+        virtual void            SetUniformFloatImpl(UniformHandle_t uniform, float value);
+        virtual void            SetUniformVector2Impl(UniformHandle_t uniform, float value1, float value2);
+        virtual void            SetUniformVector3Impl(UniformHandle_t uniform, const Vector3& value);
+        virtual void            SetUniformVector3ArrayImpl(UniformHandle_t uniform, const Vector3* values, int arraySize);
+        virtual void            SetUniformVector4Impl(UniformHandle_t uniform, const Vector4& value);
+        virtual void            SetUniformMatrix3x3Impl(UniformHandle_t uniform, const Matrix3x3& value);
+        virtual void            SetUniformMatrix4x4Impl(UniformHandle_t uniform, const Matrix4x4& value);
+        virtual void            SetUniformMatrix4x4ArrayImpl(UniformHandle_t uniform, const Matrix4x4* values, int arraySize);
+        virtual void            SetUniformTextureImpl(UniformHandle_t uniform, const Texture* texture);
+        virtual size_t          GetUniformArrayLength(UniformHandle_t uniform) const;
+
+	private:
+        RenderCommandLog*                       commandLog_;        /**< Log in which the uniform sets are recorded */
+        unordered_map<string, UniformHandle_t>  nameToUniforms_;    /**< Map of uniform names to handle */
+        vector<string>                          uniformNames_;      /**< Name of the uniforms, indexed by their handle */
+        vector<size_t>                          uniformArrayLengths_;   /**< Number of elements of the uniforms, indexed by their handle */
+
+		/**
+		 * Read a shader file
+		 * @param filename The name of the file to read
+		 * @param source The content of the file
+		 * @return true if the file could be read
+		 */
+		bool	ReadShader(const string& filename, string& source) const;
+
+		/**
+		 * Assign a handle to every uniform declared in a shader source
+		 * @param source The GLSL source of the shader
+		 */
+		void	ReflectUniforms(const string& source);
+};
+
+}
+
+#endif
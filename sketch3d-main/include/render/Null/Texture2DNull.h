@@ -0,0 +1,33 @@
+#ifndef SKETCH_3D_TEXTURE_2D_NULL_H
+#define SKETCH_3D_TEXTURE_2D_NULL_H
+
+#include "render/Texture2D.h"
+
+namespace Sketch3D {
+
+/**
+ * @class Texture2DNull
+ * 2D texture of the null render system. No storage is created for the texture
+ */
+class Texture2DNull : public Texture2D {
+    public:
+		/**
+		 * Constructor
+         * @param generateMipmaps If set to true, generate mipmaps for this texture
+		 */
+					        Texture2DNull(bool generateMipmaps=false);
+
+        virtual            ~Texture2DNull();
+        virtual bool        Create();
+        virtual const void* GetData() const;
+
+    private:
+        virtual void        SetFilterModeImpl() const;
+        virtual void        SetWrapModeImpl() const;
+        virtual void        SetPixelDataBytesImp(unsigned char* data);
+        virtual void        SetPixelDataFloatsImp(float* data);
+};
+
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef SKETCH_3D_TEXTURE_3D_NULL_H
+#define SKETCH_3D_TEXTURE_3D_NULL_H
+
+#include "render/Texture3D.h"
+
+namespace Sketch3D {
+
+/**
+ * @class Texture3DNull
+ * 3D texture of the null render system. No storage is created for the texture
+ */
+class Texture3DNull : public Texture3D {
+    public:
+		/**
+		 * Constructor
+         * @param generateMipmaps If set to true, generate mipmaps for this texture
+		 */
+					        Texture3DNull(bool generateMipmaps=false);
+
+        virtual            ~Texture3DNull();
+        virtual bool        Create();
+
+    private:
+        virtual void        SetFilterModeImpl() const;
+        virtual void        SetWrapModeImpl() const;
+        virtual void        SetPixelDataBytesImp(unsigned char* data);
+        virtual void        SetPixelDataFloatsImp(float* data);
+};
+
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef SKETCH_3D_BIND_STATE_OPENGL_H
+#define SKETCH_3D_BIND_STATE_OPENGL_H
+
+#include "render/OpenGL/gl/glew.h"
+#include "render/OpenGL/gl/gl.h"
+
+#include <stddef.h>
+
+namespace Sketch3D {
+
+/**
+ * @enum BufferBindingTarget_t
+ * The buffer binding points shadowed by BindStateOpenGL
+ */
+enum BufferBindingTarget_t {
+    BUFFER_BINDING_ARRAY,
+    BUFFER_BINDING_ELEMENT_ARRAY,
+    BUFFER_BINDING_UNIFORM,
+    BUFFER_BINDING_DRAW_INDIRECT,
+    BUFFER_BINDING_COUNT
+};
+
+/**
+ * @class BindStateOpenGL
+ * Shadow of the objects bound to the OpenGL context. All the binds of the OpenGL backend go through this class, which
+ * only calls the driver when the object isn't bound yet.
+ *
+ * The objects must also be deleted through this class: OpenGL unbinds a deleted object and may give its name to a new
+ * object, which the shadow would otherwise consider as bound.
+ *
+ * The textures bound to each texture unit are shadowed by the TextureUnitCache of the render system, which identifies
+ * the textures by their Texture id rather than by their OpenGL name, so it doesn't have to know when they are deleted.
+ */
+class BindStateOpenGL {
+    public:
+                            BindStateOpenGL();
+
+        /**
+         * Consider that nothing is bound, like in a new context
+         */
+        void                Reset();
+
+        void                UseProgram(GLuint program);
+        void                BindVertexArray(GLuint vertexArray);
+
+        /**
+         * Bind a buffer. The element array buffer is part of the vertex array object, so the vertex array object that
+         * will use it must be bound first
+         * @param target The binding point of the buffer, GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER or
+         * GL_DRAW_INDIRECT_BUFFER. The other targets aren't shadowed
+         * @param buffer The buffer to bind
+         */
+        void                BindBuffer(GLenum target, GLuint buffer);
+        void                BindFramebuffer(GLuint framebuffer);
+
+        /**
+         * Select the texture unit modified by BindTexture
+         * @param textureUnit The texture unit, starting at 0
+         */
+        void                ActiveTexture(size_t textureUnit);
+
+        /**
+         * Bind a texture to the active texture unit. The bind always reaches the driver, the texture unit cache having
+         * already dropped the textures that are bound
+         * @param target GL_TEXTURE_2D or GL_TEXTURE_3D
+         * @param texture The texture to bind
+         */
+        void                BindTexture(GLenum target, GLuint texture);
+
+        void                DeleteProgram(GLuint program);
+        void                DeleteVertexArray(GLuint vertexArray);
+        void                DeleteBuffer(GLuint buffer);
+        void                DeleteFramebuffer(GLuint framebuffer);
+
+        /**
+         * Returns the number of binds that reached the driver since the counters were reset
+         */
+        size_t              GetNumIssuedBinds() const { return numIssuedBinds_; }
+
+        /**
+         * Returns the number of binds that were dropped because the object was already bound
+         */
+        size_t              GetNumSkippedBinds() const { return numSkippedBinds_; }
+
+        void                ResetCounters();
+
+    private:
+        GLuint              program_;
+        GLuint              vertexArray_;
+        GLuint              buffers_[BUFFER_BINDING_COUNT];
+        bool                isElementArrayBufferKnown_;     /**< false when a vertex array object was bound since the
+                                                                 last bind of the element array buffer */
+        GLuint              framebuffer_;
+        size_t              activeTextureUnit_;
+        size_t              numIssuedBinds_;
+        size_t              numSkippedBinds_;
+
+        /**
+         * Count a bind and tell if it has to reach the driver
+         * @param bound The name of the object bound at the binding point, updated to object
+         * @param object The object to bind
+         * @return true if the object must be bound
+         */
+        bool                UpdateBinding(GLuint& bound, GLuint object);
+};
+
+}
+
+#endif
@@ -3,17 +3,68 @@
 
 #include "render/BufferObjectManager.h"
 
+#include "render/OpenGL/GeometryPoolOpenGL.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+using namespace std;
+
 namespace Sketch3D {
 
+// Forward declaration
+class BindStateOpenGL;
+class InstanceRingBufferOpenGL;
+
 /**
  * @class BufferObjectManagerOpenGL
- * OpenGL implementation of the buffer object manager
+ * OpenGL implementation of the buffer object manager. It owns the geometry pools of the static buffer objects and
+ * submits the draws of a same pool with glMultiDrawElementsIndirect
  */
 class BufferObjectManagerOpenGL : public BufferObjectManager {
     public:
-        virtual BufferObject* CreateBufferObject(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage=BUFFER_USAGE_STATIC);
+        /**
+         * Constructor
+         * @param instanceRingBuffer The buffer in which the buffer objects stream the model matrices of their instances
+         * @param bindState The objects bound to the context
+         */
+                                    BufferObjectManagerOpenGL(InstanceRingBufferOpenGL* instanceRingBuffer, BindStateOpenGL* bindState);
+
+        /**
+         * Destructor - releases the buffer objects before the geometry pools that they use
+         */
+        virtual                    ~BufferObjectManagerOpenGL();
+
+        virtual BufferObject*       CreateBufferObject(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage=BUFFER_USAGE_STATIC);
+
+        /**
+         * Write the model matrices of all the draws in the instance ring buffer at once, then draw the buffer objects
+         * of each geometry pool with a single glMultiDrawElementsIndirect. The buffer objects that aren't in a pool
+         * are drawn one by one
+         */
+        virtual void                RenderMultiDraw(const MultiDrawCommand_t* commands, size_t numCommands, const vector<Matrix4x4>& modelMatrices);
+
+        /**
+         * Returns the geometry pool of a vertex layout, creating it if needed
+         * @param vertexAttributes The location of the vertex attributes
+         * @param presentVertexAttributes The vertex attributes present in the vertices
+         * @return The geometry pool, nullptr if the context can't draw from shared buffers with multi-draw indirect
+         */
+        GeometryPoolOpenGL*         GetGeometryPool(const VertexAttributesMap_t& vertexAttributes, int presentVertexAttributes);
+
+        InstanceRingBufferOpenGL*   GetInstanceRingBuffer() const { return instanceRingBuffer_; }
+        BindStateOpenGL*            GetBindState() const { return bindState_; }
+
+    private:
+        InstanceRingBufferOpenGL*   instanceRingBuffer_;
+        BindStateOpenGL*            bindState_;
+        map<pair<VertexAttributesMap_t, int>, GeometryPoolOpenGL*>  geometryPools_;    /**< Geometry pools by vertex layout */
+        GLuint                      indirectBuffer_;    /**< Buffer from which glMultiDrawElementsIndirect reads the commands */
+        vector<MultiDrawCommand_t>  sortedCommands_;    /**< Draws being submitted, grouped by geometry pool */
+        vector<size_t>              bucketOffsets_;     /**< Position in sortedCommands_ of the draws of each geometry pool */
+        vector<DrawElementsIndirectCommand_t>   indirectCommands_;  /**< Commands of the geometry pool being submitted */
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -8,13 +8,22 @@
 
 namespace Sketch3D {
 
+// Forward declaration
+class BindStateOpenGL;
+class BufferObjectManagerOpenGL;
+class GeometryPoolOpenGL;
+class InstanceRingBufferOpenGL;
+struct DrawElementsIndirectCommand_t;
+
 /**
  * @class BufferObjectOpenGL
- * OpenGL implementation of vertex paired with an index buffer
+ * OpenGL implementation of vertex paired with an index buffer. The static buffer objects store their vertices and
+ * indices in the geometry pool of their vertex layout when the context supports multi-draw indirect
  */
 class BufferObjectOpenGL : public BufferObject {
     public:
-                                    BufferObjectOpenGL(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage=BUFFER_USAGE_STATIC);
+                                    BufferObjectOpenGL(BufferObjectManagerOpenGL* manager, const VertexAttributesMap_t& vertexAttributes,
+                                                       BufferUsage_t usage=BUFFER_USAGE_STATIC);
         virtual                    ~BufferObjectOpenGL();
         virtual void                Render();
         virtual void                RenderInstances(const vector<Matrix4x4>& modelMatrices);
@@ -23,17 +32,76 @@ class BufferObjectOpenGL : public BufferObject {
         virtual BufferObjectError_t SetIndexData(unsigned short* indexData, size_t numIndex);
         virtual BufferObjectError_t AppendIndexData(unsigned short* indexData, size_t numIndex);
         virtual void                PrepareInstanceBuffers();
+        virtual bool                SupportsMultiDraw() const { return geometryPool_ != nullptr; }
+
+        /**
+         * Draw instances whose model matrices were already written in the instance ring buffer
+         * @param firstInstance The instance of the ring buffer used by the first instance drawn
+         * @param numInstances The number of instances to draw
+         */
+        void                        DrawInstances(size_t firstInstance, size_t numInstances);
+
+        /**
+         * Returns the geometry pool in which the vertices and indices are stored, nullptr if they have their own buffers
+         */
+        GeometryPoolOpenGL*         GetGeometryPool() const { return geometryPool_; }
+
+        /**
+         * Fill the indirect command drawing instances of the buffer object from its geometry pool
+         * @param firstInstance The instance of the ring buffer used by the first instance drawn
+         * @param numInstances The number of instances to draw
+         * @param command The command to fill
+         */
+        void                        GetIndirectCommand(size_t firstInstance, size_t numInstances, DrawElementsIndirectCommand_t& command) const;
+
+        /**
+         * Returns the size of a vertex in bytes
+         * @param presentVertexAttributes The vertex attributes present in the vertex
+         */
+        static size_t               ComputeVertexStride(int presentVertexAttributes);
+
+        /**
+         * Point the vertex attributes at the vertex buffer bound to GL_ARRAY_BUFFER. The vertex array object must be bound
+         * @param vertexAttributes The location of the vertex attributes
+         * @param presentVertexAttributes The vertex attributes present in the vertices
+         */
+        static void                 SetVertexAttributePointers(const VertexAttributesMap_t& vertexAttributes, int presentVertexAttributes);
+
+        /**
+         * Returns the location of the first attribute of the model matrix, which comes after the vertex attributes
+         */
+        static GLuint               GetInstanceAttributeLocation(const VertexAttributesMap_t& vertexAttributes);
 
     private:
+        BufferObjectManagerOpenGL*  manager_;
         GLuint                      vao_;   /**< Vertex array object */
         GLuint                      vbo_;   /**< Vertex buffer object */
         GLuint                      ibo_;   /**< infex buffer object */
-        GLuint                      instanceBuffer_;    /**< Buffer object used for instanced rendering */
+        InstanceRingBufferOpenGL*   instanceRingBuffer_;        /**< Buffer in which the model matrices of the instances are streamed */
+        BindStateOpenGL*            bindState_;                 /**< Objects bound to the context */
+        GLuint                      instanceAttributeLocation_; /**< First attribute of the model matrix, 0 if instancing isn't prepared */
+        size_t                      instanceBufferGeneration_;  /**< Generation of the ring buffer that the instance attributes point to */
+        GeometryPoolOpenGL*         geometryPool_;              /**< Pool in which the vertices and indices are stored, nullptr if they are in vbo_ and ibo_ */
+        size_t                      firstVertex_;               /**< First vertex of the buffer object in the geometry pool */
+        size_t                      numVertices_;               /**< Number of vertices in the geometry pool */
+        size_t                      firstIndex_;                /**< First index of the buffer object in the geometry pool */
 
         /**
          * Generate the buffers' name
          */
         void                        GenerateBuffers();
+
+        /**
+         * Move the buffer object to another geometry pool, keeping its indices. Its vertices are dropped
+         * @param geometryPool The new geometry pool
+         */
+        void                        MoveToGeometryPool(GeometryPoolOpenGL* geometryPool);
+
+        /**
+         * Point the model matrix attributes at an instance of the ring buffer. The vertex array object must be bound
+         * @param firstInstance The instance used by the first instance drawn
+         */
+        void                        SetInstanceAttributes(size_t firstInstance);
 };
 
 }
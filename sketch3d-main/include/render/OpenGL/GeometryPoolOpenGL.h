@@ -0,0 +1,138 @@
+#ifndef SKETCH_3D_GEOMETRY_POOL_OPENGL_H
+#define SKETCH_3D_GEOMETRY_POOL_OPENGL_H
+
+#include "render/BufferObject.h"
+
+#include "render/OpenGL/gl/glew.h"
+#include "render/OpenGL/gl/gl.h"
+
+#include <utility>
+#include <vector>
+using namespace std;
+
+namespace Sketch3D {
+
+// Forward declaration
+class BindStateOpenGL;
+class InstanceRingBufferOpenGL;
+
+/**
+ * @enum GeometryPoolStorage_t
+ * The two buffers of a geometry pool
+ */
+enum GeometryPoolStorage_t {
+    GEOMETRY_POOL_VERTICES,
+    GEOMETRY_POOL_INDICES,
+    GEOMETRY_POOL_STORAGE_COUNT
+};
+
+/**
+ * @struct DrawElementsIndirectCommand_t
+ * A draw read by glMultiDrawElementsIndirect from the draw indirect buffer
+ */
+struct DrawElementsIndirectCommand_t {
+    GLuint  count;
+    GLuint  instanceCount;
+    GLuint  firstIndex;
+    GLint   baseVertex;
+    GLuint  baseInstance;
+};
+
+/**
+ * @class GeometryPoolOpenGL
+ * Vertex and index buffers shared by the static buffer objects that have the same vertex layout. Each buffer object
+ * owns a range of vertices and a range of indices in the pool, its indices being relative to its first vertex. All the
+ * buffer objects of a pool are drawn with the same vertex array object, so their draws can be submitted together with
+ * glMultiDrawElementsIndirect.
+ *
+ * The model matrix of each draw is read from the instance ring buffer, starting at the base instance of the draw.
+ */
+class GeometryPoolOpenGL {
+    public:
+        /**
+         * Constructor
+         * @param instanceRingBuffer The buffer in which the model matrices of the draws are streamed
+         * @param bindState The objects bound to the context
+         * @param vertexAttributes The location of the vertex attributes
+         * @param presentVertexAttributes The vertex attributes present in the vertices
+         * @param index The number of pools created before this one
+         */
+                                    GeometryPoolOpenGL(InstanceRingBufferOpenGL* instanceRingBuffer, BindStateOpenGL* bindState,
+                                                       const VertexAttributesMap_t& vertexAttributes, int presentVertexAttributes,
+                                                       size_t index);
+                                   ~GeometryPoolOpenGL();
+
+        /**
+         * Reserve a range of elements. The buffer grows if there isn't enough space, keeping its content
+         * @param storage The buffer in which to reserve the elements
+         * @param numElements The number of vertices or indices to reserve
+         * @return The first element of the range
+         */
+        size_t                      Allocate(GeometryPoolStorage_t storage, size_t numElements);
+
+        /**
+         * Give back a range of elements returned by Allocate
+         */
+        void                        Free(GeometryPoolStorage_t storage, size_t firstElement, size_t numElements);
+
+        /**
+         * Write elements in the pool
+         * @param storage The buffer in which to write the elements
+         * @param firstElement The first element to write
+         * @param data The vertices or the indices to write
+         * @param numElements The number of elements to write
+         */
+        void                        Upload(GeometryPoolStorage_t storage, size_t firstElement, const void* data, size_t numElements);
+
+        /**
+         * Read elements back from the pool
+         */
+        void                        Download(GeometryPoolStorage_t storage, size_t firstElement, void* data, size_t numElements);
+
+        /**
+         * Copy elements from a range of the pool to another one. The ranges may not overlap
+         */
+        void                        Copy(GeometryPoolStorage_t storage, size_t sourceElement, size_t destinationElement, size_t numElements);
+
+        /**
+         * Bind the vertex array object of the pool, pointing its instance attributes at the instance ring buffer
+         */
+        void                        Bind();
+
+        /**
+         * Returns the number of pools created before this one, which the draws are grouped by
+         */
+        size_t                      GetIndex() const { return index_; }
+
+    private:
+        InstanceRingBufferOpenGL*   instanceRingBuffer_;
+        BindStateOpenGL*            bindState_;
+        VertexAttributesMap_t       vertexAttributes_;
+        int                         presentVertexAttributes_;
+        size_t                      index_;
+        GLuint                      vao_;
+        GLuint                      instanceAttributeLocation_;     /**< First attribute of the model matrix */
+        size_t                      instanceBufferGeneration_;      /**< Generation of the ring buffer that the instance attributes point to */
+
+        GLuint                      buffers_[GEOMETRY_POOL_STORAGE_COUNT];
+        size_t                      elementSizes_[GEOMETRY_POOL_STORAGE_COUNT];     /**< Size of a vertex and of an index in bytes */
+        size_t                      capacities_[GEOMETRY_POOL_STORAGE_COUNT];       /**< Number of elements that fit in the buffers */
+        size_t                      ends_[GEOMETRY_POOL_STORAGE_COUNT];             /**< Element following the last allocated one */
+        vector<pair<size_t, size_t> > freeRanges_[GEOMETRY_POOL_STORAGE_COUNT];     /**< First element and size of the free ranges before the end, sorted by first element */
+
+        /**
+         * Replace a buffer by a bigger one and point the vertex array object to it
+         * @param storage The buffer to grow
+         * @param numElements The minimum number of elements that the buffer must be able to hold
+         */
+        void                        Grow(GeometryPoolStorage_t storage, size_t numElements);
+
+        /**
+         * Create a buffer and attach it to the vertex array object
+         */
+        void                        CreateBuffer(GeometryPoolStorage_t storage);
+};
+
+}
+
+#endif
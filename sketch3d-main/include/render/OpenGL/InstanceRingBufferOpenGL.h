@@ -0,0 +1,92 @@
+#ifndef SKETCH_3D_INSTANCE_RING_BUFFER_OPENGL_H
+#define SKETCH_3D_INSTANCE_RING_BUFFER_OPENGL_H
+
+#include "render/OpenGL/gl/glew.h"
+#include "render/OpenGL/gl/gl.h"
+
+#include <stddef.h>
+
+namespace Sketch3D {
+
+// Forward declaration
+class BindStateOpenGL;
+class Matrix4x4;
+
+// Number of frames that can be in flight before the CPU has to wait for the GPU
+const size_t NUM_INSTANCE_RING_BUFFER_REGIONS = 3;
+
+/**
+ * @class InstanceRingBufferOpenGL
+ * Buffer shared by all the instanced draw calls to stream the model matrices of the instances. The buffer is split in
+ * one region per frame in flight. The matrices of a frame are appended in its region and a fence is inserted when the
+ * frame is presented, so that a region is only written again once the GPU is done reading it.
+ *
+ * When the driver supports ARB_buffer_storage, the buffer is persistently mapped and the matrices are copied directly
+ * in it. Otherwise, the buffer is orphaned at the beginning of each frame and the matrices are uploaded with
+ * glBufferSubData.
+ */
+class InstanceRingBufferOpenGL {
+    public:
+        /**
+         * Constructor. An OpenGL context must be current
+         * @param bindState The objects bound to the context
+         * @param instancesPerRegion The initial number of instances that can be drawn in a frame. The buffer grows if
+         * more are needed
+         */
+                            InstanceRingBufferOpenGL(BindStateOpenGL* bindState, size_t instancesPerRegion=4096);
+
+                           ~InstanceRingBufferOpenGL();
+
+        /**
+         * Append matrices to the region of the current frame
+         * @param matrices The matrices to append
+         * @param numMatrices The number of matrices to append
+         * @return The index, in the whole buffer, of the instance corresponding to the first matrix
+         */
+        size_t              Write(const Matrix4x4* matrices, size_t numMatrices);
+
+        /**
+         * Fence the region of the current frame and move to the next one. Must be called once per frame
+         */
+        void                EndFrame();
+
+        GLuint              GetBuffer() const { return buffer_; }
+
+        /**
+         * Returns a number that changes each time the buffer is recreated. The vertex array objects pointing to the
+         * buffer must be updated when it changes
+         */
+        size_t              GetGeneration() const { return generation_; }
+
+        bool                IsPersistentlyMapped() const { return mappedData_ != nullptr; }
+
+    private:
+        BindStateOpenGL*    bindState_;
+        GLuint              buffer_;
+        size_t              instancesPerRegion_;
+        size_t              currentRegion_;
+        size_t              numWrittenInstances_;   /**< Number of instances written in the current region */
+        bool                isRegionReady_;         /**< Was the current region made available for writing? */
+        GLsync              fences_[NUM_INSTANCE_RING_BUFFER_REGIONS];  /**< Signaled when the GPU is done with a region */
+        unsigned char*      mappedData_;            /**< Persistently mapped storage, nullptr when orphaning the buffer */
+        size_t              generation_;
+
+        /**
+         * Create the buffer, with its storage for all the regions
+         */
+        void                CreateBuffer();
+
+        /**
+         * Delete the buffer and all the fences
+         */
+        void                DeleteBuffer();
+
+        /**
+         * Make sure that the GPU is done with the current region before writing to it
+         */
+        void                PrepareRegion();
+};
+
+}
+
+#endif
@@ -14,6 +14,8 @@ class RenderContextOpenGL : public RenderContext {
 	public:
 		virtual bool Initialize(Window& window, const RenderParameters_t& renderParameters) = 0;
 		virtual void SwapBuffers() = 0;
+		virtual bool MakeCurrent() = 0;
+		virtual void ReleaseCurrent() = 0;
 };
 
 }
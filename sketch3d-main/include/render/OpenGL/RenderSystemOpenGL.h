@@ -6,6 +6,8 @@
 namespace Sketch3D {
 
 // Forward declaration
+class BindStateOpenGL;
+class InstanceRingBufferOpenGL;
 class RenderContextOpenGL;
 
 /**
@@ -24,6 +26,8 @@ class RenderSystemOpenGL : public RenderSystem {
         virtual void StartRender();
 		virtual void EndRender();
         virtual void PresentFrame();
+        virtual bool MakeContextCurrent();
+        virtual void ReleaseContext();
         virtual Matrix4x4 OrthoProjection(float left, float right, float top, float bottom, float nearPlane, float farPlane) const;
         virtual Matrix4x4 PerspectiveProjection(float left, float right, float top, float bottom, float nearPlane, float farPlane) const;
         virtual void SetViewport(size_t x, size_t y, size_t width, size_t height);
@@ -32,34 +36,26 @@ class RenderSystemOpenGL : public RenderSystem {
         virtual Texture3D* CreateTexture3D() const;
         virtual RenderTexture* CreateRenderTexture(unsigned int width, unsigned int height, TextureFormat_t format);
         virtual void BindScreenBuffer() const;
-        virtual size_t BindTexture(const Texture* texture);
         virtual void BindShader(const Shader* shader);
         virtual FrustumPlanes_t ExtractViewFrustumPlanes(const Matrix4x4& viewProjection) const;
 
-	private:
         /**
-         * @struct TextureUnitNode_t
-         * This texture serves as an element for the texture unit cache. All that it contains is
-         * a pointer to the next element and the texture unit it refers to. It is used as a single
-         * linked list
+         * Returns the shadow of the bound objects, which counts the binds that reached the driver during the frame
          */
-        struct TextureUnitNode_t {
-            size_t              textureUnit;
-            TextureUnitNode_t*  next;
-            TextureUnitNode_t*  prev;
-        };
-        typedef map<size_t, TextureUnitNode_t*> TextureCache_t;
+        const BindStateOpenGL* GetBindState() const { return bindState_; }
 
+	private:
 		RenderContextOpenGL*	renderContext_;	/**< The render context to create for OpenGL */
+        BindStateOpenGL*        bindState_;             /**< Objects bound to the context */
+        InstanceRingBufferOpenGL*   instanceRingBuffer_;    /**< Buffer shared by the instanced draw calls */
+        unsigned int            frameConstantsBuffer_;  /**< Uniform buffer holding the FrameConstants block */
 
 		TextureCacheMap_t	    textures_;		/**< Texture mapped to the API representation of the texture */
 
-        TextureUnitNode_t*      head_;                  /**< Head of the double linked list */
-        TextureUnitNode_t*      tail_;                  /**< Tail of the double linked list */
-        TextureCache_t          textureCache_;          /**< Texture pointers refer directly to a cache element for faster lookup */
-
         virtual void QueryDeviceCapabilities();
         virtual void CreateTextShader();
+        virtual void SetFrameConstantsImpl();
+        virtual void BindTextureImpl(const Texture* texture, size_t textureUnit, bool isResident);
 };
 
 }
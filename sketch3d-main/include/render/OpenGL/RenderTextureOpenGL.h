@@ -8,6 +8,9 @@ using namespace std;
 
 namespace Sketch3D {
 
+// Forward declaration
+class BindStateOpenGL;
+
 /**
  * @class RenderTextureOpenGL
  * Implements a render texture using the OpenGL API
@@ -16,11 +19,12 @@ class RenderTextureOpenGL : public RenderTexture {
     public:
         /**
          * Constructor
+         * @param bindState The objects bound to the context
          * @param width The width of the render texture
          * @param height The height of the render texture
          * @param format The format of the render texture
          */
-                            RenderTextureOpenGL(unsigned int width, unsigned int height, TextureFormat_t format);
+                            RenderTextureOpenGL(BindStateOpenGL* bindState, unsigned int width, unsigned int height, TextureFormat_t format);
 
         /**
          * Destructor
@@ -67,6 +71,7 @@ class RenderTextureOpenGL : public RenderTexture {
         virtual void        Bind() const;
 
     private:
+        BindStateOpenGL*    bindState_;   /**< Objects bound to the context */
         size_t              framebuffer_; /**< OpenGL's name of the framebuffer */
         size_t              renderbuffer_;    /**< OpenGL's name of the renderbuffer */
         vector<Texture2D*>  textures_;   /**< The textures used to receive the output of the rendering */
@@ -13,6 +13,9 @@ using namespace std;
 
 namespace Sketch3D {
 
+// Forward declaration
+class BindStateOpenGL;
+
 /**
  * @class ShaderOpenGL
  * ement an OpenGL shader object
@@ -21,28 +24,35 @@ class ShaderOpenGL : public Shader {
     friend class RenderSystemOpenGL;
 
 	public:
-		ShaderOpenGL();
+		ShaderOpenGL(BindStateOpenGL* bindState);
         virtual ~ShaderOpenGL();
 
         virtual bool SetSourceFile(const string& vertexFilename, const string& fragmentFilename);
         virtual bool SetSource(const string& vertexSource, const string& fragmentSource);
-        virtual bool SetUniformInt(const string& uniform, int value);
-        virtual bool SetUniformFloat(const string& uniform, float value);
-        virtual bool SetUniformVector2(const string& uniform, float value1, float value2);
-        virtual bool SetUniformVector3(const string& uniform, const Vector3& value);
-        virtual bool SetUniformVector3Array(const string& uniform, const Vector3* values, int arraySize);
-        virtual bool SetUniformVector4(const string& uniform, const Vector4& value);
-        virtual bool SetUniformMatrix3x3(const string& uniform, const Matrix3x3& value);
-        virtual bool SetUniformMatrix4x4(const string& uniform, const Matrix4x4& value);
-        virtual bool SetUniformMatrix4x4Array(const string& uniform, const Matrix4x4* values, int arraySize);
-        virtual bool SetUniformTexture(const string& uniform, const Texture* texture);
+        virtual UniformHandle_t GetUniformHandle(const string& uniform) const;
+
+    protected:
+        virtual void SetUniformIntImpl(UniformHandle_t uniform, int value);
+        virtual void SetUniformFloatImpl(UniformHandle_t uniform, float value);
+        virtual void SetUniformVector2Impl(UniformHandle_t uniform, float value1, float value2);
+        virtual void SetUniformVector3Impl(UniformHandle_t uniform, const Vector3& value);
+        virtual void SetUniformVector3ArrayImpl(UniformHandle_t uniform, const Vector3* values, int arraySize);
+        virtual void SetUniformVector4Impl(UniformHandle_t uniform, const Vector4& value);
+        virtual void SetUniformMatrix3x3Impl(UniformHandle_t uniform, const Matrix3x3& value);
+        virtual void SetUniformMatrix4x4Impl(UniformHandle_t uniform, const Matrix4x4& value);
+        virtual void SetUniformMatrix4x4ArrayImpl(UniformHandle_t uniform, const Matrix4x4* values, int arraySize);
+        virtual void SetUniformTextureImpl(UniformHandle_t uniform, const Texture* texture);
+        virtual size_t GetUniformArrayLength(UniformHandle_t uniform) const;
 
 	private:
+        BindStateOpenGL*                bindState_; /**< Objects bound to the context */
         GLuint                          vertex_;    /**< Represents the vertex shader */
         GLuint                          fragment_;  /**< Represents the fragment shader */
 		GLuint				            program_;	/**< Represents the shader program */
 		map<GLint, GLuint>	            textures_;	/**< Allows the shader to map textures to its different texture units */
-        unordered_map<string, GLuint>   nameToUniforms_;    /**< Map of uniform names to location */
+        unordered_map<string, UniformHandle_t>  nameToUniforms_;    /**< Map of uniform names to handle */
+        vector<GLint>                   uniformLocations_;  /**< Location of the uniforms, indexed by their handle */
+        vector<size_t>                  uniformArrayLengths_;   /**< Number of elements of the uniforms, indexed by their handle */
 
 		/**
 		 * Read the shader file and output a string to pass to the GLSL
@@ -52,6 +62,11 @@ class ShaderOpenGL : public Shader {
 		 */
 		char*	ReadShader(const string& filename);
 
+		/**
+		 * Query the active uniforms of the linked program and assign them a handle
+		 */
+		void	ReflectUniforms();
+
 		/**
 		 * Log the errors reported by the program
 		 */
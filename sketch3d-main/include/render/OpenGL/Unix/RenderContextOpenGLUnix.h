@@ -29,6 +29,8 @@ class RenderContextOpenGLUnix : public RenderContextOpenGL {
 
         virtual bool    Initialize(Window& window, const RenderParameters_t& renderParameters);
         virtual void    SwapBuffers();
+        virtual bool    MakeCurrent();
+        virtual void    ReleaseCurrent();
           
     private:
         ::Window        xWindow_;  /**< X11 structure defining the window */
@@ -25,6 +25,8 @@ class RenderContextOpenGLWin32 : public RenderContextOpenGL {
 
 		virtual bool	Initialize(Window& window, const RenderParameters_t& renderParameters);
 		virtual void	SwapBuffers();
+		virtual bool	MakeCurrent();
+		virtual void	ReleaseCurrent();
 
 	private:
 		HDC				deviceContext_;		/**< Window's device context */
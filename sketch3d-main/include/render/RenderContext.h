@@ -33,6 +33,18 @@ class SKETCH_3D_API RenderContext {
 		 */
 		virtual void	        SwapBuffers() = 0;
 
+        /**
+         * Make the context current on the calling thread. The APIs whose contexts belong to a thread have to implement
+         * this so that another thread may render
+         * @return false if the context couldn't be made current
+         */
+        virtual bool            MakeCurrent();
+
+        /**
+         * Detach the context from the calling thread, so that another thread may make it current
+         */
+        virtual void            ReleaseCurrent();
+
     protected:
         vector<DisplayMode_t>   supportedDisplayModes_;   /**< List of supported display modes by the display adapter */
 
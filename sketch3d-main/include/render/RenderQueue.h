@@ -1,23 +1,94 @@
 #ifndef SKETCH_3D_RENDER_QUEUE_H
 #define SKETCH_3D_RENDER_QUEUE_H
 
+#include "render/BufferObjectManager.h"
+#include "render/Material.h"
 #include "render/RenderQueueItem.h"
+#include "render/Shader.h"
 
+#include "system/LinearAllocator.h"
 #include "system/Platform.h"
 
+#include <atomic>
+#include <stdint.h>
+#include <utility>
 #include <vector>
 using namespace std;
 
 namespace Sketch3D {
 
 // Forward declaration
+class BufferObject;
 class Node;
+struct RenderCommandPacket_t;
+
+/**
+ * @struct RenderQueueKey_t
+ * Sorting key of a render queue item along with the index of that item in the queue. The keys are copied in a
+ * contiguous array so that sorting them doesn't have to touch the items themselves
+ */
+struct RenderQueueKey_t {
+    uint64_t    key;
+    size_t      index;
+};
+
+/**
+ * @struct RenderQueueStatistics_t
+ * Number of draw calls and state changes issued by a render queue during a frame
+ */
+struct RenderQueueStatistics_t {
+    size_t      numDrawCalls;
+    size_t      numInstancedDrawCalls;
+    size_t      numTriangles;           /**< Number of triangles drawn, counting each instance */
+    size_t      numVertices;            /**< Number of vertices submitted, one per index of each instance */
+    size_t      numShaderChanges;
+    size_t      numMaterialChanges;
+    size_t      numTextureChanges;      /**< Number of times that the textures of the sub-meshes were bound */
+    size_t      numBufferObjectChanges;
+    size_t      numItems;               /**< Number of items drawn by the queue */
+    double      sortingTime;            /**< Time spent sorting the items and building the commands, in milliseconds */
+    double      executionTime;          /**< Time spent executing the commands, in milliseconds */
+};
+
+/**
+ * @struct RenderQueueSegment_t
+ * Items added to a render queue by one thread, without touching the queue. The segments are merged in the queue once
+ * all the threads are done, so that the nodes can be added in parallel without a lock
+ */
+struct RenderQueueSegment_t {
+    vector<RenderQueueItem>     items;              /**< Items whose model matrix index is relative to the segment */
+    vector<Matrix4x4>           modelMatrices;
+};
+
+/**
+ * @struct RenderQueuePacket_t
+ * The commands drawing the items of a frame along with everything that they read: the camera, the model matrices and
+ * their builtin matrices and, if requested, a copy of the materials' buffers. A prepared packet doesn't refer to the
+ * items of the queue anymore, so it can be executed on another thread while the next frame is added to the queue
+ */
+struct RenderQueuePacket_t {
+    LinearAllocator             commandAllocator;   /**< Frame arena in which the render commands are allocated */
+    const RenderCommandPacket_t* firstCommand;
+    FrameConstants_t            frameConstants;     /**< Camera matrices with which the packet was prepared */
+    vector<Matrix4x4>           modelMatrices;      /**< Pool of the model matrices of the nodes added this frame */
+    vector<Matrix4x4>           modelViewProjections;   /**< Builtin matrices of the models, indexed like modelMatrices */
+    vector<Matrix4x4>           modelViews;
+    vector<Matrix4x4>           normalMatrices;
+    vector<MaterialParameter_t> materialParameters; /**< Copies of the buffers of the materials used by the commands, only filled when requested */
+    vector<float>               materialParameterData;
+    vector<const Texture*>      materialTextures;
+    RenderQueueStatistics_t     statistics;         /**< Statistics of the preparation and of the execution of the packet */
+    bool                        isPrepared;         /**< Set until the queue starts filling the packet again */
+};
 
 /**
  * @class RenderQueue
  * Implements a render queue. Each item in the queue is sorted to allow faster drawing.
  * The render queue will also try to batch geometry data if they share the same material and
  * that they are both the same type of vertex buffers (static or dynamic)
+ *
+ * The commands are built in one of two packets used in turn, so that the packet of a frame can still be executed while
+ * the items of the next frame are added and prepared.
  */
 class SKETCH_3D_API RenderQueue {
     public:
@@ -34,19 +105,143 @@ class SKETCH_3D_API RenderQueue {
          */
         void                        AddNode(Node* node, Layer_t layer=LAYER_GAME);
 
+        /**
+         * Adds a node to a segment instead of the queue. Several threads may add nodes at the same time as long as
+         * each one uses its own segment
+         * @param node The node to render
+         * @param segment The segment that receives the items of the node
+         * @param layer On which layer are we drawing everything. This option might change render state, such as depth testing
+         */
+        void                        AddNode(Node* node, RenderQueueSegment_t& segment, Layer_t layer=LAYER_GAME) const;
+
+        /**
+         * Moves the items of a segment at the end of the queue. The segment is left empty, its buffers being kept to
+         * be filled again
+         * @param segment The segment to merge
+         */
+        void                        MergeSegment(RenderQueueSegment_t& segment);
+
         /**
          * Renders the content of the queue. This invalidates the queue by removing all items in the queue.
          */
         void                        Render();
 
+        /**
+         * Sorts the items of the queue and builds their commands in a packet, without any call to the render system.
+         * This invalidates the queue by removing all items in the queue. The packet stays valid until the queue
+         * prepares the packet after this one, so it must have been executed by then
+         * @param frameConstants The camera matrices used to compute the builtin matrices of the items
+         * @param copyMaterials If set to true, the packet draws with a copy of the materials taken now, so that the
+         * application may change them before the packet is executed
+         * @return The packet to execute
+         */
+        RenderQueuePacket_t*        Prepare(const FrameConstants_t& frameConstants, bool copyMaterials);
+
+        /**
+         * Executes the commands of a packet prepared by this queue
+         * @param packet The packet to execute
+         */
+        void                        Execute(RenderQueuePacket_t* packet);
+
         /**
          * Checks if the render queue is empty or not
          */
         bool                        IsEmpty() const;
 
+        /**
+         * Returns the number of heap allocations made by the queue while building and executing its render commands,
+         * that is the blocks allocated by the command arena and the reallocations of the buffers reused from frame to
+         * frame. Once the queue reached its steady state size, this number doesn't change anymore.
+         */
+        size_t                      GetNumHeapAllocations() const;
+
+        /**
+         * Changes the layout of the sorting key of the items added from now on
+         * @param keyLayout The new layout
+         * @return false if the layout doesn't fit in the key, in which case the layout isn't changed, true otherwise
+         */
+        bool                        SetKeyLayout(const RenderQueueKeyLayout_t& keyLayout);
+
+        const RenderQueueKeyLayout_t& GetKeyLayout() const { return keyLayout_; }
+
+        /**
+         * Returns the number of draw calls and state changes issued by the queue since the statistics were reset
+         */
+        const RenderQueueStatistics_t& GetStatistics() const { return statistics_; }
+
+        /**
+         * Resets the statistics, usually at the beginning of a frame
+         */
+        void                        ResetStatistics();
+
+        /**
+         * Sorts keys with a stable LSD radix sort, one pass per byte. The passes in which all the keys share the same
+         * byte are skipped
+         * @param keys The keys to sort
+         * @param scratch A buffer of numKeys keys that the passes alternate with
+         * @param numKeys The number of keys
+         * @return keys or scratch, whichever holds the sorted keys
+         */
+        static RenderQueueKey_t*    RadixSortKeys(RenderQueueKey_t* keys, RenderQueueKey_t* scratch, size_t numKeys);
+
     private:
          vector<RenderQueueItem>    items_;         /**< The items in the queue */
          vector<size_t>             itemsIndex_;    /**< This list is the list that get actually sorted. We can then use temporal coherence to have less things to sort on subsequent frames */
+         vector<RenderQueueKey_t>   sortKeys_;      /**< Keys of the items, gathered in the order of itemsIndex_ before sorting */
+         vector<RenderQueueKey_t>   sortKeysScratch_;   /**< Scratch buffer used when radix sorting the keys */
+
+         RenderQueuePacket_t        packets_[2];
+         size_t                     currentPacket_;     /**< Packet in which the items are added */
+         vector<pair<BufferObject*, const Matrix4x4*> >  accumulatedInstances_;  /**< Instances waiting to be drawn with their buffer object */
+         vector<Matrix4x4>          instanceMatrices_;  /**< Transposed model matrices of the instances, grouped by buffer object */
+         vector<MultiDrawCommand_t> multiDrawCommands_; /**< Range of instanceMatrices_ drawn by each buffer object */
+         vector<size_t>             bufferObjectGroups_;    /**< Index in multiDrawCommands_ of the group of each buffer object, indexed by the id of the buffer object */
+         size_t                     buffersCapacity_;   /**< Total capacity of the reused buffers at the end of the last preparation */
+         size_t                     numBufferGrowths_;  /**< Number of preparations during which a reused buffer had to grow */
+         size_t                     instanceBuffersCapacity_;   /**< Same as buffersCapacity_ for the buffers used while executing */
+         atomic<size_t>             numInstanceBufferGrowths_;  /**< Same as numBufferGrowths_ for the buffers used while executing */
+         RenderQueueKeyLayout_t     keyLayout_;
+         RenderQueueStatistics_t    statistics_;
+
+        /**
+         * Sorts itemsIndex_ by the items' key with a stable LSD radix sort. Items that have the same key keep the
+         * order that they had on the previous frame.
+         */
+        void                        SortItems();
+
+        /**
+         * Creates the items of a node
+         * @param node The node to render
+         * @param layer The layer on which the node is drawn
+         * @param modelMatrices The pool that receives the model matrix of the node
+         * @param items The list that receives the items
+         */
+        void                        AddNodeItems(Node* node, Layer_t layer, vector<Matrix4x4>& modelMatrices,
+                                                 vector<RenderQueueItem>& items) const;
+
+        /**
+         * Returns the packet in which the items are added, emptying it first if it was prepared
+         */
+        RenderQueuePacket_t&        GetCurrentPacket();
+
+        /**
+         * Computes the builtin matrices of all the models added this frame in batches, before the commands are executed
+         * @param packet The packet whose models are transformed with its camera matrices
+         * @param builtinUniformMask Mask of the builtin uniforms used by the shaders of the models, as returned by
+         * Shader::GetBuiltinUniformMask. Only the matrices in the mask are computed
+         */
+        void                        ComputeBuiltinMatrices(RenderQueuePacket_t& packet, uint32_t builtinUniformMask);
+
+        /**
+         * Copies the buffers that the material states of the USE_MATERIAL commands of a packet point to in the packet,
+         * so that the commands don't read the materials anymore
+         */
+        void                        CopyMaterials(RenderQueuePacket_t& packet);
+
+        /**
+         * Checks if one of the buffers reused from frame to frame had to grow while preparing a packet
+         */
+        void                        UpdateHeapAllocationsCount();
 };
 
 }
@@ -7,23 +7,14 @@
 
 #include "system/Platform.h"
 
-#include <map>
-#include <memory>
 #include <stdint.h>
-#include <string>
-#include <utility>
-#include <vector>
-using namespace std;
 
 namespace Sketch3D {
 
 // Forward declaration
 class BufferObject;
 class Node;
-class Vector3;
-class Vector4;
-class Matrix3x3;
-class Texture2D;
+struct SurfaceTriangles_t;
 
 enum Layer_t {
     LAYER_GAME,
@@ -31,10 +22,34 @@ enum Layer_t {
     LAYER_HUD
 };
 
+// Number of bits of the key available to the state id and the depth of opaque items, below the layer
+const size_t RENDER_QUEUE_KEY_OPAQUE_BITS = 62;
+
+// Number of bits of the key available to the state id of transparent items, below the depth
+const size_t RENDER_QUEUE_KEY_TRANSPARENT_STATE_BITS = 30;
+
+/**
+ * @struct RenderQueueKeyLayout_t
+ * Number of bits given to each component of the state id of the items, from the most significant one to the least
+ * significant one, and to the depth of the opaque items. The components that don't fit in their budget are hashed
+ * down to it: items that collide are only interleaved, they are still drawn correctly.
+ *
+ * The sum of all the budgets can't exceed RENDER_QUEUE_KEY_OPAQUE_BITS and each budget is at most 32 bits
+ */
+struct RenderQueueKeyLayout_t {
+    size_t  shaderBits;
+    size_t  materialBits;
+    size_t  textureSetBits;     /**< Bits identifying the set of textures of the sub-mesh */
+    size_t  bufferObjectBits;
+    size_t  depthBits;          /**< Bits of the depth of opaque items, which only orders the items of the same state */
+};
+
 /**
  * @class RenderQueueItem
  * Creates a render queue item which is used to sort draw commands. The render queue item is a pair of key and value,
- * where the key is used to sort and the value is the actual drawing data.
+ * where the key is used to sort and the value is the actual drawing data. The item is kept as small as possible: the
+ * drawing data is only a handle to the node and sub-mesh to draw, and the index of its model matrix, which is stored in
+ * a pool owned by the render queue.
  *
  * The key is composed of the following components
  *
@@ -48,69 +63,48 @@ enum Layer_t {
  *      --> 10 = Subtractive transparency.
  *  - Depth : The depth value of the object.
  *            When the transluency type is opaque, this is used as front-to-back sorting, otherwise, this is back-to-front sorting
- *  - Material id : The id of the material used.
+ *  - State id : The shader, material, set of textures and buffer object used, laid out as described by a
+ *                RenderQueueKeyLayout_t so that consecutive items share as much state as possible.
  *
- * NOTE: if the transluency type is opaque, the Material Id and Depth value are swapped together, so that opaque objects are sorted
- * through material ids before depth. Otherwise, we sort via depth.
+ * NOTE: if the transluency type is opaque, the State Id and Depth value are swapped together, so that opaque objects are sorted
+ * through state ids before depth, the depth being truncated to the bits left by the state id. Otherwise, we sort via
+ * depth and the state id is truncated to its 30 most significant bits.
  */
 class SKETCH_3D_API RenderQueueItem {
     friend class RenderQueue;
-    friend class RenderQueueItemKeyComparator;
 
     public:
         /**
          * Constructor.
          * Creates a render queue item
-         * @param modelMatrix The modelMatrix to position the sub-mesh
-         * @param material The material to use to draw the sub-mesh
-         * @param textures The textures to use on this sub-mesh
-         * @param numTextures The number of textures to use on this sub-mesh
-         * @param bufferObject The buffer object representing the actual sub-mesh to draw
-         * @param useInstancing If set to true, the bufferObject will be used in instanced rendering
+         * @param node The node that holds the sub-mesh. The node's material is used to draw the sub-mesh
+         * @param surfaceIndex The index of the sub-mesh in the node's mesh
+         * @param modelMatrixIndex The index of the model matrix to position the sub-mesh in the render queue's matrix pool
          * @param distanceFromCamera The distance that the mesh is from the camera, normalized on the distance between the near and far plane of the camera.
          * A distance of 0 means on the near plane and a distance corresponding to the maximum value of a unsigned 32 btis word means on the far plane.
+         * @param keyLayout The layout of the sorting key
          * @param layer On which layer are we drawing everything. This option might change render state, such as depth testing
          */
-                            RenderQueueItem(shared_ptr<Matrix4x4> modelMatrix, Material* material, Texture2D** textures,
-                                            size_t numTextures, BufferObject* bufferObject, bool useInstancing,
-                                            uint32_t distanceFromCamera, Layer_t layer=LAYER_GAME);
-
-        /**
-         * Destructor. Frees the uniform map
-         */
-                           ~RenderQueueItem();
+                            RenderQueueItem(Node* node, uint32_t surfaceIndex, uint32_t modelMatrixIndex,
+                                            uint32_t distanceFromCamera, const RenderQueueKeyLayout_t& keyLayout,
+                                            Layer_t layer=LAYER_GAME);
 
     private:
-        // Key stuff
-        uint64_t            key_;
-        Layer_t             layer_;
-        TransluencyType_t   transluencyType_;
-        uint32_t            distanceFromCamera_;
-        int                 materialId_;
-
-        shared_ptr<Matrix4x4>   modelMatrix_;       /**< The model matrix to use to position the sub-mesh */
-        Material*           material_;          /**< The material to use to draw the sub-mesh */
-        Texture2D**         textures_;          /**< The textures to use on this sub-mesh */
-        size_t              numTextures_;       /**< The number of textures to use on this sub-mesh */
-        BufferObject*       bufferObject_;      /**< The buffer object representing the actual sub-mesh to draw */
-        bool                useInstancing_;     /**< Determine if we draw multiple instances of the buffer object */
+        uint64_t            key_;               /**< The key used to sort the items */
+        Node*               node_;              /**< The node that holds the sub-mesh to draw */
+        uint32_t            surfaceIndex_;      /**< The index of the sub-mesh in the node's mesh */
+        uint32_t            modelMatrixIndex_;  /**< The index of the model matrix in the render queue's matrix pool */
 
         /**
-         * Construct the 30 bits material id from the material properties
+         * Construct the state id from the states used to draw the sub-mesh
+         * @param material The material used to draw the sub-mesh
+         * @param surface The sub-mesh, which holds the textures
+         * @param bufferObject The buffer object of the sub-mesh
+         * @param keyLayout The number of bits of each component of the state id
+         * @return The state id, on the sum of the bits of its components
          */
-        uint32_t            ConstructMaterialId() const;
-};
-
-
-class SKETCH_3D_API RenderQueueItemKeyComparator {
-    public:
-        RenderQueueItemKeyComparator(const vector<RenderQueueItem>& items) : items_(items) {
-        }
-
-        bool operator() (size_t lhs, size_t rhs) const;
-
-    private:
-        const vector<RenderQueueItem>& items_;
+        static uint64_t     ConstructStateId(const Material* material, const SurfaceTriangles_t* surface,
+                                             const BufferObject* bufferObject, const RenderQueueKeyLayout_t& keyLayout);
 };
 
 }
@@ -1,6 +1,8 @@
 #ifndef SKETCH_3D_RENDER_STATE_H
 #define SKETCH_3D_RENDER_STATE_H
 
+#include <stddef.h>
+
 namespace Sketch3D {
 /**
  * @enum BlendingEquation_t
@@ -75,5 +77,34 @@ enum RenderMode_t {
 	RENDER_MODE_POINT
 };
 
+/**
+ * @struct RenderStateBlock_t
+ * A complete set of render states, applied at once through the RenderStateCache. The default values are the ones of
+ * a new render state cache
+ */
+struct RenderStateBlock_t {
+    bool                isDepthTestEnabled;
+    bool                isDepthWriteEnabled;
+    bool                isColorWriteEnabled;
+    bool                isBlendingEnabled;
+    DepthFunc_t         depthComparisonFunction;
+    CullingMethod_t     cullingMethod;
+    BlendingEquation_t  blendingEquation;
+    BlendingFactor_t    sourceBlendingFactor;
+    BlendingFactor_t    destinationBlendingFactor;
+    RenderMode_t        renderMode;
+
+    RenderStateBlock_t() : isDepthTestEnabled(true), isDepthWriteEnabled(true), isColorWriteEnabled(true),
+        isBlendingEnabled(false), depthComparisonFunction(DEPTH_FUNC_LESS), cullingMethod(CULLING_METHOD_BACK_FACE),
+        blendingEquation(BLENDING_EQUATION_ADD), sourceBlendingFactor(BLENDING_FACTOR_ONE),
+        destinationBlendingFactor(BLENDING_FACTOR_ZERO), renderMode(RENDER_MODE_FILL) {}
+};
+
+/**
+ * Handle of a render state block created by the RenderStateCache
+ */
+typedef size_t RenderStateBlockHandle_t;
+const RenderStateBlockHandle_t INVALID_RENDER_STATE_BLOCK = (RenderStateBlockHandle_t)-1;
+
 }
 #endif
\ No newline at end of file
@@ -5,12 +5,22 @@
 
 #include "system/Platform.h"
 
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
 namespace Sketch3D {
 
 /**
  * @class RenderStateCache
  * This class is used to state the render state. It doesn't immediately apply the states but instead
  * store the new value and apply it through the device when the actual rendering occurs.
+ *
+ * The states can also be grouped in immutable render state blocks that materials and passes refer to by handle. The
+ * blocks are deduplicated, so that two identical sets of states share the same handle, and each block is packed in a
+ * key when it is created: switching from a block to another one only compares the two keys and applies the states that
+ * differ.
  */
 class SKETCH_3D_API RenderStateCache {
     public:
@@ -33,6 +43,34 @@ class SKETCH_3D_API RenderStateCache {
         void                SetBlendingFactor(BlendingFactor_t srcFactor, BlendingFactor_t dstFactor);
         void                SetRenderFillMode(RenderMode_t mode);
 
+        /**
+         * Create a render state block, or return the handle of the identical block if it was already created
+         * @param block The states of the block
+         * @return The handle of the block, valid for the whole life of the cache
+         */
+        RenderStateBlockHandle_t    CreateRenderStateBlock(const RenderStateBlock_t& block);
+
+        /**
+         * Apply all the states of a block to the device right away. The changes made through the individual setters
+         * that weren't applied yet are replaced by the block
+         * @param handle The handle of the block
+         */
+        void                ApplyRenderStateBlock(RenderStateBlockHandle_t handle);
+
+        const RenderStateBlock_t&   GetRenderStateBlock(RenderStateBlockHandle_t handle) const { return renderStateBlocks_[handle]; }
+        size_t              GetNumRenderStateBlocks() const { return renderStateBlocks_.size(); }
+
+        /**
+         * Returns the states set so far, including the ones that weren't applied yet
+         */
+        RenderStateBlock_t  GetCurrentRenderState() const;
+
+        /**
+         * Returns the number of states that reached the device since the counter was reset
+         */
+        size_t              GetNumRenderStateChanges() const { return numRenderStateChanges_; }
+        void                ResetRenderStateChangeCounter() { numRenderStateChanges_ = 0; }
+
     protected:
         // Current render state values
         bool                isDepthTestEnabled_;
@@ -67,6 +105,14 @@ class SKETCH_3D_API RenderStateCache {
         virtual void        SetBlendingEquationImpl() = 0;
         virtual void        SetBlendingFactorImpl() = 0;
         virtual void        SetRenderFillModeImpl() = 0;
+
+    private:
+        vector<RenderStateBlock_t>                  renderStateBlocks_;
+        vector<uint32_t>                            renderStateBlockKeys_;      /**< Packed states of each block */
+        unordered_map<uint32_t, RenderStateBlockHandle_t>   renderStateBlockIndices_;   /**< Block of each key */
+        RenderStateBlockHandle_t                    appliedRenderStateBlock_;   /**< The block applied last, invalid
+                                                                                     once a state is set individually */
+        size_t                                      numRenderStateChanges_;
 };
 
 }
@@ -2,6 +2,8 @@
 #define SKETCH_3D_RENDER_SYSTEM_H
 
 #include "render/Renderer.h"
+#include "render/Shader.h"
+#include "render/TextureUnitCache.h"
 
 #include "math/Matrix4x4.h"
 #include "math/Vector3.h"
@@ -21,7 +23,6 @@ class BufferObjectManager;
 class RenderQueue;
 class RenderStateCache;
 class RenderTexture;
-class Shader;
 class Texture2D;
 class Texture3D;
 class Vector2;
@@ -50,6 +51,13 @@ class SKETCH_3D_API RenderSystem {
 		 */
 										    RenderSystem(Window& window);
 
+		/**
+		 * Constructor for render systems that don't draw to a window
+         * @param width The width of the surface on which to render
+         * @param height The height of the surface on which to render
+		 */
+										    RenderSystem(unsigned int width, unsigned int height);
+
 		/**
 		 * Destructor. Free the underlying API
 		 */
@@ -92,6 +100,18 @@ class SKETCH_3D_API RenderSystem {
          */
         virtual void                        PresentFrame() = 0;
 
+        /**
+         * Make the render context current on the calling thread, which is then the only one that may use the render
+         * system. The render system does nothing if its context isn't bound to a thread
+         * @return false if the context couldn't be made current
+         */
+        virtual bool                        MakeContextCurrent();
+
+        /**
+         * Detach the render context from the calling thread
+         */
+        virtual void                        ReleaseContext();
+
 		/**
 		 * Set an orthogonal projection. This replace the current projection matrix
 		 * @param left The left position of the viewing volume
@@ -220,10 +240,12 @@ class SKETCH_3D_API RenderSystem {
         Vector3                             ScreenToWorldPoint(const Matrix4x4& inversedViewProjection, const Vector2& point) const;
 
         /**
-         * Bind a texture to a texture unit
+         * Bind a texture to a texture unit. The texture stays on its unit until it is evicted by another texture, so
+         * a texture that is already bound isn't bound again
          * @param texture A pointer to the texture object to bind
+         * @return The texture unit on which the texture is bound, to be sent to the sampler uniforms
          */
-        virtual size_t                      BindTexture(const Texture* texture);
+        size_t                              BindTexture(const Texture* texture);
 
         /**
          * Bind the specified shader to the GPU
@@ -231,6 +253,12 @@ class SKETCH_3D_API RenderSystem {
          */
         virtual void                        BindShader(const Shader* shader) = 0;
 
+        /**
+         * Set the uniforms shared by all the shaders. Nothing is uploaded if they are the same as the last ones
+         * @param frameConstants The new values of the shared uniforms
+         */
+        void                                SetFrameConstants(const FrameConstants_t& frameConstants);
+
         /**
          * Extract the frustum planes from the view projection matrix
          * @param viewProjection The view projection matrix of the view frustum used to extract the planes
@@ -252,8 +280,24 @@ class SKETCH_3D_API RenderSystem {
         BufferObjectManager*                GetBufferObjectManager() const;
         RenderStateCache*                   GetRenderStateCache() const;
 
+        /**
+         * Returns the cache of the texture units, which counts the binds, hits and evictions
+         */
+        TextureUnitCache&                   GetTextureUnitCache() { return textureUnitCache_; }
+
+        /**
+         * Returns the shader bound to the device, nullptr if none is bound
+         */
+        const Shader*                       GetBoundShader() const { return boundShader_; }
+
+        /**
+         * Returns the number of uniforms that the shaders sent to the device since their counters were reset
+         */
+        size_t                              GetNumUniformUploads() const;
+        void                                ResetUniformUploadCounters();
+
 	protected:
-        Window&							    window_;        /**< The window */
+        Window*							    window_;        /**< The window, nullptr if the render system doesn't use one */
 		WindowHandle					    windowHandle_;	/**< The window's handle */
 		unsigned int					    width_;			/**< The width of the window */
 		unsigned int					    height_;		/**< The height of the window */
@@ -268,6 +312,11 @@ class SKETCH_3D_API RenderSystem {
         RenderStateCache*                   renderStateCache_;
 
         Shader*                             textShader_;    /**< Shader used to draw text on screen */
+        TextureUnitCache                    textureUnitCache_;  /**< Texture bound on each texture unit. The implementations
+                                                                     set its number of units once the device is queried */
+
+        FrameConstants_t                    frameConstants_;    /**< The last uniforms shared by all the shaders */
+        bool                                hasFrameConstants_; /**< Were the shared uniforms uploaded at least once? */
 
 		/**
 		 * Query the device capabilities
@@ -279,6 +328,21 @@ class SKETCH_3D_API RenderSystem {
          */
         virtual void                        CreateTextShader() = 0;
 
+        /**
+         * Bind a texture to a texture unit
+         * @param texture The texture to bind
+         * @param textureUnit The texture unit chosen by the cache
+         * @param isResident true if the texture is already bound to that unit. The implementation may still have to
+         * select the unit, for instance to modify the texture
+         */
+        virtual void                        BindTextureImpl(const Texture* /*texture*/, size_t /*textureUnit*/, bool /*isResident*/) {}
+
+        /**
+         * Upload frameConstants_ to the GPU. Render systems without uniform blocks don't have to implement it, their
+         * shaders only use the builtin uniforms
+         */
+        virtual void                        SetFrameConstantsImpl() {}
+
         /**
          * Free the render system
          */
@@ -5,15 +5,22 @@
 #include "math/Plane.h"
 #include "math/Vector3.h"
 
+#include "render/FrameStatistics.h"
 #include "render/Renderer_Common.h"
 #include "render/RenderQueue.h"
 #include "render/RenderState.h"
 #include "render/SceneTree.h"
+#include "render/Shader.h"
 #include "render/Texture.h"
 
 #include "system/Platform.h"
 
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 using namespace std;
 
 namespace Sketch3D {
@@ -29,12 +36,26 @@ class Texture2D;
 class Texture3D;
 class Window;
 
+/**
+ * @struct RenderFramePacket_t
+ * Everything needed to draw a frame once the scene was culled: the camera and the prepared packets of the render queues
+ */
+struct RenderFramePacket_t {
+    FrameConstants_t        frameConstants;
+    int                     clearBuffers;       /**< Buffers to clear before drawing, 0 if Clear wasn't called */
+    RenderQueuePacket_t*    opaquePacket;       /**< NULL if Render wasn't called */
+    RenderQueuePacket_t*    transparentPacket;  /**< NULL if there wasn't any transparent item */
+    double                  cullingTime;        /**< Time spent culling the scene and filling the queues, in milliseconds */
+};
+
 /**
  * @class Renderer
  * This class provides an interface to used the underlying render system based
  * on its implementation (OpenGL or Direct3D). It is through this class that
  * the user can draw things on the screen and modify certain parameters of the
  * rendering context
+ *
+ * The frames can be drawn on a dedicated render thread, see EnableRenderThread.
  */
 class SKETCH_3D_API Renderer {
 	public:
@@ -55,6 +76,14 @@ class SKETCH_3D_API Renderer {
 		bool				    Initialize(RenderSystem_t renderSystem,
 									       Window& window, const RenderParameters_t& renderParameters);
 
+		/**
+		 * Initialize the renderer with the null render system, without any window. Nothing is drawn, the commands
+		 * are recorded instead, see RenderSystemNull
+         * @param renderParameters The rendering parameters. Only the width and height are used
+		 * @return true if the initialization went correctly
+		 */
+		bool				    InitializeHeadless(const RenderParameters_t& renderParameters);
+
 		/**
 		 * Change the clear color
 		 * @param red The red component of the color
@@ -90,6 +119,31 @@ class SKETCH_3D_API Renderer {
          */
         void                    PresentFrame();
 
+        /**
+         * Start or stop drawing the frames on a dedicated render thread, which then owns the render context.
+         *
+         * While the render thread is running, Clear only records the buffers to clear, StartRender and EndRender do
+         * nothing and Render culls the scene and prepares the render queues with a copy of the materials, without any
+         * call to the render system. PresentFrame waits for the render thread to finish the previous frame and hands
+         * it the prepared one, so the application updates the next frame while the render thread submits this one.
+         * Render may only be called once per frame and GetFrameStatistics lags one frame behind.
+         *
+         * The other functions that use the render system, like creating resources, changing the render states or
+         * drawing text, have to be called through RunOnRenderThread.
+         * @param useRenderThread true to start the render thread, false to stop it and take the render context back
+         * @return false if the render thread couldn't be started
+         */
+        bool                    EnableRenderThread(bool useRenderThread);
+
+        bool                    IsRenderThreadEnabled() const { return useRenderThread_; }
+
+        /**
+         * Run a function on the thread that owns the render context and wait for it to return. The function is called
+         * directly if the render thread isn't running or if this is the render thread
+         * @param task The function to run
+         */
+        void                    RunOnRenderThread(const function<void()>& task);
+
 		/**
 		 * Set an orthogonal projection. This replace the current projection matrix
 		 * @param left The left position of the viewing volume
@@ -296,6 +350,12 @@ class SKETCH_3D_API Renderer {
 		const Matrix4x4&	    GetProjectionMatrix() const;
 		const Matrix4x4&	    GetViewMatrix() const;
 		const Matrix4x4&	    GetViewProjectionMatrix() const;
+
+        /**
+         * Returns the camera matrices of the FrameConstants block for the current view and projection
+         */
+        FrameConstants_t        GetFrameConstants() const;
+
         float                   GetNearFrustumPlane() const;
         float                   GetFarFrustumPlane() const;
 
@@ -304,6 +364,29 @@ class SKETCH_3D_API Renderer {
 
         BufferObjectManager*    GetBufferObjectManager() const;
         RenderStateCache*       GetRenderStateCache() const;
+        RenderSystem*           GetRenderSystem() const;
+
+        /**
+         * Returns the number of heap allocations made by the render queues while drawing. This should stay constant
+         * once the scene reached its steady state
+         */
+        size_t                  GetNumRenderQueueHeapAllocations() const;
+
+        /**
+         * Returns the number of draw calls and state changes issued by the render queues during the last frame
+         */
+        RenderQueueStatistics_t GetRenderQueueStatistics() const;
+
+        /**
+         * Returns the work submitted during the last frame, between the last calls to StartRender and EndRender
+         */
+        const FrameStatistics_t& GetFrameStatistics() const;
+
+        /**
+         * Count a draw call made outside of the render queues, like the static batches or the nodes drawn directly
+         * @param bufferObject The buffer object drawn
+         */
+        void                    RecordDraw(const BufferObject* bufferObject);
 
         size_t                  GetScreenWidth() const;
         size_t                  GetScreenHeight() const;
@@ -337,6 +420,54 @@ class SKETCH_3D_API Renderer {
 
         CullingMethod_t         cullingMethod_;         /**< Current culling method */
 
+        FrameStatistics_t       frameStatistics_;       /**< Work submitted so far during the current frame */
+        FrameStatistics_t       lastFrameStatistics_;   /**< Work submitted during the last frame */
+
+        // Render thread data. The members below the mutex are protected by it
+        bool                    useRenderThread_;       /**< If set to true, the frames are drawn by renderThread_ */
+        thread                  renderThread_;
+        RenderFramePacket_t     framePacket_;           /**< Frame being prepared by the application */
+        mutable int             clearBuffers_;          /**< Buffers that Clear was asked to clear during the frame being prepared */
+        mutex                   renderThreadMutex_;
+        condition_variable      renderThreadCondition_; /**< Signaled when a frame or a task is submitted, or to stop */
+        condition_variable      renderThreadIdleCondition_; /**< Signaled when the render thread finished a frame or tasks */
+        bool                    stopRenderThread_;
+        bool                    isFrameSubmitted_;      /**< Set until the render thread drew submittedFramePacket_ */
+        RenderFramePacket_t     submittedFramePacket_;
+        vector<function<void()> > renderThreadTasks_;   /**< Tasks waiting to run on the render thread */
+        size_t                  numSubmittedTasks_;
+        size_t                  numCompletedTasks_;
+        FrameStatistics_t       renderThreadFrameStatistics_;   /**< Statistics of the last frame drawn by the render thread */
+        RenderQueueStatistics_t renderThreadQueueStatistics_;
+        RenderQueueStatistics_t lastRenderQueueStatistics_;     /**< Statistics of the render queues of the last frame */
+
+        /**
+         * Add the statistics of the render queues to the ones of the frame
+         */
+        void                    AccumulateRenderQueueStatistics();
+
+        /**
+         * Cull the scene and prepare the render queues for the frame
+         * @param framePacket The packet to fill
+         * @param copyMaterials If set to true, the packets of the queues draw with a copy of the materials
+         */
+        void                    PrepareFramePacket(RenderFramePacket_t& framePacket, bool copyMaterials);
+
+        /**
+         * Draw the static batches and execute the render queues of a prepared frame
+         */
+        void                    ExecuteFramePacket(const RenderFramePacket_t& framePacket);
+
+        /**
+         * Returns true if the calling thread has to leave the frames to the render thread
+         */
+        bool                    IsDeferredToRenderThread() const;
+
+        /**
+         * Function of the render thread, which draws the submitted frames and runs the tasks
+         */
+        void                    RenderThreadLoop();
+
         /**
          * Initializes some default values
          */
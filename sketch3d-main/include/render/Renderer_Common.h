@@ -15,7 +15,8 @@ class Sphere;
  */
 enum RenderSystem_t {
 	RENDER_SYSTEM_OPENGL,
-	RENDER_SYSTEM_DIRECT3D9
+	RENDER_SYSTEM_DIRECT3D9,
+	RENDER_SYSTEM_NULL      // Records the commands instead of drawing, see RenderSystemNull
 };
 
 /**
@@ -98,6 +99,8 @@ struct SKETCH_3D_API ConfigFileAttributes_t {
     size_t              refreshRate;
     DisplayFormat_t     displayFormat;
     DepthStencilBits_t  depthStencilBits;
+    size_t              numWorkerThreads;   /**< Number of threads of the job system, 0 to use one per hardware thread but one */
+    bool                useRenderThread;    /**< If set to true, the frames are drawn on a dedicated render thread */
 };
 
 bool SKETCH_3D_API ParseConfigFile(const string& filename, ConfigFileAttributes_t& configFileAttributes);
@@ -1,7 +1,9 @@
 #ifndef SKETCH_3D_SCENE_TREE_H
 #define SKETCH_3D_SCENE_TREE_H
 
+#include "render/BoundingVolumeHierarchy.h"
 #include "render/Node.h"
+#include "render/RenderQueue.h"
 
 #include "system/Platform.h"
 
@@ -12,12 +14,12 @@ using namespace std;
 
 namespace Sketch3D {
 // Forward struct declaration
+struct FrameConstants_t;
 struct FrustumPlanes_t;
 struct SurfaceTriangles_t;
 
 // Forward class declaration
 class BufferObject;
-class RenderQueue;
 class Shader;
 class Texture2D;
 
@@ -29,6 +31,8 @@ class Texture2D;
  * of all its children node and send it for rendering.
  */
 class SKETCH_3D_API SceneTree {
+    friend class Node;
+
     typedef pair<size_t, Texture2D**>                   TexturesPair_t;
     typedef pair<TexturesPair_t, vector<BufferObject*>> TexturesBuffersPair_t;
     typedef map<size_t, TexturesBuffersPair_t>          TexturesToBuffersMap_t;
@@ -47,7 +51,8 @@ class SKETCH_3D_API SceneTree {
 			
 		/**
          * Populate the render queue with nodes. This will cull nodes that aren't in the view frustum and
-         * prepare the data for the actual rendering process
+         * prepare the data for the actual rendering process. Large scenes are added to the queues by the job system,
+         * each range of visible nodes in its own segments
          * @param frustumPlanes The 6 view frustum planes to cull objects that are not visible by the camera
          * @param useFrustumCulling If set to true, the frustum planes will be used to cull objects
 		 * @param opaqueRenderQueue The render queue to populate with opaque objects
@@ -58,8 +63,9 @@ class SKETCH_3D_API SceneTree {
 
         /**
          * Render the static batches
+         * @param frameConstants The camera matrices with which the batches are drawn
          */
-        void                        RenderStaticBatches() const;
+        void                        RenderStaticBatches(const FrameConstants_t& frameConstants) const;
 
         /**
          * Add a node to the scene tree. This will add the node directly to the root node. It is the responsability of the  caller
@@ -100,6 +106,23 @@ class SKETCH_3D_API SceneTree {
         Node                        root_;          /**< The root node of the scene tree */
         StaticBatches_t             staticBatches_; /**< List of batches to draw */
         vector<SurfaceTriangles_t*> preTransformedSurfaces_;    /**< List of pretransformed surfaces used in static batches */
+
+        BoundingVolumeHierarchy     cullingHierarchy_;  /**< Bounding volumes of the dynamic nodes, used for frustum culling */
+        vector<Node*>               dirtyNodes_;        /**< Nodes whose bounds changed since the last frame */
+        vector<Node*>               visibleNodes_;      /**< Result of the culling, kept to avoid allocating each frame */
+        vector<RenderQueueSegment_t> opaqueSegments_;   /**< Opaque items of each range of visible nodes added in parallel */
+        vector<RenderQueueSegment_t> transparentSegments_;
+
+        /**
+         * Update the bounds of the nodes that moved or changed since the last frame
+         */
+        void                        UpdateCullingHierarchy();
+
+        /**
+         * Remove a node from the culling hierarchy when it leaves the scene tree
+         * @param node The node to remove. Its children aren't removed
+         */
+        void                        RemoveFromCullingHierarchy(Node* node);
 };
 
 }
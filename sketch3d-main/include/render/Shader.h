@@ -44,6 +44,43 @@ enum BuiltinUniform_t {
     NUM_BUILTIN_UNIFORMS
 };
 
+/**
+ * @struct FrameConstants_t
+ * Uniforms shared by all the shaders, uploaded once for each camera rather than each time a shader is bound. The
+ * render systems that support uniform blocks bind them at FRAME_CONSTANTS_BINDING_POINT, where the shaders read them
+ * with the following declaration:
+ *
+ *     layout(std140) uniform FrameConstants {
+ *         mat4 view;
+ *         mat4 projection;
+ *         mat4 viewProjection;
+ *         mat4 transInvView;
+ *     };
+ *
+ * Shaders that declare these matrices as standalone uniforms still receive them through the builtin uniforms.
+ */
+struct SKETCH_3D_API FrameConstants_t {
+    Matrix4x4   view;
+    Matrix4x4   projection;
+    Matrix4x4   viewProjection;
+    Matrix4x4   transposedInverseView;
+};
+
+const char* const FRAME_CONSTANTS_BLOCK_NAME = "FrameConstants";
+const unsigned int FRAME_CONSTANTS_BINDING_POINT = 0;
+
+/**
+ * Builtin uniforms holding the matrices of the FrameConstants block. Shaders that read the block don't have any of them
+ */
+const uint32_t FRAME_CONSTANTS_BUILTIN_UNIFORM_MASK = (1u << VIEW) | (1u << TRANS_INV_VIEW) | (1u << PROJECTION) | (1u << VIEW_PROJECTION);
+
+/**
+ * Builtin uniforms that change with each model. They are set before each draw, so the draws of a shader that uses one
+ * of them can't be submitted together with BufferObjectManager::RenderMultiDraw. Shaders that have none of them read
+ * the model matrix from the instance attributes, declared after the vertex attributes of the mesh, if they need it
+ */
+const uint32_t MODEL_BUILTIN_UNIFORM_MASK = (1u << MODEL) | (1u << MODEL_VIEW) | (1u << TRANS_INV_MODEL_VIEW) | (1u << MODEL_VIEW_PROJECTION);
+
 /**
  * @enum ShaderType_t
  * Shows the possible shaders
@@ -53,11 +90,27 @@ enum ShaderType_t {
     SHADER_TYPE_FRAGMENT,
 };
 
+/**
+ * Handle to a uniform of a shader. The handle is resolved once from the uniform's name and is only valid for the
+ * shader that returned it
+ */
+typedef int32_t UniformHandle_t;
+
+const UniformHandle_t INVALID_UNIFORM_HANDLE = -1;
+
 /**
  * @class Shader
  * This class make it possible to use easily a set of shader to render an
  * object as well as to pass properties to the shader. It acts as an interface
- * for the DirectX and OpenGL type of shaders
+ * for the DirectX and OpenGL type of shaders.
+ *
+ * Uniforms can be set either by name or by handle. Setting a uniform by name has to look up the uniform each time,
+ * so code that sets the same uniforms often should resolve their handle once with GetUniformHandle. The handles of
+ * the builtin uniforms are resolved when the shader is created and can be fetched with GetBuiltinUniformHandle.
+ *
+ * The shader keeps a shadow copy of the values of its uniforms. A uniform keeps its value in the program even when
+ * another shader is bound, so setting a uniform to the value that it already has is dropped before reaching the API.
+ * Textures are always bound since their texture unit may have been given to another texture.
  */
 class SKETCH_3D_API Shader {
     typedef pair<const Vector3*, int> Vector3Array_t;
@@ -90,25 +143,143 @@ class SKETCH_3D_API Shader {
          */
         virtual bool    SetSource(const string& vertexSource, const string& fragmentSource) = 0;
 
+        /**
+         * Resolves the handle of a uniform
+         * @param uniform The name of the uniform
+         * @return The handle of the uniform, or INVALID_UNIFORM_HANDLE if the shader doesn't use that uniform
+         */
+        virtual UniformHandle_t GetUniformHandle(const string& uniform) const = 0;
+
+        /**
+         * Returns the handle of a builtin uniform, as resolved when the shader was created
+         * @param builtinUniform The builtin uniform
+         * @return The handle of the uniform, or INVALID_UNIFORM_HANDLE if the shader doesn't use that uniform
+         */
+        UniformHandle_t GetBuiltinUniformHandle(BuiltinUniform_t builtinUniform) const { return builtinUniformHandles_[builtinUniform]; }
+
+        /**
+         * Returns a mask with the bit (1 << builtinUniform) set for each builtin uniform that the shader uses, so that
+         * the values of the other ones don't have to be computed
+         */
+        uint32_t        GetBuiltinUniformMask() const { return builtinUniformMask_; }
+
+        bool            UsesBuiltinUniform(BuiltinUniform_t builtinUniform) const { return (builtinUniformMask_ & (1u << builtinUniform)) != 0; }
+
 		// UNIFORM SETTERS
-        virtual bool	SetUniformInt(const string& uniform, int value) = 0;
-        virtual bool	SetUniformFloat(const string& uniform, float value) = 0;
-        virtual bool	SetUniformVector2(const string& uniform, float value1, float value2) = 0;
-        virtual bool	SetUniformVector3(const string& uniform, const Vector3& value) = 0;
-        virtual bool    SetUniformVector3Array(const string& uniform, const Vector3* values, int arraySize) = 0;
-        virtual bool	SetUniformVector4(const string& uniform, const Vector4& value) = 0;
-        virtual bool	SetUniformMatrix3x3(const string& uniform, const Matrix3x3& value) = 0;
-        virtual bool	SetUniformMatrix4x4(const string& uniform, const Matrix4x4& value) = 0;
-        virtual bool    SetUniformMatrix4x4Array(const string& uniform, const Matrix4x4* values, int arraySize) = 0;
-        virtual bool	SetUniformTexture(const string& uniform, const Texture* texture) = 0;
+        bool	        SetUniformInt(const string& uniform, int value);
+        bool	        SetUniformFloat(const string& uniform, float value);
+        bool	        SetUniformVector2(const string& uniform, float value1, float value2);
+        bool	        SetUniformVector3(const string& uniform, const Vector3& value);
+        bool            SetUniformVector3Array(const string& uniform, const Vector3* values, int arraySize);
+        bool	        SetUniformVector4(const string& uniform, const Vector4& value);
+        bool	        SetUniformMatrix3x3(const string& uniform, const Matrix3x3& value);
+        bool	        SetUniformMatrix4x4(const string& uniform, const Matrix4x4& value);
+        bool            SetUniformMatrix4x4Array(const string& uniform, const Matrix4x4* values, int arraySize);
+        bool	        SetUniformTexture(const string& uniform, const Texture* texture);
+
+		// UNIFORM SETTERS BY HANDLE. An invalid handle is silently ignored
+        bool	        SetUniformInt(UniformHandle_t uniform, int value);
+        bool	        SetUniformFloat(UniformHandle_t uniform, float value);
+        bool	        SetUniformVector2(UniformHandle_t uniform, float value1, float value2);
+        bool	        SetUniformVector3(UniformHandle_t uniform, const Vector3& value);
+        bool            SetUniformVector3Array(UniformHandle_t uniform, const Vector3* values, int arraySize);
+        bool	        SetUniformVector4(UniformHandle_t uniform, const Vector4& value);
+        bool	        SetUniformMatrix3x3(UniformHandle_t uniform, const Matrix3x3& value);
+        bool	        SetUniformMatrix4x4(UniformHandle_t uniform, const Matrix4x4& value);
+        bool            SetUniformMatrix4x4Array(UniformHandle_t uniform, const Matrix4x4* values, int arraySize);
+        bool	        SetUniformTexture(UniformHandle_t uniform, const Texture* texture);
 
         uint16_t        GetId() const { return id_; }
 
+        /**
+         * Returns the number of uniform values sent to the API since the counters were reset
+         */
+        size_t          GetNumIssuedUniformUploads() const { return numIssuedUniformUploads_; }
+
+        /**
+         * Returns the number of uniform values that weren't sent to the API because the uniform already had that value
+         * since the counters were reset
+         */
+        size_t          GetNumSkippedUniformUploads() const { return numSkippedUniformUploads_; }
+
+        void            ResetUniformUploadCounters();
+
+        /**
+         * Returns the size of the shadow copy of the uniforms, in bytes
+         */
+        size_t          GetUniformShadowSize() const { return uniformShadowData_.size(); }
+
 	protected:
         uint16_t        id_;                /**< Id of the shader */
         static uint16_t nextAvailableId_;
+        UniformHandle_t builtinUniformHandles_[NUM_BUILTIN_UNIFORMS];   /**< Handles of the builtin uniforms */
+        uint32_t        builtinUniformMask_;    /**< Builtin uniforms used by the shader */
+        bool            useUniformShadows_; /**< False if the API doesn't keep the values of the uniforms of each shader */
+
+        /**
+         * Resolves the handles of the builtin uniforms and forgets the values of the uniforms. Must be called by the
+         * implementations once the shader is created
+         */
+        void            ResolveBuiltinUniforms();
+
+        /**
+         * Logs that a uniform couldn't be found by its name
+         * @param uniform The name of the uniform
+         */
+        void            LogUniformNotFound(const string& uniform) const;
+
+        /**
+         * Returns the number of elements of a uniform as declared in the shader, so that the shadow copy of an array
+         * is sized once for its largest value
+         * @param uniform A valid handle
+         * @return The length of the array, 1 if the uniform isn't an array
+         */
+        virtual size_t  GetUniformArrayLength(UniformHandle_t /*uniform*/) const { return 1; }
+
+        // API SPECIFIC UNIFORM SETTERS. The handles are always valid
+        virtual void    SetUniformIntImpl(UniformHandle_t uniform, int value) = 0;
+        virtual void    SetUniformFloatImpl(UniformHandle_t uniform, float value) = 0;
+        virtual void    SetUniformVector2Impl(UniformHandle_t uniform, float value1, float value2) = 0;
+        virtual void    SetUniformVector3Impl(UniformHandle_t uniform, const Vector3& value) = 0;
+        virtual void    SetUniformVector3ArrayImpl(UniformHandle_t uniform, const Vector3* values, int arraySize) = 0;
+        virtual void    SetUniformVector4Impl(UniformHandle_t uniform, const Vector4& value) = 0;
+        virtual void    SetUniformMatrix3x3Impl(UniformHandle_t uniform, const Matrix3x3& value) = 0;
+        virtual void    SetUniformMatrix4x4Impl(UniformHandle_t uniform, const Matrix4x4& value) = 0;
+        virtual void    SetUniformMatrix4x4ArrayImpl(UniformHandle_t uniform, const Matrix4x4* values, int arraySize) = 0;
+        virtual void    SetUniformTextureImpl(UniformHandle_t uniform, const Texture* texture) = 0;
+
+    private:
+        /**
+         * @struct UniformShadow_t
+         * Location of the last value of a uniform in the shadow data
+         */
+        struct UniformShadow_t {
+            size_t      offset;
+            size_t      size;       /**< Size of the value, in bytes */
+            size_t      capacity;   /**< Size reserved for the value in the shadow data, in bytes */
+            bool        isSet;
+        };
+
+        vector<UniformShadow_t> uniformShadows_;    /**< Shadow of the uniforms, indexed by their handle */
+        vector<unsigned char>   uniformShadowData_; /**< Last values of the uniforms */
+        size_t          numIssuedUniformUploads_;
+        size_t          numSkippedUniformUploads_;
+
+        /**
+         * Compares a value with the last value of a uniform and updates the shadow copy if they differ
+         * @param uniform A valid handle
+         * @param value The new value of the uniform
+         * @param elementSize The size of one element of the value, in bytes
+         * @param numElements The number of elements of the value, more than one for arrays
+         * @return true if the value has to be sent to the API, false if the uniform already has that value
+         */
+        bool            UpdateUniformShadow(UniformHandle_t uniform, const void* value, size_t elementSize, size_t numElements=1);
 };
 
+/**
+ * Changes the name of a builtin uniform. The handles of the builtin uniforms are resolved when a shader is created,
+ * so this has to be called before creating the shaders that use the new name
+ */
 extern "C" {
     SKETCH_3D_API void SetBuiltinUniformName(BuiltinUniform_t builtinUniform, const string& uniformName);
     SKETCH_3D_API const string& GetBuiltinUniformName(BuiltinUniform_t builtinUniform);
@@ -0,0 +1,89 @@
+#ifndef SKETCH_3D_TEXTURE_UNIT_CACHE_H
+#define SKETCH_3D_TEXTURE_UNIT_CACHE_H
+
+#include "system/Platform.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+namespace Sketch3D {
+
+/**
+ * @class TextureUnitCache
+ * Keeps track of the texture bound on each texture unit. A texture that is already bound stays on its unit, so that
+ * drawing with it again doesn't have to bind it. When a texture isn't bound, it replaces the texture that was used the
+ * least recently: the textures used by every draw call stay resident while the ones used once in a while are evicted.
+ *
+ * The textures are identified by their id, see Texture::GetId.
+ */
+class SKETCH_3D_API TextureUnitCache {
+    public:
+        /**
+         * Constructor
+         * @param numTextureUnits The number of texture units to manage
+         */
+                            TextureUnitCache(size_t numTextureUnits=0);
+
+        /**
+         * Change the number of texture units to manage. The cache then considers that no texture is bound
+         */
+        void                SetNumTextureUnits(size_t numTextureUnits);
+
+        /**
+         * Find the texture unit of a texture, choosing one if the texture isn't bound
+         * @param textureId The id of the texture
+         * @param textureUnit The texture unit of the texture
+         * @return true if the texture has to be bound to textureUnit, false if it already is
+         */
+        bool                Acquire(uint32_t textureId, size_t& textureUnit);
+
+        /**
+         * Forget the texture bound to all the texture units, for instance when the API state was changed behind the
+         * back of the cache
+         */
+        void                Clear();
+
+        size_t              GetNumTextureUnits() const { return textureUnits_.size(); }
+
+        /**
+         * Returns the number of textures that had to be bound since the counters were reset
+         */
+        size_t              GetNumBinds() const { return numBinds_; }
+
+        /**
+         * Returns the number of textures that were already bound since the counters were reset
+         */
+        size_t              GetNumHits() const { return numHits_; }
+
+        /**
+         * Returns the number of bound textures that were replaced by another one since the counters were reset
+         */
+        size_t              GetNumEvictions() const { return numEvictions_; }
+
+        void                ResetCounters();
+
+    private:
+        /**
+         * @struct TextureUnit_t
+         * The texture bound to a texture unit
+         */
+        struct TextureUnit_t {
+            uint32_t        textureId;
+            bool            isUsed;         /**< Is a texture bound to the unit? */
+            uint64_t        lastUse;        /**< Value of useCounter_ when the texture was last acquired */
+        };
+
+        vector<TextureUnit_t>               textureUnits_;
+        unordered_map<uint32_t, size_t>     textureToUnit_;     /**< Texture unit of each bound texture */
+        uint64_t                            useCounter_;        /**< Incremented each time that a texture is acquired */
+        size_t                              numBinds_;
+        size_t                              numHits_;
+        size_t                              numEvictions_;
+};
+
+}
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef SKETCH_3D_JOB_SYSTEM_H
+#define SKETCH_3D_JOB_SYSTEM_H
+
+#include "system/Platform.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+using namespace std;
+
+namespace Sketch3D {
+
+// Forward declaration
+struct Job_t;
+class JobDeque;
+
+/**
+ * @class JobCounter
+ * Counts the jobs that were started with it as signal and that didn't finish yet. A job can wait for a counter to
+ * reach 0 before starting, which is how the dependencies between the jobs are expressed
+ */
+class SKETCH_3D_API JobCounter {
+    friend class JobSystem;
+
+    public:
+                            JobCounter();
+
+        /**
+         * Returns true once all the jobs signaling the counter finished
+         */
+        bool                IsDone() const { return value_.load(memory_order_acquire) == 0; }
+
+    private:
+        atomic<size_t>      value_;
+        mutex               waitingJobsMutex_;
+        vector<Job_t*>      waitingJobs_;   /**< Jobs started once the counter reaches 0 */
+
+                            JobCounter(const JobCounter& src);
+        JobCounter&         operator= (const JobCounter& rhs);
+};
+
+/**
+ * @class JobSystem
+ * This class is a singleton that runs jobs on a pool of worker threads. Each worker has its own deque of jobs: it
+ * takes the last job that it pushed and steals the oldest job of the other workers when its deque is empty. The
+ * thread that initialized the job system also owns a deque, the other threads push their jobs in a shared queue.
+ *
+ * A thread waiting for a counter runs jobs in the meantime, so a job may start other jobs and wait for them.
+ */
+class SKETCH_3D_API JobSystem {
+    public:
+        /**
+         * Destructor. Waits for the workers to finish their current job and stops them
+         */
+                           ~JobSystem();
+
+        static JobSystem*   GetInstance();
+
+        /**
+         * Start the worker threads. Called by the first job if the job system wasn't initialized
+         * @param numWorkerThreads The number of worker threads, 0 to use one less than the number of hardware threads
+         * so that the calling thread has a core to itself
+         */
+        void                Initialize(size_t numWorkerThreads=0);
+
+        /**
+         * Returns the number of worker threads, the calling thread excluded
+         */
+        size_t              GetNumWorkerThreads() const { return workerThreads_.size(); }
+
+        /**
+         * Start a job
+         * @param task The function to execute
+         * @param signal Counter incremented until the job finishes, can be NULL
+         * @param dependency Counter that has to reach 0 before the job starts, can be NULL
+         */
+        void                Run(const function<void()>& task, JobCounter* signal=NULL, JobCounter* dependency=NULL);
+
+        /**
+         * Run jobs on the calling thread until a counter reaches 0
+         */
+        void                Wait(JobCounter& counter);
+
+        /**
+         * Call a function on consecutive ranges of [begin, end) in parallel and wait for all the calls to finish
+         * @param begin The first index
+         * @param end The index following the last one
+         * @param grainSize The maximum number of indices of a range
+         * @param body Called with the first index of a range and the index following its last one
+         */
+        void                ParallelFor(size_t begin, size_t end, size_t grainSize, const function<void(size_t, size_t)>& body);
+
+    private:
+        static JobSystem    instance_;  /**< Singleton's instance */
+
+        mutex               initializationMutex_;
+        atomic<bool>        isInitialized_;
+        vector<thread>      workerThreads_;
+        vector<unique_ptr<JobDeque> > deques_;      /**< Deque of the initializing thread followed by the deques of the workers */
+
+        mutex               sharedJobsMutex_;
+        deque<Job_t*>       sharedJobs_;            /**< Jobs pushed by the threads without a deque */
+
+        atomic<size_t>      numQueuedJobs_;         /**< Jobs in the deques and in the shared queue */
+        atomic<size_t>      numSleepingWorkers_;
+        mutex               sleepMutex_;
+        condition_variable  sleepCondition_;
+        atomic<bool>        stopWorkers_;
+
+        /**
+         * Constructor
+         */
+                            JobSystem();
+
+        /**
+         * Copy-constructor to disallow copy
+         */
+                            JobSystem(const JobSystem& src);
+
+        /**
+         * Assignment operator to disallow assignment
+         */
+        JobSystem&          operator= (const JobSystem& rhs);
+
+        /**
+         * Create the deques and start the worker threads, the initialization mutex being locked
+         */
+        void                StartWorkers(size_t numWorkerThreads);
+
+        /**
+         * Queue a job whose dependency is satisfied
+         */
+        void                Push(Job_t* job);
+
+        /**
+         * Take a job from the deque of the calling thread, from the other deques or from the shared queue
+         * @return NULL if there is no job to run
+         */
+        Job_t*              FindJob();
+
+        /**
+         * Run a job, then release the jobs waiting for its signal if it was the last one
+         */
+        void                Execute(Job_t* job);
+
+        /**
+         * Function of the worker threads
+         * @param dequeIndex The deque of the worker
+         */
+        void                WorkerLoop(size_t dequeIndex);
+};
+
+}
+
+#endif
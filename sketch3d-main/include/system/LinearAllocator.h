@@ -0,0 +1,83 @@
+#ifndef SKETCH_3D_LINEAR_ALLOCATOR_H
+#define SKETCH_3D_LINEAR_ALLOCATOR_H
+
+#include "system/Platform.h"
+
+#include <vector>
+using namespace std;
+
+namespace Sketch3D {
+
+/**
+ * @class LinearAllocator
+ * Arena allocator that hands out memory by bumping an offset in big blocks. Memory isn't freed one allocation
+ * at a time: the whole arena is reset at once, typically at the end of a frame. When an arena needed more than
+ * one block, the blocks are merged together on reset so that following frames fit in a single block and don't
+ * touch the heap anymore.
+ */
+class SKETCH_3D_API LinearAllocator {
+    public:
+        /**
+         * Constructor. No memory is allocated until the first allocation
+         * @param blockSize The size in bytes of the first block
+         */
+                            LinearAllocator(size_t blockSize=64 * 1024);
+
+        /**
+         * Destructor. Frees all the blocks
+         */
+                           ~LinearAllocator();
+
+        /**
+         * Allocates memory aligned on SIMD_ALIGNMENT. The memory is valid until the next call to Reset
+         * @param size The size in bytes to allocate
+         * @return A pointer to the allocated memory
+         */
+        void*               Allocate(size_t size);
+
+        /**
+         * Makes all the memory available again. The previous allocations become invalid
+         */
+        void                Reset();
+
+        /**
+         * Returns the number of blocks that were allocated on the heap since the creation of the arena
+         */
+        size_t              GetNumHeapAllocations() const;
+
+    private:
+        /**
+         * @struct Block_t
+         * A chunk of memory from which the allocations are made
+         */
+        struct Block_t {
+            char*   data;
+            size_t  size;
+        };
+
+        vector<Block_t>     blocks_;                /**< The blocks allocated so far */
+        size_t              blockSize_;             /**< Size of the next block to allocate */
+        size_t              currentBlock_;          /**< Index of the block where the allocations are made */
+        size_t              offset_;                /**< Offset of the next free byte in the current block */
+        size_t              numHeapAllocations_;    /**< Number of blocks allocated on the heap */
+
+        /**
+         * Allocate a new block on the heap and make it the current one
+         * @param size The minimum size of the block
+         */
+        void                AllocateBlock(size_t size);
+
+        /**
+         * Copy-constructor - here only to disallow copy
+         */
+                            LinearAllocator(const LinearAllocator& src);
+
+        /**
+         * Assignment operator - here only to disallow assignment
+         */
+        LinearAllocator&    operator=(const LinearAllocator& rhs);
+};
+
+}
+
+#endif
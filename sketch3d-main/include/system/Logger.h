@@ -3,13 +3,23 @@
 
 #include "system/Platform.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
 using namespace std;
 
 namespace Sketch3D {
 
+// Forward declaration
+struct LoggerThreadBuffer_t;
+
 /**
  * @enum LoggerLevel_t
  * Determines what information should the logger output. When the Logger has one of those value
@@ -28,6 +38,13 @@ enum LoggerLevel_t {
  * @class Logger
  * This class is a singleton and is used to log information, warnings and
  * errors into a structure html file.
+ *
+ * The messages are written in a ring buffer owned by the calling thread
+ * without taking a lock, a background thread formatting them and writing
+ * them in the file. A message that was already logged by the same thread
+ * in the last seconds is only counted, its next occurrence telling how
+ * many times it was repeated. The LOG_* macros don't evaluate their message
+ * when its level is filtered out.
  */
 class SKETCH_3D_API Logger {
 	public:
@@ -44,6 +61,20 @@ class SKETCH_3D_API Logger {
          */
         void            SetLoggerLevel(LoggerLevel_t level);
 
+        /**
+         * Tell if the messages of a level are written
+         * @param level The level of the message
+         */
+        bool            IsLevelEnabled(LoggerLevel_t level) const { return level <= level_.load(memory_order_relaxed); }
+
+        /**
+         * Write a message in the log
+         * @param level The level of the message
+         * @param message The message to write
+         */
+        void            Log(LoggerLevel_t level, const char* message);
+        void            Log(LoggerLevel_t level, const string& message);
+
 		/**
 		 * Write a debug message in the log
 		 * @param message The message to write
@@ -67,12 +98,35 @@ class SKETCH_3D_API Logger {
 		 * @param message The message to write
 		 */
 		void			Error(const string& message);
+
+        /**
+         * Wait for the messages logged before the call to be written in the file
+         */
+        void            Flush();
+
+        /**
+         * Returns the number of messages that were dropped because the buffer of their thread was full
+         */
+        size_t          GetNumDroppedMessages() const;
 		
 	private:
 		static Logger	instance_;	/**< Singleton's instance */
 
-		ofstream		file_;		/**< The file to which we're writting */
-        LoggerLevel_t   level_;     /**< Logger output level */
+		ofstream		file_;		/**< The file to which we're writting, only used by the writer thread */
+        atomic<LoggerLevel_t>   level_;     /**< Logger output level */
+        atomic<bool>    isShutDown_;    /**< The messages logged while the static objects are destroyed are dropped */
+
+        mutable mutex   threadBuffersMutex_;    /**< Only taken when a thread logs its first message and by the writer thread */
+        vector<unique_ptr<LoggerThreadBuffer_t> > threadBuffers_;
+
+        thread          writerThread_;      /**< Started with the first message */
+        mutex           writerMutex_;
+        condition_variable  writerCondition_;   /**< Wakes the writer thread up before its period */
+        condition_variable  flushCondition_;    /**< Signaled each time the writer thread emptied the buffers */
+        size_t          numFlushRequests_;
+        size_t          numCompletedFlushRequests_;
+        bool            stopWriter_;
+        size_t          numReportedDroppedMessages_;    /**< Only used by the writer thread */
 
 		/**
 		 * Constructor
@@ -89,12 +143,47 @@ class SKETCH_3D_API Logger {
 		 */
 		Logger&			operator= (const Logger& rhs);
 
+        /**
+         * Copy a message in the buffer of the calling thread unless it was repeated recently
+         */
+        void            Write(LoggerLevel_t level, const char* message, size_t length);
+
+        /**
+         * Returns the buffer of the calling thread, registering one on the first call
+         */
+        LoggerThreadBuffer_t*   GetThreadBuffer();
+
+        /**
+         * Function of the writer thread
+         */
+        void            WriterLoop();
+
+        /**
+         * Write the messages of all the thread buffers in the file
+         */
+        void            WriteThreadBuffers();
+
 		/**
-		 * Return the current time as a string in the format H:M:S
+		 * Return a time as a string in the format H:M:S
 		 */
-		string			GetCurrentTime() const;
+		string			FormatTime(time_t t) const;
 };
 
 }
 
+/**
+ * Log a message if its level is enabled, the message expression isn't evaluated otherwise
+ */
+#define SKETCH_3D_LOG(level, message) \
+    do { \
+        if (Sketch3D::Logger::GetInstance()->IsLevelEnabled(level)) { \
+            Sketch3D::Logger::GetInstance()->Log(level, message); \
+        } \
+    } while (false)
+
+#define LOG_ERROR(message) SKETCH_3D_LOG(Sketch3D::LOGGER_LEVEL_ERROR, message)
+#define LOG_WARNING(message) SKETCH_3D_LOG(Sketch3D::LOGGER_LEVEL_WARNING, message)
+#define LOG_INFO(message) SKETCH_3D_LOG(Sketch3D::LOGGER_LEVEL_INFO, message)
+#define LOG_DEBUG(message) SKETCH_3D_LOG(Sketch3D::LOGGER_LEVEL_DEBUG, message)
+
 #endif
\ No newline at end of file
@@ -69,6 +69,14 @@ namespace Sketch3D
 #   define HAVE_SSE 0
 #endif
 
+// AVX intrinsics need a compiler that can target AVX on a per function basis
+#if HAVE_SSE && ((COMPILER == COMPILER_MSVC && _MSC_VER >= 1600) || \
+                 (COMPILER == COMPILER_GNUC && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#   define HAVE_AVX 1
+#else
+#   define HAVE_AVX 0
+#endif
+
 // DLL stuff
 #if !defined(SKETCH_3D_BUILD_STATIC)
 #   if PLATFORM == PLATFORM_WIN32
@@ -108,7 +116,8 @@ class PlatformInformation
         enum CpuFeatures {
             SSE         = 1 << 0,
             SSE2        = 1 << 1,
-            MMX         = 1 << 2
+            MMX         = 1 << 2,
+            AVX         = 1 << 3
         };
 
         /**
@@ -0,0 +1,183 @@
+#ifndef SKETCH_3D_PROFILER_H
+#define SKETCH_3D_PROFILER_H
+
+#include "system/Platform.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace Sketch3D {
+
+// Forward declaration
+struct ProfilerThreadBuffer_t;
+
+/**
+ * @struct ProfilerEvent_t
+ * A zone that was closed, its times being in nanoseconds since the creation of the profiler
+ */
+struct ProfilerEvent_t {
+    const char* name;
+    uint64_t    start;
+    uint64_t    end;
+    uint32_t    depth;      /**< Number of zones that were open on the thread when the zone was opened */
+};
+
+/**
+ * @class Profiler
+ * This class is a singleton that records the time spent in the zones of the engine, each thread writing in its own
+ * buffer without taking a lock. The zones are opened with the PROFILE_ZONE macro, which is compiled out unless
+ * SKETCH_3D_PROFILING is defined.
+ *
+ * Each thread keeps its latest events, the oldest ones being overwritten once its buffer is full, so that a trace
+ * exported at the end of a run covers its last frames. The events can be saved in the Chrome trace format, to be
+ * opened in chrome://tracing or in Perfetto.
+ */
+class SKETCH_3D_API Profiler {
+    public:
+        /**
+         * Destructor
+         */
+                                   ~Profiler();
+
+        static Profiler*            GetInstance();
+
+        /**
+         * Start or stop the recording of the zones. The zones already open when the recording is stopped are still
+         * recorded
+         */
+        void                        SetEnabled(bool enabled);
+        bool                        IsEnabled() const { return enabled_.load(memory_order_relaxed); }
+
+        /**
+         * Set the number of events that each thread keeps, the oldest ones being overwritten by the new ones. Only
+         * applies to the threads that didn't record anything yet
+         */
+        void                        SetMaxEventsPerThread(size_t maxEvents);
+
+        /**
+         * Name the calling thread in the exported traces, which creates its buffer. Use the PROFILE_THREAD_NAME macro
+         * so that the buffer isn't created when profiling is disabled
+         */
+        void                        SetThreadName(const string& name);
+
+        /**
+         * Returns the current time in nanoseconds since the creation of the profiler
+         */
+        uint64_t                    GetTime() const;
+
+        /**
+         * Record a zone closed by the calling thread
+         * @param name The name of the zone. It isn't copied, so it must outlive the profiler, like a string literal
+         * @param start The time at which the zone was opened
+         * @param end The time at which the zone was closed
+         * @param depth The number of zones that were open on the thread when the zone was opened
+         */
+        void                        AddEvent(const char* name, uint64_t start, uint64_t end, uint32_t depth);
+
+        /**
+         * Returns the events kept by all the threads, sorted by thread and then by closing time. The events overwritten
+         * by their thread while they are being read are left out
+         * @param threadIndices Filled with the thread of each event, can be NULL
+         */
+        vector<ProfilerEvent_t>     GetEvents(vector<size_t>* threadIndices=NULL) const;
+
+        /**
+         * Returns the number of events that were overwritten because a thread buffer was full
+         */
+        size_t                      GetNumDroppedEvents() const;
+
+        /**
+         * Forget the recorded events. No zone may be closed on another thread while clearing
+         */
+        void                        Clear();
+
+        /**
+         * Write the recorded events in the Chrome trace event format
+         * @param filename The JSON file to write
+         * @return false if the file couldn't be written
+         */
+        bool                        ExportChromeTrace(const string& filename) const;
+
+    private:
+        static Profiler             instance_;  /**< Singleton's instance */
+
+        atomic<bool>                enabled_;
+        size_t                      maxEventsPerThread_;
+        uint64_t                    startTime_;             /**< Time of the creation of the profiler in nanoseconds */
+        mutable mutex               threadBuffersMutex_;    /**< Only taken when a thread records its first event and when reading the events */
+        vector<unique_ptr<ProfilerThreadBuffer_t> > threadBuffers_;
+
+        /**
+         * Constructor
+         */
+                                    Profiler();
+
+        /**
+         * Copy-constructor to disallow copy
+         */
+                                    Profiler(const Profiler& src);
+
+        /**
+         * Assignment operator to disallow assignment
+         */
+        Profiler&                   operator= (const Profiler& rhs);
+
+        /**
+         * Returns the buffer of the calling thread, creating it on the first call
+         */
+        ProfilerThreadBuffer_t*     GetThreadBuffer();
+};
+
+/**
+ * @class ProfilerZone
+ * Records the time spent between its construction and its destruction. Use the PROFILE_ZONE macro rather than this
+ * class so that the zones disappear when profiling is disabled
+ */
+class SKETCH_3D_API ProfilerZone {
+    public:
+        /**
+         * Constructor
+         * @param name The name of the zone, which must outlive the profiler
+         */
+                                    ProfilerZone(const char* name);
+                                   ~ProfilerZone();
+
+    private:
+        const char*                 name_;      /**< NULL if the profiler was disabled when the zone was opened */
+        uint64_t                    start_;
+        uint32_t                    depth_;
+
+                                    ProfilerZone(const ProfilerZone& src);
+        ProfilerZone&               operator= (const ProfilerZone& rhs);
+};
+
+}
+
+#define SKETCH_3D_PROFILER_CONCATENATE_IMPL(a, b) a##b
+#define SKETCH_3D_PROFILER_CONCATENATE(a, b) SKETCH_3D_PROFILER_CONCATENATE_IMPL(a, b)
+
+/**
+ * Record the time spent until the end of the enclosing scope under the given name, which must be a string literal
+ */
+#ifdef SKETCH_3D_PROFILING
+#   define PROFILE_ZONE(name) Sketch3D::ProfilerZone SKETCH_3D_PROFILER_CONCATENATE(profilerZone, __LINE__)(name)
+#else
+#   define PROFILE_ZONE(name)
+#endif
+
+/**
+ * Name the calling thread in the exported traces. Naming a thread creates its buffer, so the engine's threads are only
+ * named when profiling is enabled
+ */
+#ifdef SKETCH_3D_PROFILING
+#   define PROFILE_THREAD_NAME(name) Sketch3D::Profiler::GetInstance()->SetThreadName(name)
+#else
+#   define PROFILE_THREAD_NAME(name)
+#endif
+
+#endif
@@ -0,0 +1,72 @@
+#include "math/BoundingBox.h"
+
+#include "math/Sphere.h"
+
+#include <algorithm>
+#include <math.h>
+using namespace std;
+
+namespace Sketch3D {
+BoundingBox::BoundingBox() {
+}
+
+BoundingBox::BoundingBox(const Vector3& minimum, const Vector3& maximum) : minimum_(minimum), maximum_(maximum) {
+}
+
+BoundingBox::BoundingBox(const Sphere& sphere) : minimum_(sphere.GetCenter() - sphere.GetRadius()),
+                                                 maximum_(sphere.GetCenter() + sphere.GetRadius())
+{
+}
+
+RelativePlanePosition_t BoundingBox::IntersectsPlane(const Plane& plane) const {
+    // Project the half extents on the normal to get the radius of the box along it
+    const Vector3& normal = plane.GetNormal();
+    Vector3 center = (minimum_ + maximum_) * 0.5f;
+    Vector3 extents = (maximum_ - minimum_) * 0.5f;
+
+    float radius = fabs(normal.x) * extents.x + fabs(normal.y) * extents.y + fabs(normal.z) * extents.z;
+    float distance = normal.Dot(center) + plane.GetDistance();
+
+    if (distance < -radius) {
+        return RELATIVE_PLANE_POSITION_OUTSIDE;
+    }
+
+    if (distance <= radius) {
+        return RELATIVE_PLANE_POSITION_INTERSECTS;
+    }
+
+    return RELATIVE_PLANE_POSITION_INSIDE;
+}
+
+bool BoundingBox::Contains(const BoundingBox& box) const {
+    return minimum_.x <= box.minimum_.x && minimum_.y <= box.minimum_.y && minimum_.z <= box.minimum_.z &&
+           maximum_.x >= box.maximum_.x && maximum_.y >= box.maximum_.y && maximum_.z >= box.maximum_.z;
+}
+
+BoundingBox BoundingBox::Merged(const BoundingBox& box) const {
+    return BoundingBox(Vector3(min(minimum_.x, box.minimum_.x), min(minimum_.y, box.minimum_.y), min(minimum_.z, box.minimum_.z)),
+                       Vector3(max(maximum_.x, box.maximum_.x), max(maximum_.y, box.maximum_.y), max(maximum_.z, box.maximum_.z)));
+}
+
+float BoundingBox::GetSurfaceArea() const {
+    Vector3 size = maximum_ - minimum_;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+void BoundingBox::SetMinimum(const Vector3& minimum) {
+    minimum_ = minimum;
+}
+
+void BoundingBox::SetMaximum(const Vector3& maximum) {
+    maximum_ = maximum;
+}
+
+const Vector3& BoundingBox::GetMinimum() const {
+    return minimum_;
+}
+
+const Vector3& BoundingBox::GetMaximum() const {
+    return maximum_;
+}
+
+}
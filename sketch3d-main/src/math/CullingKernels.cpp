@@ -0,0 +1,279 @@
+#include "math/CullingKernels.h"
+
+#include <string.h>
+
+#if HAVE_SSE
+#   include <emmintrin.h>
+#endif
+
+#if HAVE_AVX
+#   include <immintrin.h>
+#endif
+
+#if COMPILER == COMPILER_GNUC
+#   define TARGET_SSE2 __attribute__((target("sse2")))
+#   define TARGET_AVX  __attribute__((target("avx")))
+#else
+#   define TARGET_SSE2
+#   define TARGET_AVX
+#endif
+
+namespace Sketch3D {
+
+///////////////////////////////////////////////////////////////////////////////
+// SCALAR KERNELS
+///////////////////////////////////////////////////////////////////////////////
+static inline bool IsSphereBehindPlane(const float* plane, float x, float y, float z, float radius) {
+    // Same order of operations as the SIMD kernels, so that all the implementations agree on the borderline cases
+    return (plane[0] * x + plane[1] * y) + (plane[2] * z + plane[3]) < -radius;
+}
+
+/**
+ * Returns the plane hint of a sphere, or 0 if there is none
+ */
+static inline size_t GetPlaneHint(const SphereBatch_t& spheres, size_t sphere, size_t numPlanes) {
+    if (spheres.planeHints == nullptr || spheres.planeHints[sphere] >= numPlanes) {
+        return 0;
+    }
+
+    return spheres.planeHints[sphere];
+}
+
+static bool IsSphereVisibleScalar(const float* planes, size_t numPlanes, const SphereBatch_t& spheres, size_t sphere) {
+    float x = spheres.centersX[sphere];
+    float y = spheres.centersY[sphere];
+    float z = spheres.centersZ[sphere];
+    float radius = spheres.radii[sphere];
+
+    // Objects tend to be rejected by the same plane from one frame to the next
+    size_t hint = GetPlaneHint(spheres, sphere, numPlanes);
+    if (IsSphereBehindPlane(planes + hint * 4, x, y, z, radius)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < numPlanes; i++) {
+        if (i != hint && IsSphereBehindPlane(planes + i * 4, x, y, z, radius)) {
+            if (spheres.planeHints != nullptr) {
+                spheres.planeHints[sphere] = (uint8_t)i;
+            }
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void CullSpheresScalar(const float* planes, size_t numPlanes, const SphereBatch_t& spheres, uint32_t* visibility) {
+    memset(visibility, 0, GetNumVisibilityWords(spheres.numSpheres) * sizeof(uint32_t));
+
+    for (size_t i = 0; i < spheres.numSpheres; i++) {
+        if (IsSphereVisibleScalar(planes, numPlanes, spheres, i)) {
+            visibility[i / 32] |= 1u << (i % 32);
+        }
+    }
+}
+
+/**
+ * Record the plane that rejected the spheres of a group that weren't already rejected
+ * @param rejected Bit mask of the spheres of the group that were just rejected
+ */
+static inline void UpdatePlaneHints(const SphereBatch_t& spheres, size_t first, int rejected, size_t plane) {
+    for (size_t i = 0; rejected != 0; i++, rejected >>= 1) {
+        if (rejected & 1) {
+            spheres.planeHints[first + i] = (uint8_t)plane;
+        }
+    }
+}
+
+static const CullingKernels_t scalarKernels = {
+    CULLING_KERNELS_SCALAR,
+    CullSpheresScalar
+};
+
+#if HAVE_SSE
+///////////////////////////////////////////////////////////////////////////////
+// SSE2 KERNELS
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Load the hinted planes of 4 consecutive spheres, transposed: one register per component of the planes
+ */
+TARGET_SSE2 static inline void LoadHintedPlanesSse2(const float* planes, size_t numPlanes, const SphereBatch_t& spheres,
+                                                    size_t first, __m128& nx, __m128& ny, __m128& nz, __m128& d)
+{
+    nx = _mm_loadu_ps(planes + GetPlaneHint(spheres, first, numPlanes) * 4);
+    ny = _mm_loadu_ps(planes + GetPlaneHint(spheres, first + 1, numPlanes) * 4);
+    nz = _mm_loadu_ps(planes + GetPlaneHint(spheres, first + 2, numPlanes) * 4);
+    d = _mm_loadu_ps(planes + GetPlaneHint(spheres, first + 3, numPlanes) * 4);
+    _MM_TRANSPOSE4_PS(nx, ny, nz, d);
+}
+
+TARGET_SSE2 static inline int TestPlaneSse2(__m128 nx, __m128 ny, __m128 nz, __m128 d, __m128 x, __m128 y, __m128 z,
+                                           __m128 negativeRadius)
+{
+    __m128 distance = _mm_add_ps(_mm_mul_ps(nx, x), _mm_mul_ps(ny, y));
+    distance = _mm_add_ps(distance, _mm_add_ps(_mm_mul_ps(nz, z), d));
+    return _mm_movemask_ps(_mm_cmplt_ps(distance, negativeRadius));
+}
+
+TARGET_SSE2 static void CullSpheresSse2(const float* planes, size_t numPlanes, const SphereBatch_t& spheres, uint32_t* visibility) {
+    memset(visibility, 0, GetNumVisibilityWords(spheres.numSpheres) * sizeof(uint32_t));
+
+    size_t i = 0;
+    for (; i + 4 <= spheres.numSpheres; i += 4) {
+        __m128 x = _mm_loadu_ps(spheres.centersX + i);
+        __m128 y = _mm_loadu_ps(spheres.centersY + i);
+        __m128 z = _mm_loadu_ps(spheres.centersZ + i);
+        __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(spheres.radii + i));
+        int outside = 0;
+
+        if (spheres.planeHints != nullptr) {
+            __m128 nx, ny, nz, d;
+            LoadHintedPlanesSse2(planes, numPlanes, spheres, i, nx, ny, nz, d);
+            outside = TestPlaneSse2(nx, ny, nz, d, x, y, z, negativeRadius);
+        }
+
+        // Stop as soon as the 4 spheres are rejected
+        for (size_t j = 0; j < numPlanes && outside != 0xF; j++) {
+            const float* plane = planes + j * 4;
+            int rejected = TestPlaneSse2(_mm_set1_ps(plane[0]), _mm_set1_ps(plane[1]), _mm_set1_ps(plane[2]),
+                                         _mm_set1_ps(plane[3]), x, y, z, negativeRadius) & ~outside;
+
+            if (rejected != 0 && spheres.planeHints != nullptr) {
+                UpdatePlaneHints(spheres, i, rejected, j);
+            }
+            outside |= rejected;
+        }
+
+        visibility[i / 32] |= (uint32_t)(~outside & 0xF) << (i % 32);
+    }
+
+    for (; i < spheres.numSpheres; i++) {
+        if (IsSphereVisibleScalar(planes, numPlanes, spheres, i)) {
+            visibility[i / 32] |= 1u << (i % 32);
+        }
+    }
+}
+
+static const CullingKernels_t sse2Kernels = {
+    CULLING_KERNELS_SSE2,
+    CullSpheresSse2
+};
+#endif
+
+#if HAVE_AVX
+///////////////////////////////////////////////////////////////////////////////
+// AVX KERNELS
+///////////////////////////////////////////////////////////////////////////////
+TARGET_AVX static inline __m256 CombineAvx(__m128 low, __m128 high) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+}
+
+TARGET_AVX static inline int TestPlaneAvx(__m256 nx, __m256 ny, __m256 nz, __m256 d, __m256 x, __m256 y, __m256 z,
+                                         __m256 negativeRadius)
+{
+    __m256 distance = _mm256_add_ps(_mm256_mul_ps(nx, x), _mm256_mul_ps(ny, y));
+    distance = _mm256_add_ps(distance, _mm256_add_ps(_mm256_mul_ps(nz, z), d));
+    return _mm256_movemask_ps(_mm256_cmp_ps(distance, negativeRadius, _CMP_LT_OQ));
+}
+
+TARGET_AVX static void CullSpheresAvx(const float* planes, size_t numPlanes, const SphereBatch_t& spheres, uint32_t* visibility) {
+    memset(visibility, 0, GetNumVisibilityWords(spheres.numSpheres) * sizeof(uint32_t));
+
+    size_t i = 0;
+    for (; i + 8 <= spheres.numSpheres; i += 8) {
+        __m256 x = _mm256_loadu_ps(spheres.centersX + i);
+        __m256 y = _mm256_loadu_ps(spheres.centersY + i);
+        __m256 z = _mm256_loadu_ps(spheres.centersZ + i);
+        __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(spheres.radii + i));
+        int outside = 0;
+
+        if (spheres.planeHints != nullptr) {
+            __m128 nx0, ny0, nz0, d0, nx1, ny1, nz1, d1;
+            LoadHintedPlanesSse2(planes, numPlanes, spheres, i, nx0, ny0, nz0, d0);
+            LoadHintedPlanesSse2(planes, numPlanes, spheres, i + 4, nx1, ny1, nz1, d1);
+            outside = TestPlaneAvx(CombineAvx(nx0, nx1), CombineAvx(ny0, ny1), CombineAvx(nz0, nz1), CombineAvx(d0, d1),
+                                   x, y, z, negativeRadius);
+        }
+
+        for (size_t j = 0; j < numPlanes && outside != 0xFF; j++) {
+            const float* plane = planes + j * 4;
+            int rejected = TestPlaneAvx(_mm256_set1_ps(plane[0]), _mm256_set1_ps(plane[1]), _mm256_set1_ps(plane[2]),
+                                        _mm256_set1_ps(plane[3]), x, y, z, negativeRadius) & ~outside;
+
+            if (rejected != 0 && spheres.planeHints != nullptr) {
+                UpdatePlaneHints(spheres, i, rejected, j);
+            }
+            outside |= rejected;
+        }
+
+        visibility[i / 32] |= (uint32_t)(~outside & 0xFF) << (i % 32);
+    }
+
+    // Avoid the penalty of mixing AVX and legacy SSE code in the caller
+    _mm256_zeroupper();
+
+    for (; i < spheres.numSpheres; i++) {
+        if (IsSphereVisibleScalar(planes, numPlanes, spheres, i)) {
+            visibility[i / 32] |= 1u << (i % 32);
+        }
+    }
+}
+
+static const CullingKernels_t avxKernels = {
+    CULLING_KERNELS_AVX,
+    CullSpheresAvx
+};
+#endif
+
+static const CullingKernels_t& SelectCullingKernels() {
+#if HAVE_AVX
+    if (PlatformInformation::HasCpuFeature(PlatformInformation::AVX)) {
+        return avxKernels;
+    }
+#endif
+
+#if HAVE_SSE
+    if (PlatformInformation::HasCpuFeature(PlatformInformation::SSE2)) {
+        return sse2Kernels;
+    }
+#endif
+
+    return scalarKernels;
+}
+
+const CullingKernels_t& GetCullingKernels() {
+    static const CullingKernels_t& kernels = SelectCullingKernels();
+    return kernels;
+}
+
+const CullingKernels_t* GetCullingKernels(CullingKernelsType_t type) {
+    switch (type) {
+        case CULLING_KERNELS_SCALAR:
+            return &scalarKernels;
+
+#if HAVE_SSE
+        case CULLING_KERNELS_SSE2:
+            if (PlatformInformation::HasCpuFeature(PlatformInformation::SSE2)) {
+                return &sse2Kernels;
+            }
+            break;
+#endif
+
+#if HAVE_AVX
+        case CULLING_KERNELS_AVX:
+            if (PlatformInformation::HasCpuFeature(PlatformInformation::AVX)) {
+                return &avxKernels;
+            }
+            break;
+#endif
+
+        default:
+            break;
+    }
+
+    return nullptr;
+}
+
+}
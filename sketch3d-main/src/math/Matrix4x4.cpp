@@ -85,78 +85,27 @@ Matrix4x4::Matrix4x4(const Matrix3x3& src) {
 
 Matrix4x4 Matrix4x4::Transpose() const
 {
-    float data[16];
-    int cnt = 0;
+    Matrix4x4 mat;
+    GetMatrixKernels().transpose(&data_[0][0], &mat.data_[0][0]);
+    return mat;
+}
 
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 4; j++) {
-            data[cnt++] = data_[j][i];
-        }
-    }
+Matrix4x4 Matrix4x4::Inverse() const {
+    Matrix4x4 mat;
+    GetMatrixKernels().inverse(&data_[0][0], &mat.data_[0][0]);
+    return mat;
+}
 
-    return Matrix4x4(data);
+void Matrix4x4::MultiplyBatch(const Matrix4x4& a, const Matrix4x4* matrices, size_t count, Matrix4x4* results) {
+    if (count > 0) {
+        GetMatrixKernels().multiplyBatch(&a.data_[0][0], &matrices[0].data_[0][0], count, &results[0].data_[0][0]);
+    }
 }
 
-Matrix4x4 Matrix4x4::Inverse() const {
-    // From OGRE source code
-    float m00 = data_[0][0], m01 = data_[0][1], m02 = data_[0][2], m03 = data_[0][3];
-    float m10 = data_[1][0], m11 = data_[1][1], m12 = data_[1][2], m13 = data_[1][3];
-    float m20 = data_[2][0], m21 = data_[2][1], m22 = data_[2][2], m23 = data_[2][3];
-    float m30 = data_[3][0], m31 = data_[3][1], m32 = data_[3][2], m33 = data_[3][3];
-
-    float v0 = m20 * m31 - m21 * m30;
-    float v1 = m20 * m32 - m22 * m30;
-    float v2 = m20 * m33 - m23 * m30;
-    float v3 = m21 * m32 - m22 * m31;
-    float v4 = m21 * m33 - m23 * m31;
-    float v5 = m22 * m33 - m23 * m32;
-
-    float t00 =  (v5 * m11 - v4 * m12 + v3 * m13);
-    float t10 = -(v5 * m10 - v2 * m12 + v1 * m13);
-    float t20 =  (v4 * m10 - v2 * m11 + v0 * m13);
-    float t30 = -(v3 * m10 - v1 * m11 + v0 * m12);
-
-    float invDet = 1.0f / (t00 * m00 + t10 * m01 + t20 * m02 + t30 * m03);
-
-    float d00 = t00 * invDet;
-    float d10 = t10 * invDet;
-    float d20 = t20 * invDet;
-    float d30 = t30 * invDet;
-
-    float d01 = -(v5 * m01 - v4 * m02 + v3 * m03) * invDet;
-    float d11 =  (v5 * m00 - v2 * m02 + v1 * m03) * invDet;
-    float d21 = -(v4 * m00 - v2 * m01 + v0 * m03) * invDet;
-    float d31 =  (v3 * m00 - v1 * m01 + v0 * m02) * invDet;
-
-    v0 = m10 * m31 - m11 * m30;
-    v1 = m10 * m32 - m12 * m30;
-    v2 = m10 * m33 - m13 * m30;
-    v3 = m11 * m32 - m12 * m31;
-    v4 = m11 * m33 - m13 * m31;
-    v5 = m12 * m33 - m13 * m32;
-
-    float d02 =  (v5 * m01 - v4 * m02 + v3 * m03) * invDet;
-    float d12 = -(v5 * m00 - v2 * m02 + v1 * m03) * invDet;
-    float d22 =  (v4 * m00 - v2 * m01 + v0 * m03) * invDet;
-    float d32 = -(v3 * m00 - v1 * m01 + v0 * m02) * invDet;
-
-    v0 = m21 * m10 - m20 * m11;
-    v1 = m22 * m10 - m20 * m12;
-    v2 = m23 * m10 - m20 * m13;
-    v3 = m22 * m11 - m21 * m12;
-    v4 = m23 * m11 - m21 * m13;
-    v5 = m23 * m12 - m22 * m13;
-
-    float d03 = -(v5 * m01 - v4 * m02 + v3 * m03) * invDet;
-    float d13 =  (v5 * m00 - v2 * m02 + v1 * m03) * invDet;
-    float d23 = -(v4 * m00 - v2 * m01 + v0 * m03) * invDet;
-    float d33 =  (v3 * m00 - v1 * m01 + v0 * m02) * invDet;
-
-    return Matrix4x4(
-        d00, d01, d02, d03,
-        d10, d11, d12, d13,
-        d20, d21, d22, d23,
-        d30, d31, d32, d33);
+void Matrix4x4::InverseTransposeBatch(const Matrix4x4* matrices, size_t count, Matrix4x4* results) {
+    if (count > 0) {
+        GetMatrixKernels().inverseTransposeBatch(&matrices[0].data_[0][0], count, &results[0].data_[0][0]);
+    }
 }
 
 void Matrix4x4::Translate(const Vector3& translation) {
@@ -247,12 +196,7 @@ Vector4 Matrix4x4::operator*(const Vector3& v) const {
 Vector4 Matrix4x4::operator*(const Vector4& v) const
 {
     Vector4 w;
-
-    w.x = v.x * data_[0][0] + v.y * data_[0][1] + v.z * data_[0][2] + v.w * data_[0][3];
-    w.y = v.x * data_[1][0] + v.y * data_[1][1] + v.z * data_[1][2] + v.w * data_[1][3];
-    w.z = v.x * data_[2][0] + v.y * data_[2][1] + v.z * data_[2][2] + v.w * data_[2][3];
-    w.w = v.x * data_[3][0] + v.y * data_[3][1] + v.z * data_[3][2] + v.w * data_[3][3];
-
+    GetMatrixKernels().transformVector(&data_[0][0], &v.x, &w.x);
     return w;
 }
 
@@ -0,0 +1,461 @@
+#include "math/MatrixKernels.h"
+
+#include <string.h>
+
+#if HAVE_SSE
+#   include <emmintrin.h>
+#endif
+
+#if HAVE_AVX
+#   include <immintrin.h>
+#endif
+
+// Let the compiler emit SSE2 and AVX instructions in the kernels that need them, whatever the target of the build
+#if COMPILER == COMPILER_GNUC
+#   define TARGET_SSE2 __attribute__((target("sse2")))
+#   define TARGET_AVX  __attribute__((target("avx")))
+#else
+#   define TARGET_SSE2
+#   define TARGET_AVX
+#endif
+
+namespace Sketch3D {
+
+///////////////////////////////////////////////////////////////////////////////
+// SCALAR KERNELS
+///////////////////////////////////////////////////////////////////////////////
+static void MultiplyScalar(const float* a, const float* b, float* result) {
+    float mat[16];
+
+    for (int i = 0; i < 4; i++) {
+        const float* row = a + i * 4;
+        for (int j = 0; j < 4; j++) {
+            mat[i * 4 + j] = row[0] * b[j] + row[1] * b[4 + j] + row[2] * b[8 + j] + row[3] * b[12 + j];
+        }
+    }
+
+    memcpy(result, mat, sizeof(mat));
+}
+
+static void TransposeScalar(const float* m, float* result) {
+    float mat[16];
+
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            mat[i * 4 + j] = m[j * 4 + i];
+        }
+    }
+
+    memcpy(result, mat, sizeof(mat));
+}
+
+static void InverseScalar(const float* m, float* result) {
+    // From OGRE source code
+    float m00 = m[0],  m01 = m[1],  m02 = m[2],  m03 = m[3];
+    float m10 = m[4],  m11 = m[5],  m12 = m[6],  m13 = m[7];
+    float m20 = m[8],  m21 = m[9],  m22 = m[10], m23 = m[11];
+    float m30 = m[12], m31 = m[13], m32 = m[14], m33 = m[15];
+
+    float v0 = m20 * m31 - m21 * m30;
+    float v1 = m20 * m32 - m22 * m30;
+    float v2 = m20 * m33 - m23 * m30;
+    float v3 = m21 * m32 - m22 * m31;
+    float v4 = m21 * m33 - m23 * m31;
+    float v5 = m22 * m33 - m23 * m32;
+
+    float t00 =  (v5 * m11 - v4 * m12 + v3 * m13);
+    float t10 = -(v5 * m10 - v2 * m12 + v1 * m13);
+    float t20 =  (v4 * m10 - v2 * m11 + v0 * m13);
+    float t30 = -(v3 * m10 - v1 * m11 + v0 * m12);
+
+    float invDet = 1.0f / (t00 * m00 + t10 * m01 + t20 * m02 + t30 * m03);
+
+    float d00 = t00 * invDet;
+    float d10 = t10 * invDet;
+    float d20 = t20 * invDet;
+    float d30 = t30 * invDet;
+
+    float d01 = -(v5 * m01 - v4 * m02 + v3 * m03) * invDet;
+    float d11 =  (v5 * m00 - v2 * m02 + v1 * m03) * invDet;
+    float d21 = -(v4 * m00 - v2 * m01 + v0 * m03) * invDet;
+    float d31 =  (v3 * m00 - v1 * m01 + v0 * m02) * invDet;
+
+    v0 = m10 * m31 - m11 * m30;
+    v1 = m10 * m32 - m12 * m30;
+    v2 = m10 * m33 - m13 * m30;
+    v3 = m11 * m32 - m12 * m31;
+    v4 = m11 * m33 - m13 * m31;
+    v5 = m12 * m33 - m13 * m32;
+
+    float d02 =  (v5 * m01 - v4 * m02 + v3 * m03) * invDet;
+    float d12 = -(v5 * m00 - v2 * m02 + v1 * m03) * invDet;
+    float d22 =  (v4 * m00 - v2 * m01 + v0 * m03) * invDet;
+    float d32 = -(v3 * m00 - v1 * m01 + v0 * m02) * invDet;
+
+    v0 = m21 * m10 - m20 * m11;
+    v1 = m22 * m10 - m20 * m12;
+    v2 = m23 * m10 - m20 * m13;
+    v3 = m22 * m11 - m21 * m12;
+    v4 = m23 * m11 - m21 * m13;
+    v5 = m23 * m12 - m22 * m13;
+
+    float d03 = -(v5 * m01 - v4 * m02 + v3 * m03) * invDet;
+    float d13 =  (v5 * m00 - v2 * m02 + v1 * m03) * invDet;
+    float d23 = -(v4 * m00 - v2 * m01 + v0 * m03) * invDet;
+    float d33 =  (v3 * m00 - v1 * m01 + v0 * m02) * invDet;
+
+    result[0]  = d00; result[1]  = d01; result[2]  = d02; result[3]  = d03;
+    result[4]  = d10; result[5]  = d11; result[6]  = d12; result[7]  = d13;
+    result[8]  = d20; result[9]  = d21; result[10] = d22; result[11] = d23;
+    result[12] = d30; result[13] = d31; result[14] = d32; result[15] = d33;
+}
+
+static void TransformVectorScalar(const float* m, const float* v, float* result) {
+    float x = v[0] * m[0]  + v[1] * m[1]  + v[2] * m[2]  + v[3] * m[3];
+    float y = v[0] * m[4]  + v[1] * m[5]  + v[2] * m[6]  + v[3] * m[7];
+    float z = v[0] * m[8]  + v[1] * m[9]  + v[2] * m[10] + v[3] * m[11];
+    float w = v[0] * m[12] + v[1] * m[13] + v[2] * m[14] + v[3] * m[15];
+
+    result[0] = x;
+    result[1] = y;
+    result[2] = z;
+    result[3] = w;
+}
+
+static void TransformRowVectorScalar(const float* v, const float* m, float* result) {
+    float x = v[0] * m[0] + v[1] * m[4] + v[2] * m[8]  + v[3] * m[12];
+    float y = v[0] * m[1] + v[1] * m[5] + v[2] * m[9]  + v[3] * m[13];
+    float z = v[0] * m[2] + v[1] * m[6] + v[2] * m[10] + v[3] * m[14];
+    float w = v[0] * m[3] + v[1] * m[7] + v[2] * m[11] + v[3] * m[15];
+
+    result[0] = x;
+    result[1] = y;
+    result[2] = z;
+    result[3] = w;
+}
+
+static void MultiplyBatchScalar(const float* a, const float* matrices, size_t count, float* results) {
+    for (size_t i = 0; i < count; i++) {
+        MultiplyScalar(a, matrices + i * 16, results + i * 16);
+    }
+}
+
+static void InverseTransposeBatchScalar(const float* matrices, size_t count, float* results) {
+    for (size_t i = 0; i < count; i++) {
+        InverseScalar(matrices + i * 16, results + i * 16);
+        TransposeScalar(results + i * 16, results + i * 16);
+    }
+}
+
+static const MatrixKernels_t scalarKernels = {
+    MATRIX_KERNELS_SCALAR,
+    MultiplyScalar,
+    TransposeScalar,
+    InverseScalar,
+    TransformVectorScalar,
+    TransformRowVectorScalar,
+    MultiplyBatchScalar,
+    InverseTransposeBatchScalar
+};
+
+#if HAVE_SSE
+///////////////////////////////////////////////////////////////////////////////
+// SSE2 KERNELS
+///////////////////////////////////////////////////////////////////////////////
+#define SHUFFLE_MASK(x, y, z, w) ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#define SWIZZLE(v, x, y, z, w) _mm_shuffle_ps(v, v, SHUFFLE_MASK(x, y, z, w))
+
+/**
+ * Linear combination of the 4 rows of a matrix: v.x * r0 + v.y * r1 + v.z * r2 + v.w * r3
+ */
+TARGET_SSE2 static inline __m128 LinearCombinationSse2(__m128 v, __m128 r0, __m128 r1, __m128 r2, __m128 r3) {
+    __m128 result = _mm_mul_ps(SWIZZLE(v, 0, 0, 0, 0), r0);
+    result = _mm_add_ps(result, _mm_mul_ps(SWIZZLE(v, 1, 1, 1, 1), r1));
+    result = _mm_add_ps(result, _mm_mul_ps(SWIZZLE(v, 2, 2, 2, 2), r2));
+    result = _mm_add_ps(result, _mm_mul_ps(SWIZZLE(v, 3, 3, 3, 3), r3));
+    return result;
+}
+
+TARGET_SSE2 static void MultiplySse2(const float* a, const float* b, float* result) {
+    __m128 b0 = _mm_loadu_ps(b);
+    __m128 b1 = _mm_loadu_ps(b + 4);
+    __m128 b2 = _mm_loadu_ps(b + 8);
+    __m128 b3 = _mm_loadu_ps(b + 12);
+
+    __m128 r0 = LinearCombinationSse2(_mm_loadu_ps(a), b0, b1, b2, b3);
+    __m128 r1 = LinearCombinationSse2(_mm_loadu_ps(a + 4), b0, b1, b2, b3);
+    __m128 r2 = LinearCombinationSse2(_mm_loadu_ps(a + 8), b0, b1, b2, b3);
+    __m128 r3 = LinearCombinationSse2(_mm_loadu_ps(a + 12), b0, b1, b2, b3);
+
+    _mm_storeu_ps(result, r0);
+    _mm_storeu_ps(result + 4, r1);
+    _mm_storeu_ps(result + 8, r2);
+    _mm_storeu_ps(result + 12, r3);
+}
+
+TARGET_SSE2 static void TransposeSse2(const float* m, float* result) {
+    __m128 r0 = _mm_loadu_ps(m);
+    __m128 r1 = _mm_loadu_ps(m + 4);
+    __m128 r2 = _mm_loadu_ps(m + 8);
+    __m128 r3 = _mm_loadu_ps(m + 12);
+
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    _mm_storeu_ps(result, r0);
+    _mm_storeu_ps(result + 4, r1);
+    _mm_storeu_ps(result + 8, r2);
+    _mm_storeu_ps(result + 12, r3);
+}
+
+/**
+ * 2x2 matrices product a * b, the matrices being packed row by row in a register
+ */
+TARGET_SSE2 static inline __m128 Mat2MultiplySse2(__m128 a, __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+/**
+ * 2x2 matrices product adj(a) * b
+ */
+TARGET_SSE2 static inline __m128 Mat2AdjointMultiplySse2(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(SWIZZLE(a, 1, 1, 2, 2), SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+/**
+ * 2x2 matrices product a * adj(b)
+ */
+TARGET_SSE2 static inline __m128 Mat2MultiplyAdjointSse2(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(a, SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+TARGET_SSE2 static void InverseSse2(const float* m, float* result) {
+    // Block-wise inversion: the matrix is split in four 2x2 matrices | A B |
+    //                                                                | C D |
+    __m128 r0 = _mm_loadu_ps(m);
+    __m128 r1 = _mm_loadu_ps(m + 4);
+    __m128 r2 = _mm_loadu_ps(m + 8);
+    __m128 r3 = _mm_loadu_ps(m + 12);
+
+    __m128 a = _mm_movelh_ps(r0, r1);
+    __m128 b = _mm_movehl_ps(r1, r0);
+    __m128 c = _mm_movelh_ps(r2, r3);
+    __m128 d = _mm_movehl_ps(r3, r2);
+
+    // Determinants of the sub matrices as (|A|, |B|, |C|, |D|)
+    __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(_mm_shuffle_ps(r0, r2, SHUFFLE_MASK(0, 2, 0, 2)), _mm_shuffle_ps(r1, r3, SHUFFLE_MASK(1, 3, 1, 3))),
+        _mm_mul_ps(_mm_shuffle_ps(r0, r2, SHUFFLE_MASK(1, 3, 1, 3)), _mm_shuffle_ps(r1, r3, SHUFFLE_MASK(0, 2, 0, 2))));
+    __m128 detA = SWIZZLE(detSub, 0, 0, 0, 0);
+    __m128 detB = SWIZZLE(detSub, 1, 1, 1, 1);
+    __m128 detC = SWIZZLE(detSub, 2, 2, 2, 2);
+    __m128 detD = SWIZZLE(detSub, 3, 3, 3, 3);
+
+    __m128 dc = Mat2AdjointMultiplySse2(d, c);
+    __m128 ab = Mat2AdjointMultiplySse2(a, b);
+
+    // Adjoints of the blocks of the inverse
+    __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Mat2MultiplySse2(b, dc));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Mat2MultiplySse2(c, ab));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), Mat2MultiplyAdjointSse2(d, ab));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), Mat2MultiplyAdjointSse2(a, dc));
+
+    // |M| = |A| * |D| + |B| * |C| - trace(adj(A) * B * adj(D) * C)
+    __m128 trace = _mm_mul_ps(ab, SWIZZLE(dc, 0, 2, 1, 3));
+    trace = _mm_add_ps(trace, SWIZZLE(trace, 2, 3, 0, 1));
+    trace = _mm_add_ps(trace, SWIZZLE(trace, 1, 0, 3, 2));
+
+    __m128 det = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+    det = _mm_sub_ps(det, trace);
+
+    __m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+    x = _mm_mul_ps(x, invDet);
+    y = _mm_mul_ps(y, invDet);
+    z = _mm_mul_ps(z, invDet);
+    w = _mm_mul_ps(w, invDet);
+
+    // Apply the adjoint of the blocks while putting the rows back together
+    _mm_storeu_ps(result,      _mm_shuffle_ps(x, y, SHUFFLE_MASK(3, 1, 3, 1)));
+    _mm_storeu_ps(result + 4,  _mm_shuffle_ps(x, y, SHUFFLE_MASK(2, 0, 2, 0)));
+    _mm_storeu_ps(result + 8,  _mm_shuffle_ps(z, w, SHUFFLE_MASK(3, 1, 3, 1)));
+    _mm_storeu_ps(result + 12, _mm_shuffle_ps(z, w, SHUFFLE_MASK(2, 0, 2, 0)));
+}
+
+TARGET_SSE2 static void TransformVectorSse2(const float* m, const float* v, float* result) {
+    // The columns of the matrix are combined, so work on the transposed matrix
+    __m128 c0 = _mm_loadu_ps(m);
+    __m128 c1 = _mm_loadu_ps(m + 4);
+    __m128 c2 = _mm_loadu_ps(m + 8);
+    __m128 c3 = _mm_loadu_ps(m + 12);
+
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+    _mm_storeu_ps(result, LinearCombinationSse2(_mm_loadu_ps(v), c0, c1, c2, c3));
+}
+
+TARGET_SSE2 static void TransformRowVectorSse2(const float* v, const float* m, float* result) {
+    __m128 r0 = _mm_loadu_ps(m);
+    __m128 r1 = _mm_loadu_ps(m + 4);
+    __m128 r2 = _mm_loadu_ps(m + 8);
+    __m128 r3 = _mm_loadu_ps(m + 12);
+
+    _mm_storeu_ps(result, LinearCombinationSse2(_mm_loadu_ps(v), r0, r1, r2, r3));
+}
+
+TARGET_SSE2 static void MultiplyBatchSse2(const float* a, const float* matrices, size_t count, float* results) {
+    // The rows of a stay in registers for the whole batch
+    __m128 a0 = _mm_loadu_ps(a);
+    __m128 a1 = _mm_loadu_ps(a + 4);
+    __m128 a2 = _mm_loadu_ps(a + 8);
+    __m128 a3 = _mm_loadu_ps(a + 12);
+
+    for (size_t i = 0; i < count; i++) {
+        const float* b = matrices + i * 16;
+        float* result = results + i * 16;
+
+        __m128 b0 = _mm_loadu_ps(b);
+        __m128 b1 = _mm_loadu_ps(b + 4);
+        __m128 b2 = _mm_loadu_ps(b + 8);
+        __m128 b3 = _mm_loadu_ps(b + 12);
+
+        _mm_storeu_ps(result, LinearCombinationSse2(a0, b0, b1, b2, b3));
+        _mm_storeu_ps(result + 4, LinearCombinationSse2(a1, b0, b1, b2, b3));
+        _mm_storeu_ps(result + 8, LinearCombinationSse2(a2, b0, b1, b2, b3));
+        _mm_storeu_ps(result + 12, LinearCombinationSse2(a3, b0, b1, b2, b3));
+    }
+}
+
+TARGET_SSE2 static void InverseTransposeBatchSse2(const float* matrices, size_t count, float* results) {
+    for (size_t i = 0; i < count; i++) {
+        InverseSse2(matrices + i * 16, results + i * 16);
+        TransposeSse2(results + i * 16, results + i * 16);
+    }
+}
+
+static const MatrixKernels_t sse2Kernels = {
+    MATRIX_KERNELS_SSE2,
+    MultiplySse2,
+    TransposeSse2,
+    InverseSse2,
+    TransformVectorSse2,
+    TransformRowVectorSse2,
+    MultiplyBatchSse2,
+    InverseTransposeBatchSse2
+};
+#endif
+
+#if HAVE_AVX
+///////////////////////////////////////////////////////////////////////////////
+// AVX KERNELS
+///////////////////////////////////////////////////////////////////////////////
+#define AVX_BROADCAST(v, i) _mm256_shuffle_ps(v, v, SHUFFLE_MASK(i, i, i, i))
+
+TARGET_AVX static inline void MultiplyRowsAvx(__m256 a01, __m256 a23, const float* b, float* result) {
+    // Each row of b is duplicated in both lanes so that two rows of the result are computed at once
+    __m128 b0 = _mm_loadu_ps(b);
+    __m128 b1 = _mm_loadu_ps(b + 4);
+    __m128 b2 = _mm_loadu_ps(b + 8);
+    __m128 b3 = _mm_loadu_ps(b + 12);
+
+    __m256 bb0 = _mm256_insertf128_ps(_mm256_castps128_ps256(b0), b0, 1);
+    __m256 bb1 = _mm256_insertf128_ps(_mm256_castps128_ps256(b1), b1, 1);
+    __m256 bb2 = _mm256_insertf128_ps(_mm256_castps128_ps256(b2), b2, 1);
+    __m256 bb3 = _mm256_insertf128_ps(_mm256_castps128_ps256(b3), b3, 1);
+
+    __m256 r01 = _mm256_mul_ps(AVX_BROADCAST(a01, 0), bb0);
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(AVX_BROADCAST(a01, 1), bb1));
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(AVX_BROADCAST(a01, 2), bb2));
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(AVX_BROADCAST(a01, 3), bb3));
+
+    __m256 r23 = _mm256_mul_ps(AVX_BROADCAST(a23, 0), bb0);
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(AVX_BROADCAST(a23, 1), bb1));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(AVX_BROADCAST(a23, 2), bb2));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(AVX_BROADCAST(a23, 3), bb3));
+
+    _mm256_storeu_ps(result, r01);
+    _mm256_storeu_ps(result + 8, r23);
+}
+
+TARGET_AVX static void MultiplyAvx(const float* a, const float* b, float* result) {
+    MultiplyRowsAvx(_mm256_loadu_ps(a), _mm256_loadu_ps(a + 8), b, result);
+
+    // Avoid the penalty of mixing AVX and legacy SSE code in the caller
+    _mm256_zeroupper();
+}
+
+TARGET_AVX static void MultiplyBatchAvx(const float* a, const float* matrices, size_t count, float* results) {
+    __m256 a01 = _mm256_loadu_ps(a);
+    __m256 a23 = _mm256_loadu_ps(a + 8);
+
+    for (size_t i = 0; i < count; i++) {
+        MultiplyRowsAvx(a01, a23, matrices + i * 16, results + i * 16);
+    }
+
+    _mm256_zeroupper();
+}
+
+// Only the multiplication benefits from the wider registers, the other kernels work on a single row at a time
+static const MatrixKernels_t avxKernels = {
+    MATRIX_KERNELS_AVX,
+    MultiplyAvx,
+    TransposeSse2,
+    InverseSse2,
+    TransformVectorSse2,
+    TransformRowVectorSse2,
+    MultiplyBatchAvx,
+    InverseTransposeBatchSse2
+};
+#endif
+
+static const MatrixKernels_t& SelectMatrixKernels() {
+#if HAVE_AVX
+    if (PlatformInformation::HasCpuFeature(PlatformInformation::AVX)) {
+        return avxKernels;
+    }
+#endif
+
+#if HAVE_SSE
+    if (PlatformInformation::HasCpuFeature(PlatformInformation::SSE2)) {
+        return sse2Kernels;
+    }
+#endif
+
+    return scalarKernels;
+}
+
+const MatrixKernels_t& GetMatrixKernels() {
+    static const MatrixKernels_t& kernels = SelectMatrixKernels();
+    return kernels;
+}
+
+const MatrixKernels_t* GetMatrixKernels(MatrixKernelsType_t type) {
+    switch (type) {
+        case MATRIX_KERNELS_SCALAR:
+            return &scalarKernels;
+
+#if HAVE_SSE
+        case MATRIX_KERNELS_SSE2:
+            if (PlatformInformation::HasCpuFeature(PlatformInformation::SSE2)) {
+                return &sse2Kernels;
+            }
+            break;
+#endif
+
+#if HAVE_AVX
+        case MATRIX_KERNELS_AVX:
+            if (PlatformInformation::HasCpuFeature(PlatformInformation::AVX)) {
+                return &avxKernels;
+            }
+            break;
+#endif
+
+        default:
+            break;
+    }
+
+    return nullptr;
+}
+
+}
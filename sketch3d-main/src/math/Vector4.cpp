@@ -2,6 +2,7 @@
 
 #include "math/Constants.h"
 #include "math/Matrix4x4.h"
+#include "math/MatrixKernels.h"
 #include "system/Platform.h"
 
 #include <iostream>
@@ -197,28 +198,13 @@ Vector4 Vector4::Cross(const Vector4& v) const
 Vector4 Vector4::operator*(const Matrix4x4& m) const
 {
     Vector4 v;
-
-    v.x = x * m[0][0] + y * m[1][0] + z * m[2][0] + w * m[3][0];
-    v.y = x * m[0][1] + y * m[1][1] + z * m[2][1] + w * m[3][1];
-    v.z = x * m[0][2] + y * m[1][2] + z * m[2][2] + w * m[3][2];
-    v.w = x * m[0][3] + y * m[1][3] + z * m[2][3] + w * m[3][3];
-
+    GetMatrixKernels().transformRowVector(&x, m[0], &v.x);
     return v;
 }
 
 void Vector4::operator*=(const Matrix4x4& m)
 {
-    float nx, ny, nz, nw;
-
-    nx = x * m[0][0] + y * m[1][0] + z * m[2][0] + w * m[3][0];
-    ny = x * m[0][1] + y * m[1][1] + z * m[2][1] + w * m[3][1];
-    nz = x * m[0][2] + y * m[1][2] + z * m[2][2] + w * m[3][2];
-    nw = x * m[0][3] + y * m[1][3] + z * m[2][3] + w * m[3][3];
-
-    x = nx;
-    y = ny;
-    z = nz;
-    w = nw;
+    GetMatrixKernels().transformRowVector(&x, m[0], &x);
 }
 
 }
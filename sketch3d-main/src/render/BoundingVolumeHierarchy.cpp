@@ -0,0 +1,456 @@
+#include "render/BoundingVolumeHierarchy.h"
+
+#include "math/CullingKernels.h"
+
+#include "render/Renderer_Common.h"
+
+#include "system/JobSystem.h"
+
+#include <algorithm>
+using namespace std;
+
+namespace Sketch3D {
+
+// Fraction of the radius of a node by which its box is enlarged, so that it can move a bit without being reinserted
+const float BVH_MARGIN_RATIO = 0.1f;
+
+const int ALL_FRUSTUM_PLANES = (1 << 6) - 1;
+
+// Number of leaves tested by each job when the leaves are culled in parallel. It is a multiple of 32 so that the jobs
+// don't share the words of the visibility mask
+const size_t BVH_PARALLEL_CULLING_GRAIN_SIZE = 32 * 256;
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy() : root_(-1), freeList_(-1), numProxies_(0) {
+}
+
+BvhProxy_t BoundingVolumeHierarchy::CreateProxy(const Sphere& boundingSphere, Node* node) {
+    int32_t leaf = AllocateNode();
+    TreeNode_t& treeNode = nodes_[leaf];
+    treeNode.box = BoundingBox(Sphere(boundingSphere.GetCenter(), boundingSphere.GetRadius() * (1.0f + BVH_MARGIN_RATIO)));
+    treeNode.sphere = boundingSphere;
+    treeNode.node = node;
+    treeNode.height = 0;
+    treeNode.planeHint = 0;
+
+    InsertLeaf(leaf);
+    numProxies_ += 1;
+
+    return leaf;
+}
+
+void BoundingVolumeHierarchy::DestroyProxy(BvhProxy_t proxy) {
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    numProxies_ -= 1;
+}
+
+bool BoundingVolumeHierarchy::MoveProxy(BvhProxy_t proxy, const Sphere& boundingSphere) {
+    nodes_[proxy].sphere = boundingSphere;
+    if (nodes_[proxy].box.Contains(BoundingBox(boundingSphere))) {
+        return false;
+    }
+
+    RemoveLeaf(proxy);
+    nodes_[proxy].box = BoundingBox(Sphere(boundingSphere.GetCenter(), boundingSphere.GetRadius() * (1.0f + BVH_MARGIN_RATIO)));
+    InsertLeaf(proxy);
+
+    return true;
+}
+
+void BoundingVolumeHierarchy::Query(const FrustumPlanes_t& frustumPlanes, vector<Node*>& visibleNodes) {
+    if (root_ == -1) {
+        return;
+    }
+
+    const Plane* planes[6] = {
+        &frustumPlanes.nearPlane, &frustumPlanes.farPlane, &frustumPlanes.leftPlane,
+        &frustumPlanes.rightPlane, &frustumPlanes.bottomPlane, &frustumPlanes.topPlane
+    };
+
+    LeafBatch_t& batch = leafBatch_;
+    batch.leaves.clear();
+    batch.centersX.clear();
+    batch.centersY.clear();
+    batch.centersZ.clear();
+    batch.radii.clear();
+    batch.planeHints.clear();
+
+    // Each entry of the stack holds the planes that still have to be tested. A box that is completely inside a plane
+    // can't have children outside of it, so the children don't test that plane again
+    stack_.clear();
+    stack_.push_back(pair<int32_t, int>(root_, ALL_FRUSTUM_PLANES));
+
+    while (!stack_.empty()) {
+        int32_t index = stack_.back().first;
+        int planeMask = stack_.back().second;
+        stack_.pop_back();
+
+        const TreeNode_t& treeNode = nodes_[index];
+
+        // The leaves are tested later, all at once, with their exact sphere rather than with their enlarged box
+        if (treeNode.IsLeaf()) {
+            if (planeMask == 0) {
+                visibleNodes.push_back(treeNode.node);
+            } else {
+                const Vector3& center = treeNode.sphere.GetCenter();
+                batch.leaves.push_back(index);
+                batch.centersX.push_back(center.x);
+                batch.centersY.push_back(center.y);
+                batch.centersZ.push_back(center.z);
+                batch.radii.push_back(treeNode.sphere.GetRadius());
+                batch.planeHints.push_back(treeNode.planeHint);
+            }
+
+            continue;
+        }
+
+        bool isOutside = false;
+        for (int i = 0; i < 6 && !isOutside; i++) {
+            if ((planeMask & (1 << i)) == 0) {
+                continue;
+            }
+
+            RelativePlanePosition_t position = treeNode.box.IntersectsPlane(*planes[i]);
+            if (position == RELATIVE_PLANE_POSITION_OUTSIDE) {
+                isOutside = true;
+            } else if (position == RELATIVE_PLANE_POSITION_INSIDE) {
+                planeMask &= ~(1 << i);
+            }
+        }
+
+        if (isOutside) {
+            continue;
+        }
+
+        if (planeMask == 0) {
+            CollectNodes(index, visibleNodes);
+        } else {
+            stack_.push_back(pair<int32_t, int>(treeNode.child1, planeMask));
+            stack_.push_back(pair<int32_t, int>(treeNode.child2, planeMask));
+        }
+    }
+
+    size_t numLeaves = batch.leaves.size();
+    if (numLeaves == 0) {
+        return;
+    }
+
+    // The leaves are tested against all the planes. The planes that their ancestors were completely inside of can't
+    // reject them since their sphere is inside those boxes
+    float planeData[6 * 4];
+    for (size_t i = 0; i < 6; i++) {
+        const Vector3& normal = planes[i]->GetNormal();
+        planeData[i * 4] = normal.x;
+        planeData[i * 4 + 1] = normal.y;
+        planeData[i * 4 + 2] = normal.z;
+        planeData[i * 4 + 3] = planes[i]->GetDistance();
+    }
+
+    SphereBatch_t spheres;
+    spheres.centersX = &batch.centersX[0];
+    spheres.centersY = &batch.centersY[0];
+    spheres.centersZ = &batch.centersZ[0];
+    spheres.radii = &batch.radii[0];
+    spheres.planeHints = &batch.planeHints[0];
+    spheres.numSpheres = numLeaves;
+
+    batch.visibility.resize(GetNumVisibilityWords(numLeaves));
+    const CullingKernels_t& cullingKernels = GetCullingKernels();
+
+    if (numLeaves <= BVH_PARALLEL_CULLING_GRAIN_SIZE) {
+        cullingKernels.cullSpheres(planeData, 6, spheres, &batch.visibility[0]);
+    } else {
+        uint32_t* visibility = &batch.visibility[0];
+        JobSystem::GetInstance()->ParallelFor(0, numLeaves, BVH_PARALLEL_CULLING_GRAIN_SIZE,
+            [&cullingKernels, &planeData, &spheres, visibility] (size_t begin, size_t end) {
+                SphereBatch_t range;
+                range.centersX = spheres.centersX + begin;
+                range.centersY = spheres.centersY + begin;
+                range.centersZ = spheres.centersZ + begin;
+                range.radii = spheres.radii + begin;
+                range.planeHints = spheres.planeHints + begin;
+                range.numSpheres = end - begin;
+                cullingKernels.cullSpheres(planeData, 6, range, visibility + begin / 32);
+            });
+    }
+
+    for (size_t i = 0; i < numLeaves; i++) {
+        TreeNode_t& leaf = nodes_[batch.leaves[i]];
+        leaf.planeHint = batch.planeHints[i];
+
+        if (batch.visibility[i / 32] & (1u << (i % 32))) {
+            visibleNodes.push_back(leaf.node);
+        }
+    }
+}
+
+void BoundingVolumeHierarchy::GetAllNodes(vector<Node*>& nodes) const {
+    for (size_t i = 0; i < nodes_.size(); i++) {
+        if (nodes_[i].height == 0) {
+            nodes.push_back(nodes_[i].node);
+        }
+    }
+}
+
+int32_t BoundingVolumeHierarchy::GetHeight() const {
+    if (root_ == -1) {
+        return 0;
+    }
+
+    return nodes_[root_].height;
+}
+
+int32_t BoundingVolumeHierarchy::AllocateNode() {
+    int32_t index;
+    if (freeList_ != -1) {
+        index = freeList_;
+        freeList_ = nodes_[index].parent;
+    } else {
+        index = (int32_t)nodes_.size();
+        nodes_.push_back(TreeNode_t());
+    }
+
+    TreeNode_t& treeNode = nodes_[index];
+    treeNode.node = nullptr;
+    treeNode.parent = -1;
+    treeNode.child1 = -1;
+    treeNode.child2 = -1;
+    treeNode.height = 0;
+
+    return index;
+}
+
+void BoundingVolumeHierarchy::FreeNode(int32_t index) {
+    nodes_[index].parent = freeList_;
+    nodes_[index].height = -1;
+    freeList_ = index;
+}
+
+void BoundingVolumeHierarchy::InsertLeaf(int32_t leaf) {
+    if (root_ == -1) {
+        root_ = leaf;
+        nodes_[root_].parent = -1;
+        return;
+    }
+
+    // Walk down the tree to find the sibling that increases the total surface area the least
+    BoundingBox leafBox = nodes_[leaf].box;
+    int32_t index = root_;
+
+    while (!nodes_[index].IsLeaf()) {
+        const TreeNode_t& treeNode = nodes_[index];
+        float area = treeNode.box.GetSurfaceArea();
+        float combinedArea = treeNode.box.Merged(leafBox).GetSurfaceArea();
+
+        // Cost of creating a new parent for this node and the new leaf
+        float cost = 2.0f * combinedArea;
+
+        // Minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        const TreeNode_t& child1 = nodes_[treeNode.child1];
+        float cost1 = child1.box.Merged(leafBox).GetSurfaceArea() + inheritanceCost;
+        if (!child1.IsLeaf()) {
+            cost1 -= child1.box.GetSurfaceArea();
+        }
+
+        const TreeNode_t& child2 = nodes_[treeNode.child2];
+        float cost2 = child2.box.Merged(leafBox).GetSurfaceArea() + inheritanceCost;
+        if (!child2.IsLeaf()) {
+            cost2 -= child2.box.GetSurfaceArea();
+        }
+
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+
+        index = (cost1 < cost2) ? treeNode.child1 : treeNode.child2;
+    }
+
+    // Create a new parent for the sibling and the leaf
+    int32_t sibling = index;
+    int32_t oldParent = nodes_[sibling].parent;
+    int32_t newParent = AllocateNode();
+
+    nodes_[newParent].parent = oldParent;
+    nodes_[newParent].box = leafBox.Merged(nodes_[sibling].box);
+    nodes_[newParent].height = nodes_[sibling].height + 1;
+    nodes_[newParent].child1 = sibling;
+    nodes_[newParent].child2 = leaf;
+    nodes_[sibling].parent = newParent;
+    nodes_[leaf].parent = newParent;
+
+    if (oldParent != -1) {
+        if (nodes_[oldParent].child1 == sibling) {
+            nodes_[oldParent].child1 = newParent;
+        } else {
+            nodes_[oldParent].child2 = newParent;
+        }
+    } else {
+        root_ = newParent;
+    }
+
+    Refit(newParent);
+}
+
+void BoundingVolumeHierarchy::RemoveLeaf(int32_t leaf) {
+    if (leaf == root_) {
+        root_ = -1;
+        return;
+    }
+
+    int32_t parent = nodes_[leaf].parent;
+    int32_t grandParent = nodes_[parent].parent;
+    int32_t sibling = (nodes_[parent].child1 == leaf) ? nodes_[parent].child2 : nodes_[parent].child1;
+
+    // The sibling takes the place of the parent
+    FreeNode(parent);
+    nodes_[sibling].parent = grandParent;
+
+    if (grandParent != -1) {
+        if (nodes_[grandParent].child1 == parent) {
+            nodes_[grandParent].child1 = sibling;
+        } else {
+            nodes_[grandParent].child2 = sibling;
+        }
+
+        Refit(grandParent);
+    } else {
+        root_ = sibling;
+    }
+}
+
+void BoundingVolumeHierarchy::Refit(int32_t index) {
+    while (index != -1) {
+        index = Balance(index);
+
+        TreeNode_t& treeNode = nodes_[index];
+        const TreeNode_t& child1 = nodes_[treeNode.child1];
+        const TreeNode_t& child2 = nodes_[treeNode.child2];
+
+        treeNode.height = 1 + max(child1.height, child2.height);
+        treeNode.box = child1.box.Merged(child2.box);
+
+        index = treeNode.parent;
+    }
+}
+
+int32_t BoundingVolumeHierarchy::Balance(int32_t indexA) {
+    TreeNode_t& a = nodes_[indexA];
+    if (a.IsLeaf() || a.height < 2) {
+        return indexA;
+    }
+
+    int32_t indexB = a.child1;
+    int32_t indexC = a.child2;
+    TreeNode_t& b = nodes_[indexB];
+    TreeNode_t& c = nodes_[indexC];
+
+    int32_t balance = c.height - b.height;
+
+    // Rotate C up
+    if (balance > 1) {
+        int32_t indexF = c.child1;
+        int32_t indexG = c.child2;
+        TreeNode_t& f = nodes_[indexF];
+        TreeNode_t& g = nodes_[indexG];
+
+        // Swap A and C
+        c.child1 = indexA;
+        c.parent = a.parent;
+        a.parent = indexC;
+
+        if (c.parent != -1) {
+            if (nodes_[c.parent].child1 == indexA) {
+                nodes_[c.parent].child1 = indexC;
+            } else {
+                nodes_[c.parent].child2 = indexC;
+            }
+        } else {
+            root_ = indexC;
+        }
+
+        // The highest child of C stays under it, the other one goes under A
+        if (f.height > g.height) {
+            c.child2 = indexF;
+            a.child2 = indexG;
+            g.parent = indexA;
+            a.box = b.box.Merged(g.box);
+            c.box = a.box.Merged(f.box);
+
+            a.height = 1 + max(b.height, g.height);
+            c.height = 1 + max(a.height, f.height);
+        } else {
+            c.child2 = indexG;
+            a.child2 = indexF;
+            f.parent = indexA;
+            a.box = b.box.Merged(f.box);
+            c.box = a.box.Merged(g.box);
+
+            a.height = 1 + max(b.height, f.height);
+            c.height = 1 + max(a.height, g.height);
+        }
+
+        return indexC;
+    }
+
+    // Rotate B up
+    if (balance < -1) {
+        int32_t indexD = b.child1;
+        int32_t indexE = b.child2;
+        TreeNode_t& d = nodes_[indexD];
+        TreeNode_t& e = nodes_[indexE];
+
+        // Swap A and B
+        b.child1 = indexA;
+        b.parent = a.parent;
+        a.parent = indexB;
+
+        if (b.parent != -1) {
+            if (nodes_[b.parent].child1 == indexA) {
+                nodes_[b.parent].child1 = indexB;
+            } else {
+                nodes_[b.parent].child2 = indexB;
+            }
+        } else {
+            root_ = indexB;
+        }
+
+        // The highest child of B stays under it, the other one goes under A
+        if (d.height > e.height) {
+            b.child2 = indexD;
+            a.child1 = indexE;
+            e.parent = indexA;
+            a.box = c.box.Merged(e.box);
+            b.box = a.box.Merged(d.box);
+
+            a.height = 1 + max(c.height, e.height);
+            b.height = 1 + max(a.height, d.height);
+        } else {
+            b.child2 = indexE;
+            a.child1 = indexD;
+            d.parent = indexA;
+            a.box = c.box.Merged(d.box);
+            b.box = a.box.Merged(e.box);
+
+            a.height = 1 + max(c.height, d.height);
+            b.height = 1 + max(a.height, e.height);
+        }
+
+        return indexB;
+    }
+
+    return indexA;
+}
+
+void BoundingVolumeHierarchy::CollectNodes(int32_t index, vector<Node*>& nodes) const {
+    const TreeNode_t& treeNode = nodes_[index];
+    if (treeNode.IsLeaf()) {
+        nodes.push_back(treeNode.node);
+    } else {
+        CollectNodes(treeNode.child1, nodes);
+        CollectNodes(treeNode.child2, nodes);
+    }
+}
+
+}
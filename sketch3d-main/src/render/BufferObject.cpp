@@ -29,6 +29,10 @@ size_t BufferObject::GetId() const {
     return id_;
 }
 
+size_t BufferObject::GetIndexCount() const {
+    return indexCount_;
+}
+
 bool BufferObject::AreVertexAttributesValid(int presentVertexAttributes) const {
     // We implicitely count position
     size_t count = 1;
@@ -18,4 +18,12 @@ void BufferObjectManager::DeleteBufferObject(BufferObject* bufferObject) {
     }
 }
 
-}
\ No newline at end of file
+void BufferObjectManager::RenderMultiDraw(const MultiDrawCommand_t* commands, size_t numCommands, const vector<Matrix4x4>& modelMatrices) {
+    for (size_t i = 0; i < numCommands; i++) {
+        const Matrix4x4* firstMatrix = &modelMatrices[commands[i].firstInstance];
+        drawModelMatrices_.assign(firstMatrix, firstMatrix + commands[i].numInstances);
+        commands[i].bufferObject->RenderInstances(drawModelMatrices_);
+    }
+}
+
+}
@@ -1,5 +1,7 @@
 #include "render/Direct3D9/BufferObjectDirect3D9.h"
 
+#include "render/FrameStatistics.h"
+
 #include "math/Matrix4x4.h"
 #include "math/Vector2.h"
 #include "math/Vector3.h"
@@ -60,6 +62,7 @@ void BufferObjectDirect3D9::RenderInstances(const vector<Matrix4x4>& modelMatric
     instanceBuffer_->Lock(0, 0, (void**)&data, 0);
 
     memcpy((void*)data, &tranposedModelMatrices[0], modelMatrices.size() * sizeof(Matrix4x4));
+    BufferUploadCounter::Add(modelMatrices.size() * sizeof(Matrix4x4));
 
     instanceBuffer_->Unlock();
 
@@ -116,6 +119,7 @@ BufferObjectError_t BufferObjectDirect3D9::SetVertexData(const vector<float>& ve
     vertexBuffer_->Lock(0, bufferSize, &data, lockFlags);
 
     memcpy(data, (void*)&vertexData[0], bufferSize);
+    BufferUploadCounter::Add(bufferSize);
 
     vertexBuffer_->Unlock();
 
@@ -162,6 +166,7 @@ BufferObjectError_t BufferObjectDirect3D9::AppendVertexData(const vector<float>&
     vertexBuffer_->Lock(0, 0, &data, lockFlags);
 
     memcpy(data, &newVertexData[0], newSize * sizeof(float));
+    BufferUploadCounter::Add(newSize * sizeof(float));
 
     vertexBuffer_->Unlock();
 
@@ -182,6 +187,7 @@ BufferObjectError_t BufferObjectDirect3D9::SetIndexData(unsigned short* indexDat
     indexBuffer_->Lock(0, indexCount_ * sizeof(unsigned short), &data, lockFlags);
 
     memcpy(data, (void*)indexData, indexCount_ * sizeof(unsigned short));
+    BufferUploadCounter::Add(indexCount_ * sizeof(unsigned short));
 
     indexBuffer_->Unlock();
 
@@ -224,6 +230,7 @@ BufferObjectError_t BufferObjectDirect3D9::AppendIndexData(unsigned short* index
     indexBuffer_->Lock(0, indexCount_ * sizeof(unsigned short), &data, lockFlags);
 
     memcpy(data, (void*)&newIndexData[0], indexCount_ * sizeof(unsigned short));
+    BufferUploadCounter::Add(indexCount_ * sizeof(unsigned short));
 
     indexBuffer_->Unlock();
 
@@ -31,7 +31,7 @@ bool RenderSystemDirect3D9::Initialize(const RenderParameters_t& renderParameter
     Logger::GetInstance()->Info("Initializing Direct3D9");
 
     renderContext_ = new RenderContextDirect3D9;
-    if (!renderContext_->Initialize(window_, renderParameters)) {
+    if (!renderContext_->Initialize(*window_, renderParameters)) {
         Logger::GetInstance()->Error("Couldn't create Direct3D9 context");
         return false;
     }
@@ -16,6 +16,9 @@ namespace Sketch3D {
 
 ShaderDirect3D9::ShaderDirect3D9(IDirect3DDevice9* device) : device_(device) {
     Logger::GetInstance()->Debug("Direct3D9 shader creation");
+
+    // The constants are registers of the device shared by all the shaders
+    useUniformShadows_ = false;
 }
 
 ShaderDirect3D9::~ShaderDirect3D9() {
@@ -110,6 +113,12 @@ bool ShaderDirect3D9::SetSourceFile(const string& vertexFilename, const string&
     shader->Release();
     shader = nullptr;
 
+    nameToConstants_.clear();
+    constants_.clear();
+    ReflectConstants(vertexConstants_);
+    ReflectConstants(fragmentConstants_);
+    ResolveBuiltinUniforms();
+
     return true;
 }
 
@@ -195,101 +204,48 @@ bool ShaderDirect3D9::SetSource(const string& vertexSource, const string& fragme
     shader->Release();
     shader = nullptr;
 
-    return true;
-}
-
-bool ShaderDirect3D9::SetUniformInt(const string& uniformName, int value) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        fragmentConstants_->SetInt(device_, uniformHandle, value);
-    } else {
-        vertexConstants_->SetInt(device_, uniformHandle, value);
-    }
+    nameToConstants_.clear();
+    constants_.clear();
+    ReflectConstants(vertexConstants_);
+    ReflectConstants(fragmentConstants_);
+    ResolveBuiltinUniforms();
 
     return true;
 }
 
-bool ShaderDirect3D9::SetUniformFloat(const string& uniformName, float value) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        fragmentConstants_->SetFloat(device_, uniformHandle, value);
-    } else {
-        vertexConstants_->SetFloat(device_, uniformHandle, value);
+UniformHandle_t ShaderDirect3D9::GetUniformHandle(const string& uniform) const {
+    unordered_map<string, UniformHandle_t>::const_iterator it = nameToConstants_.find(uniform);
+    if (it == nameToConstants_.end()) {
+        return INVALID_UNIFORM_HANDLE;
     }
 
-    return true;
+    return it->second;
 }
 
-bool ShaderDirect3D9::SetUniformVector2(const string& uniformName, float value1, float value2) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        float values[] = { value1, value2 };
-        fragmentConstants_->SetFloatArray(device_, uniformHandle, values, 2);
-    } else {
-        float values[] = { value1, value2 };
-        vertexConstants_->SetFloatArray(device_, uniformHandle, values, 2);
-    }
-
-    return true;
+void ShaderDirect3D9::SetUniformIntImpl(UniformHandle_t uniform, int value) {
+    const Constant_t& constant = constants_[uniform];
+    constant.constantTable->SetInt(device_, constant.handle, value);
 }
 
-bool ShaderDirect3D9::SetUniformVector3(const string& uniformName, const Vector3& value) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        float values[] = { value.x, value.y, value.z };
-        fragmentConstants_->SetFloatArray(device_, uniformHandle, values, 3);
-    } else {
-        float values[] = { value.x, value.y, value.z };
-        vertexConstants_->SetFloatArray(device_, uniformHandle, values, 3);
-    }
-
-    return true;
+void ShaderDirect3D9::SetUniformFloatImpl(UniformHandle_t uniform, float value) {
+    const Constant_t& constant = constants_[uniform];
+    constant.constantTable->SetFloat(device_, constant.handle, value);
 }
 
-bool ShaderDirect3D9::SetUniformVector3Array(const string& uniformName, const Vector3* values, int arraySize) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    ID3DXConstantTable* constantTable = nullptr;
-
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
+void ShaderDirect3D9::SetUniformVector2Impl(UniformHandle_t uniform, float value1, float value2) {
+    const Constant_t& constant = constants_[uniform];
+    float values[] = { value1, value2 };
+    constant.constantTable->SetFloatArray(device_, constant.handle, values, 2);
+}
 
-        if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-        }
+void ShaderDirect3D9::SetUniformVector3Impl(UniformHandle_t uniform, const Vector3& value) {
+    const Constant_t& constant = constants_[uniform];
+    float values[] = { value.x, value.y, value.z };
+    constant.constantTable->SetFloatArray(device_, constant.handle, values, 3);
+}
 
-        constantTable = fragmentConstants_;
-    } else {
-        constantTable = vertexConstants_;
-    }
+void ShaderDirect3D9::SetUniformVector3ArrayImpl(UniformHandle_t uniform, const Vector3* values, int arraySize) {
+    const Constant_t& constant = constants_[uniform];
 
     vector<float> floatValues;
     floatValues.reserve(3 * arraySize);
@@ -299,95 +255,33 @@ bool ShaderDirect3D9::SetUniformVector3Array(const string& uniformName, const Ve
         floatValues.push_back(values[i].z);
     }
 
-    constantTable->SetFloatArray(device_, uniformHandle, &floatValues[0], floatValues.size());
-
-    return true;
+    constant.constantTable->SetFloatArray(device_, constant.handle, &floatValues[0], floatValues.size());
 }
 
-bool ShaderDirect3D9::SetUniformVector4(const string& uniformName, const Vector4& value) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        float values[] = { value.x, value.y, value.z, value.w };
-        fragmentConstants_->SetFloatArray(device_, uniformHandle, values, 4);
-    } else {
-        float values[] = { value.x, value.y, value.z, value.w };
-        vertexConstants_->SetFloatArray(device_, uniformHandle, values, 4);
-    }
-
-    return true;
+void ShaderDirect3D9::SetUniformVector4Impl(UniformHandle_t uniform, const Vector4& value) {
+    const Constant_t& constant = constants_[uniform];
+    float values[] = { value.x, value.y, value.z, value.w };
+    constant.constantTable->SetFloatArray(device_, constant.handle, values, 4);
 }
 
-bool ShaderDirect3D9::SetUniformMatrix3x3(const string& uniformName, const Matrix3x3& value) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    ID3DXConstantTable* constantTable = nullptr;
-
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        constantTable = fragmentConstants_;
-    } else {
-        constantTable = vertexConstants_;
-    }
+void ShaderDirect3D9::SetUniformMatrix3x3Impl(UniformHandle_t uniform, const Matrix3x3& value) {
+    const Constant_t& constant = constants_[uniform];
 
     float mat[9];
     value.Transpose().GetData(mat);
-    constantTable->SetFloatArray(device_, uniformHandle, mat, 9);
-
-    return true;
+    constant.constantTable->SetFloatArray(device_, constant.handle, mat, 9);
 }
 
-bool ShaderDirect3D9::SetUniformMatrix4x4(const string& uniformName, const Matrix4x4& value) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    ID3DXConstantTable* constantTable = nullptr;
-
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        constantTable = fragmentConstants_;
-    } else {
-        constantTable = vertexConstants_;
-    }
+void ShaderDirect3D9::SetUniformMatrix4x4Impl(UniformHandle_t uniform, const Matrix4x4& value) {
+    const Constant_t& constant = constants_[uniform];
 
     float mat[16];
     value.Transpose().GetData(mat);
-    constantTable->SetFloatArray(device_, uniformHandle, mat, 16);
-
-    return true;
+    constant.constantTable->SetFloatArray(device_, constant.handle, mat, 16);
 }
 
-bool ShaderDirect3D9::SetUniformMatrix4x4Array(const string& uniformName, const Matrix4x4* values, int arraySize) {
-    D3DXHANDLE uniformHandle = vertexConstants_->GetConstantByName(0, uniformName.c_str());
-    ID3DXConstantTable* constantTable = nullptr;
-
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniformName.c_str());
-
-        if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-            return false;
-        }
-
-        constantTable = fragmentConstants_;
-    } else {
-        constantTable = vertexConstants_;
-    }
+void ShaderDirect3D9::SetUniformMatrix4x4ArrayImpl(UniformHandle_t uniform, const Matrix4x4* values, int arraySize) {
+    const Constant_t& constant = constants_[uniform];
 
     vector<float> floatValues;
     floatValues.reserve(16 * arraySize);
@@ -401,34 +295,12 @@ bool ShaderDirect3D9::SetUniformMatrix4x4Array(const string& uniformName, const
         }
     }
 
-    constantTable->SetFloatArray(device_, uniformHandle, &floatValues[0], floatValues.size());
-
-    return true;
+    constant.constantTable->SetFloatArray(device_, constant.handle, &floatValues[0], floatValues.size());
 }
 
-bool ShaderDirect3D9::SetUniformTexture(const string& uniform, const Texture* texture) {
-    bool fromVertexShader = true;
-    D3DXHANDLE uniformHandle = 0;
-
-    uniformHandle = vertexConstants_->GetConstantByName(0, uniform.c_str());
-    if (uniformHandle == 0) {
-        uniformHandle = fragmentConstants_->GetConstantByName(0, uniform.c_str());
-
-	    if (uniformHandle == 0) {
-            Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniform + " in shader #" + to_string(id_));
-            return false;
-	    }
-
-        fromVertexShader = false;
-    }
-
-    UINT samplerIndex = 10000;
-
-    if (fromVertexShader) {
-        samplerIndex = vertexConstants_->GetSamplerIndex(uniformHandle);
-    } else {
-        samplerIndex = fragmentConstants_->GetSamplerIndex(uniformHandle);
-    }
+void ShaderDirect3D9::SetUniformTextureImpl(UniformHandle_t uniform, const Texture* texture) {
+    const Constant_t& constant = constants_[uniform];
+    UINT samplerIndex = constant.constantTable->GetSamplerIndex(constant.handle);
 
     if (samplerIndex != 10000) {
         const Texture2DDirect3D9* textureDirect3D9 = static_cast<const Texture2DDirect3D9*>(texture);
@@ -436,8 +308,41 @@ bool ShaderDirect3D9::SetUniformTexture(const string& uniform, const Texture* te
         device_->SetSamplerState( samplerIndex, D3DSAMP_MINFILTER, GetFilter(texture->GetFilterMode()) );
         device_->SetSamplerState( samplerIndex, D3DSAMP_MAGFILTER, GetFilter(texture->GetFilterMode()) );
     }
+}
 
-    return true;
+size_t ShaderDirect3D9::GetUniformArrayLength(UniformHandle_t uniform) const {
+    return constants_[uniform].numElements;
+}
+
+void ShaderDirect3D9::ReflectConstants(ID3DXConstantTable* constantTable) {
+    D3DXCONSTANTTABLE_DESC tableDesc;
+    if (FAILED(constantTable->GetDesc(&tableDesc))) {
+        return;
+    }
+
+    for (UINT i = 0; i < tableDesc.Constants; i++) {
+        D3DXHANDLE handle = constantTable->GetConstant(0, i);
+
+        D3DXCONSTANT_DESC constantDesc;
+        UINT count = 1;
+        if (FAILED(constantTable->GetConstantDesc(handle, &constantDesc, &count))) {
+            continue;
+        }
+
+        // Prefer the vertex shader's constant when both shaders use the same name
+        string name = constantDesc.Name;
+        if (nameToConstants_.find(name) != nameToConstants_.end()) {
+            continue;
+        }
+
+        Constant_t constant;
+        constant.handle = handle;
+        constant.constantTable = constantTable;
+        constant.numElements = (constantDesc.Elements > 0) ? constantDesc.Elements : 1;
+
+        nameToConstants_[name] = (UniformHandle_t)constants_.size();
+        constants_.push_back(constant);
+    }
 }
 
 unsigned long ShaderDirect3D9::GetFilter(FilterMode_t filter) const {
@@ -0,0 +1,7 @@
+#include "render/FrameStatistics.h"
+
+namespace Sketch3D {
+
+size_t BufferUploadCounter::numUploadedBytes_ = 0;
+
+}
@@ -6,56 +6,114 @@
 
 #include "system/Logger.h"
 
+#include <string.h>
+
 namespace Sketch3D {
 
-Material::Material(Shader* shader) : shader_(shader), transluencyType_(TRANSLUENCY_TYPE_OPAQUE) {
-}
+// All the types of uniforms are made of floats only, so that their values can be packed in a single buffer
+#define NUM_FLOATS(type) (sizeof(type) / sizeof(float))
 
-bool Material::ApplyMaterial() const {
-    if (shader_ == nullptr) {
-        return false;
+/**
+ * Resolves the handle of one of the material's uniforms
+ */
+static UniformHandle_t ResolveParameter(const Shader* shader, const string& uniform) {
+    if (shader == nullptr) {
+        return INVALID_UNIFORM_HANDLE;
     }
 
-    Renderer::GetInstance()->BindShader(shader_);
-
-    for (auto it = intUniforms_.begin(); it != intUniforms_.end(); ++it) {
-        shader_->SetUniformInt(it->first, it->second);
+    UniformHandle_t handle = shader->GetUniformHandle(uniform);
+    if (handle == INVALID_UNIFORM_HANDLE) {
+        LOG_DEBUG("Couldn't find uniform location of name " + uniform + " in shader #" + to_string(shader->GetId()));
     }
 
-    for (auto it = floatUniforms_.begin(); it != floatUniforms_.end(); ++it) {
-        shader_->SetUniformFloat(it->first, it->second);
-    }
+    return handle;
+}
 
-    for (auto it = vector2Uniforms_.begin(); it != vector2Uniforms_.end(); ++it) {
-        shader_->SetUniformVector2(it->first, it->second.x, it->second.y);
+/**
+ * Upload one of the uniforms of a material's state to its shader
+ */
+static void ApplyParameter(const MaterialState_t& state, const MaterialParameter_t& parameter) {
+    const float* data = state.parameterData + parameter.offset;
+
+    switch (parameter.type) {
+        case MATERIAL_PARAMETER_INT: {
+            int value;
+            memcpy(&value, data, sizeof(int));
+            state.shader->SetUniformInt(parameter.handle, value);
+            break;
+        }
+
+        case MATERIAL_PARAMETER_FLOAT:
+            state.shader->SetUniformFloat(parameter.handle, *data);
+            break;
+
+        case MATERIAL_PARAMETER_VECTOR2:
+            state.shader->SetUniformVector2(parameter.handle, data[0], data[1]);
+            break;
+
+        case MATERIAL_PARAMETER_VECTOR3:
+            state.shader->SetUniformVector3(parameter.handle, *reinterpret_cast<const Vector3*>(data));
+            break;
+
+        case MATERIAL_PARAMETER_VECTOR3_ARRAY:
+            state.shader->SetUniformVector3Array(parameter.handle, reinterpret_cast<const Vector3*>(data),
+                                                 (int)(parameter.size / NUM_FLOATS(Vector3)));
+            break;
+
+        case MATERIAL_PARAMETER_VECTOR4:
+            state.shader->SetUniformVector4(parameter.handle, *reinterpret_cast<const Vector4*>(data));
+            break;
+
+        case MATERIAL_PARAMETER_MATRIX3X3:
+            state.shader->SetUniformMatrix3x3(parameter.handle, *reinterpret_cast<const Matrix3x3*>(data));
+            break;
+
+        case MATERIAL_PARAMETER_MATRIX4X4:
+            state.shader->SetUniformMatrix4x4(parameter.handle, *reinterpret_cast<const Matrix4x4*>(data));
+            break;
+
+        case MATERIAL_PARAMETER_MATRIX4X4_ARRAY:
+            state.shader->SetUniformMatrix4x4Array(parameter.handle, reinterpret_cast<const Matrix4x4*>(data),
+                                                   (int)(parameter.size / NUM_FLOATS(Matrix4x4)));
+            break;
+
+        case MATERIAL_PARAMETER_TEXTURE:
+            state.shader->SetUniformTexture(parameter.handle, state.textures[parameter.offset]);
+            break;
     }
+}
 
-    for (auto it = vector3Uniforms_.begin(); it != vector3Uniforms_.end(); ++it) {
-        shader_->SetUniformVector3(it->first, it->second);
-    }
+size_t Material::nextAvailableId_ = 0;
 
-    for (auto it = vector3ArrayUniforms_.begin(); it != vector3ArrayUniforms_.end(); ++it) {
-        shader_->SetUniformVector3Array(it->first, &(it->second[0]), it->second.size());
-    }
+Material::Material(Shader* shader) : shader_(shader), transluencyType_(TRANSLUENCY_TYPE_OPAQUE),
+        renderStateBlock_(INVALID_RENDER_STATE_BLOCK), version_(0)
+{
+    id_ = nextAvailableId_++;
+}
 
-    for (auto it = vector4Uniforms_.begin(); it != vector4Uniforms_.end(); ++it) {
-        shader_->SetUniformVector4(it->first, it->second);
-    }
+bool Material::ApplyMaterial() const {
+    // Every uniform has a version greater than 0
+    return ApplyMaterial(0);
+}
 
-    for (auto it = matrix3x3Uniforms_.begin(); it != matrix3x3Uniforms_.end(); ++it) {
-        shader_->SetUniformMatrix3x3(it->first, it->second);
-    }
+bool Material::ApplyMaterial(size_t appliedVersion) const {
+    return ApplyMaterialState(GetState(), appliedVersion);
+}
 
-    for (auto it = matrix4x4Uniforms_.begin(); it != matrix4x4Uniforms_.end(); ++it) {
-        shader_->SetUniformMatrix4x4(it->first, it->second);
+bool Material::ApplyMaterialState(const MaterialState_t& state, size_t appliedVersion) {
+    if (state.shader == nullptr) {
+        return false;
     }
 
-    for (auto it = matrix4x4ArrayUniforms_.begin(); it != matrix4x4ArrayUniforms_.end(); ++it) {
-        shader_->SetUniformMatrix4x4Array(it->first, &(it->second[0]), it->second.size());
-    }
+    Renderer::GetInstance()->BindShader(state.shader);
 
-    for (auto it = textureUniforms_.begin(); it != textureUniforms_.end(); ++it) {
-        shader_->SetUniformTexture(it->first, it->second);
+    for (size_t i = 0; i < state.numParameters; i++) {
+        const MaterialParameter_t& parameter = state.parameters[i];
+        if (parameter.handle != INVALID_UNIFORM_HANDLE &&
+            (parameter.version > appliedVersion || parameter.type == MATERIAL_PARAMETER_TEXTURE))
+        {
+            ApplyParameter(state, parameter);
+        }
     }
 
     return true;
@@ -63,6 +121,13 @@ bool Material::ApplyMaterial() const {
 
 void Material::SetShader(Shader* shader) {
 	shader_ = shader;
+
+    // The handles are only valid for the shader that returned them
+    version_ += 1;
+    for (size_t i = 0; i < parameters_.size(); i++) {
+        parameters_[i].handle = ResolveParameter(shader_, parameterNames_[i]);
+        parameters_[i].version = version_;
+    }
 }
 
 void Material::SetTransluencyType(TransluencyType_t type) {
@@ -70,43 +135,45 @@ void Material::SetTransluencyType(TransluencyType_t type) {
 }
 
 void Material::SetUniformInt(const string& uniform, int value) {
-    intUniforms_[uniform] = value;
+    SetParameterData(uniform, MATERIAL_PARAMETER_INT, &value, NUM_FLOATS(int));
 }
 
 void Material::SetUniformFloat(const string& uniform, float value) {
-    floatUniforms_[uniform] = value;
+    SetParameterData(uniform, MATERIAL_PARAMETER_FLOAT, &value, 1);
 }
 
 void Material::SetUniformVector2(const string& uniform, float value1, float value2) {
-    vector2Uniforms_[uniform] = Vector2(value1, value2);
+    Vector2 value(value1, value2);
+    SetParameterData(uniform, MATERIAL_PARAMETER_VECTOR2, &value, NUM_FLOATS(Vector2));
 }
 
 void Material::SetUniformVector3(const string& uniform, const Vector3& value) {
-    vector3Uniforms_[uniform] = value;
+    SetParameterData(uniform, MATERIAL_PARAMETER_VECTOR3, &value, NUM_FLOATS(Vector3));
 }
 
 void Material::SetUniformVector3Array(const string& uniform, const vector<Vector3>& values) {
-    vector3ArrayUniforms_[uniform] = values;
+    SetParameterData(uniform, MATERIAL_PARAMETER_VECTOR3_ARRAY, values.data(), values.size() * NUM_FLOATS(Vector3));
 }
 
 void Material::SetUniformVector4(const string& uniform, const Vector4& value) {
-    vector4Uniforms_[uniform] = value;
+    SetParameterData(uniform, MATERIAL_PARAMETER_VECTOR4, &value, NUM_FLOATS(Vector4));
 }
 
 void Material::SetUniformMatrix3x3(const string& uniform, const Matrix3x3& value) {
-    matrix3x3Uniforms_[uniform] = value;
+    SetParameterData(uniform, MATERIAL_PARAMETER_MATRIX3X3, &value, NUM_FLOATS(Matrix3x3));
 }
 
 void Material::SetUniformMatrix4x4(const string& uniform, const Matrix4x4& value) {
-    matrix4x4Uniforms_[uniform] = value;
+    SetParameterData(uniform, MATERIAL_PARAMETER_MATRIX4X4, &value, NUM_FLOATS(Matrix4x4));
 }
 
 void Material::SetUniformMatrix4x4Array(const string& uniform, const vector<Matrix4x4>& values) {
-    matrix4x4ArrayUniforms_[uniform] = values;
+    SetParameterData(uniform, MATERIAL_PARAMETER_MATRIX4X4_ARRAY, values.data(), values.size() * NUM_FLOATS(Matrix4x4));
 }
 
 void Material::SetUniformTexture(const string& uniform, const Texture* texture) {
-    textureUniforms_[uniform] = texture;
+    MaterialParameter_t& parameter = PrepareParameter(uniform, MATERIAL_PARAMETER_TEXTURE, 0);
+    textures_[parameter.offset] = texture;
 }
 
 Shader* Material::GetShader() const {
@@ -117,4 +184,86 @@ TransluencyType_t Material::GetTransluencyType() const {
     return transluencyType_;
 }
 
+MaterialState_t Material::GetState() const {
+    MaterialState_t state;
+    state.shader = shader_;
+    state.renderStateBlock = renderStateBlock_;
+    state.version = version_;
+    state.parameters = parameters_.data();
+    state.numParameters = parameters_.size();
+    state.parameterData = parameterData_.data();
+    state.numParameterData = parameterData_.size();
+    state.textures = textures_.data();
+    state.numTextures = textures_.size();
+    return state;
+}
+
+MaterialParameter_t& Material::PrepareParameter(const string& uniform, MaterialParameterType_t type, size_t size) {
+    version_ += 1;
+
+    auto it = parameterIndices_.find(uniform);
+    if (it == parameterIndices_.end()) {
+        MaterialParameter_t parameter;
+        parameter.type = type;
+        parameter.handle = ResolveParameter(shader_, uniform);
+        parameter.size = size;
+        parameter.version = version_;
+
+        if (type == MATERIAL_PARAMETER_TEXTURE) {
+            parameter.offset = textures_.size();
+            textures_.push_back(nullptr);
+        } else {
+            parameter.offset = parameterData_.size();
+            parameterData_.resize(parameterData_.size() + size);
+        }
+
+        parameterIndices_[uniform] = parameters_.size();
+        parameters_.push_back(parameter);
+        parameterNames_.push_back(uniform);
+        return parameters_.back();
+    }
+
+    MaterialParameter_t& parameter = parameters_[it->second];
+    parameter.version = version_;
+
+    bool wasTexture = parameter.type == MATERIAL_PARAMETER_TEXTURE;
+    bool isTexture = type == MATERIAL_PARAMETER_TEXTURE;
+    if (wasTexture == isTexture && parameter.size == size) {
+        parameter.type = type;
+        return parameter;
+    }
+
+    // The size of the value changed, usually an array. Compact the parameter data and move the value at its end
+    if (!wasTexture) {
+        parameterData_.erase(parameterData_.begin() + parameter.offset, parameterData_.begin() + parameter.offset + parameter.size);
+        for (size_t i = 0; i < parameters_.size(); i++) {
+            if (parameters_[i].type != MATERIAL_PARAMETER_TEXTURE && parameters_[i].offset > parameter.offset) {
+                parameters_[i].offset -= parameter.size;
+            }
+        }
+    }
+
+    if (isTexture) {
+        if (!wasTexture) {
+            parameter.offset = textures_.size();
+            textures_.push_back(nullptr);
+        }
+    } else {
+        // The texture slot isn't reused, the uniforms of a material rarely change type
+        parameter.offset = parameterData_.size();
+        parameterData_.resize(parameterData_.size() + size);
+    }
+
+    parameter.type = type;
+    parameter.size = size;
+    return parameter;
+}
+
+void Material::SetParameterData(const string& uniform, MaterialParameterType_t type, const void* data, size_t size) {
+    MaterialParameter_t& parameter = PrepareParameter(uniform, type, size);
+    if (size > 0) {
+        memcpy(&parameterData_[parameter.offset], data, size * sizeof(float));
+    }
+}
+
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include "render/TextureManager.h"
 
 #include "system/Logger.h"
+#include "system/Profiler.h"
 #include "system/Utils.h"
 
 #include "render/OpenGL/gl/glew.h"
@@ -70,6 +71,8 @@ Mesh& Mesh::operator= (const Mesh& rhs) {
 }
 
 void Mesh::Load(const string& filename, const VertexAttributesMap_t& vertexAttributes, bool counterClockWise) {
+    PROFILE_ZONE("Mesh::Load");
+
     if (filename == filename_) {
         return;
     }
@@ -389,6 +392,18 @@ void Mesh::GetRenderInfo(BufferObject**& bufferObjects, vector<SurfaceTriangles_
     surfaces = surfaces_;
 }
 
+size_t Mesh::GetNumSurfaces() const {
+    return surfaces_.size();
+}
+
+SurfaceTriangles_t* Mesh::GetSurface(size_t index) const {
+    return surfaces_[index];
+}
+
+BufferObject* Mesh::GetBufferObject(size_t index) const {
+    return bufferObjects_[index];
+}
+
 const Sphere& Mesh::GetBoundingSphere() const {
     return boundingSphere_;
 }
@@ -7,6 +7,8 @@
 #include "render/Renderer.h"
 #include "render/RenderQueue.h"
 #include "render/RenderStateCache.h"
+#include "render/RenderSystem.h"
+#include "render/SceneTree.h"
 #include "render/Shader.h"
 #include "render/SkinnedMesh.h"
 #include "render/Texture2D.h"
@@ -19,7 +21,8 @@ long long Node::nextNameIndex_ = 0;
 
 Node::Node(Node* parent) : parent_(parent), mesh_(NULL), material_(NULL),
                            scale_(1.0f, 1.0f, 1.0), parentTransformation_(&Matrix4x4::IDENTITY),
-                           needTransformationUpdate_(true), useInstancing_(false), isStatic_(false)
+                           needTransformationUpdate_(true), useInstancing_(false), isStatic_(false),
+                           sceneTree_(nullptr), cullingProxy_(INVALID_BVH_PROXY), isBoundsDirty_(false)
 {
     ostringstream convert;
     convert << nextNameIndex_;
@@ -30,7 +33,8 @@ Node::Node(Node* parent) : parent_(parent), mesh_(NULL), material_(NULL),
 Node::Node(const string& name, Node* parent) : name_(name), parent_(parent),
 											   mesh_(NULL), material_(NULL),
 											   scale_(1.0f, 1.0f, 1.0f), parentTransformation_(&Matrix4x4::IDENTITY),
-                                               needTransformationUpdate_(true), useInstancing_(false), isStatic_(false)
+                                               needTransformationUpdate_(true), useInstancing_(false), isStatic_(false),
+                                               sceneTree_(nullptr), cullingProxy_(INVALID_BVH_PROXY), isBoundsDirty_(false)
 {
 }
 
@@ -44,7 +48,10 @@ Node::Node(const Vector3& position, const Vector3& scale,
                                                           parentTransformation_(&Matrix4x4::IDENTITY),
                                                           needTransformationUpdate_(true),
                                                           useInstancing_(false),
-                                                          isStatic_(false)
+                                                          isStatic_(false),
+                                                          sceneTree_(nullptr),
+                                                          cullingProxy_(INVALID_BVH_PROXY),
+                                                          isBoundsDirty_(false)
 {
     ostringstream convert;
     convert << nextNameIndex_;
@@ -63,7 +70,10 @@ Node::Node(const string& name, const Vector3& position, const Vector3& scale,
                                                           parentTransformation_(&Matrix4x4::IDENTITY),
                                                           needTransformationUpdate_(true),
                                                           useInstancing_(false),
-                                                          isStatic_(false)
+                                                          isStatic_(false),
+                                                          sceneTree_(nullptr),
+                                                          cullingProxy_(INVALID_BVH_PROXY),
+                                                          isBoundsDirty_(false)
 {
 }
 
@@ -75,7 +85,10 @@ Node::Node(const Node& src) : parent_(src.parent_),
                               parentTransformation_(&Matrix4x4::IDENTITY),
                               needTransformationUpdate_(true),
                               useInstancing_(false),
-                              isStatic_(false)
+                              isStatic_(false),
+                              sceneTree_(nullptr),
+                              cullingProxy_(INVALID_BVH_PROXY),
+                              isBoundsDirty_(false)
 {
     // TODO
     // Better manage name copy
@@ -87,11 +100,16 @@ Node::Node(const Node& src) : parent_(src.parent_),
 }
 
 Node::~Node() {
+    // The children aren't owned by the node, only remove this one from the culling hierarchy
+    if (sceneTree_ != nullptr) {
+        sceneTree_->RemoveFromCullingHierarchy(this);
+    }
 }
 
 void Node::Render() {
     // Commit state changes
-    Renderer::GetInstance()->GetRenderStateCache()->ApplyRenderStateChanges();
+    RenderStateCache* renderStateCache = Renderer::GetInstance()->GetRenderStateCache();
+    renderStateCache->ApplyRenderStateChanges();
 
 	Shader* shader = material_->GetShader();
 
@@ -101,36 +119,54 @@ void Node::Render() {
 
     // Setup the transformation matrix for this node
     const Matrix4x4& model = ConstructModelMatrix();
-    Matrix4x4 modelViewProjection(viewProjection * model);
-    Matrix4x4 modelView(view * model);
 
-    // Set the uniform matrices
+    // The camera may have changed since the frame constants were uploaded
+    Renderer::GetInstance()->GetRenderSystem()->SetFrameConstants(Renderer::GetInstance()->GetFrameConstants());
+
+    // Set the uniform matrices that the shader uses
     Renderer::GetInstance()->BindShader(shader);
-    shader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::MODEL_VIEW_PROJECTION), modelViewProjection );
-    shader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::MODEL_VIEW), modelView );
-    shader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::MODEL), model );
-    shader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::VIEW), view );
-    shader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::PROJECTION), projection );
+    if (shader->UsesBuiltinUniform(BuiltinUniform_t::MODEL_VIEW_PROJECTION)) {
+        shader->SetUniformMatrix4x4( shader->GetBuiltinUniformHandle(BuiltinUniform_t::MODEL_VIEW_PROJECTION), viewProjection * model );
+    }
+
+    if (shader->UsesBuiltinUniform(BuiltinUniform_t::MODEL_VIEW)) {
+        shader->SetUniformMatrix4x4( shader->GetBuiltinUniformHandle(BuiltinUniform_t::MODEL_VIEW), view * model );
+    }
 
-    // Get the rendering data
-    BufferObject** bufferObjects;
-    vector<SurfaceTriangles_t*> surfaces;
-    mesh_->GetRenderInfo(bufferObjects, surfaces);
+    shader->SetUniformMatrix4x4( shader->GetBuiltinUniformHandle(BuiltinUniform_t::MODEL), model );
+    if (shader->GetBuiltinUniformMask() & FRAME_CONSTANTS_BUILTIN_UNIFORM_MASK) {
+        shader->SetUniformMatrix4x4( shader->GetBuiltinUniformHandle(BuiltinUniform_t::VIEW), view );
+        shader->SetUniformMatrix4x4( shader->GetBuiltinUniformHandle(BuiltinUniform_t::PROJECTION), projection );
+    }
 
     material_->ApplyMaterial();
 
+    // Draw with the material's states, the renderer's ones are restored afterwards
+    RenderStateBlockHandle_t previousRenderStateBlock = INVALID_RENDER_STATE_BLOCK;
+    if (material_->GetRenderStateBlock() != INVALID_RENDER_STATE_BLOCK) {
+        previousRenderStateBlock = renderStateCache->CreateRenderStateBlock(renderStateCache->GetCurrentRenderState());
+        renderStateCache->ApplyRenderStateBlock(material_->GetRenderStateBlock());
+    }
+
     // Render the mesh
-    for (size_t i = 0; i < surfaces.size(); i++) {
+    for (size_t i = 0; i < mesh_->GetNumSurfaces(); i++) {
+        const SurfaceTriangles_t* surface = mesh_->GetSurface(i);
+
         // Textures associated with the surface
-        for (size_t j = 0; j < surfaces[i]->numTextures; j++) {
-            Texture2D* texture = surfaces[i]->textures[j];
+        for (size_t j = 0; j < surface->numTextures; j++) {
+            Texture2D* texture = surface->textures[j];
             if (texture != nullptr) {
                 BuiltinUniform_t builtinUniformTexture = (BuiltinUniform_t)((size_t)BuiltinUniform_t::TEXTURE_0 + j);
-                shader->SetUniformTexture( GetBuiltinUniformName(builtinUniformTexture), texture );
+                shader->SetUniformTexture( shader->GetBuiltinUniformHandle(builtinUniformTexture), texture );
             }
         }
 
-        bufferObjects[i]->Render();
+        mesh_->GetBufferObject(i)->Render();
+        Renderer::GetInstance()->RecordDraw(mesh_->GetBufferObject(i));
+    }
+
+    if (previousRenderStateBlock != INVALID_RENDER_STATE_BLOCK) {
+        renderStateCache->ApplyRenderStateBlock(previousRenderStateBlock);
     }
 }
 
@@ -143,6 +179,13 @@ bool Node::AddChildren(Node* node) {
 
     node->parentTransformation_ = &cachedTransformation_;
 	children_[name] = node;
+
+    if (node->sceneTree_ != sceneTree_) {
+        node->DetachFromSceneTree();
+        node->AttachToSceneTree(sceneTree_);
+    }
+    node->MarkBoundsDirty();
+
 	return true;
 }
 
@@ -167,6 +210,7 @@ Node* Node::GetNodeByName(const string& name) const {
 bool Node::RemoveChildrenByName(const string& name) {
 	map<string, Node*>::iterator it = children_.find(name);
 	if (it != children_.end()) {
+        it->second->DetachFromSceneTree();
 	    children_.erase(it);
 	    return true;
 	}
@@ -187,6 +231,7 @@ bool Node::RemoveChildren(const Node* const node) {
 void Node::Translate(const Vector3& translation) {
 	position_ += translation;
     needTransformationUpdate_ = true;
+    MarkBoundsDirty();
 }
 
 void Node::Scale(const Vector3& scale) {
@@ -194,6 +239,7 @@ void Node::Scale(const Vector3& scale) {
 	scale_.y *= scale.y;
 	scale_.z *= scale.z;
     needTransformationUpdate_ = true;
+    MarkBoundsDirty();
 }
 
 void Node::Pitch(float angle) {
@@ -214,6 +260,7 @@ void Node::RotateAroundAxis(float angle, const Vector3& axis) {
 	rot.Normalize();
 	orientation_ = rot * orientation_;
     needTransformationUpdate_ = true;
+    MarkBoundsDirty();
 }
 
 Matrix4x4 Node::ConstructModelMatrix() {
@@ -245,20 +292,24 @@ void Node::SetParent(Node* parent) {
 void Node::SetPosition(const Vector3& position) {
 	position_ = position;
     needTransformationUpdate_ = true;
+    MarkBoundsDirty();
 }
 
 void Node::SetScale(const Vector3& scale) {
 	scale_ = scale;
     needTransformationUpdate_ = true;
+    MarkBoundsDirty();
 }
 
 void Node::SetOrientation(const Quaternion& orientation) {
 	orientation_ = orientation;
     needTransformationUpdate_ = true;
+    MarkBoundsDirty();
 }
 
 void Node::SetMesh(Mesh* mesh) {
 	mesh_ = mesh;
+    MarkBoundsDirty();
 }
 
 void Node::SetMaterial(Material* material) {
@@ -274,6 +325,7 @@ void Node::SetInstancing(bool val) {
 
 void Node::SetStatic(bool val) {
     isStatic_ = val;
+    MarkBoundsDirty();
 }
 
 const string& Node::GetName() const {
@@ -312,35 +364,41 @@ bool Node::IsStatic() const {
     return isStatic_;
 }
 
-void Node::Render(const FrustumPlanes_t& frustumPlanes, bool useFrustumCulling, RenderQueue& opaqueRenderQueue, RenderQueue& transparentRenderQueue) {
-    if (mesh_ != nullptr && !isStatic_) {
-        bool addMeshToRenderQueue = true;
+void Node::AttachToSceneTree(SceneTree* sceneTree) {
+    sceneTree_ = sceneTree;
 
-        if (useFrustumCulling) {
-            float maxScaleValue = max(scale_.x, max(scale_.y, scale_.z));
-            const Matrix4x4& model = ConstructModelMatrix();
+	map<string, Node*>::const_iterator it = children_.begin();
+	for (; it != children_.end(); ++it) {
+        it->second->AttachToSceneTree(sceneTree);
+	}
+}
 
-            const Sphere& meshBoundingSphere = mesh_->GetBoundingSphere();
-            Vector4 transformedCenter = model * meshBoundingSphere.GetCenter();
-            Sphere nodeBoundingSphere(Vector3(transformedCenter.x, transformedCenter.y, transformedCenter.z), meshBoundingSphere.GetRadius() * maxScaleValue);
+void Node::DetachFromSceneTree() {
+    if (sceneTree_ == nullptr) {
+        return;
+    }
 
-            if (frustumPlanes.IsSphereOutside(nodeBoundingSphere)) {
-                addMeshToRenderQueue = false;
-            }
-        }
+    sceneTree_->RemoveFromCullingHierarchy(this);
+    sceneTree_ = nullptr;
 
-        if (addMeshToRenderQueue) {
-            if (material_->GetTransluencyType() == TRANSLUENCY_TYPE_OPAQUE) {
-                opaqueRenderQueue.AddNode(this);
-            } else {
-                transparentRenderQueue.AddNode(this);
-            }
-        }
+	map<string, Node*>::const_iterator it = children_.begin();
+	for (; it != children_.end(); ++it) {
+        it->second->DetachFromSceneTree();
+	}
+}
+
+void Node::MarkBoundsDirty() {
+    // The children of a dirty node are always dirty too, so there is no need to go further
+    if (sceneTree_ == nullptr || isBoundsDirty_) {
+        return;
     }
 
+    isBoundsDirty_ = true;
+    sceneTree_->dirtyNodes_.push_back(this);
+
 	map<string, Node*>::const_iterator it = children_.begin();
 	for (; it != children_.end(); ++it) {
-        it->second->Render(frustumPlanes, useFrustumCulling, opaqueRenderQueue, transparentRenderQueue);
+        it->second->MarkBoundsDirty();
 	}
 }
 
@@ -0,0 +1,16 @@
+#include "render/Null/BufferObjectManagerNull.h"
+
+#include "render/Null/BufferObjectNull.h"
+
+namespace Sketch3D {
+
+BufferObjectManagerNull::BufferObjectManagerNull(RenderCommandLog* commandLog) : commandLog_(commandLog) {
+}
+
+BufferObject* BufferObjectManagerNull::CreateBufferObject(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage) {
+    BufferObject* buffer = new BufferObjectNull(commandLog_, vertexAttributes, usage);
+    bufferObjects_.insert(buffer);
+    return buffer;
+}
+
+}
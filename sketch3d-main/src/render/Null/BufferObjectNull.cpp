@@ -0,0 +1,81 @@
+#include "render/Null/BufferObjectNull.h"
+
+#include "render/Null/RenderCommandLog.h"
+
+#include "render/FrameStatistics.h"
+
+#include "math/Matrix4x4.h"
+#include "math/Vector2.h"
+#include "math/Vector3.h"
+#include "math/Vector4.h"
+
+namespace Sketch3D {
+
+BufferObjectNull::BufferObjectNull(RenderCommandLog* commandLog, const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage) :
+        BufferObject(vertexAttributes, usage), commandLog_(commandLog)
+{
+}
+
+BufferObjectNull::~BufferObjectNull() {
+}
+
+void BufferObjectNull::Render() {
+    commandLog_->Record(RECORDED_COMMAND_DRAW, id_, indexCount_);
+}
+
+void BufferObjectNull::RenderInstances(const vector<Matrix4x4>& modelMatrices) {
+    commandLog_->Record(RECORDED_COMMAND_DRAW_INSTANCED, id_, indexCount_, modelMatrices.size());
+}
+
+BufferObjectError_t BufferObjectNull::SetVertexData(const vector<float>& vertexData, int presentVertexAttributes) {
+    // Same validation as the other render systems, so that a scene that loads here also loads on the GPU
+    stride_ = sizeof(Vector3) +
+                (((presentVertexAttributes & VERTEX_ATTRIBUTES_NORMAL) > 0) ? sizeof(Vector3) : 0) +
+                (((presentVertexAttributes & VERTEX_ATTRIBUTES_TEX_COORDS) > 0) ? sizeof(Vector2) : 0) +
+                (((presentVertexAttributes & VERTEX_ATTRIBUTES_TANGENT) > 0) ? sizeof(Vector3) : 0) +
+                (((presentVertexAttributes & VERTEX_ATTRIBUTES_BONES) > 0) ? sizeof(Vector4) : 0) +
+                (((presentVertexAttributes & VERTEX_ATTRIBUTES_WEIGHTS) > 0) ? sizeof(Vector4) : 0);
+
+    if ( (vertexData.size() / (stride_ / sizeof(float))) > 65535) {
+        return BUFFER_OBJECT_ERROR_NOT_ENOUGH_SPACE;
+    } else if (!AreVertexAttributesValid(presentVertexAttributes)) {
+        return BUFFER_OBJECT_ERROR_INVALID_VERTEX_ATTRIBUTES;
+    }
+
+    vertexCount_ = vertexData.size();
+    BufferUploadCounter::Add(vertexData.size() * sizeof(float));
+    return BUFFER_OBJECT_ERROR_NONE;
+}
+
+BufferObjectError_t BufferObjectNull::AppendVertexData(const vector<float>& vertexData, int presentVertexAttributes) {
+    if (vertexCount_ == 0) {
+        return SetVertexData(vertexData, presentVertexAttributes);
+    } else if ( ((vertexCount_ + vertexData.size()) / (stride_ / sizeof(float))) > 65535) {
+        return BUFFER_OBJECT_ERROR_NOT_ENOUGH_SPACE;
+    }
+
+    if (!AreVertexAttributesValid(presentVertexAttributes)) {
+        return BUFFER_OBJECT_ERROR_INVALID_VERTEX_ATTRIBUTES;
+    }
+
+    vertexCount_ += vertexData.size();
+    BufferUploadCounter::Add(vertexData.size() * sizeof(float));
+    return BUFFER_OBJECT_ERROR_NONE;
+}
+
+BufferObjectError_t BufferObjectNull::SetIndexData(unsigned short* /*indexData*/, size_t numIndex) {
+    indexCount_ = numIndex;
+    BufferUploadCounter::Add(numIndex * sizeof(unsigned short));
+    return BUFFER_OBJECT_ERROR_NONE;
+}
+
+BufferObjectError_t BufferObjectNull::AppendIndexData(unsigned short* /*indexData*/, size_t numIndex) {
+    indexCount_ += numIndex;
+    BufferUploadCounter::Add(numIndex * sizeof(unsigned short));
+    return BUFFER_OBJECT_ERROR_NONE;
+}
+
+void BufferObjectNull::PrepareInstanceBuffers() {
+}
+
+}
@@ -0,0 +1,81 @@
+#include "render/Null/RenderCommandLog.h"
+
+#include <sstream>
+
+namespace Sketch3D {
+
+static const char* COMMAND_NAMES[NUM_RECORDED_COMMANDS] = {
+    "Clear",
+    "SetViewport",
+    "BindFramebuffer",
+    "BindShader",
+    "BindTexture",
+    "SetUniform",
+    "SetFrameConstants",
+    "SetRenderState",
+    "Draw",
+    "DrawInstanced",
+    "Present"
+};
+
+RenderCommandLog::RenderCommandLog() : enabled_(true) {
+}
+
+void RenderCommandLog::Record(RecordedCommandType_t type, size_t objectId, size_t argument0, size_t argument1, size_t argument2,
+                              size_t argument3)
+{
+    if (!enabled_) {
+        return;
+    }
+
+    RecordedCommand_t command;
+    command.type = type;
+    command.objectId = objectId;
+    command.arguments[0] = argument0;
+    command.arguments[1] = argument1;
+    command.arguments[2] = argument2;
+    command.arguments[3] = argument3;
+    commands_.push_back(command);
+}
+
+void RenderCommandLog::Clear() {
+    commands_.clear();
+}
+
+void RenderCommandLog::SetEnabled(bool enabled) {
+    enabled_ = enabled;
+}
+
+size_t RenderCommandLog::CountCommands(RecordedCommandType_t type) const {
+    size_t count = 0;
+    for (size_t i = 0; i < commands_.size(); i++) {
+        if (commands_[i].type == type) {
+            count += 1;
+        }
+    }
+
+    return count;
+}
+
+string RenderCommandLog::ToString() const {
+    ostringstream stream;
+    for (size_t i = 0; i < commands_.size(); i++) {
+        const RecordedCommand_t& command = commands_[i];
+        stream << COMMAND_NAMES[command.type];
+
+        if (command.objectId == RECORDED_NULL_OBJECT) {
+            stream << " -";
+        } else {
+            stream << " " << command.objectId;
+        }
+
+        for (size_t j = 0; j < 4; j++) {
+            stream << " " << command.arguments[j];
+        }
+        stream << "\n";
+    }
+
+    return stream.str();
+}
+
+}
@@ -0,0 +1,58 @@
+#include "render/Null/RenderStateCacheNull.h"
+
+#include "render/Null/RenderCommandLog.h"
+
+namespace Sketch3D {
+RenderStateCacheNull::RenderStateCacheNull(RenderCommandLog* commandLog) : commandLog_(commandLog) {
+    EnableDepthTestImpl();
+    EnableDepthWriteImpl();
+    EnableColorWriteImpl();
+    EnableBlendingImpl();
+    SetDepthComparisonFuncImpl();
+    SetCullingMethodImpl();
+    SetBlendingEquationImpl();
+    SetBlendingFactorImpl();
+    SetRenderFillModeImpl();
+}
+
+RenderStateCacheNull::~RenderStateCacheNull() {
+}
+
+void RenderStateCacheNull::EnableDepthTestImpl() {
+    commandLog_->Record(RECORDED_COMMAND_SET_RENDER_STATE, RECORDED_RENDER_STATE_DEPTH_TEST, isDepthTestEnabled_);
+}
+
+void RenderStateCacheNull::EnableDepthWriteImpl() {
+    commandLog_->Record(RECORDED_COMMAND_SET_RENDER_STATE, RECORDED_RENDER_STATE_DEPTH_WRITE, isDepthWriteEnabled_);
+}
+
+void RenderStateCacheNull::EnableColorWriteImpl() {
+    commandLog_->Record(RECORDED_COMMAND_SET_RENDER_STATE, RECORDED_RENDER_STATE_COLOR_WRITE, isColorWriteEnabled_);
+}
+
+void RenderStateCacheNull::EnableBlendingImpl() {
+    commandLog_->Record(RECORDED_COMMAND_SET_RENDER_STATE, RECORDED_RENDER_STATE_BLENDING, isBlendingEnabled_);
+}
+
+void RenderStateCacheNull::SetDepthComparisonFuncImpl() {
+    commandLog_->Record(RECORDED_COMMAND_SET_RENDER_STATE, RECORDED_RENDER_STATE_DEPTH_COMPARISON_FUNC, depthComparisonFunction_);
+}
+
+void RenderStateCacheNull::SetCullingMethodImpl() {
+    commandLog_->Record(RECORDED_COMMAND_SET_RENDER_STATE, RECORDED_RENDER_STATE_CULLING_METHOD, cullingMethod_);
+}
+
+void RenderStateCacheNull::SetBlendingEquationImpl() {
+    commandLog_->Record(RECORDED_COMMAND_SET_RENDER_STATE, RECORDED_RENDER_STATE_BLENDING_EQUATION, blendingEquation_);
+}
+
+void RenderStateCacheNull::SetBlendingFactorImpl() {
+    commandLog_->Record(RECORDED_COMMAND_SET_RENDER_STATE, RECORDED_RENDER_STATE_BLENDING_FACTOR, sourceBlendingFactor_,
+                        destinationBlendingFactor_);
+}
+
+void RenderStateCacheNull::SetRenderFillModeImpl() {
+    commandLog_->Record(RECORDED_COMMAND_SET_RENDER_STATE, RECORDED_RENDER_STATE_FILL_MODE, renderMode_);
+}
+
+}
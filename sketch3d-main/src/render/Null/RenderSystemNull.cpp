@@ -0,0 +1,197 @@
+#include "render/Null/RenderSystemNull.h"
+
+#include "render/Null/BufferObjectManagerNull.h"
+#include "render/Null/RenderStateCacheNull.h"
+#include "render/Null/RenderTextureNull.h"
+#include "render/Null/ShaderNull.h"
+#include "render/Null/Texture2DNull.h"
+#include "render/Null/Texture3DNull.h"
+#include "render/Texture.h"
+
+#include "system/Logger.h"
+
+namespace Sketch3D {
+
+// Pretend to have the capabilities of a common desktop GPU
+const int NULL_MAX_ACTIVE_TEXTURES = 32;
+const int NULL_MAX_RENDER_TARGETS = 8;
+
+RenderSystemNull::RenderSystemNull(unsigned int width, unsigned int height) : RenderSystem(width, height) {
+	Logger::GetInstance()->Info("Current rendering API: Null");
+}
+
+RenderSystemNull::~RenderSystemNull() {
+	Logger::GetInstance()->Info("Shutdown Null render system");
+    FreeRenderSystem();
+}
+
+bool RenderSystemNull::Initialize(const RenderParameters_t& /*renderParameters*/) {
+	Logger::GetInstance()->Info("Initializing Null render system...");
+
+	QueryDeviceCapabilities();
+
+    bufferObjectManager_ = new BufferObjectManagerNull(&commandLog_);
+    renderStateCache_ = new RenderStateCacheNull(&commandLog_);
+
+    textureUnitCache_.SetNumTextureUnits(deviceCapabilities_.maxActiveTextures_);
+
+    CreateTextShader();
+
+	return true;
+}
+
+void RenderSystemNull::SetClearColor(float /*red*/, float /*green*/, float /*blue*/, float /*alpha*/) {
+}
+
+void RenderSystemNull::Clear(int buffer) const {
+    commandLog_.Record(RECORDED_COMMAND_CLEAR, RECORDED_NULL_OBJECT, buffer);
+}
+
+void RenderSystemNull::StartRender() {
+}
+
+void RenderSystemNull::EndRender() {
+}
+
+void RenderSystemNull::PresentFrame() {
+    commandLog_.Record(RECORDED_COMMAND_PRESENT);
+}
+
+// Same conventions as the OpenGL render system so that the culling gives the same results
+Matrix4x4 RenderSystemNull::OrthoProjection(float left, float right, float bottom, float top,
+                                            float nearPlane, float farPlane) const
+{
+	float dx = right - left;
+	float dy = top - bottom;
+	float dz = farPlane - nearPlane;
+
+	Matrix4x4 projection;
+	projection[0][0] = 2.0f / dx;
+	projection[1][1] = 2.0f / dy;
+	projection[2][2] = -2.0f / dz;
+	projection[0][3] = -(right + left) / dx;
+	projection[1][3] = -(top + bottom) / dy;
+	projection[2][3] = -(farPlane + nearPlane) / dz;
+
+    return projection;
+}
+
+Matrix4x4 RenderSystemNull::PerspectiveProjection(float left, float right, float bottom, float top,
+                                                  float nearPlane, float farPlane) const
+{
+	float dx = right - left;
+	float dy = top - bottom;
+	float dz = nearPlane - farPlane;
+
+	Matrix4x4 projection;
+	projection[0][0] = 2.0f * nearPlane / dx;
+	projection[1][1] = 2.0f * nearPlane / dy;
+	projection[0][2] = (right + left) / dx;
+	projection[1][2] = (top + bottom) / dy;
+	projection[2][2] = (farPlane + nearPlane) / dz;
+	projection[3][2] = -1.0f;
+	projection[2][3] = 2.0f * nearPlane * farPlane / dz;
+	projection[3][3] = 0.0f;
+
+    return projection;
+}
+
+void RenderSystemNull::SetViewport(size_t x, size_t y, size_t width, size_t height) {
+    commandLog_.Record(RECORDED_COMMAND_SET_VIEWPORT, RECORDED_NULL_OBJECT, x, y, width, height);
+}
+
+Shader* RenderSystemNull::CreateShader() {
+    shaders_.push_back(new ShaderNull(&commandLog_));
+    return shaders_[shaders_.size() - 1];
+}
+
+Texture2D* RenderSystemNull::CreateTexture2D() const {
+    return new Texture2DNull;
+}
+
+Texture3D* RenderSystemNull::CreateTexture3D() const {
+    return new Texture3DNull;
+}
+
+RenderTexture* RenderSystemNull::CreateRenderTexture(unsigned int width, unsigned int height, TextureFormat_t format) {
+    renderTextures_.push_back(new RenderTextureNull(&commandLog_, width, height, format));
+    return renderTextures_.back();
+}
+
+void RenderSystemNull::BindScreenBuffer() const {
+    commandLog_.Record(RECORDED_COMMAND_BIND_FRAMEBUFFER, 0, width_, height_);
+    Renderer::GetInstance()->SetViewport(0, 0, width_, height_);
+}
+
+void RenderSystemNull::BindTextureImpl(const Texture* texture, size_t textureUnit, bool isResident) {
+    if (!isResident) {
+        commandLog_.Record(RECORDED_COMMAND_BIND_TEXTURE, texture->GetId(), textureUnit);
+    }
+}
+
+void RenderSystemNull::BindShader(const Shader* shader) {
+    if (shader != boundShader_) {
+        commandLog_.Record(RECORDED_COMMAND_BIND_SHADER, (shader == nullptr) ? RECORDED_NULL_OBJECT : shader->GetId());
+        boundShader_ = shader;
+    }
+}
+
+FrustumPlanes_t RenderSystemNull::ExtractViewFrustumPlanes(const Matrix4x4& viewProjection) const {
+    FrustumPlanes_t frustumPlanes;
+
+    Vector3 nearPlaneNormal(viewProjection[3][0] + viewProjection[2][0], viewProjection[3][1] + viewProjection[2][1], viewProjection[3][2] + viewProjection[2][2]);
+    float nearPlaneLength = nearPlaneNormal.Length();
+    frustumPlanes.nearPlane.SetNormalizedNormal(nearPlaneNormal / nearPlaneLength);
+    frustumPlanes.nearPlane.SetDistance( (viewProjection[3][3] + viewProjection[2][3]) / nearPlaneLength );
+
+    Vector3 farPlaneNormal(viewProjection[3][0] - viewProjection[2][0], viewProjection[3][1] - viewProjection[2][1], viewProjection[3][2] - viewProjection[2][2]);
+    float farPlaneLength = farPlaneNormal.Length();
+    frustumPlanes.farPlane.SetNormalizedNormal(farPlaneNormal / farPlaneLength);
+    frustumPlanes.farPlane.SetDistance( (viewProjection[3][3] - viewProjection[2][3]) / farPlaneLength );
+
+    Vector3 leftPlaneNormal(viewProjection[3][0] + viewProjection[0][0], viewProjection[3][1] + viewProjection[0][1], viewProjection[3][2] + viewProjection[0][2]);
+    float leftPlaneLength = leftPlaneNormal.Length();
+    frustumPlanes.leftPlane.SetNormalizedNormal(leftPlaneNormal / leftPlaneLength);
+    frustumPlanes.leftPlane.SetDistance( (viewProjection[3][3] + viewProjection[0][3]) / leftPlaneLength );
+
+    Vector3 rightPlaneNormal(viewProjection[3][0] - viewProjection[0][0], viewProjection[3][1] - viewProjection[0][1], viewProjection[3][2] - viewProjection[0][2]);
+    float rightPlaneLength = rightPlaneNormal.Length();
+    frustumPlanes.rightPlane.SetNormalizedNormal(rightPlaneNormal / rightPlaneLength);
+    frustumPlanes.rightPlane.SetDistance( (viewProjection[3][3] - viewProjection[0][3]) / rightPlaneLength );
+
+    Vector3 bottomPlaneNormal(viewProjection[3][0] + viewProjection[1][0], viewProjection[3][1] + viewProjection[1][1], viewProjection[3][2] + viewProjection[1][2]);
+    float bottomPlaneLength = bottomPlaneNormal.Length();
+    frustumPlanes.bottomPlane.SetNormalizedNormal(bottomPlaneNormal / bottomPlaneLength);
+    frustumPlanes.bottomPlane.SetDistance( (viewProjection[3][3] + viewProjection[1][3]) / bottomPlaneLength );
+
+    Vector3 topPlaneNormal(viewProjection[3][0] - viewProjection[1][0], viewProjection[3][1] - viewProjection[1][1], viewProjection[3][2] - viewProjection[1][2]);
+    float topPlaneLength = topPlaneNormal.Length();
+    frustumPlanes.topPlane.SetNormalizedNormal(topPlaneNormal / topPlaneLength);
+    frustumPlanes.topPlane.SetDistance( (viewProjection[3][3] - viewProjection[1][3]) / topPlaneLength );
+
+    return frustumPlanes;
+}
+
+void RenderSystemNull::SetFrameConstantsImpl() {
+    commandLog_.Record(RECORDED_COMMAND_SET_FRAME_CONSTANTS);
+}
+
+void RenderSystemNull::QueryDeviceCapabilities() {
+    deviceCapabilities_.maxActiveTextures_ = NULL_MAX_ACTIVE_TEXTURES;
+    deviceCapabilities_.maxNumberRenderTargets_ = NULL_MAX_RENDER_TARGETS;
+}
+
+void RenderSystemNull::CreateTextShader() {
+    // Only the uniforms matter to the null shaders
+    const char* textFragmentShaderSource = \
+        "uniform sampler2D fontAtlas;\n"
+        "uniform vec3 textColor;\n"
+    ;
+
+    textShader_ = Renderer::GetInstance()->CreateShader();
+    if (!textShader_->SetSource("", textFragmentShaderSource)) {
+        Logger::GetInstance()->Error("Couldn't create text shader");
+    }
+}
+
+}
@@ -0,0 +1,96 @@
+#include "render/Null/RenderTextureNull.h"
+
+#include "render/Null/RenderCommandLog.h"
+#include "render/Renderer.h"
+#include "render/Texture2D.h"
+#include "render/TextureManager.h"
+
+#include "system/Logger.h"
+
+namespace Sketch3D {
+
+int RenderTextureNull::numGeneratedTextures_ = 0;
+
+RenderTextureNull::RenderTextureNull(RenderCommandLog* commandLog, unsigned int width, unsigned int height, TextureFormat_t format) :
+        RenderTexture(width, height, format), commandLog_(commandLog)
+{
+}
+
+RenderTextureNull::~RenderTextureNull() {
+}
+
+bool RenderTextureNull::AddDepthBuffer() {
+    return !depthBufferBound_;
+}
+
+Texture2D* RenderTextureNull::CreateTexture2D() const {
+    Texture2D* texture = Renderer::GetInstance()->CreateTexture2D();
+    texture->SetWidth(width_);
+    texture->SetHeight(height_);
+    texture->SetTextureFormat(format_);
+    texture->Create();
+
+    TextureManager::GetInstance()->CacheTexture("__RenderTexture_Generated_Texture_" + to_string(numGeneratedTextures_++), texture);
+
+    return texture;
+}
+
+Texture2D* RenderTextureNull::CreateDepthBufferTexture() const {
+    Texture2D* texture = Renderer::GetInstance()->CreateTexture2D();
+    texture->SetWidth(width_);
+    texture->SetHeight(height_);
+    texture->SetTextureFormat(TEXTURE_FORMAT_DEPTH);
+    texture->Create();
+
+    TextureManager::GetInstance()->CacheTexture("__RenderTexture_Generated_Texture_" + to_string(numGeneratedTextures_++), texture);
+
+    return texture;
+}
+
+bool RenderTextureNull::AttachTextureToDepthBuffer(Texture2D* texture) {
+    if (depthBufferBound_) {
+        return true;
+    }
+
+    if (texture->GetWidth() != width_ || texture->GetHeight() != height_) {
+        Logger::GetInstance()->Error("Texture used as attachment for the depth buffer isn't of the same size as the render texture");
+        return false;
+    }
+
+    depthBufferBound_ = true;
+    return true;
+}
+
+bool RenderTextureNull::AttachTextures(const vector<Texture2D*>& textures) {
+    if (texturesAttached_) {
+        return true;
+    }
+
+    for (size_t i = 0; i < textures.size(); i++) {
+        Texture2D* texture = textures[i];
+        if (texture == nullptr) {
+            Logger::GetInstance()->Error("Couldn't create render texture, texture #" + to_string(i) + " is null.");
+            return false;
+        }
+
+        if (texture->GetWidth() != width_ || texture->GetHeight() != height_) {
+            Logger::GetInstance()->Error("Couldn't create render texture, texture #" + to_string(i) + " doesn't have the appropriate size.");
+            return false;
+        }
+
+        if (texture->GetTextureFormat() != format_) {
+            Logger::GetInstance()->Error("Couldn't create render texture, texture #" + to_string(i) + " doesn't have the appropriate format.");
+            return false;
+        }
+    }
+
+    texturesAttached_ = true;
+    return true;
+}
+
+void RenderTextureNull::Bind() const {
+    commandLog_->Record(RECORDED_COMMAND_BIND_FRAMEBUFFER, 1, width_, height_);
+    Renderer::GetInstance()->SetViewport(0, 0, width_, height_);
+}
+
+}
@@ -0,0 +1,200 @@
+#include "render/Null/ShaderNull.h"
+
+#include "render/Null/RenderCommandLog.h"
+
+#include "render/Texture.h"
+
+#include "system/Logger.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <fstream>
+#include <sstream>
+using namespace std;
+
+namespace Sketch3D {
+
+static bool IsIdentifierCharacter(char c) {
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+/**
+ * Reads the identifier starting at the first non-space character after position
+ * @param source The source to read from
+ * @param position The position where to start reading. Set to the end of the identifier
+ * @return The identifier, empty if the next token isn't an identifier
+ */
+static string ReadIdentifier(const string& source, size_t& position) {
+    while (position < source.size() && isspace((unsigned char)source[position])) {
+        position += 1;
+    }
+
+    size_t start = position;
+    while (position < source.size() && IsIdentifierCharacter(source[position])) {
+        position += 1;
+    }
+
+    return source.substr(start, position - start);
+}
+
+/**
+ * Reads the length of an array declaration, such as "[4]", starting at the first non-space character after position
+ * @param source The source to read from
+ * @param position The position where to start reading. Set to the end of the declaration if there is one
+ * @return The length of the array, 1 if there isn't an array declaration
+ */
+static size_t ReadArrayLength(const string& source, size_t& position) {
+    size_t start = position;
+    while (start < source.size() && isspace((unsigned char)source[start])) {
+        start += 1;
+    }
+
+    if (start == source.size() || source[start] != '[') {
+        return 1;
+    }
+
+    size_t end = source.find(']', start);
+    if (end == string::npos) {
+        return 1;
+    }
+
+    position = end + 1;
+    int length = atoi(source.substr(start + 1, end - start - 1).c_str());
+    return (length > 0) ? (size_t)length : 1;
+}
+
+ShaderNull::ShaderNull(RenderCommandLog* commandLog) : commandLog_(commandLog) {
+    Logger::GetInstance()->Debug("Null Shader creation");
+}
+
+ShaderNull::~ShaderNull() {
+}
+
+bool ShaderNull::SetSourceFile(const string& vertexFilename, const string& fragmentFilename) {
+    string vertexSource;
+    if (!ReadShader(vertexFilename + ".glsl", vertexSource)) {
+        Logger::GetInstance()->Error("Couldn't read vertex shader file " + vertexFilename + ".glsl");
+        return false;
+    }
+
+    string fragmentSource;
+    if (!ReadShader(fragmentFilename + ".glsl", fragmentSource)) {
+        Logger::GetInstance()->Error("Couldn't read fragment shader file " + fragmentFilename + ".glsl");
+        return false;
+    }
+
+    return SetSource(vertexSource, fragmentSource);
+}
+
+bool ShaderNull::SetSource(const string& vertexSource, const string& fragmentSource) {
+    nameToUniforms_.clear();
+    uniformNames_.clear();
+    uniformArrayLengths_.clear();
+
+    ReflectUniforms(vertexSource);
+    ReflectUniforms(fragmentSource);
+    ResolveBuiltinUniforms();
+
+    return true;
+}
+
+UniformHandle_t ShaderNull::GetUniformHandle(const string& uniform) const {
+    unordered_map<string, UniformHandle_t>::const_iterator it = nameToUniforms_.find(uniform);
+    if (it == nameToUniforms_.end()) {
+        return INVALID_UNIFORM_HANDLE;
+    }
+
+    return it->second;
+}
+
+void ShaderNull::SetUniformIntImpl(UniformHandle_t uniform, int value) {
+    commandLog_->Record(RECORDED_COMMAND_SET_UNIFORM, id_, uniform, RECORDED_UNIFORM_INT, value);
+}
+
+void ShaderNull::SetUniformFloatImpl(UniformHandle_t uniform, float /*value*/) {
+    commandLog_->Record(RECORDED_COMMAND_SET_UNIFORM, id_, uniform, RECORDED_UNIFORM_FLOAT);
+}
+
+void ShaderNull::SetUniformVector2Impl(UniformHandle_t uniform, float /*value1*/, float /*value2*/) {
+    commandLog_->Record(RECORDED_COMMAND_SET_UNIFORM, id_, uniform, RECORDED_UNIFORM_VECTOR2);
+}
+
+void ShaderNull::SetUniformVector3Impl(UniformHandle_t uniform, const Vector3& /*value*/) {
+    commandLog_->Record(RECORDED_COMMAND_SET_UNIFORM, id_, uniform, RECORDED_UNIFORM_VECTOR3);
+}
+
+void ShaderNull::SetUniformVector3ArrayImpl(UniformHandle_t uniform, const Vector3* /*values*/, int arraySize) {
+    commandLog_->Record(RECORDED_COMMAND_SET_UNIFORM, id_, uniform, RECORDED_UNIFORM_VECTOR3_ARRAY, arraySize);
+}
+
+void ShaderNull::SetUniformVector4Impl(UniformHandle_t uniform, const Vector4& /*value*/) {
+    commandLog_->Record(RECORDED_COMMAND_SET_UNIFORM, id_, uniform, RECORDED_UNIFORM_VECTOR4);
+}
+
+void ShaderNull::SetUniformMatrix3x3Impl(UniformHandle_t uniform, const Matrix3x3& /*value*/) {
+    commandLog_->Record(RECORDED_COMMAND_SET_UNIFORM, id_, uniform, RECORDED_UNIFORM_MATRIX3X3);
+}
+
+void ShaderNull::SetUniformMatrix4x4Impl(UniformHandle_t uniform, const Matrix4x4& /*value*/) {
+    commandLog_->Record(RECORDED_COMMAND_SET_UNIFORM, id_, uniform, RECORDED_UNIFORM_MATRIX4X4);
+}
+
+void ShaderNull::SetUniformMatrix4x4ArrayImpl(UniformHandle_t uniform, const Matrix4x4* /*values*/, int arraySize) {
+    commandLog_->Record(RECORDED_COMMAND_SET_UNIFORM, id_, uniform, RECORDED_UNIFORM_MATRIX4X4_ARRAY, arraySize);
+}
+
+void ShaderNull::SetUniformTextureImpl(UniformHandle_t uniform, const Texture* texture) {
+    // Bind the texture like the other render systems do, so that the binds show up in the log
+    size_t textureUnit = texture->Bind();
+    commandLog_->Record(RECORDED_COMMAND_SET_UNIFORM, id_, uniform, RECORDED_UNIFORM_TEXTURE, textureUnit);
+}
+
+size_t ShaderNull::GetUniformArrayLength(UniformHandle_t uniform) const {
+    return uniformArrayLengths_[uniform];
+}
+
+bool ShaderNull::ReadShader(const string& filename, string& source) const {
+    ifstream file(filename.c_str());
+    if (!file.is_open()) {
+        Logger::GetInstance()->Error("Can't open file : " + filename);
+        return false;
+    }
+
+    stringstream content;
+    content << file.rdbuf();
+    source = content.str();
+
+    return true;
+}
+
+void ShaderNull::ReflectUniforms(const string& source) {
+    // Look for declarations of the form "uniform [precision] type name". Unlike a GLSL compiler, this also finds the
+    // uniforms that are declared but never used
+    const string keyword = "uniform";
+    size_t position = source.find(keyword);
+
+    while (position != string::npos) {
+        bool isKeyword = (position == 0 || !IsIdentifierCharacter(source[position - 1])) &&
+                         (position + keyword.size() < source.size() && isspace((unsigned char)source[position + keyword.size()]));
+        position += keyword.size();
+
+        if (isKeyword) {
+            string type = ReadIdentifier(source, position);
+            if (type == "lowp" || type == "mediump" || type == "highp") {
+                type = ReadIdentifier(source, position);
+            }
+
+            // Uniform blocks don't have a name after their type
+            string name = ReadIdentifier(source, position);
+            if (!type.empty() && !name.empty() && nameToUniforms_.find(name) == nameToUniforms_.end()) {
+                nameToUniforms_[name] = (UniformHandle_t)uniformNames_.size();
+                uniformNames_.push_back(name);
+                uniformArrayLengths_.push_back(ReadArrayLength(source, position));
+            }
+        }
+
+        position = source.find(keyword, position);
+    }
+}
+
+}
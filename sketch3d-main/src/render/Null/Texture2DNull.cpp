@@ -0,0 +1,30 @@
+#include "render/Null/Texture2DNull.h"
+
+namespace Sketch3D {
+Texture2DNull::Texture2DNull(bool generateMipmaps) : Texture2D(generateMipmaps) {
+}
+
+Texture2DNull::~Texture2DNull() {
+}
+
+bool Texture2DNull::Create() {
+    return true;
+}
+
+const void* Texture2DNull::GetData() const {
+    return data_;
+}
+
+void Texture2DNull::SetFilterModeImpl() const {
+}
+
+void Texture2DNull::SetWrapModeImpl() const {
+}
+
+void Texture2DNull::SetPixelDataBytesImp(unsigned char* /*data*/) {
+}
+
+void Texture2DNull::SetPixelDataFloatsImp(float* /*data*/) {
+}
+
+}
@@ -0,0 +1,26 @@
+#include "render/Null/Texture3DNull.h"
+
+namespace Sketch3D {
+Texture3DNull::Texture3DNull(bool generateMipmaps) : Texture3D(generateMipmaps) {
+}
+
+Texture3DNull::~Texture3DNull() {
+}
+
+bool Texture3DNull::Create() {
+    return true;
+}
+
+void Texture3DNull::SetFilterModeImpl() const {
+}
+
+void Texture3DNull::SetWrapModeImpl() const {
+}
+
+void Texture3DNull::SetPixelDataBytesImp(unsigned char* /*data*/) {
+}
+
+void Texture3DNull::SetPixelDataFloatsImp(float* /*data*/) {
+}
+
+}
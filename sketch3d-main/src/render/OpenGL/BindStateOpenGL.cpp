@@ -0,0 +1,162 @@
+#include "render/OpenGL/BindStateOpenGL.h"
+
+namespace Sketch3D {
+
+/**
+ * Returns the shadowed binding point of a buffer target, BUFFER_BINDING_COUNT if it isn't shadowed
+ */
+static BufferBindingTarget_t GetBufferBindingTarget(GLenum target) {
+    switch (target) {
+        case GL_ARRAY_BUFFER:
+            return BUFFER_BINDING_ARRAY;
+
+        case GL_ELEMENT_ARRAY_BUFFER:
+            return BUFFER_BINDING_ELEMENT_ARRAY;
+
+        case GL_UNIFORM_BUFFER:
+            return BUFFER_BINDING_UNIFORM;
+
+        case GL_DRAW_INDIRECT_BUFFER:
+            return BUFFER_BINDING_DRAW_INDIRECT;
+    }
+
+    return BUFFER_BINDING_COUNT;
+}
+
+BindStateOpenGL::BindStateOpenGL() : numIssuedBinds_(0), numSkippedBinds_(0) {
+    Reset();
+}
+
+void BindStateOpenGL::Reset() {
+    program_ = 0;
+    vertexArray_ = 0;
+    for (size_t i = 0; i < BUFFER_BINDING_COUNT; i++) {
+        buffers_[i] = 0;
+    }
+    isElementArrayBufferKnown_ = true;
+    framebuffer_ = 0;
+    activeTextureUnit_ = 0;
+}
+
+void BindStateOpenGL::UseProgram(GLuint program) {
+    if (UpdateBinding(program_, program)) {
+        glUseProgram(program);
+    }
+}
+
+void BindStateOpenGL::BindVertexArray(GLuint vertexArray) {
+    if (UpdateBinding(vertexArray_, vertexArray)) {
+        glBindVertexArray(vertexArray);
+
+        // The element array buffer binding now is the one stored in the vertex array object
+        isElementArrayBufferKnown_ = false;
+    }
+}
+
+void BindStateOpenGL::BindBuffer(GLenum target, GLuint buffer) {
+    BufferBindingTarget_t bindingTarget = GetBufferBindingTarget(target);
+    if (bindingTarget == BUFFER_BINDING_COUNT) {
+        numIssuedBinds_ += 1;
+        glBindBuffer(target, buffer);
+        return;
+    }
+
+    if (bindingTarget == BUFFER_BINDING_ELEMENT_ARRAY && !isElementArrayBufferKnown_) {
+        numIssuedBinds_ += 1;
+        buffers_[bindingTarget] = buffer;
+        isElementArrayBufferKnown_ = true;
+        glBindBuffer(target, buffer);
+        return;
+    }
+
+    if (UpdateBinding(buffers_[bindingTarget], buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void BindStateOpenGL::BindFramebuffer(GLuint framebuffer) {
+    if (UpdateBinding(framebuffer_, framebuffer)) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+}
+
+void BindStateOpenGL::ActiveTexture(size_t textureUnit) {
+    if (textureUnit != activeTextureUnit_) {
+        numIssuedBinds_ += 1;
+        activeTextureUnit_ = textureUnit;
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+    } else {
+        numSkippedBinds_ += 1;
+    }
+}
+
+void BindStateOpenGL::BindTexture(GLenum target, GLuint texture) {
+    numIssuedBinds_ += 1;
+    glBindTexture(target, texture);
+}
+
+void BindStateOpenGL::DeleteProgram(GLuint program) {
+    if (program_ == program) {
+        program_ = 0;
+    }
+
+    glDeleteProgram(program);
+}
+
+void BindStateOpenGL::DeleteVertexArray(GLuint vertexArray) {
+    if (vertexArray == 0) {
+        return;
+    }
+
+    // The default vertex array object is bound in place of the deleted one, with its own element array buffer
+    if (vertexArray_ == vertexArray) {
+        vertexArray_ = 0;
+        isElementArrayBufferKnown_ = false;
+    }
+
+    glDeleteVertexArrays(1, &vertexArray);
+}
+
+void BindStateOpenGL::DeleteBuffer(GLuint buffer) {
+    if (buffer == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < BUFFER_BINDING_COUNT; i++) {
+        if (buffers_[i] == buffer) {
+            buffers_[i] = 0;
+        }
+    }
+
+    glDeleteBuffers(1, &buffer);
+}
+
+void BindStateOpenGL::DeleteFramebuffer(GLuint framebuffer) {
+    if (framebuffer == 0) {
+        return;
+    }
+
+    if (framebuffer_ == framebuffer) {
+        framebuffer_ = 0;
+    }
+
+    glDeleteFramebuffers(1, &framebuffer);
+}
+
+void BindStateOpenGL::ResetCounters() {
+    numIssuedBinds_ = 0;
+    numSkippedBinds_ = 0;
+}
+
+bool BindStateOpenGL::UpdateBinding(GLuint& bound, GLuint object) {
+    if (bound == object) {
+        numSkippedBinds_ += 1;
+        return false;
+    }
+
+    bound = object;
+    numIssuedBinds_ += 1;
+    return true;
+}
+
+}
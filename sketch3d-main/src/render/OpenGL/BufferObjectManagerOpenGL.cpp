@@ -1,13 +1,126 @@
 #include "render/OpenGL/BufferObjectManagerOpenGL.h"
 
+#include "render/OpenGL/BindStateOpenGL.h"
 #include "render/OpenGL/BufferObjectOpenGL.h"
+#include "render/OpenGL/InstanceRingBufferOpenGL.h"
+
+#include "render/FrameStatistics.h"
 
 namespace Sketch3D {
 
+/**
+ * Returns the bucket in which a draw is grouped: 0 for the buffer objects outside of a geometry pool, one past the
+ * index of their pool otherwise
+ */
+static size_t GetGeometryPoolBucket(const MultiDrawCommand_t& command) {
+    GeometryPoolOpenGL* geometryPool = static_cast<BufferObjectOpenGL*>(command.bufferObject)->GetGeometryPool();
+    return (geometryPool != nullptr) ? geometryPool->GetIndex() + 1 : 0;
+}
+
+BufferObjectManagerOpenGL::BufferObjectManagerOpenGL(InstanceRingBufferOpenGL* instanceRingBuffer, BindStateOpenGL* bindState) :
+        instanceRingBuffer_(instanceRingBuffer), bindState_(bindState), indirectBuffer_(0)
+{
+}
+
+BufferObjectManagerOpenGL::~BufferObjectManagerOpenGL() {
+    for (set<BufferObject*>::iterator it = bufferObjects_.begin(); it != bufferObjects_.end(); ++it) {
+        delete *it;
+    }
+    bufferObjects_.clear();
+
+    map<pair<VertexAttributesMap_t, int>, GeometryPoolOpenGL*>::iterator it = geometryPools_.begin();
+    for (; it != geometryPools_.end(); ++it) {
+        delete it->second;
+    }
+
+    bindState_->DeleteBuffer(indirectBuffer_);
+}
+
 BufferObject* BufferObjectManagerOpenGL::CreateBufferObject(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage) {
-    BufferObject* buffer = new BufferObjectOpenGL(vertexAttributes, usage);
+    BufferObject* buffer = new BufferObjectOpenGL(this, vertexAttributes, usage);
     bufferObjects_.insert(buffer);
     return buffer;
 }
 
-}
\ No newline at end of file
+void BufferObjectManagerOpenGL::RenderMultiDraw(const MultiDrawCommand_t* commands, size_t numCommands, const vector<Matrix4x4>& modelMatrices) {
+    if (numCommands == 0 || modelMatrices.empty()) {
+        return;
+    }
+
+    // The draws read their model matrices starting at their base instance
+    size_t firstInstance = instanceRingBuffer_->Write(&modelMatrices[0], modelMatrices.size());
+
+    // The draws all use the same shader and textures, so they can be reordered. They are grouped by geometry pool with
+    // a counting sort, which keeps their order within a pool
+    bucketOffsets_.assign(geometryPools_.size() + 1, 0);
+    for (size_t i = 0; i < numCommands; i++) {
+        bucketOffsets_[GetGeometryPoolBucket(commands[i])] += 1;
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < bucketOffsets_.size(); i++) {
+        size_t numBucketCommands = bucketOffsets_[i];
+        bucketOffsets_[i] = offset;
+        offset += numBucketCommands;
+    }
+
+    sortedCommands_.resize(numCommands);
+    for (size_t i = 0; i < numCommands; i++) {
+        sortedCommands_[bucketOffsets_[GetGeometryPoolBucket(commands[i])]++] = commands[i];
+    }
+
+    size_t i = 0;
+    while (i < sortedCommands_.size()) {
+        BufferObjectOpenGL* bufferObject = static_cast<BufferObjectOpenGL*>(sortedCommands_[i].bufferObject);
+        GeometryPoolOpenGL* geometryPool = bufferObject->GetGeometryPool();
+        if (geometryPool == nullptr) {
+            bufferObject->DrawInstances(firstInstance + sortedCommands_[i].firstInstance, sortedCommands_[i].numInstances);
+            i++;
+            continue;
+        }
+
+        // Gather the draws of the geometry pool
+        indirectCommands_.clear();
+        for (; i < sortedCommands_.size(); i++) {
+            bufferObject = static_cast<BufferObjectOpenGL*>(sortedCommands_[i].bufferObject);
+            if (bufferObject->GetGeometryPool() != geometryPool) {
+                break;
+            }
+
+            DrawElementsIndirectCommand_t command;
+            bufferObject->GetIndirectCommand(firstInstance + sortedCommands_[i].firstInstance, sortedCommands_[i].numInstances, command);
+            indirectCommands_.push_back(command);
+        }
+
+        if (indirectBuffer_ == 0) {
+            glGenBuffers(1, &indirectBuffer_);
+        }
+
+        // The buffer is orphaned so that the commands still read by the previous draws don't have to be waited for
+        geometryPool->Bind();
+        bindState_->BindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer_);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, indirectCommands_.size() * sizeof(DrawElementsIndirectCommand_t), &indirectCommands_[0], GL_STREAM_DRAW);
+        BufferUploadCounter::Add(indirectCommands_.size() * sizeof(DrawElementsIndirectCommand_t));
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, 0, indirectCommands_.size(), 0);
+    }
+}
+
+GeometryPoolOpenGL* BufferObjectManagerOpenGL::GetGeometryPool(const VertexAttributesMap_t& vertexAttributes, int presentVertexAttributes) {
+    // The draws of a pool are offset by their base vertex and read their model matrix from their base instance
+    if (!GLEW_ARB_multi_draw_indirect || !GLEW_ARB_base_instance || !GLEW_ARB_draw_elements_base_vertex || !GLEW_ARB_copy_buffer) {
+        return nullptr;
+    }
+
+    pair<VertexAttributesMap_t, int> vertexLayout(vertexAttributes, presentVertexAttributes);
+    map<pair<VertexAttributesMap_t, int>, GeometryPoolOpenGL*>::iterator it = geometryPools_.find(vertexLayout);
+    if (it != geometryPools_.end()) {
+        return it->second;
+    }
+
+    GeometryPoolOpenGL* geometryPool = new GeometryPoolOpenGL(instanceRingBuffer_, bindState_, vertexAttributes, presentVertexAttributes,
+                                                              geometryPools_.size());
+    geometryPools_[vertexLayout] = geometryPool;
+    return geometryPool;
+}
+
+}
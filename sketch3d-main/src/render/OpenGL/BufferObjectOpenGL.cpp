@@ -1,5 +1,12 @@
 #include "render/OpenGL/BufferObjectOpenGL.h"
 
+#include "render/OpenGL/BindStateOpenGL.h"
+#include "render/OpenGL/BufferObjectManagerOpenGL.h"
+#include "render/OpenGL/GeometryPoolOpenGL.h"
+#include "render/OpenGL/InstanceRingBufferOpenGL.h"
+
+#include "render/FrameStatistics.h"
+
 #include "math/Matrix4x4.h"
 #include "math/Vector2.h"
 #include "math/Vector3.h"
@@ -7,48 +14,79 @@
 
 namespace Sketch3D {
 
-BufferObjectOpenGL::BufferObjectOpenGL(const VertexAttributesMap_t& vertexAttributes, BufferUsage_t usage) : BufferObject(vertexAttributes, usage),
-        vao_(0), vbo_(0), ibo_(0), instanceBuffer_(0)
+BufferObjectOpenGL::BufferObjectOpenGL(BufferObjectManagerOpenGL* manager, const VertexAttributesMap_t& vertexAttributes,
+                                       BufferUsage_t usage) :
+        BufferObject(vertexAttributes, usage), manager_(manager), vao_(0), vbo_(0), ibo_(0),
+        instanceRingBuffer_(manager->GetInstanceRingBuffer()), bindState_(manager->GetBindState()),
+        instanceAttributeLocation_(0), instanceBufferGeneration_(0), geometryPool_(nullptr), firstVertex_(0),
+        numVertices_(0), firstIndex_(0)
 {
 }
 
 BufferObjectOpenGL::~BufferObjectOpenGL() {
-    glDeleteVertexArrays(1, &vao_);
-    glDeleteBuffers(1, &vbo_);
-    glDeleteBuffers(1, &ibo_);
-    
-    if (instanceBuffer_ != 0) {
-        glDeleteBuffers(1, &instanceBuffer_);
+    if (geometryPool_ != nullptr) {
+        geometryPool_->Free(GEOMETRY_POOL_VERTICES, firstVertex_, numVertices_);
+        geometryPool_->Free(GEOMETRY_POOL_INDICES, firstIndex_, indexCount_);
     }
+
+    bindState_->DeleteVertexArray(vao_);
+    bindState_->DeleteBuffer(vbo_);
+    bindState_->DeleteBuffer(ibo_);
 }
 
 void BufferObjectOpenGL::Render() {
-    glBindVertexArray(vao_);
+    if (geometryPool_ != nullptr) {
+        geometryPool_->Bind();
+        glDrawElementsBaseVertex(GL_TRIANGLES, indexCount_, GL_UNSIGNED_SHORT, (const void*)(firstIndex_ * sizeof(unsigned short)), firstVertex_);
+        return;
+    }
+
+    bindState_->BindVertexArray(vao_);
     glDrawElements(GL_TRIANGLES, indexCount_, GL_UNSIGNED_SHORT, 0);
 }
 
 void BufferObjectOpenGL::RenderInstances(const vector<Matrix4x4>& modelMatrices) {
-    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Matrix4x4) * modelMatrices.size(), &modelMatrices[0], GL_DYNAMIC_DRAW);
+    if (modelMatrices.empty()) {
+        return;
+    }
 
-    glBindVertexArray(vao_);
+    size_t firstInstance = instanceRingBuffer_->Write(&modelMatrices[0], modelMatrices.size());
+    DrawInstances(firstInstance, modelMatrices.size());
+}
 
-    glDrawElementsInstanced(GL_TRIANGLES, indexCount_, GL_UNSIGNED_SHORT, 0, modelMatrices.size());
+void BufferObjectOpenGL::DrawInstances(size_t firstInstance, size_t numInstances) {
+    if (geometryPool_ != nullptr) {
+        geometryPool_->Bind();
+        glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, indexCount_, GL_UNSIGNED_SHORT, (const void*)(firstIndex_ * sizeof(unsigned short)),
+                                                      numInstances, firstVertex_, firstInstance);
+        return;
+    }
+
+    bindState_->BindVertexArray(vao_);
+
+    // Without base instance support, the attributes have to be moved to the matrices of this draw call
+    if (GLEW_ARB_base_instance) {
+        if (instanceBufferGeneration_ != instanceRingBuffer_->GetGeneration()) {
+            SetInstanceAttributes(0);
+        }
+
+        glDrawElementsInstancedBaseInstance(GL_TRIANGLES, indexCount_, GL_UNSIGNED_SHORT, 0, numInstances, firstInstance);
+    } else {
+        SetInstanceAttributes(firstInstance);
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount_, GL_UNSIGNED_SHORT, 0, numInstances);
+    }
 }
 
-BufferObjectError_t BufferObjectOpenGL::SetVertexData(const vector<float>& vertexData, int presentVertexAttributes) {
-    bool hasNormals = ((presentVertexAttributes & VERTEX_ATTRIBUTES_NORMAL) > 0);
-    bool hasTexCoords = ((presentVertexAttributes & VERTEX_ATTRIBUTES_TEX_COORDS) > 0);
-    bool hasTangents = ((presentVertexAttributes & VERTEX_ATTRIBUTES_TANGENT) > 0);
-    bool hasBones = ((presentVertexAttributes & VERTEX_ATTRIBUTES_BONES) > 0);
-    bool hasWeights = ((presentVertexAttributes & VERTEX_ATTRIBUTES_WEIGHTS) > 0);
+void BufferObjectOpenGL::GetIndirectCommand(size_t firstInstance, size_t numInstances, DrawElementsIndirectCommand_t& command) const {
+    command.count = indexCount_;
+    command.instanceCount = numInstances;
+    command.firstIndex = firstIndex_;
+    command.baseVertex = firstVertex_;
+    command.baseInstance = firstInstance;
+}
 
-    stride_ = sizeof(Vector3) +
-                ((hasNormals) ? sizeof(Vector3) : 0) +
-                ((hasTexCoords) ? sizeof(Vector2) : 0) +
-                ((hasTangents) ? sizeof(Vector3) : 0) +
-                ((hasBones) ? sizeof(Vector4) : 0) +
-                ((hasWeights) ? sizeof(Vector4) : 0);
+BufferObjectError_t BufferObjectOpenGL::SetVertexData(const vector<float>& vertexData, int presentVertexAttributes) {
+    stride_ = ComputeVertexStride(presentVertexAttributes);
 
     if ( (vertexData.size() / (stride_ / sizeof(float))) > 65535) {
         return BUFFER_OBJECT_ERROR_NOT_ENOUGH_SPACE;
@@ -56,6 +94,33 @@ BufferObjectError_t BufferObjectOpenGL::SetVertexData(const vector<float>& verte
         return BUFFER_OBJECT_ERROR_INVALID_VERTEX_ATTRIBUTES;
     }
 
+    // Static geometry goes in the pool of its vertex layout so that it can be drawn along with the other buffer objects
+    // of the pool. The buffer objects that already have their own buffers keep them
+    GeometryPoolOpenGL* geometryPool = nullptr;
+    if (usage_ == BUFFER_USAGE_STATIC && vao_ == 0) {
+        geometryPool = manager_->GetGeometryPool(vertexAttributes_, presentVertexAttributes);
+    }
+
+    if (geometryPool != nullptr) {
+        if (geometryPool != geometryPool_) {
+            MoveToGeometryPool(geometryPool);
+        }
+
+        size_t numVertices = vertexData.size() / (stride_ / sizeof(float));
+        if (numVertices != numVertices_) {
+            geometryPool_->Free(GEOMETRY_POOL_VERTICES, firstVertex_, numVertices_);
+            firstVertex_ = geometryPool_->Allocate(GEOMETRY_POOL_VERTICES, numVertices);
+            numVertices_ = numVertices;
+        }
+
+        if (numVertices > 0) {
+            geometryPool_->Upload(GEOMETRY_POOL_VERTICES, firstVertex_, &vertexData[0], numVertices);
+        }
+
+        vertexCount_ = vertexData.size();
+        return BUFFER_OBJECT_ERROR_NONE;
+    }
+
     GenerateBuffers();
 
     // We want to allocate data for a new buffer if there's nothing in there or if the new data that we want to put in
@@ -64,88 +129,22 @@ BufferObjectError_t BufferObjectOpenGL::SetVertexData(const vector<float>& verte
         vertexCount_ = vertexData.size();
 
         // We first bind the vertex array object nad then bind the two other buffers
-        glBindVertexArray(vao_);
+        bindState_->BindVertexArray(vao_);
 
         // Vertex buffer object
         int type = (usage_ == BUFFER_USAGE_STATIC) ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
-	    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+	    bindState_->BindBuffer(GL_ARRAY_BUFFER, vbo_);
 	    glBufferData(GL_ARRAY_BUFFER, vertexCount_ * sizeof(float), &vertexData[0], type);
+        BufferUploadCounter::Add(vertexCount_ * sizeof(float));
 
-        // Calculate offset and array index depending on vertex attributes provided by the user
-        map<size_t, VertexAttributes_t> attributesFromIndex;
-        VertexAttributesMap_t::iterator it = vertexAttributes_.begin();
-        for (; it != vertexAttributes_.end(); ++it) {
-            attributesFromIndex[it->second] = it->first;
-        }
-
-        size_t cumulativeOffset = 0;
-        map<size_t, VertexAttributes_t>::iterator v_it = attributesFromIndex.begin();
-        for (; v_it != attributesFromIndex.end(); ++v_it) {
-            size_t size = 0;
-            size_t offset = 0;
-
-            switch (v_it->second) {
-                case VERTEX_ATTRIBUTES_POSITION:
-                    size = 3;
-                    offset = sizeof(Vector3);
-                    break;
-
-                case VERTEX_ATTRIBUTES_NORMAL:
-                    if (!hasNormals) {
-                        continue;
-                    }
-
-                    size = 3;
-                    offset = sizeof(Vector3);
-                    break;
-
-                case VERTEX_ATTRIBUTES_TEX_COORDS:
-                    if (!hasTexCoords) {
-                        continue;
-                    }
-
-                    size = 2;
-                    offset = sizeof(Vector2);
-                    break;
-
-                case VERTEX_ATTRIBUTES_TANGENT:
-                    if (!hasTangents) {
-                        continue;
-                    }
-
-                    size = 3;
-                    offset = sizeof(Vector3);
-                    break;
-
-                case VERTEX_ATTRIBUTES_BONES:
-                    if (!hasBones) {
-                        continue;
-                    }
-                    
-                    size = 4;
-                    offset = sizeof(Vector4);
-                    break;
-
-                case VERTEX_ATTRIBUTES_WEIGHTS:
-                    if (!hasWeights) {
-                        continue;
-                    }
-
-                    size = 4;
-                    offset = sizeof(Vector4);
-                    break;
-            }
-
-            glEnableVertexAttribArray(v_it->first);
-            glVertexAttribPointer(v_it->first, size, GL_FLOAT, GL_FALSE, stride_, (void*)cumulativeOffset);
-            cumulativeOffset += offset;
-        }
+        SetVertexAttributePointers(vertexAttributes_, presentVertexAttributes);
     }
 
     // Otherwise, we want to simple change the data without reallocating everything
     else {
-	    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+	    bindState_->BindBuffer(GL_ARRAY_BUFFER, vbo_);
         glBufferSubData(GL_ARRAY_BUFFER, 0, vertexData.size() * sizeof(float), &vertexData[0]);
+        BufferUploadCounter::Add(vertexData.size() * sizeof(float));
     }
 
     return BUFFER_OBJECT_ERROR_NONE;
@@ -162,12 +161,26 @@ BufferObjectError_t BufferObjectOpenGL::AppendVertexData(const vector<float>& ve
         return BUFFER_OBJECT_ERROR_INVALID_VERTEX_ATTRIBUTES;
     }
 
+    // The vertices are moved to a range of the pool big enough for the appended ones
+    if (geometryPool_ != nullptr) {
+        size_t numVertices = vertexData.size() / (stride_ / sizeof(float));
+        size_t firstVertex = geometryPool_->Allocate(GEOMETRY_POOL_VERTICES, numVertices_ + numVertices);
+        geometryPool_->Copy(GEOMETRY_POOL_VERTICES, firstVertex_, firstVertex, numVertices_);
+        geometryPool_->Upload(GEOMETRY_POOL_VERTICES, firstVertex + numVertices_, &vertexData[0], numVertices);
+        geometryPool_->Free(GEOMETRY_POOL_VERTICES, firstVertex_, numVertices_);
+
+        firstVertex_ = firstVertex;
+        numVertices_ += numVertices;
+        vertexCount_ += vertexData.size();
+        return BUFFER_OBJECT_ERROR_NONE;
+    }
+
     // We have to copy the buffer that we have, reallocate the space for it, append the data and copy back the new array
     size_t newSize = vertexCount_ + vertexData.size();
     vector<float> newVertexData;
     newVertexData.resize(newSize);
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    bindState_->BindBuffer(GL_ARRAY_BUFFER, vbo_);
     glGetBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount_ * sizeof(float), &newVertexData[0]);
 
     size_t idx = 0;
@@ -178,20 +191,36 @@ BufferObjectError_t BufferObjectOpenGL::AppendVertexData(const vector<float>& ve
     vertexCount_ = newSize;
     int type = (usage_ == BUFFER_USAGE_STATIC) ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
     glBufferData(GL_ARRAY_BUFFER, vertexCount_ * sizeof(float), &newVertexData[0], type);
+    BufferUploadCounter::Add(vertexCount_ * sizeof(float));
 
     return BUFFER_OBJECT_ERROR_NONE;
 }
 
 BufferObjectError_t BufferObjectOpenGL::SetIndexData(unsigned short* indexData, size_t numIndex) {
+    if (geometryPool_ != nullptr) {
+        if (numIndex != indexCount_) {
+            geometryPool_->Free(GEOMETRY_POOL_INDICES, firstIndex_, indexCount_);
+            firstIndex_ = geometryPool_->Allocate(GEOMETRY_POOL_INDICES, numIndex);
+            indexCount_ = numIndex;
+        }
+
+        if (numIndex > 0) {
+            geometryPool_->Upload(GEOMETRY_POOL_INDICES, firstIndex_, indexData, numIndex);
+        }
+
+        return BUFFER_OBJECT_ERROR_NONE;
+    }
+
     GenerateBuffers();
 
     indexCount_ = numIndex;
 
-    glBindVertexArray(vao_);
+    bindState_->BindVertexArray(vao_);
 
     // Index buffer object
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_);
+	bindState_->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount_ * sizeof(unsigned short), indexData, GL_STATIC_DRAW);
+    BufferUploadCounter::Add(indexCount_ * sizeof(unsigned short));
 
     return BUFFER_OBJECT_ERROR_NONE;
 }
@@ -201,12 +230,25 @@ BufferObjectError_t BufferObjectOpenGL::AppendIndexData(unsigned short* indexDat
         return SetIndexData(indexData, numIndex);
     }
 
+    if (geometryPool_ != nullptr) {
+        size_t firstIndex = geometryPool_->Allocate(GEOMETRY_POOL_INDICES, indexCount_ + numIndex);
+        geometryPool_->Copy(GEOMETRY_POOL_INDICES, firstIndex_, firstIndex, indexCount_);
+        geometryPool_->Upload(GEOMETRY_POOL_INDICES, firstIndex + indexCount_, indexData, numIndex);
+        geometryPool_->Free(GEOMETRY_POOL_INDICES, firstIndex_, indexCount_);
+
+        firstIndex_ = firstIndex;
+        indexCount_ += numIndex;
+        return BUFFER_OBJECT_ERROR_NONE;
+    }
+
     // We have to copy the buffer that we have, reallocate the space for it, append the data and copy back the new array
     size_t newSize = indexCount_ + numIndex;
     vector<unsigned int> newIndexData;
     newIndexData.resize(newSize);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_);
+    // The element array buffer binding belongs to the vertex array object
+    bindState_->BindVertexArray(vao_);
+    bindState_->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_);
     glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexCount_ * sizeof(unsigned short), &newIndexData[0]);
 
     size_t idx = 0;
@@ -216,35 +258,132 @@ BufferObjectError_t BufferObjectOpenGL::AppendIndexData(unsigned short* indexDat
 
     indexCount_ = newSize;
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount_ * sizeof(unsigned short), &newIndexData[0], GL_STATIC_DRAW);
+    BufferUploadCounter::Add(indexCount_ * sizeof(unsigned short));
     
     return BUFFER_OBJECT_ERROR_NONE;
 }
 
 void BufferObjectOpenGL::PrepareInstanceBuffers() {
-    if (instanceBuffer_ != 0) {
+    // The vertex array object of the geometry pools always has the instance attributes
+    if (instanceAttributeLocation_ != 0 || geometryPool_ != nullptr) {
         return;
     }
 
-    glGenBuffers(1, &instanceBuffer_);
+    instanceAttributeLocation_ = GetInstanceAttributeLocation(vertexAttributes_);
+
+    bindState_->BindVertexArray(vao_);
+    for (size_t i = 0; i < 4; i++) {
+        glEnableVertexAttribArray(instanceAttributeLocation_ + i);
+        glVertexAttribDivisor(instanceAttributeLocation_ + i, 1);
+    }
+
+    SetInstanceAttributes(0);
+}
 
-    glBindVertexArray(vao_);
-    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer_);
+size_t BufferObjectOpenGL::ComputeVertexStride(int presentVertexAttributes) {
+    bool hasNormals = ((presentVertexAttributes & VERTEX_ATTRIBUTES_NORMAL) > 0);
+    bool hasTexCoords = ((presentVertexAttributes & VERTEX_ATTRIBUTES_TEX_COORDS) > 0);
+    bool hasTangents = ((presentVertexAttributes & VERTEX_ATTRIBUTES_TANGENT) > 0);
+    bool hasBones = ((presentVertexAttributes & VERTEX_ATTRIBUTES_BONES) > 0);
+    bool hasWeights = ((presentVertexAttributes & VERTEX_ATTRIBUTES_WEIGHTS) > 0);
+
+    return sizeof(Vector3) +
+            ((hasNormals) ? sizeof(Vector3) : 0) +
+            ((hasTexCoords) ? sizeof(Vector2) : 0) +
+            ((hasTangents) ? sizeof(Vector3) : 0) +
+            ((hasBones) ? sizeof(Vector4) : 0) +
+            ((hasWeights) ? sizeof(Vector4) : 0);
+}
+
+void BufferObjectOpenGL::SetVertexAttributePointers(const VertexAttributesMap_t& vertexAttributes, int presentVertexAttributes) {
+    bool hasNormals = ((presentVertexAttributes & VERTEX_ATTRIBUTES_NORMAL) > 0);
+    bool hasTexCoords = ((presentVertexAttributes & VERTEX_ATTRIBUTES_TEX_COORDS) > 0);
+    bool hasTangents = ((presentVertexAttributes & VERTEX_ATTRIBUTES_TANGENT) > 0);
+    bool hasBones = ((presentVertexAttributes & VERTEX_ATTRIBUTES_BONES) > 0);
+    bool hasWeights = ((presentVertexAttributes & VERTEX_ATTRIBUTES_WEIGHTS) > 0);
+    size_t stride = ComputeVertexStride(presentVertexAttributes);
 
-    // Populate the buffer with the model matrices
+    // Calculate offset and array index depending on vertex attributes provided by the user
+    map<size_t, VertexAttributes_t> attributesFromIndex;
+    VertexAttributesMap_t::const_iterator it = vertexAttributes.begin();
+    for (; it != vertexAttributes.end(); ++it) {
+        attributesFromIndex[it->second] = it->first;
+    }
+
+    size_t cumulativeOffset = 0;
+    map<size_t, VertexAttributes_t>::iterator v_it = attributesFromIndex.begin();
+    for (; v_it != attributesFromIndex.end(); ++v_it) {
+        size_t size = 0;
+        size_t offset = 0;
+
+        switch (v_it->second) {
+            case VERTEX_ATTRIBUTES_POSITION:
+                size = 3;
+                offset = sizeof(Vector3);
+                break;
+
+            case VERTEX_ATTRIBUTES_NORMAL:
+                if (!hasNormals) {
+                    continue;
+                }
+
+                size = 3;
+                offset = sizeof(Vector3);
+                break;
+
+            case VERTEX_ATTRIBUTES_TEX_COORDS:
+                if (!hasTexCoords) {
+                    continue;
+                }
+
+                size = 2;
+                offset = sizeof(Vector2);
+                break;
+
+            case VERTEX_ATTRIBUTES_TANGENT:
+                if (!hasTangents) {
+                    continue;
+                }
+
+                size = 3;
+                offset = sizeof(Vector3);
+                break;
+
+            case VERTEX_ATTRIBUTES_BONES:
+                if (!hasBones) {
+                    continue;
+                }
+
+                size = 4;
+                offset = sizeof(Vector4);
+                break;
+
+            case VERTEX_ATTRIBUTES_WEIGHTS:
+                if (!hasWeights) {
+                    continue;
+                }
+
+                size = 4;
+                offset = sizeof(Vector4);
+                break;
+        }
+
+        glEnableVertexAttribArray(v_it->first);
+        glVertexAttribPointer(v_it->first, size, GL_FLOAT, GL_FALSE, stride, (void*)cumulativeOffset);
+        cumulativeOffset += offset;
+    }
+}
+
+GLuint BufferObjectOpenGL::GetInstanceAttributeLocation(const VertexAttributesMap_t& vertexAttributes) {
     size_t attributeLocation = 0;
-    VertexAttributesMap_t::iterator it = vertexAttributes_.begin();
-    for (; it != vertexAttributes_.end(); ++it) {
+    VertexAttributesMap_t::const_iterator it = vertexAttributes.begin();
+    for (; it != vertexAttributes.end(); ++it) {
         if (it->second > attributeLocation) {
             attributeLocation = it->second;
         }
     }
-    attributeLocation += 1;
 
-    for (size_t i = 0; i < 4; i++) {
-        glEnableVertexAttribArray(attributeLocation + i);
-        glVertexAttribPointer(attributeLocation + i, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix4x4), (const void*)(sizeof(GLfloat) * i * 4));
-        glVertexAttribDivisor(attributeLocation + i, 1);
-    }
+    return attributeLocation + 1;
 }
 
 void BufferObjectOpenGL::GenerateBuffers() {
@@ -261,4 +400,36 @@ void BufferObjectOpenGL::GenerateBuffers() {
     }
 }
 
+void BufferObjectOpenGL::MoveToGeometryPool(GeometryPoolOpenGL* geometryPool) {
+    vector<unsigned short> indices(indexCount_);
+    if (geometryPool_ != nullptr) {
+        if (indexCount_ > 0) {
+            geometryPool_->Download(GEOMETRY_POOL_INDICES, firstIndex_, &indices[0], indexCount_);
+        }
+
+        geometryPool_->Free(GEOMETRY_POOL_VERTICES, firstVertex_, numVertices_);
+        geometryPool_->Free(GEOMETRY_POOL_INDICES, firstIndex_, indexCount_);
+    }
+
+    geometryPool_ = geometryPool;
+    firstVertex_ = 0;
+    numVertices_ = 0;
+    firstIndex_ = geometryPool_->Allocate(GEOMETRY_POOL_INDICES, indexCount_);
+    if (indexCount_ > 0) {
+        geometryPool_->Upload(GEOMETRY_POOL_INDICES, firstIndex_, &indices[0], indexCount_);
+    }
+}
+
+void BufferObjectOpenGL::SetInstanceAttributes(size_t firstInstance) {
+    bindState_->BindBuffer(GL_ARRAY_BUFFER, instanceRingBuffer_->GetBuffer());
+
+    size_t offset = firstInstance * sizeof(Matrix4x4);
+    for (size_t i = 0; i < 4; i++) {
+        glVertexAttribPointer(instanceAttributeLocation_ + i, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix4x4),
+                              (const void*)(offset + sizeof(GLfloat) * i * 4));
+    }
+
+    instanceBufferGeneration_ = instanceRingBuffer_->GetGeneration();
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include "render/OpenGL/GeometryPoolOpenGL.h"
+
+#include "render/OpenGL/BindStateOpenGL.h"
+#include "render/OpenGL/BufferObjectOpenGL.h"
+#include "render/OpenGL/InstanceRingBufferOpenGL.h"
+
+#include "render/FrameStatistics.h"
+
+#include "math/Matrix4x4.h"
+
+#include "system/Logger.h"
+
+#include <algorithm>
+
+namespace Sketch3D {
+
+// Number of vertices and indices that a new pool can hold before it has to grow
+const size_t GEOMETRY_POOL_INITIAL_VERTICES = 65536;
+const size_t GEOMETRY_POOL_INITIAL_INDICES = 3 * 65536;
+
+GeometryPoolOpenGL::GeometryPoolOpenGL(InstanceRingBufferOpenGL* instanceRingBuffer, BindStateOpenGL* bindState,
+                                       const VertexAttributesMap_t& vertexAttributes, int presentVertexAttributes, size_t index) :
+        instanceRingBuffer_(instanceRingBuffer), bindState_(bindState), vertexAttributes_(vertexAttributes),
+        presentVertexAttributes_(presentVertexAttributes), index_(index), vao_(0), instanceBufferGeneration_(0)
+{
+    elementSizes_[GEOMETRY_POOL_VERTICES] = BufferObjectOpenGL::ComputeVertexStride(presentVertexAttributes);
+    elementSizes_[GEOMETRY_POOL_INDICES] = sizeof(unsigned short);
+    capacities_[GEOMETRY_POOL_VERTICES] = GEOMETRY_POOL_INITIAL_VERTICES;
+    capacities_[GEOMETRY_POOL_INDICES] = GEOMETRY_POOL_INITIAL_INDICES;
+
+    glGenVertexArrays(1, &vao_);
+    for (size_t i = 0; i < GEOMETRY_POOL_STORAGE_COUNT; i++) {
+        buffers_[i] = 0;
+        ends_[i] = 0;
+        CreateBuffer((GeometryPoolStorage_t)i);
+    }
+
+    // The model matrix of the draws comes after the vertex attributes
+    instanceAttributeLocation_ = BufferObjectOpenGL::GetInstanceAttributeLocation(vertexAttributes_);
+    for (size_t i = 0; i < 4; i++) {
+        glEnableVertexAttribArray(instanceAttributeLocation_ + i);
+        glVertexAttribDivisor(instanceAttributeLocation_ + i, 1);
+    }
+}
+
+GeometryPoolOpenGL::~GeometryPoolOpenGL() {
+    bindState_->DeleteVertexArray(vao_);
+    for (size_t i = 0; i < GEOMETRY_POOL_STORAGE_COUNT; i++) {
+        bindState_->DeleteBuffer(buffers_[i]);
+    }
+}
+
+size_t GeometryPoolOpenGL::Allocate(GeometryPoolStorage_t storage, size_t numElements) {
+    if (numElements == 0) {
+        return 0;
+    }
+
+    // Take the first free range big enough
+    vector<pair<size_t, size_t> >& freeRanges = freeRanges_[storage];
+    for (size_t i = 0; i < freeRanges.size(); i++) {
+        if (freeRanges[i].second >= numElements) {
+            size_t firstElement = freeRanges[i].first;
+            freeRanges[i].first += numElements;
+            freeRanges[i].second -= numElements;
+
+            if (freeRanges[i].second == 0) {
+                freeRanges.erase(freeRanges.begin() + i);
+            }
+
+            return firstElement;
+        }
+    }
+
+    // Otherwise, allocate after the last range
+    if (ends_[storage] + numElements > capacities_[storage]) {
+        Grow(storage, ends_[storage] + numElements);
+    }
+
+    size_t firstElement = ends_[storage];
+    ends_[storage] += numElements;
+    return firstElement;
+}
+
+void GeometryPoolOpenGL::Free(GeometryPoolStorage_t storage, size_t firstElement, size_t numElements) {
+    if (numElements == 0) {
+        return;
+    }
+
+    vector<pair<size_t, size_t> >& freeRanges = freeRanges_[storage];
+    vector<pair<size_t, size_t> >::iterator it = lower_bound(freeRanges.begin(), freeRanges.end(), make_pair(firstElement, (size_t)0));
+    it = freeRanges.insert(it, make_pair(firstElement, numElements));
+
+    // Merge the range with its neighbours so that the big allocations can reuse them
+    vector<pair<size_t, size_t> >::iterator next = it + 1;
+    if (next != freeRanges.end() && it->first + it->second == next->first) {
+        it->second += next->second;
+        freeRanges.erase(next);
+    }
+
+    if (it != freeRanges.begin()) {
+        vector<pair<size_t, size_t> >::iterator previous = it - 1;
+        if (previous->first + previous->second == it->first) {
+            previous->second += it->second;
+            freeRanges.erase(it);
+            it = previous;
+        }
+    }
+
+    // The last range is given back to the end of the buffer
+    if (it->first + it->second == ends_[storage]) {
+        ends_[storage] = it->first;
+        freeRanges.erase(it);
+    }
+}
+
+void GeometryPoolOpenGL::Upload(GeometryPoolStorage_t storage, size_t firstElement, const void* data, size_t numElements) {
+    bindState_->BindBuffer(GL_COPY_WRITE_BUFFER, buffers_[storage]);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, firstElement * elementSizes_[storage], numElements * elementSizes_[storage], data);
+    BufferUploadCounter::Add(numElements * elementSizes_[storage]);
+}
+
+void GeometryPoolOpenGL::Download(GeometryPoolStorage_t storage, size_t firstElement, void* data, size_t numElements) {
+    bindState_->BindBuffer(GL_COPY_READ_BUFFER, buffers_[storage]);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, firstElement * elementSizes_[storage], numElements * elementSizes_[storage], data);
+}
+
+void GeometryPoolOpenGL::Copy(GeometryPoolStorage_t storage, size_t sourceElement, size_t destinationElement, size_t numElements) {
+    if (numElements == 0) {
+        return;
+    }
+
+    bindState_->BindBuffer(GL_COPY_READ_BUFFER, buffers_[storage]);
+    bindState_->BindBuffer(GL_COPY_WRITE_BUFFER, buffers_[storage]);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceElement * elementSizes_[storage],
+                        destinationElement * elementSizes_[storage], numElements * elementSizes_[storage]);
+}
+
+void GeometryPoolOpenGL::Bind() {
+    bindState_->BindVertexArray(vao_);
+
+    // The ring buffer was replaced by a bigger one
+    if (instanceBufferGeneration_ != instanceRingBuffer_->GetGeneration()) {
+        bindState_->BindBuffer(GL_ARRAY_BUFFER, instanceRingBuffer_->GetBuffer());
+        for (size_t i = 0; i < 4; i++) {
+            glVertexAttribPointer(instanceAttributeLocation_ + i, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix4x4),
+                                  (const void*)(sizeof(GLfloat) * i * 4));
+        }
+
+        instanceBufferGeneration_ = instanceRingBuffer_->GetGeneration();
+    }
+}
+
+void GeometryPoolOpenGL::Grow(GeometryPoolStorage_t storage, size_t numElements) {
+    size_t capacity = capacities_[storage] * 2;
+    while (capacity < numElements) {
+        capacity *= 2;
+    }
+
+    Logger::GetInstance()->Debug("Growing a geometry pool");
+
+    // The draw calls already issued keep using the old buffer, the driver deletes it once they are done
+    GLuint oldBuffer = buffers_[storage];
+    capacities_[storage] = capacity;
+    CreateBuffer(storage);
+
+    if (ends_[storage] > 0) {
+        bindState_->BindBuffer(GL_COPY_READ_BUFFER, oldBuffer);
+        bindState_->BindBuffer(GL_COPY_WRITE_BUFFER, buffers_[storage]);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, ends_[storage] * elementSizes_[storage]);
+    }
+
+    bindState_->DeleteBuffer(oldBuffer);
+}
+
+void GeometryPoolOpenGL::CreateBuffer(GeometryPoolStorage_t storage) {
+    glGenBuffers(1, &buffers_[storage]);
+
+    // The element array buffer binding belongs to the vertex array object
+    bindState_->BindVertexArray(vao_);
+    if (storage == GEOMETRY_POOL_VERTICES) {
+        bindState_->BindBuffer(GL_ARRAY_BUFFER, buffers_[storage]);
+        glBufferData(GL_ARRAY_BUFFER, capacities_[storage] * elementSizes_[storage], NULL, GL_STATIC_DRAW);
+        BufferObjectOpenGL::SetVertexAttributePointers(vertexAttributes_, presentVertexAttributes_);
+    } else {
+        bindState_->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers_[storage]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, capacities_[storage] * elementSizes_[storage], NULL, GL_STATIC_DRAW);
+    }
+}
+
+}
@@ -0,0 +1,151 @@
+#include "render/OpenGL/InstanceRingBufferOpenGL.h"
+
+#include "render/OpenGL/BindStateOpenGL.h"
+
+#include "render/FrameStatistics.h"
+
+#include "math/Matrix4x4.h"
+
+#include "system/Logger.h"
+
+#include <string.h>
+
+namespace Sketch3D {
+
+// Time waited by glClientWaitSync before checking the fence again, in nanoseconds
+const GLuint64 FENCE_WAIT_TIMEOUT = 1000000;
+
+InstanceRingBufferOpenGL::InstanceRingBufferOpenGL(BindStateOpenGL* bindState, size_t instancesPerRegion) : bindState_(bindState),
+        buffer_(0), instancesPerRegion_(instancesPerRegion), currentRegion_(0), numWrittenInstances_(0), isRegionReady_(false), mappedData_(nullptr), generation_(0)
+{
+    for (size_t i = 0; i < NUM_INSTANCE_RING_BUFFER_REGIONS; i++) {
+        fences_[i] = 0;
+    }
+
+    CreateBuffer();
+}
+
+InstanceRingBufferOpenGL::~InstanceRingBufferOpenGL() {
+    DeleteBuffer();
+}
+
+size_t InstanceRingBufferOpenGL::Write(const Matrix4x4* matrices, size_t numMatrices) {
+    if (numWrittenInstances_ + numMatrices > instancesPerRegion_) {
+        // The draw calls already issued keep using the old buffer, the driver deletes it once they are done
+        size_t instancesPerRegion = instancesPerRegion_ * 2;
+        while (instancesPerRegion < numWrittenInstances_ + numMatrices) {
+            instancesPerRegion *= 2;
+        }
+
+        Logger::GetInstance()->Debug("Growing the instance ring buffer");
+        DeleteBuffer();
+        instancesPerRegion_ = instancesPerRegion;
+        CreateBuffer();
+    }
+
+    PrepareRegion();
+
+    size_t firstInstance = currentRegion_ * instancesPerRegion_ + numWrittenInstances_;
+    size_t offset = firstInstance * sizeof(Matrix4x4);
+    size_t size = numMatrices * sizeof(Matrix4x4);
+
+    if (mappedData_ != nullptr) {
+        memcpy(mappedData_ + offset, matrices, size);
+    } else {
+        bindState_->BindBuffer(GL_ARRAY_BUFFER, buffer_);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, matrices);
+    }
+
+    numWrittenInstances_ += numMatrices;
+    BufferUploadCounter::Add(size);
+    return firstInstance;
+}
+
+void InstanceRingBufferOpenGL::EndFrame() {
+    if (!isRegionReady_) {
+        return;
+    }
+
+    if (mappedData_ != nullptr) {
+        fences_[currentRegion_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    currentRegion_ = (currentRegion_ + 1) % NUM_INSTANCE_RING_BUFFER_REGIONS;
+    numWrittenInstances_ = 0;
+    isRegionReady_ = false;
+}
+
+void InstanceRingBufferOpenGL::CreateBuffer() {
+    GLsizeiptr bufferSize = NUM_INSTANCE_RING_BUFFER_REGIONS * instancesPerRegion_ * sizeof(Matrix4x4);
+
+    glGenBuffers(1, &buffer_);
+    bindState_->BindBuffer(GL_ARRAY_BUFFER, buffer_);
+
+    if (GLEW_ARB_buffer_storage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, bufferSize, nullptr, flags);
+        mappedData_ = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bufferSize, flags);
+
+        if (mappedData_ == nullptr) {
+            Logger::GetInstance()->Warning("Couldn't map the instance ring buffer, falling back to buffer orphaning");
+            bindState_->DeleteBuffer(buffer_);
+            glGenBuffers(1, &buffer_);
+            bindState_->BindBuffer(GL_ARRAY_BUFFER, buffer_);
+            glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr, GL_STREAM_DRAW);
+        }
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr, GL_STREAM_DRAW);
+    }
+
+    currentRegion_ = 0;
+    numWrittenInstances_ = 0;
+    isRegionReady_ = false;
+    generation_ += 1;
+}
+
+void InstanceRingBufferOpenGL::DeleteBuffer() {
+    for (size_t i = 0; i < NUM_INSTANCE_RING_BUFFER_REGIONS; i++) {
+        if (fences_[i] != 0) {
+            glDeleteSync(fences_[i]);
+            fences_[i] = 0;
+        }
+    }
+
+    if (mappedData_ != nullptr) {
+        bindState_->BindBuffer(GL_ARRAY_BUFFER, buffer_);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        mappedData_ = nullptr;
+    }
+
+    bindState_->DeleteBuffer(buffer_);
+    buffer_ = 0;
+}
+
+void InstanceRingBufferOpenGL::PrepareRegion() {
+    if (isRegionReady_) {
+        return;
+    }
+
+    if (mappedData_ != nullptr) {
+        // Only wait if the GPU is still reading the region, that is if it is NUM_INSTANCE_RING_BUFFER_REGIONS frames late
+        GLsync fence = fences_[currentRegion_];
+        if (fence != 0) {
+            GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            while (status == GL_TIMEOUT_EXPIRED) {
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT);
+            }
+
+            glDeleteSync(fence);
+            fences_[currentRegion_] = 0;
+        }
+    } else {
+        // Give a new storage to the buffer, the driver keeps the old one alive until the GPU is done with it
+        bindState_->BindBuffer(GL_ARRAY_BUFFER, buffer_);
+        glBufferData(GL_ARRAY_BUFFER, NUM_INSTANCE_RING_BUFFER_REGIONS * instancesPerRegion_ * sizeof(Matrix4x4), nullptr,
+                     GL_STREAM_DRAW);
+    }
+
+    isRegionReady_ = true;
+}
+
+}
@@ -3,8 +3,10 @@
 #include "render/OpenGL/gl/glew.h"
 #include "render/OpenGL/gl/gl.h"
 
+#include "render/OpenGL/BindStateOpenGL.h"
 #include "render/OpenGL/BufferObjectManagerOpenGL.h"
 #include "render/OpenGL/BufferObjectOpenGL.h"
+#include "render/OpenGL/InstanceRingBufferOpenGL.h"
 #include "render/OpenGL/RenderStateCacheOpenGL.h"
 #include "render/OpenGL/RenderTextureOpenGL.h"
 #include "render/OpenGL/ShaderOpenGL.h"
@@ -22,21 +24,20 @@
 
 namespace Sketch3D {
 
-RenderSystemOpenGL::RenderSystemOpenGL(Window& window) : RenderSystem(window), renderContext_(NULL) {
+RenderSystemOpenGL::RenderSystemOpenGL(Window& window) : RenderSystem(window), renderContext_(NULL), bindState_(NULL),
+        instanceRingBuffer_(NULL), frameConstantsBuffer_(0)
+{
 	Logger::GetInstance()->Info("Current rendering API: OpenGL");
 }
 
 RenderSystemOpenGL::~RenderSystemOpenGL() {
-    TextureUnitNode_t* node = head_;
-    TextureUnitNode_t* toDelete = nullptr;
-    while (node != nullptr) {
-        toDelete = node;
-        node = node->next;
-        delete toDelete;
-    }
-
 	Logger::GetInstance()->Info("Shutdown OpenGL");
     FreeRenderSystem();
+    delete instanceRingBuffer_;
+    if (bindState_ != NULL) {
+        bindState_->DeleteBuffer(frameConstantsBuffer_);
+    }
+    delete bindState_;
 	delete renderContext_;
 }
 
@@ -49,32 +50,28 @@ bool RenderSystemOpenGL::Initialize(const RenderParameters_t& renderParameters)
     renderContext_ = new RenderContextOpenGLUnix();
 #endif
 
-    if (!renderContext_->Initialize(window_, renderParameters)) {
+    if (!renderContext_->Initialize(*window_, renderParameters)) {
 		Logger::GetInstance()->Error("Couldn't create OpenGL context");
 		return false;
 	}
 
 	QueryDeviceCapabilities();
+    bindState_ = new BindStateOpenGL;
 
     glEnable(GL_CULL_FACE);
     glEnable(GL_TEXTURE_2D);
 
-    bufferObjectManager_ = new BufferObjectManagerOpenGL;
+    instanceRingBuffer_ = new InstanceRingBufferOpenGL(bindState_);
+    bufferObjectManager_ = new BufferObjectManagerOpenGL(instanceRingBuffer_, bindState_);
+
+    // The shared uniforms stay bound to their binding point, the shaders only have to refer to it
+    glGenBuffers(1, &frameConstantsBuffer_);
+    bindState_->BindBuffer(GL_UNIFORM_BUFFER, frameConstantsBuffer_);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstants_t), NULL, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_CONSTANTS_BINDING_POINT, frameConstantsBuffer_);
     renderStateCache_ = new RenderStateCacheOpenGL;
 
-    // Construct the texture cache
-    head_ = new TextureUnitNode_t;
-    head_->textureUnit = 0;
-    head_->prev = nullptr;
-    tail_ = head_;
-
-    for (int i = 1; i < deviceCapabilities_.maxActiveTextures_ + 1; i++) {
-        tail_->next = new TextureUnitNode_t;
-        tail_->next->prev = tail_;
-        tail_ = tail_->next;
-        tail_->textureUnit = i;
-    }
-    tail_->next = nullptr;
+    textureUnitCache_.SetNumTextureUnits(deviceCapabilities_.maxActiveTextures_);
 
     CreateTextShader();
 
@@ -99,15 +96,25 @@ void RenderSystemOpenGL::Clear(int buffer) const {
 }
 
 void RenderSystemOpenGL::StartRender() {
+    bindState_->ResetCounters();
 }
 
 void RenderSystemOpenGL::EndRender() {
 }
 
 void RenderSystemOpenGL::PresentFrame() {
+    instanceRingBuffer_->EndFrame();
     renderContext_->SwapBuffers();
 }
 
+bool RenderSystemOpenGL::MakeContextCurrent() {
+    return renderContext_->MakeCurrent();
+}
+
+void RenderSystemOpenGL::ReleaseContext() {
+    renderContext_->ReleaseCurrent();
+}
+
 Matrix4x4 RenderSystemOpenGL::OrthoProjection(float left, float right, float bottom, float top,
                                               float nearPlane, float farPlane) const
 {
@@ -151,7 +158,7 @@ void RenderSystemOpenGL::SetViewport(size_t x, size_t y, size_t width, size_t he
 }
 
 Shader* RenderSystemOpenGL::CreateShader() {
-    shaders_.push_back(new ShaderOpenGL);
+    shaders_.push_back(new ShaderOpenGL(bindState_));
     return shaders_[shaders_.size() - 1];
 }
 
@@ -164,74 +171,37 @@ Texture3D* RenderSystemOpenGL::CreateTexture3D() const {
 }
 
 RenderTexture* RenderSystemOpenGL::CreateRenderTexture(unsigned int width, unsigned int height, TextureFormat_t format) {
-    renderTextures_.push_back(new RenderTextureOpenGL(width, height, format));
+    renderTextures_.push_back(new RenderTextureOpenGL(bindState_, width, height, format));
     return renderTextures_.back();
 }
 
 void RenderSystemOpenGL::BindScreenBuffer() const {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    bindState_->BindFramebuffer(0);
     Renderer::GetInstance()->SetViewport(0, 0, width_, height_);
 }
 
-size_t RenderSystemOpenGL::BindTexture(const Texture* texture) {
-    size_t textureName;
-    GLint textureType;
-    if (texture->GetType() == TEXTURE_TYPE_2D) {
-        textureName = static_cast<const Texture2DOpenGL*>(texture)->textureName_;
-        textureType = GL_TEXTURE_2D;
-    } else {
-        textureName = static_cast<const Texture3DOpenGL*>(texture)->textureName_;
-        textureType = GL_TEXTURE_3D;
-    }
-
-    // Verify if the node is already bound
-    size_t textureUnit = 0;
-    TextureUnitNode_t* nodeToUse = head_;
-    TextureCache_t::iterator it = textureCache_.find(textureName);
+void RenderSystemOpenGL::BindTextureImpl(const Texture* texture, size_t textureUnit, bool isResident) {
+    // The texture unit is selected even if the texture is resident, since the texture may be bound to be modified
+    bindState_->ActiveTexture(textureUnit);
 
-    if (it != textureCache_.end()) {
-        nodeToUse = it->second;
-    } else {
-        glActiveTexture(GL_TEXTURE0 + nodeToUse->textureUnit);
-        glBindTexture(textureType, textureName);
-
-        textureCache_[textureName] = nodeToUse;
+    if (isResident) {
+        return;
     }
-    textureUnit = nodeToUse->textureUnit;
-
-    // Put the node to use at the end of the list if it isn't there yet
-    if (tail_ != nodeToUse) {
-        tail_->next = nodeToUse;
-
-        // Remove that node from the list since its now a duplicate
-        if (nodeToUse->prev) {
-            nodeToUse->prev->next = nodeToUse->next;
-        }
-
-        if (nodeToUse->next) {
-            nodeToUse->next->prev = nodeToUse->prev;
-        }
-
-        // Advance head if needed
-        if (nodeToUse == head_) {
-            head_ = head_->next;
-        }
 
-        tail_->next->prev = tail_;
-        tail_ = tail_->next;
-        tail_->next = nullptr;
+    if (texture->GetType() == TEXTURE_TYPE_2D) {
+        bindState_->BindTexture(GL_TEXTURE_2D, static_cast<const Texture2DOpenGL*>(texture)->textureName_);
+    } else {
+        bindState_->BindTexture(GL_TEXTURE_3D, static_cast<const Texture3DOpenGL*>(texture)->textureName_);
     }
-
-    return textureUnit;
 }
 
 void RenderSystemOpenGL::BindShader(const Shader* shader) {
     if (shader != boundShader_) {
         if (shader == nullptr) {
-            glUseProgram(0);
+            bindState_->UseProgram(0);
         } else {
             const ShaderOpenGL* shaderOpengl = static_cast<const ShaderOpenGL*>(shader);
-            glUseProgram(shaderOpengl->program_);
+            bindState_->UseProgram(shaderOpengl->program_);
         }
 
         boundShader_ = shader;
@@ -274,6 +244,18 @@ FrustumPlanes_t RenderSystemOpenGL::ExtractViewFrustumPlanes(const Matrix4x4& vi
     return frustumPlanes;
 }
 
+void RenderSystemOpenGL::SetFrameConstantsImpl() {
+    // std140 stores the matrices column after column, like GetData
+    float data[4 * 16];
+    frameConstants_.view.GetData(data);
+    frameConstants_.projection.GetData(data + 16);
+    frameConstants_.viewProjection.GetData(data + 32);
+    frameConstants_.transposedInverseView.GetData(data + 48);
+
+    bindState_->BindBuffer(GL_UNIFORM_BUFFER, frameConstantsBuffer_);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(data), data);
+}
+
 void RenderSystemOpenGL::QueryDeviceCapabilities() {
     glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &deviceCapabilities_.maxActiveTextures_);
 }
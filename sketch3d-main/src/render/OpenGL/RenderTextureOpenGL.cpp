@@ -2,6 +2,7 @@
 
 #include "render/Renderer.h"
 #include "render/TextureManager.h"
+#include "render/OpenGL/BindStateOpenGL.h"
 #include "render/OpenGL/Texture2DOpenGL.h"
 
 #include "system/Logger.h"
@@ -12,8 +13,8 @@ namespace Sketch3D {
 
 int RenderTextureOpenGL::numGeneratedTextures_ = 0;
 
-RenderTextureOpenGL::RenderTextureOpenGL(unsigned int width, unsigned int height, TextureFormat_t format) :
-        RenderTexture(width, height, format), framebuffer_(0), renderbuffer_(0)
+RenderTextureOpenGL::RenderTextureOpenGL(BindStateOpenGL* bindState, unsigned int width, unsigned int height, TextureFormat_t format) :
+        RenderTexture(width, height, format), bindState_(bindState), framebuffer_(0), renderbuffer_(0)
 {
 }
 
@@ -22,9 +23,7 @@ RenderTextureOpenGL::~RenderTextureOpenGL() {
         glDeleteRenderbuffers(1, (const GLuint*) &renderbuffer_);
     }
 
-    if (framebuffer_ != 0) {
-        glDeleteFramebuffers(1, (const GLuint*) &framebuffer_);
-    }
+    bindState_->DeleteFramebuffer(framebuffer_);
 }
 
 bool RenderTextureOpenGL::AddDepthBuffer() {   
@@ -38,13 +37,13 @@ bool RenderTextureOpenGL::AddDepthBuffer() {
         glGenFramebuffers(1, (GLuint*) &framebuffer_);
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    bindState_->BindFramebuffer(framebuffer_);
     glGenRenderbuffers(1, (GLuint*) &renderbuffer_);
     glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer_);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width_, height_);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffer_);
     glBindRenderbuffer(GL_RENDERBUFFER, 0);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    bindState_->BindFramebuffer(0);
 
     return true;
 }
@@ -89,16 +88,16 @@ bool RenderTextureOpenGL::AttachTextureToDepthBuffer(Texture2D* texture) {
         glGenFramebuffers(1, (GLuint*) &framebuffer_);
     }
     
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    bindState_->BindFramebuffer(framebuffer_);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, dynamic_cast<Texture2DOpenGL*>(texture)->textureName_, 0);
 
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
         Logger::GetInstance()->Info("Couldn't attach texture to depth buffer");
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        bindState_->BindFramebuffer(0);
         return false;
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    bindState_->BindFramebuffer(0);
     depthBufferBound_ = true;
     Logger::GetInstance()->Info("Texture successfully attached to depth buffer");
 
@@ -142,7 +141,7 @@ bool RenderTextureOpenGL::AttachTextures(const vector<Texture2D*>& textures) {
         glGenFramebuffers(1, (GLuint*) &framebuffer_);
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    bindState_->BindFramebuffer(framebuffer_);
 
     for (size_t i = 0; i < textureNames.size(); i++) {
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, textureNames[i], 0);
@@ -151,12 +150,12 @@ bool RenderTextureOpenGL::AttachTextures(const vector<Texture2D*>& textures) {
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
         texturesAttached_ = true;
         Logger::GetInstance()->Info("Render texture #" + to_string(framebuffer_) + " was succesfully created");
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        bindState_->BindFramebuffer(0);
         return true;
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glDeleteFramebuffers(1, (const GLuint*) &framebuffer_);
+    bindState_->BindFramebuffer(0);
+    bindState_->DeleteFramebuffer(framebuffer_);
     framebuffer_ = 0;
 
     Logger::GetInstance()->Error("Couldn't create render texture, frame buffer is not complete");
@@ -170,7 +169,7 @@ void RenderTextureOpenGL::Bind() const {
     }
 
     if (framebuffer_ != 0) {
-        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+        bindState_->BindFramebuffer(framebuffer_);
 
         size_t numBuffers = textures_.size();
         GLenum* buffers = new GLenum[numBuffers];
@@ -6,17 +6,19 @@
 #include "math/Vector4.h"
 
 #include "render/Renderer.h"
+#include "render/OpenGL/BindStateOpenGL.h"
 #include "render/RenderSystem.h"
 #include "render/Texture.h"
 
 #include "system/Logger.h"
 
+#include <algorithm>
 #include <fstream>
 using namespace std;
 
 namespace Sketch3D {
 
-ShaderOpenGL::ShaderOpenGL() : vertex_(0), fragment_(0) {
+ShaderOpenGL::ShaderOpenGL(BindStateOpenGL* bindState) : bindState_(bindState), vertex_(0), fragment_(0) {
     Logger::GetInstance()->Debug("OpenGL Shader creation");
     program_ = glCreateProgram();
 }
@@ -30,7 +32,7 @@ ShaderOpenGL::~ShaderOpenGL() {
         glDeleteShader(fragment_);
     }
 
-    glDeleteProgram(program_);
+    bindState_->DeleteProgram(program_);
 }
 
 bool ShaderOpenGL::SetSourceFile(const string& vertexFilename, const string& fragmentFilename) {
@@ -76,25 +78,8 @@ bool ShaderOpenGL::SetSourceFile(const string& vertexFilename, const string& fra
 	glLinkProgram(program_);
 	LogProgramErrors();
 
-    GLint numActiveUniforms;
-    char uniformName[256];
-    glGetProgramiv(program_, GL_ACTIVE_UNIFORMS, &numActiveUniforms);
-    for (int i = 0; i < numActiveUniforms; i++) {
-        GLint arraySize = 0;
-        GLenum type = 0;
-        GLsizei actualLength = 0;
-        glGetActiveUniform(program_, i, 256, &actualLength, &arraySize, &type, uniformName);
-        string name = uniformName;
-        
-        // Arrays' name are messed up
-        if (name.back() == ']') {
-            name.pop_back();
-            name.pop_back();
-            name.pop_back();
-        }
-
-        nameToUniforms_[name] = glGetUniformLocation(program_, name.c_str());
-    }
+    ReflectUniforms();
+    ResolveBuiltinUniforms();
 
     return true;
 }
@@ -132,128 +117,58 @@ bool ShaderOpenGL::SetSource(const string& vertexSource, const string& fragmentS
 	glLinkProgram(program_);
 	LogProgramErrors();
 
-    GLint numActiveUniforms;
-    char uniformName[256];
-    glGetProgramiv(program_, GL_ACTIVE_UNIFORMS, &numActiveUniforms);
-    for (int i = 0; i < numActiveUniforms; i++) {
-        GLint arraySize = 0;
-        GLenum type = 0;
-        GLsizei actualLength = 0;
-        glGetActiveUniform(program_, i, 256, &actualLength, &arraySize, &type, uniformName);
-        string name = uniformName;
-        
-        // Arrays' name are messed up
-        if (name.back() == ']') {
-            name.pop_back();
-            name.pop_back();
-            name.pop_back();
-        }
-
-        nameToUniforms_[name] = glGetUniformLocation(program_, name.c_str());
-    }
+    ReflectUniforms();
+    ResolveBuiltinUniforms();
 
     return true;
 }
 
-bool ShaderOpenGL::SetUniformInt(const string& uniformName, int value) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
+UniformHandle_t ShaderOpenGL::GetUniformHandle(const string& uniform) const {
+    unordered_map<string, UniformHandle_t>::const_iterator it = nameToUniforms_.find(uniform);
     if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
+        return INVALID_UNIFORM_HANDLE;
+    }
 
-    glUniform1i(it->second, value);
-    return true;
+    return it->second;
 }
 
-bool ShaderOpenGL::SetUniformFloat(const string& uniformName, float value) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
-    glUniform1f(it->second, value);
-    return true;
+void ShaderOpenGL::SetUniformIntImpl(UniformHandle_t uniform, int value) {
+    glUniform1i(uniformLocations_[uniform], value);
 }
 
-bool ShaderOpenGL::SetUniformVector2(const string& uniformName, float value1, float value2) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
-    glUniform2f(it->second, value1, value2);
-    return true;
+void ShaderOpenGL::SetUniformFloatImpl(UniformHandle_t uniform, float value) {
+    glUniform1f(uniformLocations_[uniform], value);
 }
 
-bool ShaderOpenGL::SetUniformVector3(const string& uniformName, const Vector3& value) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
-    glUniform3f(it->second, value.x, value.y, value.z);
-    return true;
+void ShaderOpenGL::SetUniformVector2Impl(UniformHandle_t uniform, float value1, float value2) {
+    glUniform2f(uniformLocations_[uniform], value1, value2);
 }
 
-bool ShaderOpenGL::SetUniformVector3Array(const string& uniformName, const Vector3* values, int arraySize) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
-    glUniform3fv(it->second, arraySize, (const GLfloat*) values);
-    return true;
+void ShaderOpenGL::SetUniformVector3Impl(UniformHandle_t uniform, const Vector3& value) {
+    glUniform3f(uniformLocations_[uniform], value.x, value.y, value.z);
 }
 
-bool ShaderOpenGL::SetUniformVector4(const string& uniformName, const Vector4& value) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
-    glUniform4f(it->second, value.x, value.y, value.z, value.w);
-    return true;
+void ShaderOpenGL::SetUniformVector3ArrayImpl(UniformHandle_t uniform, const Vector3* values, int arraySize) {
+    glUniform3fv(uniformLocations_[uniform], arraySize, (const GLfloat*) values);
 }
 
-bool ShaderOpenGL::SetUniformMatrix3x3(const string& uniformName, const Matrix3x3& value) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
+void ShaderOpenGL::SetUniformVector4Impl(UniformHandle_t uniform, const Vector4& value) {
+    glUniform4f(uniformLocations_[uniform], value.x, value.y, value.z, value.w);
+}
 
+void ShaderOpenGL::SetUniformMatrix3x3Impl(UniformHandle_t uniform, const Matrix3x3& value) {
     float mat[9];
     value.GetData(mat);
-    glUniformMatrix3fv(it->second, 1, false, mat);
-    return true;
+    glUniformMatrix3fv(uniformLocations_[uniform], 1, false, mat);
 }
 
-bool ShaderOpenGL::SetUniformMatrix4x4(const string& uniformName, const Matrix4x4& value) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
+void ShaderOpenGL::SetUniformMatrix4x4Impl(UniformHandle_t uniform, const Matrix4x4& value) {
     float mat[16];
     value.GetData(mat);
-    glUniformMatrix4fv(it->second, 1, false, mat);
-    return true;
+    glUniformMatrix4fv(uniformLocations_[uniform], 1, false, mat);
 }
 
-bool ShaderOpenGL::SetUniformMatrix4x4Array(const string& uniformName, const Matrix4x4* values, int arraySize) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
+void ShaderOpenGL::SetUniformMatrix4x4ArrayImpl(UniformHandle_t uniform, const Matrix4x4* values, int arraySize) {
     // Convert the matrices to an array of floats
     vector<float> matrices;
     matrices.reserve(arraySize * 16);
@@ -266,23 +181,58 @@ bool ShaderOpenGL::SetUniformMatrix4x4Array(const string& uniformName, const Mat
         }
     }
 
-    glUniformMatrix4fv(it->second, arraySize, false, &matrices[0]);
-
-    return true;
+    glUniformMatrix4fv(uniformLocations_[uniform], arraySize, false, &matrices[0]);
 }
 
-bool ShaderOpenGL::SetUniformTexture(const string& uniformName, const Texture* texture) {
-    unordered_map<string, GLuint>::iterator it = nameToUniforms_.find(uniformName);
-    if (it == nameToUniforms_.end()) {
-        Logger::GetInstance()->Debug("Couldn't find uniform location of name " + uniformName + " in shader #" + to_string(id_));
-        return false;
-	}
-
+void ShaderOpenGL::SetUniformTextureImpl(UniformHandle_t uniform, const Texture* texture) {
     // Bind the texture and send its texture unit to the shader
     size_t textureUnit = texture->Bind();
-    glUniform1i(it->second, textureUnit);
+    glUniform1i(uniformLocations_[uniform], textureUnit);
+}
 
-    return true;
+size_t ShaderOpenGL::GetUniformArrayLength(UniformHandle_t uniform) const {
+    return uniformArrayLengths_[uniform];
+}
+
+void ShaderOpenGL::ReflectUniforms() {
+    nameToUniforms_.clear();
+    uniformLocations_.clear();
+    uniformArrayLengths_.clear();
+
+    GLuint frameConstantsBlock = glGetUniformBlockIndex(program_, FRAME_CONSTANTS_BLOCK_NAME);
+    if (frameConstantsBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program_, frameConstantsBlock, FRAME_CONSTANTS_BINDING_POINT);
+    }
+
+    GLint numActiveUniforms;
+    char uniformName[256];
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORMS, &numActiveUniforms);
+    for (int i = 0; i < numActiveUniforms; i++) {
+        GLint arraySize = 0;
+        GLenum type = 0;
+        GLsizei actualLength = 0;
+        glGetActiveUniform(program_, i, 256, &actualLength, &arraySize, &type, uniformName);
+        string name = uniformName;
+
+        // The members of the uniform blocks are set through their buffer, not with glUniform
+        GLuint index = i;
+        GLint blockIndex = -1;
+        glGetActiveUniformsiv(program_, 1, &index, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+        if (blockIndex != -1) {
+            continue;
+        }
+        
+        // Arrays' name are messed up
+        if (name.back() == ']') {
+            name.pop_back();
+            name.pop_back();
+            name.pop_back();
+        }
+
+        nameToUniforms_[name] = (UniformHandle_t)uniformLocations_.size();
+        uniformLocations_.push_back(glGetUniformLocation(program_, name.c_str()));
+        uniformArrayLengths_.push_back((size_t)max(arraySize, 1));
+    }
 }
 
 char* ShaderOpenGL::ReadShader(const string& filename) {
@@ -157,6 +157,19 @@ void RenderContextOpenGLUnix::SwapBuffers() {
     glXSwapBuffers(display_, xWindow_);
 }
 
+bool RenderContextOpenGLUnix::MakeCurrent() {
+    if (!glXMakeCurrent(display_, xWindow_, renderContext_)) {
+        Logger::GetInstance()->Error("Couldn't set current OpenGL context");
+        return false;
+    }
+
+    return true;
+}
+
+void RenderContextOpenGLUnix::ReleaseCurrent() {
+    glXMakeCurrent(display_, None, NULL);
+}
+
 void RenderContextOpenGLUnix::QueryAdapterSupportedDisplayFormats() {
 }
                                                                        
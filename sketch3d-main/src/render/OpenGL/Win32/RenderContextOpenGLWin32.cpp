@@ -195,6 +195,19 @@ void RenderContextOpenGLWin32::SwapBuffers() {
 	::SwapBuffers(deviceContext_);
 }
 
+bool RenderContextOpenGLWin32::MakeCurrent() {
+	if (!wglMakeCurrent(deviceContext_, renderContext_)) {
+		Logger::GetInstance()->Error("Couldn't set the new rendering context");
+		return false;
+	}
+
+	return true;
+}
+
+void RenderContextOpenGLWin32::ReleaseCurrent() {
+	wglMakeCurrent(NULL, NULL);
+}
+
 void RenderContextOpenGLWin32::QueryAdapterSupportedDisplayFormats() {
 
 }
@@ -1,6 +1,13 @@
 #include "render/RenderContext.h"
 
 namespace Sketch3D {
+bool RenderContext::MakeCurrent() {
+    return true;
+}
+
+void RenderContext::ReleaseCurrent() {
+}
+
 bool RenderContext::AreRenderParametersSupported(const RenderParameters_t& renderParameters) const {
     for (size_t i = 0; i < supportedDisplayModes_.size(); i++) {
         const DisplayMode_t& displayMode = supportedDisplayModes_[i];
@@ -5,13 +5,19 @@
 #include "render/Mesh.h"
 #include "render/Node.h"
 #include "render/Renderer.h"
+#include "render/RenderStateCache.h"
+#include "render/RenderSystem.h"
 #include "render/Shader.h"
 #include "render/SkinnedMesh.h"
 #include "render/Texture2D.h"
 
+#include "system/Logger.h"
+#include "system/Profiler.h"
+
 #include <algorithm>
-#include <memory>
-#include <set>
+#include <chrono>
+#include <new>
+#include <string.h>
 #include <utility>
 using namespace std;
 
@@ -27,52 +33,203 @@ enum RenderCommand_t {
     RENDER_COMMAND_BIND_TEXTURES,
     RENDER_COMMAND_SET_MODEL_MATRIX,
     RENDER_COMMAND_RENDER_BUFFER_OBJECTS,
-    RENDER_COMMAND_ACCUMULATE_MODEL_MATRIX,
+    RENDER_COMMAND_ACCUMULATE_INSTANCE,
     RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES,
 
     NUMBER_RENDER_COMMANDS
 };
 
 /**
- * @struct BindTextures_t
- * Little struct used to pack information required textures that we have to bind
+ * @struct RenderCommandPacket_t
+ * Header of every packet in the command stream. The packets are allocated in the frame arena of the render
+ * queue and chained together in the order in which they have to be executed.
+ */
+struct RenderCommandPacket_t {
+    RenderCommand_t         command;
+    RenderCommandPacket_t*  next;
+};
+
+/**
+ * @struct UseMaterialPacket_t
+ * Packet for RENDER_COMMAND_USE_MATERIAL
+ */
+struct UseMaterialPacket_t : public RenderCommandPacket_t {
+    const Material* material;       /**< Only compared to the material applied last, the state is applied instead */
+    MaterialState_t state;
+};
+
+/**
+ * @struct BindTexturesPacket_t
+ * Packet for RENDER_COMMAND_BIND_TEXTURES
  */
-struct BindTextures_t {
+struct BindTexturesPacket_t : public RenderCommandPacket_t {
     size_t      numTextures;
     Texture2D** textures;
+};
 
-    // Required to be used in a set
-    bool operator<(const BindTextures_t& rhs) const {
-        return textures < rhs.textures;
-    }
+/**
+ * @struct ModelMatrixPacket_t
+ * Packet for RENDER_COMMAND_SET_MODEL_MATRIX
+ */
+struct ModelMatrixPacket_t : public RenderCommandPacket_t {
+    const Matrix4x4*    modelMatrix;
+    size_t              modelMatrixIndex;   /**< Index of the model matrix and of its builtin matrices in their pools */
+};
+
+/**
+ * @struct BufferObjectPacket_t
+ * Packet for RENDER_COMMAND_RENDER_BUFFER_OBJECTS
+ */
+struct BufferObjectPacket_t : public RenderCommandPacket_t {
+    BufferObject*   bufferObject;
+};
+
+/**
+ * @struct InstancePacket_t
+ * Packet for RENDER_COMMAND_ACCUMULATE_INSTANCE. RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES doesn't have any data
+ */
+struct InstancePacket_t : public RenderCommandPacket_t {
+    const Matrix4x4*    modelMatrix;
+    BufferObject*       bufferObject;
 };
 
-RenderQueue::RenderQueue() {
+/**
+ * @class RenderCommandStream
+ * Builds the linked list of command packets in the frame arena
+ */
+class RenderCommandStream {
+    public:
+        RenderCommandStream(LinearAllocator& allocator) : allocator_(allocator), first_(nullptr), last_(nullptr) {
+        }
+
+        /**
+         * Allocates a packet at the end of the stream
+         * @param command The command that the packet represents
+         * @return The packet, to be filled by the caller
+         */
+        template<typename T>
+        T* Push(RenderCommand_t command) {
+            T* packet = new (allocator_.Allocate(sizeof(T))) T;
+            packet->command = command;
+            packet->next = nullptr;
+
+            if (last_ == nullptr) {
+                first_ = packet;
+            } else {
+                last_->next = packet;
+            }
+            last_ = packet;
+
+            return packet;
+        }
+
+        const RenderCommandPacket_t* GetFirst() const { return first_; }
+
+    private:
+        LinearAllocator&        allocator_;
+        RenderCommandPacket_t*  first_;
+        RenderCommandPacket_t*  last_;
+};
+
+/**
+ * Checks if a sub-mesh uses the same textures as the ones that are bound. The sub-meshes have their own list of
+ * textures, even when they share them
+ */
+static bool HaveSameTextures(const SurfaceTriangles_t* surface, Texture2D** textures, size_t numTextures) {
+    if (surface->textures == textures) {
+        return true;
+    }
+
+    return textures != nullptr && surface->numTextures == numTextures &&
+           memcmp(surface->textures, textures, numTextures * sizeof(Texture2D*)) == 0;
+}
+
+/**
+ * Apply a material before a draw call. The uniforms of the material stay in its shader until another material is
+ * applied, so applying the same material again only uploads the uniforms that changed since then
+ * @param useMaterial The command with the material to apply
+ * @param appliedMaterial The material applied last during this frame, updated by this function
+ * @param appliedMaterialVersion The version of appliedMaterial when it was applied, updated by this function
+ */
+static void ApplyMaterial(const UseMaterialPacket_t* useMaterial, const Material*& appliedMaterial, size_t& appliedMaterialVersion) {
+    // Every uniform has a version greater than 0
+    Material::ApplyMaterialState(useMaterial->state, (useMaterial->material == appliedMaterial) ? appliedMaterialVersion : 0);
+
+    appliedMaterial = useMaterial->material;
+    appliedMaterialVersion = useMaterial->state.version;
+}
+
+// Radix sort constants. The 64 bits keys are sorted 8 bits at a time
+const size_t RADIX_BITS = 8;
+const size_t RADIX_NUM_BUCKETS = 1 << RADIX_BITS;
+const size_t RADIX_NUM_PASSES = sizeof(uint64_t) * 8 / RADIX_BITS;
+const uint64_t RADIX_MASK = RADIX_NUM_BUCKETS - 1;
+
+// Default layout of the sorting key: 12 bits for the shader, to hold MAX_SHADER_ID, and enough bits for the other
+// states to rarely collide. The depth only orders the opaque items that share all their states
+const RenderQueueKeyLayout_t DEFAULT_KEY_LAYOUT = { 12, 10, 10, 10, 20 };
+
+RenderQueue::RenderQueue() : currentPacket_(0), buffersCapacity_(0), numBufferGrowths_(0), instanceBuffersCapacity_(0),
+                             numInstanceBufferGrowths_(0), keyLayout_(DEFAULT_KEY_LAYOUT)
+{
+    for (size_t i = 0; i < 2; i++) {
+        packets_[i].firstCommand = nullptr;
+        packets_[i].isPrepared = false;
+    }
+
+    ResetStatistics();
 }
 
 void RenderQueue::AddNode(Node* node, Layer_t layer) {
-    // TODO
-    // Got to change the distance from the camera
-    BufferObject** bufferObjects;
-    vector<SurfaceTriangles_t*> surfaces;
-    node->GetMesh()->GetRenderInfo(bufferObjects, surfaces);
-    shared_ptr<Matrix4x4> model(new Matrix4x4(node->ConstructModelMatrix()));
+    AddNodeItems(node, layer, GetCurrentPacket().modelMatrices, items_);
 
-    const Matrix4x4& modelView = Renderer::GetInstance()->GetViewMatrix() * *(model.get());
-    float dist = -(modelView[2][3] + Renderer::GetInstance()->GetNearFrustumPlane()) / (Renderer::GetInstance()->GetFarFrustumPlane() - Renderer::GetInstance()->GetNearFrustumPlane());
-    uint32_t distanceToCamera = (uint32_t)(dist * (float)UINT32_MAX);
+    while (items_.size() > itemsIndex_.size()) {
+        itemsIndex_.push_back(itemsIndex_.size());
+    }
+}
 
-    for (size_t i = 0; i < surfaces.size(); i++) {
-        items_.push_back(RenderQueueItem(model, node->GetMaterial(), surfaces[i]->textures,
-                         surfaces[i]->numTextures, bufferObjects[i], node->UseInstancing(), distanceToCamera, layer));
+void RenderQueue::AddNode(Node* node, RenderQueueSegment_t& segment, Layer_t layer) const {
+    AddNodeItems(node, layer, segment.modelMatrices, segment.items);
+}
 
-        if (items_.size() > itemsIndex_.size()) {
-            itemsIndex_.push_back(itemsIndex_.size());
-        }
+void RenderQueue::MergeSegment(RenderQueueSegment_t& segment) {
+    // The items of the segment refer to its own pool of matrices
+    vector<Matrix4x4>& modelMatrices = GetCurrentPacket().modelMatrices;
+    uint32_t modelMatrixOffset = (uint32_t)modelMatrices.size();
+    modelMatrices.insert(modelMatrices.end(), segment.modelMatrices.begin(), segment.modelMatrices.end());
+
+    size_t firstItem = items_.size();
+    items_.insert(items_.end(), segment.items.begin(), segment.items.end());
+    for (size_t i = firstItem; i < items_.size(); i++) {
+        items_[i].modelMatrixIndex_ += modelMatrixOffset;
     }
+
+    while (items_.size() > itemsIndex_.size()) {
+        itemsIndex_.push_back(itemsIndex_.size());
+    }
+
+    segment.items.clear();
+    segment.modelMatrices.clear();
 }
 
 void RenderQueue::Render() {
+    PROFILE_ZONE("RenderQueue::Render");
+
+    FrameConstants_t frameConstants = Renderer::GetInstance()->GetFrameConstants();
+    Renderer::GetInstance()->GetRenderSystem()->SetFrameConstants(frameConstants);
+
+    Execute(Prepare(frameConstants, false));
+}
+
+RenderQueuePacket_t* RenderQueue::Prepare(const FrameConstants_t& frameConstants, bool copyMaterials) {
+    PROFILE_ZONE("RenderQueue::Prepare");
+
+    chrono::high_resolution_clock::time_point sortingStart = chrono::high_resolution_clock::now();
+    RenderQueuePacket_t& framePacket = GetCurrentPacket();
+    memset(&framePacket.statistics, 0, sizeof(RenderQueueStatistics_t));
+    framePacket.statistics.numItems = items_.size();
+    framePacket.frameConstants = frameConstants;
+
     // Do we have less index this frame?
     if (items_.size() < itemsIndex_.size()) {
         itemsIndex_.resize(items_.size());
@@ -83,228 +240,564 @@ void RenderQueue::Render() {
     }
 
     // Sort the indices
-    stable_sort(itemsIndex_.begin(), itemsIndex_.end(), RenderQueueItemKeyComparator(items_));
+    SortItems();
 
-    vector<pair<RenderCommand_t, void*>> renderCommands;
-    set<BindTextures_t> bindTexturesSet;
-    set<void*> instancedBufferObjects;
+    RenderCommandStream renderCommands(framePacket.commandAllocator);
 
-    // This array is used to determine when to insert a new render command in the list of render commands
-    void* previousRenderCommands[NUMBER_RENDER_COMMANDS];
-    for (size_t i = 0; i < NUMBER_RENDER_COMMANDS; i++) {
-        previousRenderCommands[i] = nullptr;
-    }
+    // Those are used to determine when to insert a new render command in the list of render commands
+    Material* previousMaterial = nullptr;
+    Texture2D** previousTextures = nullptr;
+    size_t previousNumTextures = 0;
+    const Matrix4x4* previousModelMatrix = nullptr;
+    BufferObject* previousBufferObject = nullptr;
     bool modelViewMatrixChanged = false;
     bool nextRenderIsInstanced = false;
+    uint32_t builtinUniformMask = 0;
 
     // Construct the list of render commands
     for (size_t i = 0; i < itemsIndex_.size(); i++) {
         size_t idx = itemsIndex_[i];
         const RenderQueueItem& item = items_[idx];
+        const Node* node = item.node_;
+        const Mesh* mesh = node->GetMesh();
+        const SurfaceTriangles_t* surface = mesh->GetSurface(item.surfaceIndex_);
+        Material* material = node->GetMaterial();
+        bool useInstancing = node->UseInstancing();
 
         // Set the material to bind for the next render commands
-        void* material = static_cast<void*>(item.material_);
-        if (previousRenderCommands[RENDER_COMMAND_USE_MATERIAL] != material) {
+        if (previousMaterial != material) {
 
             // Flush the current batch of instanced buffers before we switch material
             if (nextRenderIsInstanced) {
-                set<void*>::iterator it = instancedBufferObjects.begin();
-                for (; it != instancedBufferObjects.end(); ++it) {
-                    renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES, *it));
-                }
-                instancedBufferObjects.clear();
+                renderCommands.Push<RenderCommandPacket_t>(RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES);
+                nextRenderIsInstanced = false;
+            }
 
-                nextRenderIsInstanced = item.useInstancing_;
+            // The textures are sent to the samplers of the shader, they have to be sent again to a new shader
+            if (previousMaterial == nullptr || previousMaterial->GetShader() != material->GetShader()) {
+                previousTextures = nullptr;
             }
 
-            renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_USE_MATERIAL, material));
-            previousRenderCommands[RENDER_COMMAND_USE_MATERIAL] = material;
+            UseMaterialPacket_t* packet = renderCommands.Push<UseMaterialPacket_t>(RENDER_COMMAND_USE_MATERIAL);
+            packet->material = material;
+            packet->state = material->GetState();
+            previousMaterial = material;
         }
 
         // If any, set the textures to bind for the next render commands
-        if (item.numTextures_ > 0) {
-            BindTextures_t bindTextures;
-            bindTextures.numTextures = item.numTextures_;
-            bindTextures.textures = item.textures_;
-            pair<set<BindTextures_t>::iterator, bool> ret = bindTexturesSet.insert(bindTextures);
-        
-            void* textures = static_cast<void*>(const_cast<BindTextures_t*>(&(*(ret.first)))); // Evil stuff to make it work :/
-            if (previousRenderCommands[RENDER_COMMAND_BIND_TEXTURES] != textures) {
+        if (surface->numTextures > 0) {
+            if (!HaveSameTextures(surface, previousTextures, previousNumTextures)) {
 
                 // Flush the current batch of instanced buffers before we switch textures
                 if (nextRenderIsInstanced) {
-                    set<void*>::iterator it = instancedBufferObjects.begin();
-                    for (; it != instancedBufferObjects.end(); ++it) {
-                        renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES, *it));
-                    }
-                    instancedBufferObjects.clear();
-
-                    nextRenderIsInstanced = item.useInstancing_;
+                    renderCommands.Push<RenderCommandPacket_t>(RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES);
+                    nextRenderIsInstanced = false;
                 }
 
-                renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_BIND_TEXTURES, textures));
-                previousRenderCommands[RENDER_COMMAND_BIND_TEXTURES] = textures;
+                BindTexturesPacket_t* packet = renderCommands.Push<BindTexturesPacket_t>(RENDER_COMMAND_BIND_TEXTURES);
+                packet->numTextures = surface->numTextures;
+                packet->textures = surface->textures;
+                previousTextures = surface->textures;
+                previousNumTextures = surface->numTextures;
             }
         }
 
-        // Set the model matrix for the next render commands. If we are using instanced rendering, we want to accumulate them, instead
-        void* modelMatrix = static_cast<void*>(item.modelMatrix_.get());
-        if (previousRenderCommands[RENDER_COMMAND_SET_MODEL_MATRIX] != modelMatrix) {
+        // The instances are accumulated along with their buffer object. They are all drawn at once when the batch is
+        // flushed, that is when the material or the textures change or when a non instanced draw comes in. The draws
+        // whose shader doesn't set any per-model uniform are accumulated too, so that the buffer objects sharing a
+        // geometry pool are submitted together, each one reading its model matrix at its base instance. Only the
+        // shaders written for instancing read their model matrix that way: the ones declaring modelViewProjection,
+        // modelView, model or transInvModelView as uniforms keep one draw call per item
+        const Matrix4x4* modelMatrix = &framePacket.modelMatrices[item.modelMatrixIndex_];
+        BufferObject* bufferObject = mesh->GetBufferObject(item.surfaceIndex_);
+        if (!useInstancing && bufferObject->SupportsMultiDraw()) {
+            useInstancing = (material->GetShader()->GetBuiltinUniformMask() & MODEL_BUILTIN_UNIFORM_MASK) == 0;
+        }
 
-            if (item.useInstancing_) {
-                renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_ACCUMULATE_MODEL_MATRIX, modelMatrix));
-                nextRenderIsInstanced = true;
-            } else {
+        if (useInstancing) {
+            InstancePacket_t* packet = renderCommands.Push<InstancePacket_t>(RENDER_COMMAND_ACCUMULATE_INSTANCE);
+            packet->modelMatrix = modelMatrix;
+            packet->bufferObject = bufferObject;
+            nextRenderIsInstanced = true;
 
-                // Flush the current batch of instanced buffers
-                if (nextRenderIsInstanced) {
-                    set<void*>::iterator it = instancedBufferObjects.begin();
-                    for (; it != instancedBufferObjects.end(); ++it) {
-                        renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES, *it));
-                    }
-                    instancedBufferObjects.clear();
+            // The next non instanced draw has to set its model matrix and buffer object again
+            previousModelMatrix = nullptr;
+            previousBufferObject = nullptr;
+            continue;
+        }
 
-                    nextRenderIsInstanced = false;
-                }
+        // Flush the current batch of instanced buffers
+        if (nextRenderIsInstanced) {
+            renderCommands.Push<RenderCommandPacket_t>(RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES);
+            nextRenderIsInstanced = false;
+        }
 
-                renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_SET_MODEL_MATRIX, modelMatrix));
-            }
+        // Set the model matrix for the next render commands
+        if (previousModelMatrix != modelMatrix) {
+            ModelMatrixPacket_t* packet = renderCommands.Push<ModelMatrixPacket_t>(RENDER_COMMAND_SET_MODEL_MATRIX);
+            packet->modelMatrix = modelMatrix;
+            packet->modelMatrixIndex = item.modelMatrixIndex_;
+            builtinUniformMask |= material->GetShader()->GetBuiltinUniformMask();
 
             modelViewMatrixChanged = true;
-            previousRenderCommands[RENDER_COMMAND_SET_MODEL_MATRIX] = modelMatrix;
+            previousModelMatrix = modelMatrix;
         }
 
-        // Set the buffer objects to draw. If we are using instanced rendering, we want to delay their insertion in the list of
-        // render commands to after we accumulated all the model matrices
-        void* bufferObject = static_cast<void*>(item.bufferObject_);
-        if (modelViewMatrixChanged || previousRenderCommands[RENDER_COMMAND_RENDER_BUFFER_OBJECTS] != bufferObject) {
+        // Set the buffer objects to draw
+        if (modelViewMatrixChanged || previousBufferObject != bufferObject) {
+            BufferObjectPacket_t* packet = renderCommands.Push<BufferObjectPacket_t>(RENDER_COMMAND_RENDER_BUFFER_OBJECTS);
+            packet->bufferObject = bufferObject;
 
-            if (item.useInstancing_) {
-                instancedBufferObjects.insert(bufferObject);
-                nextRenderIsInstanced = true;
-            } else {
-
-                // Flush the current batch of instanced buffers
-                if (nextRenderIsInstanced) {
-                    set<void*>::iterator it = instancedBufferObjects.begin();
-                    for (; it != instancedBufferObjects.end(); ++it) {
-                        renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES, *it));
-                    }
-                    instancedBufferObjects.clear();
-
-                    nextRenderIsInstanced = false;
-                }
-
-                renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_RENDER_BUFFER_OBJECTS, bufferObject));
-            }
-
-            previousRenderCommands[RENDER_COMMAND_RENDER_BUFFER_OBJECTS] = bufferObject;
+            previousBufferObject = bufferObject;
             modelViewMatrixChanged = false;
         }
     }
 
     // Render the last batch of instanced buffer objects if we didn't have the chance to flush them out
     if (nextRenderIsInstanced) {
-        set<void*>::iterator it = instancedBufferObjects.begin();
-        for (; it != instancedBufferObjects.end(); ++it) {
-            renderCommands.push_back(pair<RenderCommand_t, void*>(RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES, *it));
-        }
+        renderCommands.Push<RenderCommandPacket_t>(RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES);
     }
 
+    // Compute the builtin matrices of all the models in one pass, the commands only read them
+    ComputeBuiltinMatrices(framePacket, builtinUniformMask);
+
+    framePacket.firstCommand = renderCommands.GetFirst();
+    if (copyMaterials) {
+        CopyMaterials(framePacket);
+    }
+
+    framePacket.isPrepared = true;
+    currentPacket_ = 1 - currentPacket_;
+    UpdateHeapAllocationsCount();
+
+    // Invalidate the render queue and approximate the next batch's size
+    items_.clear();
+    items_.reserve(itemsIndex_.size());
+
+    framePacket.statistics.sortingTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - sortingStart).count();
+    return &framePacket;
+}
+
+void RenderQueue::Execute(RenderQueuePacket_t* framePacket) {
+    PROFILE_ZONE("RenderQueue::Execute");
+
+    chrono::high_resolution_clock::time_point executionStart = chrono::high_resolution_clock::now();
+    RenderQueueStatistics_t& statistics = framePacket->statistics;
+
+    // The materials without render state block are drawn with the states set on the renderer
+    RenderStateCache* renderStateCache = Renderer::GetInstance()->GetRenderStateCache();
+    RenderStateBlockHandle_t defaultRenderStateBlock = renderStateCache->CreateRenderStateBlock(renderStateCache->GetCurrentRenderState());
+    RenderStateBlockHandle_t renderStateBlock;
+
     // Execute the commands sequentially
-    const Material* currentMaterial = nullptr;
-    const BindTextures_t* currentTextures = nullptr;
+    const UseMaterialPacket_t* currentMaterial = nullptr;
+    const Material* appliedMaterial = nullptr;
+    size_t appliedMaterialVersion = 0;
+    const BindTexturesPacket_t* currentTextures = nullptr;
     const Matrix4x4* currentModelMatrix;
+    size_t modelMatrixIndex;
     BufferObject* currentBufferObject = nullptr;
+    BufferObject* bufferObject;
     Shader* currentShader = nullptr;
-    const map<string, Texture*>* currentMaterialTextures = nullptr;
-    map<string, Texture*>::const_iterator mt_it;
-    vector<Matrix4x4> accumulatedInstances;
-    bool flushAccumulatedInstances = false;
-
-    const Matrix4x4& projection = Renderer::GetInstance()->GetProjectionMatrix();
-    const Matrix4x4& viewProjection = Renderer::GetInstance()->GetViewProjectionMatrix();
-    const Matrix4x4& view = Renderer::GetInstance()->GetViewMatrix();
-    const Matrix4x4& transposedInverseViewMatrix = view.Inverse().Transpose();
+    const InstancePacket_t* instance;
 
-    for (size_t i = 0; i < renderCommands.size(); i++) {
-        RenderCommand_t renderCommand = renderCommands[i].first;
+    const Matrix4x4& projection = framePacket->frameConstants.projection;
+    const Matrix4x4& viewProjection = framePacket->frameConstants.viewProjection;
+    const Matrix4x4& view = framePacket->frameConstants.view;
+    const Matrix4x4& transposedInverseViewMatrix = framePacket->frameConstants.transposedInverseView;
 
-        switch (renderCommand) {
+    for (const RenderCommandPacket_t* packet = framePacket->firstCommand; packet != nullptr; packet = packet->next) {
+        switch (packet->command) {
             case RENDER_COMMAND_USE_MATERIAL:
-                currentMaterial = static_cast<Material*>(renderCommands[i].second);
-                currentShader = currentMaterial->GetShader();
+                currentMaterial = static_cast<const UseMaterialPacket_t*>(packet);
+                statistics.numMaterialChanges += 1;
+                if (currentMaterial->state.shader != currentShader) {
+                    statistics.numShaderChanges += 1;
+                }
+                currentShader = currentMaterial->state.shader;
+
+                // Only the states that differ from the previous material's reach the device
+                renderStateBlock = currentMaterial->state.renderStateBlock;
+                renderStateCache->ApplyRenderStateBlock((renderStateBlock != INVALID_RENDER_STATE_BLOCK) ? renderStateBlock : defaultRenderStateBlock);
 
                 // Bind the current shader for all the following draw calls
                 Renderer::GetInstance()->BindShader(currentShader);
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::VIEW), view );
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::VIEW_PROJECTION), viewProjection );
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::TRANS_INV_VIEW), transposedInverseViewMatrix );
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::PROJECTION), projection );
+
+                // Shaders reading the FrameConstants block already have the camera matrices
+                if (currentShader->GetBuiltinUniformMask() & FRAME_CONSTANTS_BUILTIN_UNIFORM_MASK) {
+                    currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::VIEW), view );
+                    currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::VIEW_PROJECTION), viewProjection );
+                    currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::TRANS_INV_VIEW), transposedInverseViewMatrix );
+                    currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::PROJECTION), projection );
+                }
 
                 break;
 
             case RENDER_COMMAND_BIND_TEXTURES:
                 // Bind the textures for the next sets of buffer objects
-                currentTextures = static_cast<BindTextures_t*>(renderCommands[i].second);
+                currentTextures = static_cast<const BindTexturesPacket_t*>(packet);
+                statistics.numTextureChanges += 1;
 
                 for (size_t j = 0; j < currentTextures->numTextures; j++) {
                     Texture2D* texture = currentTextures->textures[j];
                     if (texture != nullptr) {
                         BuiltinUniform_t builtinUniformTexture = (BuiltinUniform_t)((size_t)BuiltinUniform_t::TEXTURE_0 + j);
-                        currentShader->SetUniformTexture( GetBuiltinUniformName(builtinUniformTexture), texture );
+                        currentShader->SetUniformTexture( currentShader->GetBuiltinUniformHandle(builtinUniformTexture), texture );
                     }
                 }
                 break;
 
             case RENDER_COMMAND_SET_MODEL_MATRIX:
                 // Setup the transformation matrix for the next sets of buffer objects
-                currentModelMatrix = static_cast<Matrix4x4*>(renderCommands[i].second);
-
-                // Set the uniform matrices
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::MODEL_VIEW_PROJECTION), viewProjection * (*currentModelMatrix) );
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::MODEL_VIEW), view * (*currentModelMatrix) );
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::MODEL), (*currentModelMatrix) );
-                currentShader->SetUniformMatrix4x4( GetBuiltinUniformName(BuiltinUniform_t::TRANS_INV_MODEL_VIEW),
-                                                    transposedInverseViewMatrix * currentModelMatrix->Inverse().Transpose() );
+                currentModelMatrix = static_cast<const ModelMatrixPacket_t*>(packet)->modelMatrix;
+
+                // Set the uniform matrices. Only the ones that the shader uses were computed
+                modelMatrixIndex = static_cast<const ModelMatrixPacket_t*>(packet)->modelMatrixIndex;
+
+                if (currentShader->UsesBuiltinUniform(BuiltinUniform_t::MODEL_VIEW_PROJECTION)) {
+                    currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::MODEL_VIEW_PROJECTION), framePacket->modelViewProjections[modelMatrixIndex] );
+                }
+
+                if (currentShader->UsesBuiltinUniform(BuiltinUniform_t::MODEL_VIEW)) {
+                    currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::MODEL_VIEW), framePacket->modelViews[modelMatrixIndex] );
+                }
+
+                currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::MODEL), (*currentModelMatrix) );
+
+                if (currentShader->UsesBuiltinUniform(BuiltinUniform_t::TRANS_INV_MODEL_VIEW)) {
+                    currentShader->SetUniformMatrix4x4( currentShader->GetBuiltinUniformHandle(BuiltinUniform_t::TRANS_INV_MODEL_VIEW), framePacket->normalMatrices[modelMatrixIndex] );
+                }
                 break;
 
             case RENDER_COMMAND_RENDER_BUFFER_OBJECTS:
                 // Draw a buffer object
-                currentMaterial->ApplyMaterial();
-                currentBufferObject = static_cast<BufferObject*>(renderCommands[i].second);
+                ApplyMaterial(currentMaterial, appliedMaterial, appliedMaterialVersion);
+                bufferObject = static_cast<const BufferObjectPacket_t*>(packet)->bufferObject;
+                statistics.numDrawCalls += 1;
+                statistics.numTriangles += bufferObject->GetIndexCount() / 3;
+                statistics.numVertices += bufferObject->GetIndexCount();
+                if (bufferObject != currentBufferObject) {
+                    statistics.numBufferObjectChanges += 1;
+                }
+
+                currentBufferObject = bufferObject;
                 currentBufferObject->Render();
                 break;
 
-            case RENDER_COMMAND_ACCUMULATE_MODEL_MATRIX:
-                // Accumulate the model matrices
-                if (flushAccumulatedInstances) {
-                    accumulatedInstances.clear();
-                    flushAccumulatedInstances = false;
+            case RENDER_COMMAND_ACCUMULATE_INSTANCE:
+                // Accumulate the instances until the batch is flushed
+                instance = static_cast<const InstancePacket_t*>(packet);
+                accumulatedInstances_.push_back(make_pair(instance->bufferObject, instance->modelMatrix));
+                break;
+
+            case RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES: {
+                // Group the instances by buffer object with a counting sort, keeping the order in which they were
+                // added within a group. The groups are numbered in the order in which their buffer object first appears
+                ApplyMaterial(currentMaterial, appliedMaterial, appliedMaterialVersion);
+                for (size_t j = 0; j < accumulatedInstances_.size(); j++) {
+                    bufferObject = accumulatedInstances_[j].first;
+                    size_t id = bufferObject->GetId();
+                    if (id >= bufferObjectGroups_.size()) {
+                        bufferObjectGroups_.resize(id + 1, 0);
+                    }
+
+                    // The group may have been left by a previous batch
+                    size_t group = bufferObjectGroups_[id];
+                    if (group >= multiDrawCommands_.size() || multiDrawCommands_[group].bufferObject != bufferObject) {
+                        group = multiDrawCommands_.size();
+                        bufferObjectGroups_[id] = group;
+
+                        MultiDrawCommand_t command;
+                        command.bufferObject = bufferObject;
+                        command.firstInstance = 0;
+                        command.numInstances = 0;
+                        multiDrawCommands_.push_back(command);
+                        statistics.numBufferObjectChanges += 1;
+                    }
+
+                    multiDrawCommands_[group].numInstances += 1;
                 }
 
-                currentModelMatrix = static_cast<Matrix4x4*>(renderCommands[i].second);
-                accumulatedInstances.push_back(currentModelMatrix->Transpose());
-                break;
+                size_t firstInstance = 0;
+                for (size_t j = 0; j < multiDrawCommands_.size(); j++) {
+                    multiDrawCommands_[j].firstInstance = firstInstance;
+                    firstInstance += multiDrawCommands_[j].numInstances;
+                    multiDrawCommands_[j].numInstances = 0;
+                }
+
+                instanceMatrices_.resize(accumulatedInstances_.size());
+                for (size_t j = 0; j < accumulatedInstances_.size(); j++) {
+                    MultiDrawCommand_t& command = multiDrawCommands_[bufferObjectGroups_[accumulatedInstances_[j].first->GetId()]];
+                    instanceMatrices_[command.firstInstance + command.numInstances] = accumulatedInstances_[j].second->Transpose();
+                    command.numInstances += 1;
+                }
 
-            case RENDER_COMMAND_DRAW_ACCUMULATED_INSTANCES:
-                // Draw several instances of the same buffer object
-                currentMaterial->ApplyMaterial();
-                currentBufferObject = static_cast<BufferObject*>(renderCommands[i].second);
-                currentBufferObject->RenderInstances(accumulatedInstances);
-                flushAccumulatedInstances = true;
+                // All the groups are submitted at once, the backend merging them in as few draw calls as it can
+                Renderer::GetInstance()->GetBufferObjectManager()->RenderMultiDraw(&multiDrawCommands_[0], multiDrawCommands_.size(), instanceMatrices_);
+                statistics.numDrawCalls += multiDrawCommands_.size();
+                statistics.numInstancedDrawCalls += multiDrawCommands_.size();
+                for (size_t j = 0; j < multiDrawCommands_.size(); j++) {
+                    size_t numIndices = multiDrawCommands_[j].bufferObject->GetIndexCount();
+                    statistics.numTriangles += numIndices / 3 * multiDrawCommands_[j].numInstances;
+                    statistics.numVertices += numIndices * multiDrawCommands_[j].numInstances;
+                }
+
+                accumulatedInstances_.clear();
+                instanceMatrices_.clear();
+                multiDrawCommands_.clear();
+                currentBufferObject = nullptr;
+                break;
+            }
 
+            default:
+                Logger::GetInstance()->Error("Unknown render command in the render queue");
                 break;
         }
     }
 
-    // Invalidate the render queue and approximate the next batch's size
-    items_.clear();
-    items_.reserve(itemsIndex_.size());
+    renderStateCache->ApplyRenderStateBlock(defaultRenderStateBlock);
+    statistics.executionTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - executionStart).count();
+
+    // The instance buffers are only touched by the thread executing the packets
+    size_t instanceBuffersCapacity = accumulatedInstances_.capacity() + instanceMatrices_.capacity() + multiDrawCommands_.capacity() +
+                                     bufferObjectGroups_.capacity();
+    if (instanceBuffersCapacity != instanceBuffersCapacity_) {
+        instanceBuffersCapacity_ = instanceBuffersCapacity;
+        numInstanceBufferGrowths_.fetch_add(1, memory_order_relaxed);
+    }
+
+    statistics_.numDrawCalls += statistics.numDrawCalls;
+    statistics_.numInstancedDrawCalls += statistics.numInstancedDrawCalls;
+    statistics_.numTriangles += statistics.numTriangles;
+    statistics_.numVertices += statistics.numVertices;
+    statistics_.numShaderChanges += statistics.numShaderChanges;
+    statistics_.numMaterialChanges += statistics.numMaterialChanges;
+    statistics_.numTextureChanges += statistics.numTextureChanges;
+    statistics_.numBufferObjectChanges += statistics.numBufferObjectChanges;
+    statistics_.numItems += statistics.numItems;
+    statistics_.sortingTime += statistics.sortingTime;
+    statistics_.executionTime += statistics.executionTime;
 }
 
 bool RenderQueue::IsEmpty() const {
     return items_.empty();
 }
 
+size_t RenderQueue::GetNumHeapAllocations() const {
+    return packets_[0].commandAllocator.GetNumHeapAllocations() + packets_[1].commandAllocator.GetNumHeapAllocations() +
+           numBufferGrowths_ + numInstanceBufferGrowths_.load(memory_order_relaxed);
+}
+
+void RenderQueue::ResetStatistics() {
+    memset(&statistics_, 0, sizeof(RenderQueueStatistics_t));
+}
+
+bool RenderQueue::SetKeyLayout(const RenderQueueKeyLayout_t& keyLayout) {
+    size_t budgets[] = { keyLayout.shaderBits, keyLayout.materialBits, keyLayout.textureSetBits, keyLayout.bufferObjectBits,
+                         keyLayout.depthBits };
+    size_t totalBits = 0;
+
+    for (size_t i = 0; i < sizeof(budgets) / sizeof(size_t); i++) {
+        if (budgets[i] > 32) {
+            Logger::GetInstance()->Error("The components of the render queue key can't use more than 32 bits");
+            return false;
+        }
+
+        totalBits += budgets[i];
+    }
+
+    if (totalBits > RENDER_QUEUE_KEY_OPAQUE_BITS) {
+        Logger::GetInstance()->Error("The render queue key layout uses " + to_string(totalBits) + " bits, only " +
+                                     to_string(RENDER_QUEUE_KEY_OPAQUE_BITS) + " are available");
+        return false;
+    }
+
+    keyLayout_ = keyLayout;
+    return true;
+}
+
+void RenderQueue::SortItems() {
+    PROFILE_ZONE("RenderQueue::SortItems");
+
+    size_t numItems = itemsIndex_.size();
+    if (numItems == 0) {
+        return;
+    }
+
+    sortKeys_.resize(numItems);
+    sortKeysScratch_.resize(numItems);
+
+    // Gather the keys in the order of the last frame
+    for (size_t i = 0; i < numItems; i++) {
+        size_t idx = itemsIndex_[i];
+        sortKeys_[i].key = items_[idx].key_;
+        sortKeys_[i].index = idx;
+    }
+
+    const RenderQueueKey_t* sortedKeys = RadixSortKeys(&sortKeys_[0], &sortKeysScratch_[0], numItems);
+    for (size_t i = 0; i < numItems; i++) {
+        itemsIndex_[i] = sortedKeys[i].index;
+    }
+}
+
+RenderQueueKey_t* RenderQueue::RadixSortKeys(RenderQueueKey_t* keys, RenderQueueKey_t* scratch, size_t numKeys) {
+    if (numKeys == 0) {
+        return keys;
+    }
+
+    // Build the histograms of all passes at once
+    size_t histograms[RADIX_NUM_PASSES][RADIX_NUM_BUCKETS];
+    memset(histograms, 0, sizeof(histograms));
+
+    for (size_t i = 0; i < numKeys; i++) {
+        uint64_t key = keys[i].key;
+        for (size_t pass = 0; pass < RADIX_NUM_PASSES; pass++) {
+            histograms[pass][(key >> (pass * RADIX_BITS)) & RADIX_MASK] += 1;
+        }
+    }
+
+    RenderQueueKey_t* source = keys;
+    RenderQueueKey_t* destination = scratch;
+
+    for (size_t pass = 0; pass < RADIX_NUM_PASSES; pass++) {
+        size_t* histogram = histograms[pass];
+        size_t shift = pass * RADIX_BITS;
+
+        // All the keys share the same digit, this pass wouldn't change anything
+        if (histogram[(source[0].key >> shift) & RADIX_MASK] == numKeys) {
+            continue;
+        }
+
+        // Turn the histogram into the starting offset of each bucket
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < RADIX_NUM_BUCKETS; bucket++) {
+            size_t count = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += count;
+        }
+
+        for (size_t i = 0; i < numKeys; i++) {
+            size_t bucket = (source[i].key >> shift) & RADIX_MASK;
+            destination[histogram[bucket]++] = source[i];
+        }
+
+        swap(source, destination);
+    }
+
+    return source;
+}
+
+void RenderQueue::AddNodeItems(Node* node, Layer_t layer, vector<Matrix4x4>& modelMatrices, vector<RenderQueueItem>& items) const {
+    // TODO
+    // Got to change the distance from the camera
+    uint32_t modelMatrixIndex = (uint32_t)modelMatrices.size();
+    modelMatrices.push_back(node->ConstructModelMatrix());
+
+    const Matrix4x4& modelView = Renderer::GetInstance()->GetViewMatrix() * modelMatrices.back();
+    float dist = -(modelView[2][3] + Renderer::GetInstance()->GetNearFrustumPlane()) / (Renderer::GetInstance()->GetFarFrustumPlane() - Renderer::GetInstance()->GetNearFrustumPlane());
+    uint32_t distanceToCamera = (uint32_t)(dist * (float)UINT32_MAX);
+
+    size_t numSurfaces = node->GetMesh()->GetNumSurfaces();
+    for (size_t i = 0; i < numSurfaces; i++) {
+        items.push_back(RenderQueueItem(node, (uint32_t)i, modelMatrixIndex, distanceToCamera, keyLayout_, layer));
+    }
+}
+
+RenderQueuePacket_t& RenderQueue::GetCurrentPacket() {
+    RenderQueuePacket_t& packet = packets_[currentPacket_];
+
+    // The commands and the matrices of a prepared packet were only valid for its frame
+    if (packet.isPrepared) {
+        packet.commandAllocator.Reset();
+        packet.firstCommand = nullptr;
+        packet.modelMatrices.clear();
+        packet.isPrepared = false;
+    }
+
+    return packet;
+}
+
+void RenderQueue::ComputeBuiltinMatrices(RenderQueuePacket_t& packet, uint32_t builtinUniformMask) {
+    PROFILE_ZONE("RenderQueue::ComputeBuiltinMatrices");
+
+    size_t numModels = packet.modelMatrices.size();
+    if (numModels == 0) {
+        return;
+    }
+
+    if (builtinUniformMask & (1u << BuiltinUniform_t::MODEL_VIEW_PROJECTION)) {
+        packet.modelViewProjections.resize(numModels);
+        Matrix4x4::MultiplyBatch(packet.frameConstants.viewProjection, &packet.modelMatrices[0], numModels,
+                                 &packet.modelViewProjections[0]);
+    }
+
+    // The normal matrix is the transposed inverse of the model view matrix
+    if (builtinUniformMask & ((1u << BuiltinUniform_t::MODEL_VIEW) | (1u << BuiltinUniform_t::TRANS_INV_MODEL_VIEW))) {
+        packet.modelViews.resize(numModels);
+        Matrix4x4::MultiplyBatch(packet.frameConstants.view, &packet.modelMatrices[0], numModels, &packet.modelViews[0]);
+    }
+
+    if (builtinUniformMask & (1u << BuiltinUniform_t::TRANS_INV_MODEL_VIEW)) {
+        packet.normalMatrices.resize(numModels);
+        Matrix4x4::InverseTransposeBatch(&packet.modelViews[0], numModels, &packet.normalMatrices[0]);
+    }
+}
+
+void RenderQueue::CopyMaterials(RenderQueuePacket_t& packet) {
+    // Size the buffers first, the states of the commands point inside them. They only grow when a frame uses more
+    // uniforms than any previous one
+    size_t numParameters = 0;
+    size_t numParameterData = 0;
+    size_t numTextures = 0;
+    for (const RenderCommandPacket_t* command = packet.firstCommand; command != nullptr; command = command->next) {
+        if (command->command == RENDER_COMMAND_USE_MATERIAL) {
+            const MaterialState_t& state = static_cast<const UseMaterialPacket_t*>(command)->state;
+            numParameters += state.numParameters;
+            numParameterData += state.numParameterData;
+            numTextures += state.numTextures;
+        }
+    }
+
+    packet.materialParameters.resize(numParameters);
+    packet.materialParameterData.resize(numParameterData);
+    packet.materialTextures.resize(numTextures);
+
+    MaterialParameter_t* parameters = packet.materialParameters.data();
+    float* parameterData = packet.materialParameterData.data();
+    const Texture** textures = packet.materialTextures.data();
+    for (const RenderCommandPacket_t* command = packet.firstCommand; command != nullptr; command = command->next) {
+        if (command->command == RENDER_COMMAND_USE_MATERIAL) {
+            MaterialState_t& state = static_cast<UseMaterialPacket_t*>(const_cast<RenderCommandPacket_t*>(command))->state;
+
+            copy(state.parameters, state.parameters + state.numParameters, parameters);
+            state.parameters = parameters;
+            parameters += state.numParameters;
+
+            copy(state.parameterData, state.parameterData + state.numParameterData, parameterData);
+            state.parameterData = parameterData;
+            parameterData += state.numParameterData;
+
+            copy(state.textures, state.textures + state.numTextures, textures);
+            state.textures = textures;
+            textures += state.numTextures;
+        }
+    }
+}
+
+void RenderQueue::UpdateHeapAllocationsCount() {
+    // The buffers are only cleared between frames, never shrunk, so a change of their total capacity means that
+    // at least one of them had to be reallocated
+    size_t buffersCapacity = items_.capacity() + itemsIndex_.capacity() + sortKeys_.capacity() + sortKeysScratch_.capacity();
+    for (size_t i = 0; i < 2; i++) {
+        buffersCapacity += packets_[i].modelMatrices.capacity() + packets_[i].modelViewProjections.capacity() +
+                           packets_[i].modelViews.capacity() + packets_[i].normalMatrices.capacity() + packets_[i].materialParameters.capacity() +
+                           packets_[i].materialParameterData.capacity() + packets_[i].materialTextures.capacity();
+    }
+
+    if (buffersCapacity != buffersCapacity_) {
+        buffersCapacity_ = buffersCapacity;
+        numBufferGrowths_ += 1;
+    }
+}
+
 }
@@ -1,85 +1,93 @@
 #include "render/RenderQueueItem.h"
 
 #include "render/Material.h"
+#include "render/Mesh.h"
 #include "render/Node.h"
 #include "render/Shader.h"
 #include "render/Texture2D.h"
 
-#include "math/Matrix3x3.h"
-#include "math/Matrix4x4.h"
-#include "math/Vector3.h"
-#include "math/Vector4.h"
-
 namespace Sketch3D {
 
 // Constants for bitshifts
 const int LAYER_SHIFT = 62;
 const int DEPTH_SHIFT = 30;
-const int MATERIAL_SHIFT = 32;
 
 const uint32_t DISTANCE_TRUNCATION = 0xFFFFFFFC;
 
-RenderQueueItem::RenderQueueItem(shared_ptr<Matrix4x4> modelMatrix, Material* material, Texture2D** textures,
-                                 size_t numTextures, BufferObject* bufferObject, bool useInstancing, uint32_t distanceFromCamera, Layer_t layer) : key_(0),
-        layer_(layer), transluencyType_(TRANSLUENCY_TYPE_OPAQUE), distanceFromCamera_(distanceFromCamera), materialId_(0), modelMatrix_(modelMatrix),
-        material_(material), textures_(textures), numTextures_(numTextures), bufferObject_(bufferObject), useInstancing_(useInstancing)
-{
-    TransluencyType_t transluencyType = material_->GetTransluencyType();
-    key_ |= ((uint64_t)layer_) << LAYER_SHIFT;
-    key_ |= ((uint64_t)(distanceFromCamera  & DISTANCE_TRUNCATION) << ((transluencyType == TRANSLUENCY_TYPE_OPAQUE) ? 0 : DEPTH_SHIFT));
-    key_ |= ((uint64_t)ConstructMaterialId() << ((transluencyType == TRANSLUENCY_TYPE_OPAQUE) ? MATERIAL_SHIFT : 0));
+/**
+ * Reduce a value to a number of bits. The bits are mixed with a multiplicative hash so that values that only differ in
+ * their lowest bits are spread over all the bits
+ */
+static uint64_t HashToBits(uint64_t value, size_t bits) {
+    if (bits == 0) {
+        return 0;
+    }
+
+    return (value * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
 }
 
-RenderQueueItem::~RenderQueueItem() {
+/**
+ * Reduce an id to a number of bits. The ids are small, so they are kept as is when they fit, which keeps the objects in
+ * their creation order
+ */
+static uint64_t IdToBits(uint64_t id, size_t bits) {
+    if (bits < 64 && (id >> bits) != 0) {
+        return HashToBits(id, bits);
+    }
+
+    return id;
 }
 
-uint32_t RenderQueueItem::ConstructMaterialId() const {
-    uint16_t shaderId = material_->GetShader()->GetId();
-    return shaderId;
+/**
+ * Append a component to the state id
+ */
+static void AppendComponent(uint64_t& stateId, uint64_t component, size_t bits) {
+    if (bits > 0) {
+        stateId = (stateId << bits) | component;
+    }
 }
 
-bool RenderQueueItemKeyComparator::operator() (size_t lhs, size_t rhs) const {
-    // For opaque objects, we sort by material first to minimize state changes. Otherwise,
-    // we sort by depth first, and back-to-front.
-    const RenderQueueItem& x = items_[lhs];
-    const RenderQueueItem& y = items_[rhs];
-
-    return x.key_ < y.key_;
-    /*
-    if (x.layer_ > y.layer_) {
-        return false;
-    } else if (x.layer_ == y.layer_) {
-        if (x.transluencyType_ > y.transluencyType_) {
-            return false;
-        } else if (x.transluencyType_ == y.transluencyType_) {
-            TransluencyType_t transluency = x.transluencyType_;
-
-            switch (transluency) {
-                case TRANSLUENCY_TYPE_OPAQUE:
-                    if (x.materialId_ > y.materialId_) {
-                        return false;
-                    } else if (x.materialId_ == y.materialId_) {
-                        if (x.distanceFromCamera_ >= y.distanceFromCamera_) {
-                            return false;
-                        }
-                    }
-                    break;
-                case TRANSLUENCY_TYPE_ADDITIVE:
-                case TRANSLUENCY_TYPE_SUBTRACTIVE:
-                    if (x.distanceFromCamera_ < y.distanceFromCamera_) {
-                        return false;
-                    } else if (x.distanceFromCamera_ == y.distanceFromCamera_) {
-                        if (x.materialId_ >= y.materialId_) {
-                            return false;
-                        }
-                    }
-                    break;
-            }
+RenderQueueItem::RenderQueueItem(Node* node, uint32_t surfaceIndex, uint32_t modelMatrixIndex, uint32_t distanceFromCamera,
+                                 const RenderQueueKeyLayout_t& keyLayout, Layer_t layer) :
+        key_(0), node_(node), surfaceIndex_(surfaceIndex), modelMatrixIndex_(modelMatrixIndex)
+{
+    const Material* material = node_->GetMaterial();
+    const Mesh* mesh = node_->GetMesh();
+    uint64_t stateId = ConstructStateId(material, mesh->GetSurface(surfaceIndex), mesh->GetBufferObject(surfaceIndex), keyLayout);
+    size_t stateBits = keyLayout.shaderBits + keyLayout.materialBits + keyLayout.textureSetBits + keyLayout.bufferObjectBits;
+
+    key_ |= ((uint64_t)layer) << LAYER_SHIFT;
+
+    if (material->GetTransluencyType() == TRANSLUENCY_TYPE_OPAQUE) {
+        uint64_t depth = (keyLayout.depthBits > 0) ? distanceFromCamera >> (32 - keyLayout.depthBits) : 0;
+        key_ |= (stateId << keyLayout.depthBits) | depth;
+    } else {
+        if (stateBits > RENDER_QUEUE_KEY_TRANSPARENT_STATE_BITS) {
+            stateId >>= stateBits - RENDER_QUEUE_KEY_TRANSPARENT_STATE_BITS;
         }
+
+        key_ |= ((uint64_t)(distanceFromCamera & DISTANCE_TRUNCATION)) << DEPTH_SHIFT;
+        key_ |= stateId;
+    }
+}
+
+uint64_t RenderQueueItem::ConstructStateId(const Material* material, const SurfaceTriangles_t* surface,
+                                           const BufferObject* bufferObject, const RenderQueueKeyLayout_t& keyLayout)
+{
+    // The components are built from ids rather than addresses, so that the items are sorted in the same order from one
+    // run to the next. Sub-meshes don't share their list of textures, identify the set from the textures themselves
+    uint64_t textureSetId = 0;
+    for (size_t i = 0; i < surface->numTextures; i++) {
+        const Texture* texture = surface->textures[i];
+        textureSetId = textureSetId * 31 + ((texture != nullptr) ? texture->GetId() + 1 : 0);
     }
 
-    return true;
-    */
+    uint64_t stateId = 0;
+    AppendComponent(stateId, IdToBits(material->GetShader()->GetId(), keyLayout.shaderBits), keyLayout.shaderBits);
+    AppendComponent(stateId, IdToBits(material->GetId(), keyLayout.materialBits), keyLayout.materialBits);
+    AppendComponent(stateId, IdToBits(textureSetId, keyLayout.textureSetBits), keyLayout.textureSetBits);
+    AppendComponent(stateId, IdToBits(bufferObject->GetId(), keyLayout.bufferObjectBits), keyLayout.bufferObjectBits);
+    return stateId;
 }
 
 }
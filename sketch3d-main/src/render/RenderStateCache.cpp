@@ -1,7 +1,46 @@
 #include "render/RenderStateCache.h"
 
 namespace Sketch3D {
-RenderStateCache::RenderStateCache() {
+
+// Position of each state in the key of a render state block
+const uint32_t RENDER_STATE_KEY_DEPTH_TEST = 1 << 0;
+const uint32_t RENDER_STATE_KEY_DEPTH_WRITE = 1 << 1;
+const uint32_t RENDER_STATE_KEY_COLOR_WRITE = 1 << 2;
+const uint32_t RENDER_STATE_KEY_BLENDING = 1 << 3;
+const uint32_t RENDER_STATE_KEY_DEPTH_FUNC_SHIFT = 4;       // 3 bits
+const uint32_t RENDER_STATE_KEY_CULLING_SHIFT = 7;          // 1 bit
+const uint32_t RENDER_STATE_KEY_EQUATION_SHIFT = 8;         // 3 bits
+const uint32_t RENDER_STATE_KEY_SOURCE_FACTOR_SHIFT = 11;   // 4 bits
+const uint32_t RENDER_STATE_KEY_DESTINATION_FACTOR_SHIFT = 15;  // 4 bits
+const uint32_t RENDER_STATE_KEY_RENDER_MODE_SHIFT = 19;     // 2 bits
+
+const uint32_t RENDER_STATE_KEY_DEPTH_FUNC = 0x7 << RENDER_STATE_KEY_DEPTH_FUNC_SHIFT;
+const uint32_t RENDER_STATE_KEY_CULLING = 0x1 << RENDER_STATE_KEY_CULLING_SHIFT;
+const uint32_t RENDER_STATE_KEY_EQUATION = 0x7 << RENDER_STATE_KEY_EQUATION_SHIFT;
+const uint32_t RENDER_STATE_KEY_BLENDING_FACTORS = (0xF << RENDER_STATE_KEY_SOURCE_FACTOR_SHIFT) |
+                                                   (0xF << RENDER_STATE_KEY_DESTINATION_FACTOR_SHIFT);
+const uint32_t RENDER_STATE_KEY_RENDER_MODE = 0x3 << RENDER_STATE_KEY_RENDER_MODE_SHIFT;
+
+/**
+ * Pack all the states of a block in a key. Two blocks have the same key if and only if they have the same states, and
+ * the bits that differ between two keys are the states that differ
+ */
+static uint32_t PackRenderStateBlock(const RenderStateBlock_t& block) {
+    uint32_t key = 0;
+    key |= (block.isDepthTestEnabled) ? RENDER_STATE_KEY_DEPTH_TEST : 0;
+    key |= (block.isDepthWriteEnabled) ? RENDER_STATE_KEY_DEPTH_WRITE : 0;
+    key |= (block.isColorWriteEnabled) ? RENDER_STATE_KEY_COLOR_WRITE : 0;
+    key |= (block.isBlendingEnabled) ? RENDER_STATE_KEY_BLENDING : 0;
+    key |= (uint32_t)block.depthComparisonFunction << RENDER_STATE_KEY_DEPTH_FUNC_SHIFT;
+    key |= (uint32_t)block.cullingMethod << RENDER_STATE_KEY_CULLING_SHIFT;
+    key |= (uint32_t)block.blendingEquation << RENDER_STATE_KEY_EQUATION_SHIFT;
+    key |= (uint32_t)block.sourceBlendingFactor << RENDER_STATE_KEY_SOURCE_FACTOR_SHIFT;
+    key |= (uint32_t)block.destinationBlendingFactor << RENDER_STATE_KEY_DESTINATION_FACTOR_SHIFT;
+    key |= (uint32_t)block.renderMode << RENDER_STATE_KEY_RENDER_MODE_SHIFT;
+    return key;
+}
+
+RenderStateCache::RenderStateCache() : appliedRenderStateBlock_(INVALID_RENDER_STATE_BLOCK), numRenderStateChanges_(0) {
     oldCullingMethod_ = cullingMethod_ = CULLING_METHOD_BACK_FACE;
     oldIsDepthTestEnabled_ = isDepthTestEnabled_ = true;
     oldDepthComparisonFunction_ = depthComparisonFunction_ = DEPTH_FUNC_LESS;
@@ -26,37 +65,44 @@ void RenderStateCache::ApplyRenderStateChanges() {
     if (oldIsDepthTestEnabled_ != isDepthTestEnabled_) {
         oldIsDepthTestEnabled_ = isDepthTestEnabled_;
         EnableDepthTestImpl();
+        numRenderStateChanges_ += 1;
     }
 
     if (oldIsBlendingEnabled_ != isBlendingEnabled_) {
         oldIsBlendingEnabled_ = isBlendingEnabled_;
         EnableBlendingImpl();
+        numRenderStateChanges_ += 1;
     }
 
     if (oldDepthComparisonFunction_ != depthComparisonFunction_) {
         oldDepthComparisonFunction_ = depthComparisonFunction_;
         SetDepthComparisonFuncImpl();
+        numRenderStateChanges_ += 1;
     }
 
     if (oldCullingMethod_ != cullingMethod_) {
         oldCullingMethod_ = cullingMethod_;
         SetCullingMethodImpl();
+        numRenderStateChanges_ += 1;
     }
 
     if (oldBlendingEquation_ != blendingEquation_) {
         oldBlendingEquation_ = blendingEquation_;
         SetBlendingEquationImpl();
+        numRenderStateChanges_ += 1;
     }
 
     if (oldSourceBlendingFactor_ != sourceBlendingFactor_ || oldDestinationBlendingFactor_ != destinationBlendingFactor_) {
         oldSourceBlendingFactor_ = sourceBlendingFactor_;
         oldDestinationBlendingFactor_ = destinationBlendingFactor_;
         SetBlendingFactorImpl();
+        numRenderStateChanges_ += 1;
     }
 
     if (oldRenderMode_ != renderMode_) {
         oldRenderMode_ = renderMode_;
         SetRenderFillModeImpl();
+        numRenderStateChanges_ += 1;
     }
 }
 
@@ -64,49 +110,180 @@ void RenderStateCache::ApplyClearStateChanges() {
     if (oldIsDepthWriteEnabled_ != isDepthWriteEnabled_) {
         oldIsDepthWriteEnabled_ = isDepthWriteEnabled_;
         EnableDepthWriteImpl();
+        numRenderStateChanges_ += 1;
     }
 
     if (oldIsColorWriteEnabled_ != isColorWriteEnabled_) {
         oldIsColorWriteEnabled_ = isColorWriteEnabled_;
         EnableColorWriteImpl();
+        numRenderStateChanges_ += 1;
     }
 }
 
 void RenderStateCache::EnableDepthTest(bool val) {
+    appliedRenderStateBlock_ = INVALID_RENDER_STATE_BLOCK;
     isDepthTestEnabled_ = val;
 }
 
 void RenderStateCache::EnableDepthWrite(bool val) {
+    appliedRenderStateBlock_ = INVALID_RENDER_STATE_BLOCK;
     isDepthWriteEnabled_ = val;
 }
 
 void RenderStateCache::EnableColorWrite(bool val) {
+    appliedRenderStateBlock_ = INVALID_RENDER_STATE_BLOCK;
     isColorWriteEnabled_ = val;
 }
 
 void RenderStateCache::EnableBlending(bool val) {
+    appliedRenderStateBlock_ = INVALID_RENDER_STATE_BLOCK;
     isBlendingEnabled_ = val;
 }
 
 void RenderStateCache::SetDepthComparisonFunc(DepthFunc_t comparison) {
+    appliedRenderStateBlock_ = INVALID_RENDER_STATE_BLOCK;
     depthComparisonFunction_ = comparison;
 }
 
 void RenderStateCache::SetCullingMethod(CullingMethod_t cullingMethod) {
+    appliedRenderStateBlock_ = INVALID_RENDER_STATE_BLOCK;
     cullingMethod_ = cullingMethod;
 }
 
 void RenderStateCache::SetBlendingEquation(BlendingEquation_t equation) {
+    appliedRenderStateBlock_ = INVALID_RENDER_STATE_BLOCK;
     blendingEquation_ = equation;
 }
 
 void RenderStateCache::SetBlendingFactor(BlendingFactor_t srcFactor, BlendingFactor_t dstFactor) {
+    appliedRenderStateBlock_ = INVALID_RENDER_STATE_BLOCK;
     sourceBlendingFactor_ = srcFactor;
     destinationBlendingFactor_ = dstFactor;
 }
 
 void RenderStateCache::SetRenderFillMode(RenderMode_t mode) {
+    appliedRenderStateBlock_ = INVALID_RENDER_STATE_BLOCK;
     renderMode_ = mode;
 }
 
-}
\ No newline at end of file
+RenderStateBlockHandle_t RenderStateCache::CreateRenderStateBlock(const RenderStateBlock_t& block) {
+    uint32_t key = PackRenderStateBlock(block);
+    unordered_map<uint32_t, RenderStateBlockHandle_t>::iterator it = renderStateBlockIndices_.find(key);
+    if (it != renderStateBlockIndices_.end()) {
+        return it->second;
+    }
+
+    RenderStateBlockHandle_t handle = renderStateBlocks_.size();
+    renderStateBlocks_.push_back(block);
+    renderStateBlockKeys_.push_back(key);
+    renderStateBlockIndices_[key] = handle;
+
+    return handle;
+}
+
+void RenderStateCache::ApplyRenderStateBlock(RenderStateBlockHandle_t handle) {
+    if (handle == appliedRenderStateBlock_) {
+        return;
+    }
+
+    // Compare the block with the states that reached the device
+    uint32_t appliedKey;
+    if (appliedRenderStateBlock_ != INVALID_RENDER_STATE_BLOCK) {
+        appliedKey = renderStateBlockKeys_[appliedRenderStateBlock_];
+    } else {
+        RenderStateBlock_t applied;
+        applied.isDepthTestEnabled = oldIsDepthTestEnabled_;
+        applied.isDepthWriteEnabled = oldIsDepthWriteEnabled_;
+        applied.isColorWriteEnabled = oldIsColorWriteEnabled_;
+        applied.isBlendingEnabled = oldIsBlendingEnabled_;
+        applied.depthComparisonFunction = oldDepthComparisonFunction_;
+        applied.cullingMethod = oldCullingMethod_;
+        applied.blendingEquation = oldBlendingEquation_;
+        applied.sourceBlendingFactor = oldSourceBlendingFactor_;
+        applied.destinationBlendingFactor = oldDestinationBlendingFactor_;
+        applied.renderMode = oldRenderMode_;
+        appliedKey = PackRenderStateBlock(applied);
+    }
+
+    uint32_t changes = renderStateBlockKeys_[handle] ^ appliedKey;
+    appliedRenderStateBlock_ = handle;
+
+    // The implementations read the current values, which also drops the individual changes that weren't applied
+    const RenderStateBlock_t& block = renderStateBlocks_[handle];
+    oldIsDepthTestEnabled_ = isDepthTestEnabled_ = block.isDepthTestEnabled;
+    oldIsDepthWriteEnabled_ = isDepthWriteEnabled_ = block.isDepthWriteEnabled;
+    oldIsColorWriteEnabled_ = isColorWriteEnabled_ = block.isColorWriteEnabled;
+    oldIsBlendingEnabled_ = isBlendingEnabled_ = block.isBlendingEnabled;
+    oldDepthComparisonFunction_ = depthComparisonFunction_ = block.depthComparisonFunction;
+    oldCullingMethod_ = cullingMethod_ = block.cullingMethod;
+    oldBlendingEquation_ = blendingEquation_ = block.blendingEquation;
+    oldSourceBlendingFactor_ = sourceBlendingFactor_ = block.sourceBlendingFactor;
+    oldDestinationBlendingFactor_ = destinationBlendingFactor_ = block.destinationBlendingFactor;
+    oldRenderMode_ = renderMode_ = block.renderMode;
+
+    if (changes == 0) {
+        return;
+    }
+
+    if (changes & RENDER_STATE_KEY_DEPTH_WRITE) {
+        EnableDepthWriteImpl();
+        numRenderStateChanges_ += 1;
+    }
+
+    if (changes & RENDER_STATE_KEY_COLOR_WRITE) {
+        EnableColorWriteImpl();
+        numRenderStateChanges_ += 1;
+    }
+
+    if (changes & RENDER_STATE_KEY_DEPTH_TEST) {
+        EnableDepthTestImpl();
+        numRenderStateChanges_ += 1;
+    }
+
+    if (changes & RENDER_STATE_KEY_BLENDING) {
+        EnableBlendingImpl();
+        numRenderStateChanges_ += 1;
+    }
+
+    if (changes & RENDER_STATE_KEY_DEPTH_FUNC) {
+        SetDepthComparisonFuncImpl();
+        numRenderStateChanges_ += 1;
+    }
+
+    if (changes & RENDER_STATE_KEY_CULLING) {
+        SetCullingMethodImpl();
+        numRenderStateChanges_ += 1;
+    }
+
+    if (changes & RENDER_STATE_KEY_EQUATION) {
+        SetBlendingEquationImpl();
+        numRenderStateChanges_ += 1;
+    }
+
+    if (changes & RENDER_STATE_KEY_BLENDING_FACTORS) {
+        SetBlendingFactorImpl();
+        numRenderStateChanges_ += 1;
+    }
+
+    if (changes & RENDER_STATE_KEY_RENDER_MODE) {
+        SetRenderFillModeImpl();
+        numRenderStateChanges_ += 1;
+    }
+}
+
+RenderStateBlock_t RenderStateCache::GetCurrentRenderState() const {
+    RenderStateBlock_t block;
+    block.isDepthTestEnabled = isDepthTestEnabled_;
+    block.isDepthWriteEnabled = isDepthWriteEnabled_;
+    block.isColorWriteEnabled = isColorWriteEnabled_;
+    block.isBlendingEnabled = isBlendingEnabled_;
+    block.depthComparisonFunction = depthComparisonFunction_;
+    block.cullingMethod = cullingMethod_;
+    block.blendingEquation = blendingEquation_;
+    block.sourceBlendingFactor = sourceBlendingFactor_;
+    block.destinationBlendingFactor = destinationBlendingFactor_;
+    block.renderMode = renderMode_;
+    return block;
+}
+
+}
@@ -6,24 +6,42 @@
 #include "math/Vector4.h"
 
 #include "render/BufferObjectManager.h"
+#include "render/FrameStatistics.h"
 #include "render/RenderStateCache.h"
 #include "render/RenderTexture.h"
 #include "render/Shader.h"
 
 #include "system/Window.h"
 
+#include <string.h>
+
 namespace Sketch3D {
 
-RenderSystem::RenderSystem(Window& window) : window_(window), boundShader_(nullptr), bufferObjectManager_(nullptr), textShader_(nullptr) {
-    windowHandle_ = window_.GetHandle();
-    width_ = window_.GetWidth();
-    height_ = window_.GetHeight();
-    windowed_ = window_.IsWindowed();
+RenderSystem::RenderSystem(Window& window) : window_(&window), boundShader_(nullptr), bufferObjectManager_(nullptr), textShader_(nullptr),
+        hasFrameConstants_(false)
+{
+    windowHandle_ = window_->GetHandle();
+    width_ = window_->GetWidth();
+    height_ = window_->GetHeight();
+    windowed_ = window_->IsWindowed();
+}
+
+RenderSystem::RenderSystem(unsigned int width, unsigned int height) : window_(nullptr), windowHandle_(0), width_(width), height_(height),
+        windowed_(true), boundShader_(nullptr), bufferObjectManager_(nullptr), renderStateCache_(nullptr), textShader_(nullptr),
+        hasFrameConstants_(false)
+{
 }
 
 RenderSystem::~RenderSystem() {
 }
 
+bool RenderSystem::MakeContextCurrent() {
+    return true;
+}
+
+void RenderSystem::ReleaseContext() {
+}
+
 void RenderSystem::SetRenderFillMode(RenderMode_t mode) {
     renderStateCache_->SetRenderFillMode(mode);
 }
@@ -67,7 +85,10 @@ Vector3 RenderSystem::ScreenToWorldPoint(const Matrix4x4& inversedViewProjection
 }
 
 size_t RenderSystem::BindTexture(const Texture* texture) {
-    return 0;
+    size_t textureUnit;
+    bool isResident = !textureUnitCache_.Acquire(texture->GetId(), textureUnit);
+    BindTextureImpl(texture, textureUnit, isResident);
+    return textureUnit;
 }
 
 void RenderSystem::DrawTextBuffer(BufferObject* bufferObject, Texture2D* fontAtlas, const Vector3& textColor) {
@@ -75,6 +96,7 @@ void RenderSystem::DrawTextBuffer(BufferObject* bufferObject, Texture2D* fontAtl
     textShader_->SetUniformTexture("fontAtlas", fontAtlas);
     textShader_->SetUniformVector3("textColor", textColor);
     bufferObject->Render();
+    Renderer::GetInstance()->RecordDraw(bufferObject);
 }
 
 BufferObjectManager* RenderSystem::GetBufferObjectManager() const {
@@ -85,6 +107,33 @@ RenderStateCache* RenderSystem::GetRenderStateCache() const {
     return renderStateCache_;
 }
 
+void RenderSystem::SetFrameConstants(const FrameConstants_t& frameConstants) {
+    // The camera usually doesn't change between the passes of a frame, or even between frames
+    if (hasFrameConstants_ && memcmp(&frameConstants_, &frameConstants, sizeof(FrameConstants_t)) == 0) {
+        return;
+    }
+
+    frameConstants_ = frameConstants;
+    hasFrameConstants_ = true;
+    SetFrameConstantsImpl();
+    BufferUploadCounter::Add(sizeof(FrameConstants_t));
+}
+
+size_t RenderSystem::GetNumUniformUploads() const {
+    size_t numUniformUploads = 0;
+    for (size_t i = 0; i < shaders_.size(); i++) {
+        numUniformUploads += shaders_[i]->GetNumIssuedUniformUploads();
+    }
+
+    return numUniformUploads;
+}
+
+void RenderSystem::ResetUniformUploadCounters() {
+    for (size_t i = 0; i < shaders_.size(); i++) {
+        shaders_[i]->ResetUniformUploadCounters();
+    }
+}
+
 void RenderSystem::FreeRenderSystem() {
     for (size_t i = 0; i < shaders_.size(); i++) {
         delete shaders_[i];
@@ -3,6 +3,7 @@
 #include "math/Constants.h"
 #include "math/Sphere.h"
 
+#include "render/Null/RenderSystemNull.h"
 #include "render/OpenGL/RenderSystemOpenGL.h"
 
 #include "system/Platform.h"
@@ -12,14 +13,18 @@
 #include "render/Direct3D9/RenderSystemDirect3D9.h"
 #endif
 
+#include "render/BufferObject.h"
 #include "render/RenderStateCache.h"
 #include "render/Texture2D.h"
 #include "render/TextureManager.h"
 
 #include "system/Logger.h"
+#include "system/Profiler.h"
 #include "system/Window.h"
 
+#include <chrono>
 #include <math.h>
+#include <string.h>
 
 #include <FreeImage.h>
 
@@ -27,12 +32,36 @@ namespace Sketch3D {
 
 Renderer Renderer::instance_;
 
+/**
+ * Set on the render thread of the renderer, which draws the frames itself
+ */
+static thread_local bool isRenderThread = false;
+
+/**
+ * Empty a frame packet before preparing the next frame in it
+ */
+static void ResetFramePacket(RenderFramePacket_t& framePacket) {
+    framePacket.clearBuffers = 0;
+    framePacket.opaquePacket = nullptr;
+    framePacket.transparentPacket = nullptr;
+    framePacket.cullingTime = 0.0;
+}
+
 Renderer::Renderer() : renderSystem_(nullptr), useFrustumCulling_(true), nearFrustumPlane_(0.0f), farFrustumPlane_(0.0f),
-                       oldViewportX_(0), oldViewportY_(0), oldViewportWidth_(0), oldViewportHeight_(0)
+                       oldViewportX_(0), oldViewportY_(0), oldViewportWidth_(0), oldViewportHeight_(0),
+                       useRenderThread_(false), clearBuffers_(0), stopRenderThread_(false), isFrameSubmitted_(false),
+                       numSubmittedTasks_(0), numCompletedTasks_(0)
 {
+    memset(&frameStatistics_, 0, sizeof(FrameStatistics_t));
+    memset(&lastFrameStatistics_, 0, sizeof(FrameStatistics_t));
+    memset(&renderThreadFrameStatistics_, 0, sizeof(FrameStatistics_t));
+    memset(&renderThreadQueueStatistics_, 0, sizeof(RenderQueueStatistics_t));
+    memset(&lastRenderQueueStatistics_, 0, sizeof(RenderQueueStatistics_t));
+    ResetFramePacket(framePacket_);
 }
 
 Renderer::~Renderer() {
+    EnableRenderThread(false);
 	delete renderSystem_;
 }
 
@@ -55,6 +84,10 @@ bool Renderer::Initialize(RenderSystem_t renderSystem,
             renderSystem_ = new RenderSystemDirect3D9(window);			
 			break;
 #endif
+		case RENDER_SYSTEM_NULL:
+			renderSystem_ = new RenderSystemNull(window.GetWidth(), window.GetHeight());
+			break;
+
 		default:
 			Logger::GetInstance()->Error("Unknown render system");
 			break;
@@ -70,55 +103,167 @@ bool Renderer::Initialize(RenderSystem_t renderSystem,
     return true;
 }
 
+bool Renderer::InitializeHeadless(const RenderParameters_t& renderParameters) {
+    renderParamters_ = renderParameters;
+    renderSystem_ = new RenderSystemNull(renderParameters.width, renderParameters.height);
+
+	if (!renderSystem_->Initialize(renderParamters_)) {
+        Logger::GetInstance()->Error("Couldn't initialize render system properly");
+        return false;
+    }
+
+    SetDefaultRenderingValues();
+
+    return true;
+}
+
 void Renderer::SetClearColor(float red, float green, float blue, float alpha) const {
 	renderSystem_->SetClearColor(red, green, blue, alpha);
 }
 
 void Renderer::Clear(int buffer) const {
+    // The render thread clears the buffers when it starts drawing the frame
+    if (IsDeferredToRenderThread()) {
+        clearBuffers_ |= buffer;
+        return;
+    }
+
     renderSystem_->GetRenderStateCache()->ApplyClearStateChanges();
 	renderSystem_->Clear(buffer);
 }
 
 void Renderer::StartRender() {
+    if (IsDeferredToRenderThread()) {
+        return;
+    }
+
+    memset(&frameStatistics_, 0, sizeof(FrameStatistics_t));
+    renderSystem_->GetTextureUnitCache().ResetCounters();
+    renderSystem_->GetRenderStateCache()->ResetRenderStateChangeCounter();
+    renderSystem_->ResetUniformUploadCounters();
+    BufferUploadCounter::Reset();
+
     renderSystem_->StartRender();
 }
 
 void Renderer::EndRender() {
+    if (IsDeferredToRenderThread()) {
+        return;
+    }
+
 	renderSystem_->EndRender();
+
+    // The counters of the render system cover the whole frame
+    frameStatistics_.numTextureChanges = renderSystem_->GetTextureUnitCache().GetNumBinds();
+    frameStatistics_.numRenderStateChanges = renderSystem_->GetRenderStateCache()->GetNumRenderStateChanges();
+    frameStatistics_.numUniformUploads = renderSystem_->GetNumUniformUploads();
+    frameStatistics_.numUploadedBytes = BufferUploadCounter::GetNumUploadedBytes();
+
+    // The statistics of the render thread are handed to the application when it submits the next frame
+    if (useRenderThread_) {
+        renderThreadFrameStatistics_ = frameStatistics_;
+    } else {
+        lastFrameStatistics_ = frameStatistics_;
+    }
 }
 
 void Renderer::Render() {
-    // Commit the state changes
-    RenderStateCache* renderStateCache = renderSystem_->GetRenderStateCache();
-    renderStateCache->ApplyRenderStateChanges();
+    PROFILE_ZONE("Renderer::Render");
 
-    // Draw the static batches first
-    sceneTree_.RenderStaticBatches();
+    // Only prepare the frame, the render thread draws it once it is presented
+    if (IsDeferredToRenderThread()) {
+        if (framePacket_.opaquePacket != nullptr) {
+            Logger::GetInstance()->Error("Render can only be called once per frame while the render thread is enabled");
+            return;
+        }
 
-	// Populate the render queue with nodes from the scene tree
-    FrustumPlanes_t frustumPlanes;
-    if (useFrustumCulling_) {
-        frustumPlanes = ExtractViewFrustumPlanes();
+        PrepareFramePacket(framePacket_, true);
+        return;
     }
 
-    sceneTree_.Render(frustumPlanes, useFrustumCulling_, opaqueRenderQueue_, transparentRenderQueue_);
+    RenderFramePacket_t framePacket;
+    PrepareFramePacket(framePacket, false);
+    frameStatistics_.cullingTime += framePacket.cullingTime;
+    ExecuteFramePacket(framePacket);
+}
 
-	// Draw the render queue contents
-    opaqueRenderQueue_.Render();
+void Renderer::PresentFrame() {
+    PROFILE_ZONE("Renderer::PresentFrame");
 
-    if (!transparentRenderQueue_.IsEmpty()) {
-        renderStateCache->SetBlendingEquation(BLENDING_EQUATION_ADD);
-        renderStateCache->EnableBlending(true);
-        renderStateCache->ApplyRenderStateChanges();
+    if (!IsDeferredToRenderThread()) {
+        renderSystem_->PresentFrame();
+        return;
+    }
 
-        transparentRenderQueue_.Render();
+    framePacket_.clearBuffers = clearBuffers_;
 
-        renderStateCache->EnableBlending(false);
+    {
+        unique_lock<mutex> lock(renderThreadMutex_);
+
+        // The packets of the render queues are used in turn, the previous frame has to be drawn before they are reused
+        renderThreadIdleCondition_.wait(lock, [this] { return !isFrameSubmitted_; });
+        lastFrameStatistics_ = renderThreadFrameStatistics_;
+        lastRenderQueueStatistics_ = renderThreadQueueStatistics_;
+
+        submittedFramePacket_ = framePacket_;
+        isFrameSubmitted_ = true;
     }
+
+    renderThreadCondition_.notify_one();
+
+    ResetFramePacket(framePacket_);
+    clearBuffers_ = 0;
 }
 
-void Renderer::PresentFrame() {
-    renderSystem_->PresentFrame();
+bool Renderer::EnableRenderThread(bool useRenderThread) {
+    if (useRenderThread == useRenderThread_) {
+        return true;
+    }
+
+    if (useRenderThread) {
+        if (renderSystem_ == nullptr) {
+            Logger::GetInstance()->Error("The renderer has to be initialized before starting the render thread");
+            return false;
+        }
+
+        // The context can only be current on one thread at a time
+        renderSystem_->ReleaseContext();
+        stopRenderThread_ = false;
+        useRenderThread_ = true;
+        renderThread_ = thread(&Renderer::RenderThreadLoop, this);
+    } else {
+        {
+            lock_guard<mutex> lock(renderThreadMutex_);
+            stopRenderThread_ = true;
+        }
+
+        // The render thread draws the submitted frame before stopping. A frame prepared but not presented is dropped
+        renderThreadCondition_.notify_one();
+        renderThread_.join();
+        useRenderThread_ = false;
+
+        ResetFramePacket(framePacket_);
+        clearBuffers_ = 0;
+        lastFrameStatistics_ = renderThreadFrameStatistics_;
+        renderSystem_->MakeContextCurrent();
+    }
+
+    return true;
+}
+
+void Renderer::RunOnRenderThread(const function<void()>& task) {
+    if (!IsDeferredToRenderThread()) {
+        task();
+        return;
+    }
+
+    unique_lock<mutex> lock(renderThreadMutex_);
+    renderThreadTasks_.push_back(task);
+    size_t taskNumber = ++numSubmittedTasks_;
+    renderThreadCondition_.notify_one();
+
+    // The tasks run in the order in which they were submitted
+    renderThreadIdleCondition_.wait(lock, [this, taskNumber] { return numCompletedTasks_ >= taskNumber; });
 }
 
 void Renderer::OrthoProjection(float left, float right,
@@ -280,6 +425,10 @@ size_t Renderer::BindTexture(const Texture* texture) {
 }
 
 void Renderer::BindShader(const Shader* shader) {
+    if (shader != renderSystem_->GetBoundShader()) {
+        frameStatistics_.numShaderChanges += 1;
+    }
+
     renderSystem_->BindShader(shader);
 }
 
@@ -313,6 +462,16 @@ const Matrix4x4& Renderer::GetViewProjectionMatrix() const {
 	return viewProjection_;
 }
 
+FrameConstants_t Renderer::GetFrameConstants() const {
+    FrameConstants_t frameConstants;
+    frameConstants.view = view_;
+    frameConstants.projection = projection_;
+    frameConstants.viewProjection = viewProjection_;
+    frameConstants.transposedInverseView = view_.Inverse().Transpose();
+
+    return frameConstants;
+}
+
 float Renderer::GetNearFrustumPlane() const {
     return nearFrustumPlane_;
 }
@@ -337,6 +496,183 @@ RenderStateCache* Renderer::GetRenderStateCache() const {
     return renderSystem_->GetRenderStateCache();
 }
 
+RenderSystem* Renderer::GetRenderSystem() const {
+    return renderSystem_;
+}
+
+size_t Renderer::GetNumRenderQueueHeapAllocations() const {
+    return opaqueRenderQueue_.GetNumHeapAllocations() + transparentRenderQueue_.GetNumHeapAllocations();
+}
+
+RenderQueueStatistics_t Renderer::GetRenderQueueStatistics() const {
+    if (useRenderThread_ && !isRenderThread) {
+        return lastRenderQueueStatistics_;
+    }
+
+    const RenderQueueStatistics_t& opaque = opaqueRenderQueue_.GetStatistics();
+    const RenderQueueStatistics_t& transparent = transparentRenderQueue_.GetStatistics();
+
+    RenderQueueStatistics_t statistics;
+    statistics.numDrawCalls = opaque.numDrawCalls + transparent.numDrawCalls;
+    statistics.numInstancedDrawCalls = opaque.numInstancedDrawCalls + transparent.numInstancedDrawCalls;
+    statistics.numTriangles = opaque.numTriangles + transparent.numTriangles;
+    statistics.numVertices = opaque.numVertices + transparent.numVertices;
+    statistics.numShaderChanges = opaque.numShaderChanges + transparent.numShaderChanges;
+    statistics.numMaterialChanges = opaque.numMaterialChanges + transparent.numMaterialChanges;
+    statistics.numTextureChanges = opaque.numTextureChanges + transparent.numTextureChanges;
+    statistics.numBufferObjectChanges = opaque.numBufferObjectChanges + transparent.numBufferObjectChanges;
+    statistics.numItems = opaque.numItems + transparent.numItems;
+    statistics.sortingTime = opaque.sortingTime + transparent.sortingTime;
+    statistics.executionTime = opaque.executionTime + transparent.executionTime;
+    return statistics;
+}
+
+const FrameStatistics_t& Renderer::GetFrameStatistics() const {
+    return lastFrameStatistics_;
+}
+
+void Renderer::RecordDraw(const BufferObject* bufferObject) {
+    frameStatistics_.numDrawCalls += 1;
+    frameStatistics_.numTriangles += bufferObject->GetIndexCount() / 3;
+    frameStatistics_.numVertices += bufferObject->GetIndexCount();
+}
+
+void Renderer::PrepareFramePacket(RenderFramePacket_t& framePacket, bool copyMaterials) {
+    PROFILE_ZONE("Renderer::PrepareFramePacket");
+
+    framePacket.frameConstants = GetFrameConstants();
+    framePacket.clearBuffers = 0;
+
+	// Populate the render queue with nodes from the scene tree
+    FrustumPlanes_t frustumPlanes;
+    if (useFrustumCulling_) {
+        frustumPlanes = ExtractViewFrustumPlanes();
+    }
+
+    chrono::high_resolution_clock::time_point cullingStart = chrono::high_resolution_clock::now();
+    sceneTree_.Render(frustumPlanes, useFrustumCulling_, opaqueRenderQueue_, transparentRenderQueue_);
+    framePacket.cullingTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - cullingStart).count();
+
+    framePacket.opaquePacket = opaqueRenderQueue_.Prepare(framePacket.frameConstants, copyMaterials);
+    framePacket.transparentPacket = nullptr;
+    if (!transparentRenderQueue_.IsEmpty()) {
+        framePacket.transparentPacket = transparentRenderQueue_.Prepare(framePacket.frameConstants, copyMaterials);
+    }
+}
+
+void Renderer::ExecuteFramePacket(const RenderFramePacket_t& framePacket) {
+    // Commit the state changes
+    RenderStateCache* renderStateCache = renderSystem_->GetRenderStateCache();
+    renderStateCache->ApplyRenderStateChanges();
+
+    // Upload the camera matrices once for all the shaders
+    renderSystem_->SetFrameConstants(framePacket.frameConstants);
+
+    opaqueRenderQueue_.ResetStatistics();
+    transparentRenderQueue_.ResetStatistics();
+
+    // Draw the static batches first
+    sceneTree_.RenderStaticBatches(framePacket.frameConstants);
+
+	// Draw the render queue contents
+    if (framePacket.opaquePacket != nullptr) {
+        opaqueRenderQueue_.Execute(framePacket.opaquePacket);
+    }
+
+    if (framePacket.transparentPacket != nullptr) {
+        renderStateCache->SetBlendingEquation(BLENDING_EQUATION_ADD);
+        renderStateCache->EnableBlending(true);
+        renderStateCache->ApplyRenderStateChanges();
+
+        transparentRenderQueue_.Execute(framePacket.transparentPacket);
+
+        renderStateCache->EnableBlending(false);
+    }
+
+    AccumulateRenderQueueStatistics();
+}
+
+bool Renderer::IsDeferredToRenderThread() const {
+    return useRenderThread_ && !isRenderThread;
+}
+
+void Renderer::RenderThreadLoop() {
+    isRenderThread = true;
+    PROFILE_THREAD_NAME("Render thread");
+
+    if (!renderSystem_->MakeContextCurrent()) {
+        Logger::GetInstance()->Error("Couldn't make the render context current on the render thread");
+    }
+
+    vector<function<void()> > tasks;
+    unique_lock<mutex> lock(renderThreadMutex_);
+
+    while (true) {
+        renderThreadCondition_.wait(lock, [this] { return isFrameSubmitted_ || !renderThreadTasks_.empty() || stopRenderThread_; });
+
+        // The tasks were submitted before the frame, which may depend on them
+        if (!renderThreadTasks_.empty()) {
+            tasks.swap(renderThreadTasks_);
+            lock.unlock();
+
+            for (size_t i = 0; i < tasks.size(); i++) {
+                tasks[i]();
+            }
+
+            lock.lock();
+            numCompletedTasks_ += tasks.size();
+            tasks.clear();
+            renderThreadIdleCondition_.notify_all();
+        }
+
+        if (isFrameSubmitted_) {
+            lock.unlock();
+
+            {
+                PROFILE_ZONE("Renderer::DrawFrame");
+
+                StartRender();
+                frameStatistics_.cullingTime = submittedFramePacket_.cullingTime;
+                if (submittedFramePacket_.clearBuffers != 0) {
+                    Clear(submittedFramePacket_.clearBuffers);
+                }
+
+                ExecuteFramePacket(submittedFramePacket_);
+                renderThreadQueueStatistics_ = GetRenderQueueStatistics();
+                EndRender();
+                PresentFrame();
+            }
+
+            lock.lock();
+            isFrameSubmitted_ = false;
+            renderThreadIdleCondition_.notify_all();
+        }
+
+        if (stopRenderThread_ && !isFrameSubmitted_ && renderThreadTasks_.empty()) {
+            break;
+        }
+    }
+
+    lock.unlock();
+    renderSystem_->ReleaseContext();
+}
+
+void Renderer::AccumulateRenderQueueStatistics() {
+    const RenderQueueStatistics_t& opaque = opaqueRenderQueue_.GetStatistics();
+    const RenderQueueStatistics_t& transparent = transparentRenderQueue_.GetStatistics();
+
+    // The shader changes are counted when the shaders are bound and the texture changes by the texture unit cache
+    frameStatistics_.numDrawCalls += opaque.numDrawCalls + transparent.numDrawCalls;
+    frameStatistics_.numInstancedDrawCalls += opaque.numInstancedDrawCalls + transparent.numInstancedDrawCalls;
+    frameStatistics_.numTriangles += opaque.numTriangles + transparent.numTriangles;
+    frameStatistics_.numVertices += opaque.numVertices + transparent.numVertices;
+    frameStatistics_.numBufferObjectChanges += opaque.numBufferObjectChanges + transparent.numBufferObjectChanges;
+    frameStatistics_.numOpaqueItems += opaque.numItems;
+    frameStatistics_.numTransparentItems += transparent.numItems;
+    frameStatistics_.sortingTime += opaque.sortingTime + transparent.sortingTime;
+    frameStatistics_.executionTime += opaque.executionTime + transparent.executionTime;
+}
+
 size_t Renderer::GetScreenWidth() const {
     return renderSystem_->GetWidth();
 }
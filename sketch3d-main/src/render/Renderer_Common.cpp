@@ -19,6 +19,8 @@ bool ParseConfigFile(const string& filename, ConfigFileAttributes_t& configFileA
     configFileAttributes.refreshRate = 0;
     configFileAttributes.windowed = true;
     configFileAttributes.depthStencilBits = DEPTH_STENCIL_BITS_D24X8;
+    configFileAttributes.numWorkerThreads = 0;
+    configFileAttributes.useRenderThread = false;
 
     ifstream configFile(filename);
     if (!configFile.is_open()) {
@@ -49,6 +51,8 @@ bool ParseConfigFile(const string& filename, ConfigFileAttributes_t& configFileA
                 configFileAttributes.renderSystem = RENDER_SYSTEM_OPENGL;
             } else if (value == "Direct3D9") {
                 configFileAttributes.renderSystem = RENDER_SYSTEM_DIRECT3D9;
+            } else if (value == "Null") {
+                configFileAttributes.renderSystem = RENDER_SYSTEM_NULL;
             } else {
                 Logger::GetInstance()->Warning("Unsupported render system: " + value);
             }
@@ -82,6 +86,17 @@ bool ParseConfigFile(const string& filename, ConfigFileAttributes_t& configFileA
                 Logger::GetInstance()->Warning("Unrecognized parameter for \"[DisplayFormat]\": " + value + " Defaulting to X8R8G8B8");
                 configFileAttributes.displayFormat = DISPLAY_FORMAT_X8R8G8B8;
             }
+        } else if (attributes == "[WorkerThreads]") {
+            configFileAttributes.numWorkerThreads = (size_t)atoi(value.c_str());
+        } else if (attributes == "[RenderThread]") {
+            if (value == "True") {
+                configFileAttributes.useRenderThread = true;
+            } else if (value == "False") {
+                configFileAttributes.useRenderThread = false;
+            } else {
+                Logger::GetInstance()->Warning("Unrecognized parameter for \"[RenderThread]\": " + value + " Defaulting to no render thread");
+                configFileAttributes.useRenderThread = false;
+            }
         } else if (attributes == "[RefreshRate]") {
             configFileAttributes.refreshRate = (size_t)atoi(value.c_str());
         } else if (attributes == "[DepthStencilBits]") {
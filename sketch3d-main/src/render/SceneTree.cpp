@@ -9,6 +9,10 @@
 #include "render/Shader.h"
 #include "render/Texture2D.h"
 
+#include "system/JobSystem.h"
+#include "system/Profiler.h"
+
+#include <algorithm>
 #include <queue>
 #include <vector>
 using namespace std;
@@ -18,10 +22,17 @@ using namespace std;
 
 namespace Sketch3D {
 
+// Number of visible nodes added to the render queues by each job. Smaller scenes are added on the calling thread
+const size_t SCENE_TREE_PARALLEL_GRAIN_SIZE = 4096;
+
 SceneTree::SceneTree() {
+    root_.sceneTree_ = this;
 }
 
 SceneTree::~SceneTree() {
+    // The root is destroyed after the culling hierarchy, it must not try to remove itself from it
+    root_.sceneTree_ = nullptr;
+
     // Free the static batches
     StaticBatches_t::iterator it = staticBatches_.begin();
     for (; it != staticBatches_.end(); ++it) {
@@ -47,16 +58,67 @@ SceneTree::~SceneTree() {
 }
 
 void SceneTree::Render(const FrustumPlanes_t& frustumPlanes, bool useFrustumCulling, RenderQueue& opaqueRenderQueue, RenderQueue& transparentRenderQueue) {
-    map<string, Node*>::iterator it = root_.children_.begin();
-    for (; it != root_.children_.end(); ++it) {
-        it->second->Render(frustumPlanes, useFrustumCulling, opaqueRenderQueue, transparentRenderQueue);
+    PROFILE_ZONE("SceneTree::Render");
+
+    UpdateCullingHierarchy();
+
+    visibleNodes_.clear();
+    if (useFrustumCulling) {
+        cullingHierarchy_.Query(frustumPlanes, visibleNodes_);
+    } else {
+        cullingHierarchy_.GetAllNodes(visibleNodes_);
+    }
+
+    size_t numVisibleNodes = visibleNodes_.size();
+    if (numVisibleNodes <= SCENE_TREE_PARALLEL_GRAIN_SIZE) {
+        for (size_t i = 0; i < numVisibleNodes; i++) {
+            Node* node = visibleNodes_[i];
+            if (node->material_->GetTransluencyType() == TRANSLUENCY_TYPE_OPAQUE) {
+                opaqueRenderQueue.AddNode(node);
+            } else {
+                transparentRenderQueue.AddNode(node);
+            }
+        }
+
+        return;
+    }
+
+    // Each range fills its own segments. The transformations were refreshed with the hierarchy, so the nodes are only
+    // read. The segments are merged in the order of the ranges, the items thus keep the same order from frame to
+    // frame, which the sort of the queues takes advantage of
+    size_t numRanges = (numVisibleNodes + SCENE_TREE_PARALLEL_GRAIN_SIZE - 1) / SCENE_TREE_PARALLEL_GRAIN_SIZE;
+    if (opaqueSegments_.size() < numRanges) {
+        opaqueSegments_.resize(numRanges);
+        transparentSegments_.resize(numRanges);
+    }
+
+    JobSystem::GetInstance()->ParallelFor(0, numVisibleNodes, SCENE_TREE_PARALLEL_GRAIN_SIZE,
+        [this, &opaqueRenderQueue, &transparentRenderQueue] (size_t begin, size_t end) {
+            PROFILE_ZONE("SceneTree::AddNodes");
+
+            size_t range = begin / SCENE_TREE_PARALLEL_GRAIN_SIZE;
+            for (size_t i = begin; i < end; i++) {
+                Node* node = visibleNodes_[i];
+                if (node->material_->GetTransluencyType() == TRANSLUENCY_TYPE_OPAQUE) {
+                    opaqueRenderQueue.AddNode(node, opaqueSegments_[range]);
+                } else {
+                    transparentRenderQueue.AddNode(node, transparentSegments_[range]);
+                }
+            }
+        });
+
+    for (size_t i = 0; i < numRanges; i++) {
+        opaqueRenderQueue.MergeSegment(opaqueSegments_[i]);
+        transparentRenderQueue.MergeSegment(transparentSegments_[i]);
     }
 }
 
-void SceneTree::RenderStaticBatches() const {
-    const Matrix4x4& viewProjectionMatrix = Renderer::GetInstance()->GetViewProjectionMatrix();
-    const Matrix4x4& viewMatrix = Renderer::GetInstance()->GetViewMatrix();
-    const Matrix4x4& transposedInverseViewMatrix = viewMatrix.Inverse().Transpose();
+void SceneTree::RenderStaticBatches(const FrameConstants_t& frameConstants) const {
+    PROFILE_ZONE("SceneTree::RenderStaticBatches");
+
+    const Matrix4x4& viewProjectionMatrix = frameConstants.viewProjection;
+    const Matrix4x4& viewMatrix = frameConstants.view;
+    const Matrix4x4& transposedInverseViewMatrix = frameConstants.transposedInverseView;
 
     StaticBatches_t::const_iterator it = staticBatches_.begin();
     for (; it != staticBatches_.end(); ++it) {
@@ -65,9 +127,11 @@ void SceneTree::RenderStaticBatches() const {
         // Bind the shader for the following render
         Shader* shader = it->first;
         Renderer::GetInstance()->BindShader(shader);
-        shader->SetUniformMatrix4x4("viewProjection", viewProjectionMatrix);
-        shader->SetUniformMatrix4x4("view", viewMatrix);
-        shader->SetUniformMatrix4x4("transInvView", transposedInverseViewMatrix);
+        if (shader->GetBuiltinUniformMask() & FRAME_CONSTANTS_BUILTIN_UNIFORM_MASK) {
+            shader->SetUniformMatrix4x4(shader->GetBuiltinUniformHandle(BuiltinUniform_t::VIEW_PROJECTION), viewProjectionMatrix);
+            shader->SetUniformMatrix4x4(shader->GetBuiltinUniformHandle(BuiltinUniform_t::VIEW), viewMatrix);
+            shader->SetUniformMatrix4x4(shader->GetBuiltinUniformHandle(BuiltinUniform_t::TRANS_INV_VIEW), transposedInverseViewMatrix);
+        }
 
         for (; ttb_it != it->second.end(); ++ttb_it) {
             const TexturesBuffersPair_t& texturesToBuffers = ttb_it->second;
@@ -79,12 +143,18 @@ void SceneTree::RenderStaticBatches() const {
             size_t numTextures = texturesToBind.first;
             Texture2D** textures = texturesToBind.second;
             for (size_t i = 0; i < numTextures; i++) {
-                shader->SetUniformTexture("texture" + to_string(i), textures[i]);
+                size_t builtinUniformTexture = (size_t)BuiltinUniform_t::TEXTURE_0 + i;
+                if (builtinUniformTexture < BuiltinUniform_t::NUM_BUILTIN_UNIFORMS) {
+                    shader->SetUniformTexture(shader->GetBuiltinUniformHandle((BuiltinUniform_t)builtinUniformTexture), textures[i]);
+                } else {
+                    shader->SetUniformTexture("texture" + to_string(i), textures[i]);
+                }
             }
 
             // Render the actual buffer contents
             for (size_t i = 0; i < bufferObjects.size(); i++) {
                 bufferObjects[i]->Render();
+                Renderer::GetInstance()->RecordDraw(bufferObjects[i]);
             }
         }
     }
@@ -107,6 +177,8 @@ bool SceneTree::RemoveNodeByName(const string& name) {
 }
 
 void SceneTree::PerformStaticBatching() {
+    PROFILE_ZONE("SceneTree::PerformStaticBatching");
+
     //////////////////////////////////////////////////////////////////////////////////
     // WARNING: I think this function is pretty much the worst thing you'll ever see
     //////////////////////////////////////////////////////////////////////////////////
@@ -366,4 +438,50 @@ void SceneTree::PerformStaticBatching() {
     }
 }
 
-}
\ No newline at end of file
+void SceneTree::UpdateCullingHierarchy() {
+    // Refresh the local transformations first, the world transformation of a node depends on the one of its parent
+    // and the parents aren't necessarily before their children in the list
+    for (size_t i = 0; i < dirtyNodes_.size(); i++) {
+        dirtyNodes_[i]->ConstructModelMatrix();
+    }
+
+    for (size_t i = 0; i < dirtyNodes_.size(); i++) {
+        Node* node = dirtyNodes_[i];
+        node->isBoundsDirty_ = false;
+
+        if (node->mesh_ != nullptr && !node->isStatic_) {
+            float maxScaleValue = max(node->scale_.x, max(node->scale_.y, node->scale_.z));
+            const Matrix4x4& model = node->ConstructModelMatrix();
+
+            const Sphere& meshBoundingSphere = node->mesh_->GetBoundingSphere();
+            Vector4 transformedCenter = model * meshBoundingSphere.GetCenter();
+            Sphere nodeBoundingSphere(Vector3(transformedCenter.x, transformedCenter.y, transformedCenter.z), meshBoundingSphere.GetRadius() * maxScaleValue);
+
+            if (node->cullingProxy_ == INVALID_BVH_PROXY) {
+                node->cullingProxy_ = cullingHierarchy_.CreateProxy(nodeBoundingSphere, node);
+            } else {
+                cullingHierarchy_.MoveProxy(node->cullingProxy_, nodeBoundingSphere);
+            }
+        } else if (node->cullingProxy_ != INVALID_BVH_PROXY) {
+            // Nodes without mesh and static nodes aren't culled
+            cullingHierarchy_.DestroyProxy(node->cullingProxy_);
+            node->cullingProxy_ = INVALID_BVH_PROXY;
+        }
+    }
+
+    dirtyNodes_.clear();
+}
+
+void SceneTree::RemoveFromCullingHierarchy(Node* node) {
+    if (node->cullingProxy_ != INVALID_BVH_PROXY) {
+        cullingHierarchy_.DestroyProxy(node->cullingProxy_);
+        node->cullingProxy_ = INVALID_BVH_PROXY;
+    }
+
+    if (node->isBoundsDirty_) {
+        dirtyNodes_.erase(find(dirtyNodes_.begin(), dirtyNodes_.end(), node));
+        node->isBoundsDirty_ = false;
+    }
+}
+
+}
@@ -4,6 +4,9 @@
 
 #include "system/Logger.h"
 
+#include <algorithm>
+#include <string.h>
+
 namespace Sketch3D {
 
 string builtUniformNames[] = {
@@ -23,7 +26,11 @@ string builtUniformNames[] = {
 
 uint16_t Shader::nextAvailableId_ = 0;
 
-Shader::Shader() : id_(MAX_SHADER_ID) {
+Shader::Shader() : id_(MAX_SHADER_ID), builtinUniformMask_(0), useUniformShadows_(true), numIssuedUniformUploads_(0), numSkippedUniformUploads_(0) {
+    for (size_t i = 0; i < NUM_BUILTIN_UNIFORMS; i++) {
+        builtinUniformHandles_[i] = INVALID_UNIFORM_HANDLE;
+    }
+
     if (nextAvailableId_ == MAX_SHADER_ID) {
         Logger::GetInstance()->Error("Maximum number of shaders created (" + to_string(MAX_SHADER_ID) + ")");
     } else {
@@ -34,6 +41,276 @@ Shader::Shader() : id_(MAX_SHADER_ID) {
 Shader::~Shader() {
 }
 
+bool Shader::SetUniformInt(const string& uniform, int value) {
+    UniformHandle_t handle = GetUniformHandle(uniform);
+    if (handle == INVALID_UNIFORM_HANDLE) {
+        LogUniformNotFound(uniform);
+        return false;
+    }
+
+    return SetUniformInt(handle, value);
+}
+
+bool Shader::SetUniformFloat(const string& uniform, float value) {
+    UniformHandle_t handle = GetUniformHandle(uniform);
+    if (handle == INVALID_UNIFORM_HANDLE) {
+        LogUniformNotFound(uniform);
+        return false;
+    }
+
+    return SetUniformFloat(handle, value);
+}
+
+bool Shader::SetUniformVector2(const string& uniform, float value1, float value2) {
+    UniformHandle_t handle = GetUniformHandle(uniform);
+    if (handle == INVALID_UNIFORM_HANDLE) {
+        LogUniformNotFound(uniform);
+        return false;
+    }
+
+    return SetUniformVector2(handle, value1, value2);
+}
+
+bool Shader::SetUniformVector3(const string& uniform, const Vector3& value) {
+    UniformHandle_t handle = GetUniformHandle(uniform);
+    if (handle == INVALID_UNIFORM_HANDLE) {
+        LogUniformNotFound(uniform);
+        return false;
+    }
+
+    return SetUniformVector3(handle, value);
+}
+
+bool Shader::SetUniformVector3Array(const string& uniform, const Vector3* values, int arraySize) {
+    UniformHandle_t handle = GetUniformHandle(uniform);
+    if (handle == INVALID_UNIFORM_HANDLE) {
+        LogUniformNotFound(uniform);
+        return false;
+    }
+
+    return SetUniformVector3Array(handle, values, arraySize);
+}
+
+bool Shader::SetUniformVector4(const string& uniform, const Vector4& value) {
+    UniformHandle_t handle = GetUniformHandle(uniform);
+    if (handle == INVALID_UNIFORM_HANDLE) {
+        LogUniformNotFound(uniform);
+        return false;
+    }
+
+    return SetUniformVector4(handle, value);
+}
+
+bool Shader::SetUniformMatrix3x3(const string& uniform, const Matrix3x3& value) {
+    UniformHandle_t handle = GetUniformHandle(uniform);
+    if (handle == INVALID_UNIFORM_HANDLE) {
+        LogUniformNotFound(uniform);
+        return false;
+    }
+
+    return SetUniformMatrix3x3(handle, value);
+}
+
+bool Shader::SetUniformMatrix4x4(const string& uniform, const Matrix4x4& value) {
+    UniformHandle_t handle = GetUniformHandle(uniform);
+    if (handle == INVALID_UNIFORM_HANDLE) {
+        LogUniformNotFound(uniform);
+        return false;
+    }
+
+    return SetUniformMatrix4x4(handle, value);
+}
+
+bool Shader::SetUniformMatrix4x4Array(const string& uniform, const Matrix4x4* values, int arraySize) {
+    UniformHandle_t handle = GetUniformHandle(uniform);
+    if (handle == INVALID_UNIFORM_HANDLE) {
+        LogUniformNotFound(uniform);
+        return false;
+    }
+
+    return SetUniformMatrix4x4Array(handle, values, arraySize);
+}
+
+bool Shader::SetUniformTexture(const string& uniform, const Texture* texture) {
+    UniformHandle_t handle = GetUniformHandle(uniform);
+    if (handle == INVALID_UNIFORM_HANDLE) {
+        LogUniformNotFound(uniform);
+        return false;
+    }
+
+    return SetUniformTexture(handle, texture);
+}
+
+bool Shader::SetUniformInt(UniformHandle_t uniform, int value) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    if (UpdateUniformShadow(uniform, &value, sizeof(int))) {
+        SetUniformIntImpl(uniform, value);
+    }
+    return true;
+}
+
+bool Shader::SetUniformFloat(UniformHandle_t uniform, float value) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    if (UpdateUniformShadow(uniform, &value, sizeof(float))) {
+        SetUniformFloatImpl(uniform, value);
+    }
+    return true;
+}
+
+bool Shader::SetUniformVector2(UniformHandle_t uniform, float value1, float value2) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    float values[] = { value1, value2 };
+    if (UpdateUniformShadow(uniform, values, sizeof(values))) {
+        SetUniformVector2Impl(uniform, value1, value2);
+    }
+    return true;
+}
+
+bool Shader::SetUniformVector3(UniformHandle_t uniform, const Vector3& value) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    if (UpdateUniformShadow(uniform, &value, sizeof(Vector3))) {
+        SetUniformVector3Impl(uniform, value);
+    }
+    return true;
+}
+
+bool Shader::SetUniformVector3Array(UniformHandle_t uniform, const Vector3* values, int arraySize) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    if (UpdateUniformShadow(uniform, values, sizeof(Vector3), arraySize)) {
+        SetUniformVector3ArrayImpl(uniform, values, arraySize);
+    }
+    return true;
+}
+
+bool Shader::SetUniformVector4(UniformHandle_t uniform, const Vector4& value) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    if (UpdateUniformShadow(uniform, &value, sizeof(Vector4))) {
+        SetUniformVector4Impl(uniform, value);
+    }
+    return true;
+}
+
+bool Shader::SetUniformMatrix3x3(UniformHandle_t uniform, const Matrix3x3& value) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    if (UpdateUniformShadow(uniform, &value, sizeof(Matrix3x3))) {
+        SetUniformMatrix3x3Impl(uniform, value);
+    }
+    return true;
+}
+
+bool Shader::SetUniformMatrix4x4(UniformHandle_t uniform, const Matrix4x4& value) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    if (UpdateUniformShadow(uniform, &value, sizeof(Matrix4x4))) {
+        SetUniformMatrix4x4Impl(uniform, value);
+    }
+    return true;
+}
+
+bool Shader::SetUniformMatrix4x4Array(UniformHandle_t uniform, const Matrix4x4* values, int arraySize) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    if (UpdateUniformShadow(uniform, values, sizeof(Matrix4x4), arraySize)) {
+        SetUniformMatrix4x4ArrayImpl(uniform, values, arraySize);
+    }
+    return true;
+}
+
+bool Shader::SetUniformTexture(UniformHandle_t uniform, const Texture* texture) {
+    if (uniform == INVALID_UNIFORM_HANDLE) {
+        return false;
+    }
+
+    // The texture unit of the texture may have been given to another texture since, it always has to be bound
+    numIssuedUniformUploads_ += 1;
+    SetUniformTextureImpl(uniform, texture);
+    return true;
+}
+
+void Shader::ResolveBuiltinUniforms() {
+    builtinUniformMask_ = 0;
+    for (size_t i = 0; i < NUM_BUILTIN_UNIFORMS; i++) {
+        builtinUniformHandles_[i] = GetUniformHandle(GetBuiltinUniformName((BuiltinUniform_t)i));
+        if (builtinUniformHandles_[i] != INVALID_UNIFORM_HANDLE) {
+            builtinUniformMask_ |= 1u << i;
+        }
+    }
+
+    // The uniforms of a new program start from their default values
+    uniformShadows_.clear();
+    uniformShadowData_.clear();
+}
+
+bool Shader::UpdateUniformShadow(UniformHandle_t uniform, const void* value, size_t elementSize, size_t numElements) {
+    if (!useUniformShadows_) {
+        numIssuedUniformUploads_ += 1;
+        return true;
+    }
+
+    if ((size_t)uniform >= uniformShadows_.size()) {
+        UniformShadow_t unset = { 0, 0, 0, false };
+        uniformShadows_.resize(uniform + 1, unset);
+    }
+
+    size_t size = elementSize * numElements;
+    UniformShadow_t& shadow = uniformShadows_[uniform];
+    if (shadow.isSet && shadow.size == size && (size == 0 || memcmp(&uniformShadowData_[shadow.offset], value, size) == 0)) {
+        numSkippedUniformUploads_ += 1;
+        return false;
+    }
+
+    // The value is stored where the previous one was when it fits. Arrays reserve room for their declared length so
+    // that setting fewer elements reuses that room
+    if (size > shadow.capacity) {
+        shadow.offset = uniformShadowData_.size();
+        shadow.capacity = max(size, elementSize * GetUniformArrayLength(uniform));
+        uniformShadowData_.resize(uniformShadowData_.size() + shadow.capacity);
+    }
+
+    if (size > 0) {
+        memcpy(&uniformShadowData_[shadow.offset], value, size);
+    }
+    shadow.size = size;
+    shadow.isSet = true;
+
+    numIssuedUniformUploads_ += 1;
+    return true;
+}
+
+void Shader::ResetUniformUploadCounters() {
+    numIssuedUniformUploads_ = 0;
+    numSkippedUniformUploads_ = 0;
+}
+
+void Shader::LogUniformNotFound(const string& uniform) const {
+    LOG_DEBUG("Couldn't find uniform location of name " + uniform + " in shader #" + to_string(id_));
+}
+
 void SetBuiltinUniformName(BuiltinUniform_t builtinUniform, const string& uniformName) {
     builtUniformNames[builtinUniform] = uniformName;
 }
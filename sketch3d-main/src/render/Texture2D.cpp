@@ -2,6 +2,7 @@
 
 #include "render/TextureManager.h"
 #include "system/Logger.h"
+#include "system/Profiler.h"
 
 #include <FreeImage.h>
 
@@ -28,6 +29,8 @@ Texture2D::~Texture2D() {
 }
 
 bool Texture2D::Load(const string& filename) {
+    PROFILE_ZONE("Texture2D::Load");
+
     if (filename_ == filename) {
         return true;
     }
@@ -0,0 +1,76 @@
+#include "render/TextureUnitCache.h"
+
+namespace Sketch3D {
+
+TextureUnitCache::TextureUnitCache(size_t numTextureUnits) : useCounter_(0), numBinds_(0), numHits_(0), numEvictions_(0) {
+    SetNumTextureUnits(numTextureUnits);
+}
+
+void TextureUnitCache::SetNumTextureUnits(size_t numTextureUnits) {
+    textureUnits_.resize(numTextureUnits);
+    Clear();
+}
+
+bool TextureUnitCache::Acquire(uint32_t textureId, size_t& textureUnit) {
+    useCounter_ += 1;
+
+    if (textureUnits_.empty()) {
+        textureUnit = 0;
+        numBinds_ += 1;
+        return true;
+    }
+
+    unordered_map<uint32_t, size_t>::iterator it = textureToUnit_.find(textureId);
+    if (it != textureToUnit_.end()) {
+        textureUnit = it->second;
+        textureUnits_[textureUnit].lastUse = useCounter_;
+        numHits_ += 1;
+        return false;
+    }
+
+    // Take a free unit, or the one that was used the least recently. The textures acquired for the current draw call
+    // were used more recently than all the others, so they are never replaced as long as there are enough units
+    textureUnit = 0;
+    for (size_t i = 0; i < textureUnits_.size(); i++) {
+        if (!textureUnits_[i].isUsed) {
+            textureUnit = i;
+            break;
+        }
+
+        if (textureUnits_[i].lastUse < textureUnits_[textureUnit].lastUse) {
+            textureUnit = i;
+        }
+    }
+
+    TextureUnit_t& unit = textureUnits_[textureUnit];
+    if (unit.isUsed) {
+        textureToUnit_.erase(unit.textureId);
+        numEvictions_ += 1;
+    }
+
+    unit.textureId = textureId;
+    unit.isUsed = true;
+    unit.lastUse = useCounter_;
+    textureToUnit_[textureId] = textureUnit;
+
+    numBinds_ += 1;
+    return true;
+}
+
+void TextureUnitCache::Clear() {
+    for (size_t i = 0; i < textureUnits_.size(); i++) {
+        textureUnits_[i].textureId = 0;
+        textureUnits_[i].isUsed = false;
+        textureUnits_[i].lastUse = 0;
+    }
+
+    textureToUnit_.clear();
+}
+
+void TextureUnitCache::ResetCounters() {
+    numBinds_ = 0;
+    numHits_ = 0;
+    numEvictions_ = 0;
+}
+
+}
@@ -0,0 +1,321 @@
+#include "system/JobSystem.h"
+
+#include "system/Logger.h"
+#include "system/Profiler.h"
+
+#include <string>
+
+namespace Sketch3D {
+
+// Number of jobs that a deque can hold, must be a power of 2. The jobs that don't fit go in the shared queue
+const size_t JOB_DEQUE_CAPACITY = 4096;
+
+// Deque index of the threads that don't own a deque
+const size_t NO_JOB_DEQUE = (size_t)-1;
+
+/**
+ * @struct Job_t
+ * A function to run and the counter to decrement once it returned
+ */
+struct Job_t {
+    function<void()>    task;
+    JobCounter*         signal;
+};
+
+/**
+ * @class JobDeque
+ * Work-stealing deque of Chase and Lev with a fixed capacity. Only the owning thread pushes and pops at the bottom, the
+ * other threads steal at the top
+ */
+class JobDeque {
+    public:
+                            JobDeque() : top_(0), bottom_(0) {
+                                for (size_t i = 0; i < JOB_DEQUE_CAPACITY; i++) {
+                                    jobs_[i].store(nullptr, memory_order_relaxed);
+                                }
+                            }
+
+        /**
+         * Push a job at the bottom, only called by the owning thread
+         * @return false if the deque is full
+         */
+        bool                Push(Job_t* job) {
+                                int64_t bottom = bottom_.load(memory_order_relaxed);
+                                int64_t top = top_.load(memory_order_acquire);
+                                if (bottom - top >= (int64_t)JOB_DEQUE_CAPACITY) {
+                                    return false;
+                                }
+
+                                jobs_[bottom & (JOB_DEQUE_CAPACITY - 1)].store(job, memory_order_relaxed);
+                                atomic_thread_fence(memory_order_release);
+                                bottom_.store(bottom + 1, memory_order_relaxed);
+                                return true;
+                            }
+
+        /**
+         * Pop the job at the bottom, only called by the owning thread
+         */
+        Job_t*              Pop() {
+                                int64_t bottom = bottom_.load(memory_order_relaxed) - 1;
+                                bottom_.store(bottom, memory_order_relaxed);
+                                atomic_thread_fence(memory_order_seq_cst);
+                                int64_t top = top_.load(memory_order_relaxed);
+
+                                if (top > bottom) {
+                                    bottom_.store(bottom + 1, memory_order_relaxed);
+                                    return nullptr;
+                                }
+
+                                Job_t* job = jobs_[bottom & (JOB_DEQUE_CAPACITY - 1)].load(memory_order_relaxed);
+                                if (top == bottom) {
+                                    // Last job, race against the thieves
+                                    if (!top_.compare_exchange_strong(top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+                                        job = nullptr;
+                                    }
+                                    bottom_.store(bottom + 1, memory_order_relaxed);
+                                }
+
+                                return job;
+                            }
+
+        /**
+         * Steal the job at the top, called by any thread
+         */
+        Job_t*              Steal() {
+                                int64_t top = top_.load(memory_order_acquire);
+                                atomic_thread_fence(memory_order_seq_cst);
+                                int64_t bottom = bottom_.load(memory_order_acquire);
+
+                                if (top >= bottom) {
+                                    return nullptr;
+                                }
+
+                                Job_t* job = jobs_[top & (JOB_DEQUE_CAPACITY - 1)].load(memory_order_relaxed);
+                                if (!top_.compare_exchange_strong(top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+                                    return nullptr;
+                                }
+
+                                return job;
+                            }
+
+    private:
+        atomic<int64_t>     top_;
+        atomic<int64_t>     bottom_;
+        atomic<Job_t*>      jobs_[JOB_DEQUE_CAPACITY];
+};
+
+static thread_local size_t threadDequeIndex = NO_JOB_DEQUE;
+static thread_local uint32_t threadRandomState = 0;
+
+JobCounter::JobCounter() : value_(0) {
+}
+
+JobSystem JobSystem::instance_;
+
+JobSystem::JobSystem() : isInitialized_(false), numQueuedJobs_(0), numSleepingWorkers_(0), stopWorkers_(false) {
+}
+
+JobSystem::~JobSystem() {
+    stopWorkers_.store(true);
+    {
+        lock_guard<mutex> lock(sleepMutex_);
+        sleepCondition_.notify_all();
+    }
+
+    for (size_t i = 0; i < workerThreads_.size(); i++) {
+        workerThreads_[i].join();
+    }
+
+    // The jobs that were never run
+    Job_t* job;
+    for (size_t i = 0; i < deques_.size(); i++) {
+        while ((job = deques_[i]->Steal()) != nullptr) {
+            delete job;
+        }
+    }
+
+    for (size_t i = 0; i < sharedJobs_.size(); i++) {
+        delete sharedJobs_[i];
+    }
+}
+
+JobSystem* JobSystem::GetInstance() {
+    return &instance_;
+}
+
+void JobSystem::Initialize(size_t numWorkerThreads) {
+    lock_guard<mutex> lock(initializationMutex_);
+    if (isInitialized_.load(memory_order_relaxed)) {
+        Logger::GetInstance()->Warning("The job system was already initialized");
+        return;
+    }
+
+    StartWorkers(numWorkerThreads);
+}
+
+void JobSystem::Run(const function<void()>& task, JobCounter* signal, JobCounter* dependency) {
+    if (!isInitialized_.load(memory_order_acquire)) {
+        lock_guard<mutex> lock(initializationMutex_);
+        if (!isInitialized_.load(memory_order_relaxed)) {
+            StartWorkers(0);
+        }
+    }
+
+    Job_t* job = new Job_t;
+    job->task = task;
+    job->signal = signal;
+
+    if (signal != nullptr) {
+        signal->value_.fetch_add(1, memory_order_relaxed);
+    }
+
+    // The job is started by the last job of its dependency
+    if (dependency != nullptr) {
+        lock_guard<mutex> lock(dependency->waitingJobsMutex_);
+        if (dependency->value_.load(memory_order_acquire) > 0) {
+            dependency->waitingJobs_.push_back(job);
+            return;
+        }
+    }
+
+    Push(job);
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+    while (!counter.IsDone()) {
+        Job_t* job = FindJob();
+        if (job != nullptr) {
+            Execute(job);
+        } else {
+            this_thread::yield();
+        }
+    }
+
+    // The thread that released the counter may still be using it
+    lock_guard<mutex> lock(counter.waitingJobsMutex_);
+}
+
+void JobSystem::ParallelFor(size_t begin, size_t end, size_t grainSize, const function<void(size_t, size_t)>& body) {
+    if (grainSize == 0) {
+        grainSize = 1;
+    }
+
+    JobCounter counter;
+    for (size_t rangeBegin = begin; rangeBegin < end; rangeBegin += grainSize) {
+        size_t rangeEnd = (end - rangeBegin > grainSize) ? rangeBegin + grainSize : end;
+        Run([&body, rangeBegin, rangeEnd] () { body(rangeBegin, rangeEnd); }, &counter);
+    }
+
+    Wait(counter);
+}
+
+void JobSystem::StartWorkers(size_t numWorkerThreads) {
+    if (numWorkerThreads == 0) {
+        size_t numHardwareThreads = thread::hardware_concurrency();
+        numWorkerThreads = (numHardwareThreads > 1) ? numHardwareThreads - 1 : 0;
+    }
+
+    // The deques are never resized once the workers are started
+    for (size_t i = 0; i <= numWorkerThreads; i++) {
+        deques_.push_back(unique_ptr<JobDeque>(new JobDeque));
+    }
+
+    threadDequeIndex = 0;
+    for (size_t i = 0; i < numWorkerThreads; i++) {
+        workerThreads_.push_back(thread(&JobSystem::WorkerLoop, this, i + 1));
+    }
+
+    Logger::GetInstance()->Info("Job system started with " + to_string(numWorkerThreads) + " worker threads");
+    isInitialized_.store(true, memory_order_release);
+}
+
+void JobSystem::Push(Job_t* job) {
+    // Counted first so that a worker going to sleep sees the job
+    numQueuedJobs_.fetch_add(1);
+
+    if (threadDequeIndex == NO_JOB_DEQUE || !deques_[threadDequeIndex]->Push(job)) {
+        lock_guard<mutex> lock(sharedJobsMutex_);
+        sharedJobs_.push_back(job);
+    }
+
+    if (numSleepingWorkers_.load() > 0) {
+        lock_guard<mutex> lock(sleepMutex_);
+        sleepCondition_.notify_one();
+    }
+}
+
+Job_t* JobSystem::FindJob() {
+    Job_t* job = nullptr;
+    if (threadDequeIndex != NO_JOB_DEQUE) {
+        job = deques_[threadDequeIndex]->Pop();
+    }
+
+    // Steal from the other deques, starting with a random one so that the thieves don't all compete for the same deque
+    if (job == nullptr && !deques_.empty()) {
+        threadRandomState = threadRandomState * 1664525 + 1013904223;
+        size_t firstVictim = (threadRandomState >> 16) % deques_.size();
+        for (size_t i = 0; i < deques_.size() && job == nullptr; i++) {
+            size_t victim = (firstVictim + i) % deques_.size();
+            if (victim != threadDequeIndex) {
+                job = deques_[victim]->Steal();
+            }
+        }
+    }
+
+    if (job == nullptr) {
+        lock_guard<mutex> lock(sharedJobsMutex_);
+        if (!sharedJobs_.empty()) {
+            job = sharedJobs_.front();
+            sharedJobs_.pop_front();
+        }
+    }
+
+    if (job != nullptr) {
+        numQueuedJobs_.fetch_sub(1);
+    }
+
+    return job;
+}
+
+void JobSystem::Execute(Job_t* job) {
+    job->task();
+
+    // Release the jobs waiting for the signal once it reaches 0
+    vector<Job_t*> releasedJobs;
+    JobCounter* signal = job->signal;
+    if (signal != nullptr) {
+        lock_guard<mutex> lock(signal->waitingJobsMutex_);
+        if (signal->value_.fetch_sub(1, memory_order_acq_rel) == 1) {
+            releasedJobs.swap(signal->waitingJobs_);
+        }
+    }
+
+    delete job;
+
+    for (size_t i = 0; i < releasedJobs.size(); i++) {
+        Push(releasedJobs[i]);
+    }
+}
+
+void JobSystem::WorkerLoop(size_t dequeIndex) {
+    threadDequeIndex = dequeIndex;
+    threadRandomState = (uint32_t)dequeIndex;
+    PROFILE_THREAD_NAME("Worker " + to_string(dequeIndex));
+
+    while (!stopWorkers_.load()) {
+        Job_t* job = FindJob();
+        if (job != nullptr) {
+            Execute(job);
+            continue;
+        }
+
+        // Sleep until a job is pushed. The counter is incremented before checking for jobs so that a thread pushing a
+        // job either sees a sleeping worker or is seen by the worker
+        unique_lock<mutex> lock(sleepMutex_);
+        numSleepingWorkers_.fetch_add(1);
+        sleepCondition_.wait(lock, [this] () { return stopWorkers_.load() || numQueuedJobs_.load() > 0; });
+        numSleepingWorkers_.fetch_sub(1);
+    }
+}
+
+}
@@ -0,0 +1,71 @@
+#include "system/LinearAllocator.h"
+
+#include <stdint.h>
+
+namespace Sketch3D {
+
+LinearAllocator::LinearAllocator(size_t blockSize) : blockSize_(blockSize), currentBlock_(0), offset_(0), numHeapAllocations_(0) {
+}
+
+LinearAllocator::~LinearAllocator() {
+    for (size_t i = 0; i < blocks_.size(); i++) {
+        delete[] blocks_[i].data;
+    }
+}
+
+void* LinearAllocator::Allocate(size_t size) {
+    if (!blocks_.empty()) {
+        Block_t& block = blocks_[currentBlock_];
+
+        uintptr_t start = (uintptr_t)(block.data + offset_);
+        size_t padding = (SIMD_ALIGNMENT - (start & (SIMD_ALIGNMENT - 1))) & (SIMD_ALIGNMENT - 1);
+
+        if (offset_ + padding + size <= block.size) {
+            void* memory = block.data + offset_ + padding;
+            offset_ += padding + size;
+            return memory;
+        }
+    }
+
+    // Not enough space left, the allocation goes in a fresh block
+    AllocateBlock(size + SIMD_ALIGNMENT);
+    return Allocate(size);
+}
+
+void LinearAllocator::Reset() {
+    // Merge all the blocks in a single one big enough to hold everything that was allocated
+    if (blocks_.size() > 1) {
+        size_t totalSize = 0;
+        for (size_t i = 0; i < blocks_.size(); i++) {
+            totalSize += blocks_[i].size;
+            delete[] blocks_[i].data;
+        }
+        blocks_.clear();
+
+        AllocateBlock(totalSize);
+    }
+
+    currentBlock_ = 0;
+    offset_ = 0;
+}
+
+size_t LinearAllocator::GetNumHeapAllocations() const {
+    return numHeapAllocations_;
+}
+
+void LinearAllocator::AllocateBlock(size_t size) {
+    if (size < blockSize_) {
+        size = blockSize_;
+    }
+
+    Block_t block;
+    block.data = new char[size];
+    block.size = size;
+    blocks_.push_back(block);
+
+    currentBlock_ = blocks_.size() - 1;
+    offset_ = 0;
+    numHeapAllocations_ += 1;
+}
+
+}
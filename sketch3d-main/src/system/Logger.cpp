@@ -2,13 +2,100 @@
 
 #include "system/Platform.h"
 
+#include <chrono>
 #include <ctime>
+#include <stdint.h>
+#include <string.h>
 
 namespace Sketch3D {
 
+// Size of the ring buffer of each thread in bytes, must be a power of 2
+const size_t LOGGER_THREAD_BUFFER_SIZE = 65536;
+
+// The longer messages are truncated
+const size_t LOGGER_MAX_MESSAGE_LENGTH = 4096;
+
+// Number of messages whose last occurrence is remembered by each thread
+const size_t LOGGER_NUM_RECENT_MESSAGES = 64;
+
+// Number of seconds during which a message isn't written again
+const time_t LOGGER_REPEAT_INTERVAL = 2;
+
+// Time between two wake ups of the writer thread
+const chrono::milliseconds LOGGER_WRITER_PERIOD(10);
+
+// Level of the records that only fill the end of the ring buffer
+const int32_t LOGGER_RECORD_PADDING = -1;
+
+/**
+ * @struct LoggerRecord_t
+ * Header of a message in a ring buffer, followed by the text of the message
+ */
+struct LoggerRecord_t {
+    uint32_t    size;           /**< Size of the record with its text, a multiple of 8 bytes */
+    int32_t     level;
+    uint32_t    length;         /**< Length of the text */
+    uint32_t    numRepeats;     /**< Number of times the message was dropped since it was last written */
+    int64_t     time;
+};
+
+/**
+ * @struct LoggerRecentMessage_t
+ * The last occurrence of a message, used to drop its repetitions
+ */
+struct LoggerRecentMessage_t {
+    uint64_t    hash;
+    time_t      time;
+    uint32_t    numRepeats;
+};
+
+/**
+ * @struct LoggerThreadBuffer_t
+ * Single producer single consumer ring buffer of the messages of a thread. The thread advances the tail, the writer
+ * thread advances the head. Both only grow, the offset in the data being their value modulo the size of the buffer
+ */
+struct LoggerThreadBuffer_t {
+    unsigned char           data[LOGGER_THREAD_BUFFER_SIZE];
+    atomic<size_t>          head;
+    atomic<size_t>          tail;
+    atomic<size_t>          numDroppedMessages;
+    atomic<bool>            isOwned;        /**< false once the thread exited, the buffer can then be given to a new thread */
+    LoggerRecentMessage_t   recentMessages[LOGGER_NUM_RECENT_MESSAGES];    /**< Only used by the owning thread */
+};
+
+/**
+ * @struct LoggerThreadBufferOwner_t
+ * Gives the buffer of a thread back to the logger when the thread exits
+ */
+struct LoggerThreadBufferOwner_t {
+    LoggerThreadBuffer_t*   buffer;
+
+                            LoggerThreadBufferOwner_t() : buffer(nullptr) {}
+                           ~LoggerThreadBufferOwner_t() {
+                                if (buffer != nullptr) {
+                                    buffer->isOwned.store(false, memory_order_release);
+                                }
+                            }
+};
+
+static thread_local LoggerThreadBufferOwner_t threadBufferOwner;
+
+static uint64_t HashMessage(LoggerLevel_t level, const char* message, size_t length) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL ^ (uint64_t)level;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)message[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
 Logger Logger::instance_;
 
-Logger::Logger() : level_(LOGGER_LEVEL_INFO) {
+Logger::Logger() : level_(LOGGER_LEVEL_INFO), isShutDown_(false), numFlushRequests_(0), numCompletedFlushRequests_(0),
+                   stopWriter_(false), numReportedDroppedMessages_(0)
+{
 	file_.open("Log.html");
 	file_ << "<html><head><style type=\"text/css\">p {margin:3}</style>" <<
 			 "</head><body bgcolor=\"#8a8a8a\">" << endl;
@@ -18,6 +105,18 @@ Logger::Logger() : level_(LOGGER_LEVEL_INFO) {
 }
 
 Logger::~Logger() {
+    isShutDown_.store(true, memory_order_relaxed);
+
+    if (writerThread_.joinable()) {
+        {
+            lock_guard<mutex> lock(writerMutex_);
+            stopWriter_ = true;
+        }
+
+        writerCondition_.notify_one();
+        writerThread_.join();
+    }
+
 	file_ << "</body></html>";
 	file_.close();
 }
@@ -27,44 +126,260 @@ Logger* Logger::GetInstance() {
 }
 
 void Logger::SetLoggerLevel(LoggerLevel_t level) {
-    level_ = level;
+    level_.store(level, memory_order_relaxed);
 }
 
-void Logger::Debug(const string& message) {
-    if (level_ >= LOGGER_LEVEL_DEBUG) {
-	    file_ << "<p style=\"background-color:#aabbcc\">[DEBUG] ";
-	    file_ << GetCurrentTime() << " - ";
-	    file_ << message;
-	    file_ << "</p>" << endl;
+void Logger::Log(LoggerLevel_t level, const char* message) {
+    if (IsLevelEnabled(level)) {
+        Write(level, message, strlen(message));
     }
 }
 
-void Logger::Info(const string& message) {
-    if (level_ >= LOGGER_LEVEL_INFO) {
-	    file_ << "<p>" << GetCurrentTime() << " - " << message << "</p>" << endl;
+void Logger::Log(LoggerLevel_t level, const string& message) {
+    if (IsLevelEnabled(level)) {
+        Write(level, message.c_str(), message.size());
     }
 }
 
+void Logger::Debug(const string& message) {
+    Log(LOGGER_LEVEL_DEBUG, message);
+}
+
+void Logger::Info(const string& message) {
+    Log(LOGGER_LEVEL_INFO, message);
+}
+
 void Logger::Warning(const string& message) {
-    if (level_ >= LOGGER_LEVEL_WARNING) {
-	    file_ << "<p style=\"background-color:#ffbb12\">[WARNING] ";
-	    file_ << GetCurrentTime() << " - ";
-	    file_ << message;
-	    file_ << "</p>" << endl;
-    }
+    Log(LOGGER_LEVEL_WARNING, message);
 }
 
 void Logger::Error(const string& message) {
-    if (level_ >= LOGGER_LEVEL_ERROR) {
-	    file_ << "<p style=\"background-color:#ff0012\">[ERROR] ";
-	    file_ << GetCurrentTime() << " - ";
-	    file_ << message;
-	    file_ << "</p>" << endl;
+    Log(LOGGER_LEVEL_ERROR, message);
+}
+
+void Logger::Flush() {
+    unique_lock<mutex> lock(writerMutex_);
+    if (!writerThread_.joinable() || stopWriter_) {
+        return;
+    }
+
+    size_t request = ++numFlushRequests_;
+    writerCondition_.notify_one();
+    flushCondition_.wait(lock, [this, request] () { return numCompletedFlushRequests_ >= request; });
+}
+
+size_t Logger::GetNumDroppedMessages() const {
+    size_t numDroppedMessages = 0;
+
+    lock_guard<mutex> lock(threadBuffersMutex_);
+    for (size_t i = 0; i < threadBuffers_.size(); i++) {
+        numDroppedMessages += threadBuffers_[i]->numDroppedMessages.load(memory_order_relaxed);
+    }
+
+    return numDroppedMessages;
+}
+
+void Logger::Write(LoggerLevel_t level, const char* message, size_t length) {
+    if (isShutDown_.load(memory_order_relaxed)) {
+        return;
+    }
+
+    LoggerThreadBuffer_t* buffer = GetThreadBuffer();
+    time_t now = time(0);
+
+    // Only count the messages repeated recently
+    uint64_t hash = HashMessage(level, message, length);
+    LoggerRecentMessage_t& recentMessage = buffer->recentMessages[hash % LOGGER_NUM_RECENT_MESSAGES];
+    uint32_t numRepeats = 0;
+    if (recentMessage.hash == hash) {
+        if (now - recentMessage.time < LOGGER_REPEAT_INTERVAL) {
+            recentMessage.numRepeats += 1;
+            return;
+        }
+
+        numRepeats = recentMessage.numRepeats;
+    }
+
+    recentMessage.hash = hash;
+    recentMessage.time = now;
+    recentMessage.numRepeats = 0;
+
+    if (length > LOGGER_MAX_MESSAGE_LENGTH) {
+        length = LOGGER_MAX_MESSAGE_LENGTH;
+    }
+
+    size_t recordSize = (sizeof(LoggerRecord_t) + length + 7) & ~(size_t)7;
+    size_t tail = buffer->tail.load(memory_order_relaxed);
+    size_t head = buffer->head.load(memory_order_acquire);
+
+    // A record never wraps around the end of the buffer, the end is skipped if the record doesn't fit in it
+    size_t offset = tail & (LOGGER_THREAD_BUFFER_SIZE - 1);
+    size_t paddingSize = (LOGGER_THREAD_BUFFER_SIZE - offset < recordSize) ? LOGGER_THREAD_BUFFER_SIZE - offset : 0;
+    if (LOGGER_THREAD_BUFFER_SIZE - (tail - head) < paddingSize + recordSize) {
+        buffer->numDroppedMessages.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+
+    if (paddingSize > 0) {
+        // The writer thread skips the ends that are too small for a header by itself
+        if (paddingSize >= sizeof(LoggerRecord_t)) {
+            LoggerRecord_t* padding = reinterpret_cast<LoggerRecord_t*>(buffer->data + offset);
+            padding->size = (uint32_t)paddingSize;
+            padding->level = LOGGER_RECORD_PADDING;
+        }
+
+        tail += paddingSize;
+        offset = 0;
+    }
+
+    LoggerRecord_t* record = reinterpret_cast<LoggerRecord_t*>(buffer->data + offset);
+    record->size = (uint32_t)recordSize;
+    record->level = level;
+    record->length = (uint32_t)length;
+    record->numRepeats = numRepeats;
+    record->time = (int64_t)now;
+    memcpy(record + 1, message, length);
+
+    // Publish the record to the writer thread
+    buffer->tail.store(tail + recordSize, memory_order_release);
+}
+
+LoggerThreadBuffer_t* Logger::GetThreadBuffer() {
+    if (threadBufferOwner.buffer != nullptr) {
+        return threadBufferOwner.buffer;
+    }
+
+    lock_guard<mutex> lock(threadBuffersMutex_);
+
+    // Reuse the buffer of a thread that exited, the writer thread still writes the messages left in it
+    LoggerThreadBuffer_t* buffer = nullptr;
+    for (size_t i = 0; i < threadBuffers_.size(); i++) {
+        if (!threadBuffers_[i]->isOwned.load(memory_order_acquire)) {
+            buffer = threadBuffers_[i].get();
+            break;
+        }
+    }
+
+    if (buffer == nullptr) {
+        buffer = new LoggerThreadBuffer_t;
+        buffer->head.store(0, memory_order_relaxed);
+        buffer->tail.store(0, memory_order_relaxed);
+        buffer->numDroppedMessages.store(0, memory_order_relaxed);
+        threadBuffers_.push_back(unique_ptr<LoggerThreadBuffer_t>(buffer));
+    }
+
+    buffer->isOwned.store(true, memory_order_relaxed);
+    memset(buffer->recentMessages, 0, sizeof(buffer->recentMessages));
+    threadBufferOwner.buffer = buffer;
+
+    // The writer thread is started with the first message rather than with the static objects
+    {
+        lock_guard<mutex> writerLock(writerMutex_);
+        if (!writerThread_.joinable()) {
+            writerThread_ = thread(&Logger::WriterLoop, this);
+        }
+    }
+
+    return buffer;
+}
+
+void Logger::WriterLoop() {
+    unique_lock<mutex> lock(writerMutex_);
+    while (true) {
+        size_t request = numFlushRequests_;
+        bool stop = stopWriter_;
+
+        lock.unlock();
+        WriteThreadBuffers();
+        lock.lock();
+
+        numCompletedFlushRequests_ = request;
+        flushCondition_.notify_all();
+
+        if (stop) {
+            break;
+        }
+
+        if (numFlushRequests_ == request && !stopWriter_) {
+            writerCondition_.wait_for(lock, LOGGER_WRITER_PERIOD);
+        }
+    }
+}
+
+void Logger::WriteThreadBuffers() {
+    vector<LoggerThreadBuffer_t*> buffers;
+    {
+        lock_guard<mutex> lock(threadBuffersMutex_);
+        for (size_t i = 0; i < threadBuffers_.size(); i++) {
+            buffers.push_back(threadBuffers_[i].get());
+        }
+    }
+
+    bool wroteMessages = false;
+    size_t numDroppedMessages = 0;
+
+    for (size_t i = 0; i < buffers.size(); i++) {
+        LoggerThreadBuffer_t* buffer = buffers[i];
+        size_t head = buffer->head.load(memory_order_relaxed);
+        size_t tail = buffer->tail.load(memory_order_acquire);
+
+        while (head != tail) {
+            size_t offset = head & (LOGGER_THREAD_BUFFER_SIZE - 1);
+            if (LOGGER_THREAD_BUFFER_SIZE - offset < sizeof(LoggerRecord_t)) {
+                head += LOGGER_THREAD_BUFFER_SIZE - offset;
+                continue;
+            }
+
+            const LoggerRecord_t* record = reinterpret_cast<const LoggerRecord_t*>(buffer->data + offset);
+            if (record->level != LOGGER_RECORD_PADDING) {
+                switch (record->level) {
+                    case LOGGER_LEVEL_DEBUG:
+                        file_ << "<p style=\"background-color:#aabbcc\">[DEBUG] ";
+                        break;
+
+                    case LOGGER_LEVEL_WARNING:
+                        file_ << "<p style=\"background-color:#ffbb12\">[WARNING] ";
+                        break;
+
+                    case LOGGER_LEVEL_ERROR:
+                        file_ << "<p style=\"background-color:#ff0012\">[ERROR] ";
+                        break;
+
+                    default:
+                        file_ << "<p>";
+                        break;
+                }
+
+                file_ << FormatTime((time_t)record->time) << " - ";
+                file_.write(reinterpret_cast<const char*>(record + 1), record->length);
+                if (record->numRepeats > 0) {
+                    file_ << " (repeated " << record->numRepeats << " times)";
+                }
+                file_ << "</p>\n";
+
+                wroteMessages = true;
+            }
+
+            head += record->size;
+        }
+
+        buffer->head.store(head, memory_order_release);
+        numDroppedMessages += buffer->numDroppedMessages.load(memory_order_relaxed);
+    }
+
+    if (numDroppedMessages > numReportedDroppedMessages_) {
+        file_ << "<p style=\"background-color:#ffbb12\">[WARNING] " << FormatTime(time(0)) << " - " <<
+                 numDroppedMessages - numReportedDroppedMessages_ << " messages were dropped, the log buffer was full</p>\n";
+        numReportedDroppedMessages_ = numDroppedMessages;
+        wroteMessages = true;
+    }
+
+    if (wroteMessages) {
+        file_.flush();
     }
 }
 
-string Logger::GetCurrentTime() const {
-	time_t t = time(0);
+string Logger::FormatTime(time_t t) const {
 	struct tm* now;
     now = localtime(&t);
 
@@ -190,11 +190,28 @@ namespace Sketch3D
 #endif
     }
 
+    static bool CheckOperatingSystemSupportAVX()
+    {
+        // The OS has to save the full ymm registers on context switches, which is reported in XCR0
+        unsigned int xcr0 = 0;
+#if COMPILER == COMPILER_MSVC
+#   if _MSC_FULL_VER >= 160040219
+        xcr0 = (unsigned int)_xgetbv(0);
+#   endif
+#elif COMPILER == COMPILER_GNUC
+        unsigned int edx;
+        __asm__ __volatile__ ("xgetbv" : "=a" (xcr0), "=d" (edx) : "c" (0));
+#endif
+        return (xcr0 & 0x6) == 0x6;
+    }
+
     static unsigned int QueryCpuFeatures()
     {
 #define CPUID_STD_MMX       (1 << 23)
 #define CPUID_STD_SSE       (1 << 25)
 #define CPUID_STD_SSE2      (1 << 26)
+#define CPUID_STD_OSXSAVE   (1 << 27)
+#define CPUID_STD_AVX       (1 << 28)
 
         unsigned int features = 0;
         if (SupportCpuid()) {
@@ -232,6 +249,11 @@ namespace Sketch3D
                         features |= PlatformInformation::SSE2;
 						Logger::GetInstance()->Info("SSE2 supported");
                     }
+
+                    if ((result._ecx & CPUID_STD_AVX) && (result._ecx & CPUID_STD_OSXSAVE) && CheckOperatingSystemSupportAVX()) {
+                        features |= PlatformInformation::AVX;
+						Logger::GetInstance()->Info("AVX supported");
+                    }
 				}
             }
         } else {
@@ -249,7 +271,7 @@ namespace Sketch3D
         const unsigned int sse_features = PlatformInformation::SSE |
             PlatformInformation::SSE2;
         if ((features & sse_features) && !CheckOperatingSystemSupportSSE()) {
-            features &= ~sse_features;
+            features &= ~(sse_features | PlatformInformation::AVX);
         }
 
         return features;
@@ -0,0 +1,278 @@
+#include "system/Profiler.h"
+
+#include "system/Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+namespace Sketch3D {
+
+// Number of events that a thread keeps by default
+const size_t PROFILER_DEFAULT_MAX_EVENTS_PER_THREAD = 65536;
+
+/**
+ * @struct ProfilerEventSlot_t
+ * An event of a thread buffer. The fields are atomics so that the readers can copy the slot while its thread overwrites
+ * it, the copies of the overwritten slots being thrown away afterwards
+ */
+struct ProfilerEventSlot_t {
+    atomic<const char*>     name;
+    atomic<uint64_t>        start;
+    atomic<uint64_t>        end;
+    atomic<uint32_t>        depth;
+};
+
+/**
+ * @struct ProfilerThreadBuffer_t
+ * The events recorded by a thread, used as a ring. Only the thread writes in it, the event i being stored at
+ * i % capacity. numWrittenEvents is incremented before an event is written, so that the readers know which events
+ * they may have seen overwritten, and numEvents once it is written to publish it
+ */
+struct ProfilerThreadBuffer_t {
+    size_t                  threadIndex;
+    string                  name;               /**< Protected by the mutex of the profiler */
+    unique_ptr<ProfilerEventSlot_t[]> events;   /**< Allocated once, never resized */
+    size_t                  capacity;
+    atomic<size_t>          numEvents;          /**< Number of events recorded since the last clear, overwritten ones included */
+    atomic<size_t>          numWrittenEvents;   /**< numEvents plus the event being written, if any */
+};
+
+static thread_local ProfilerThreadBuffer_t* threadBuffer = nullptr;
+static thread_local uint32_t threadDepth = 0;
+
+static uint64_t GetClockTime() {
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Copy the events kept by a thread, from the oldest to the newest. The events that the thread overwrote during the copy
+ * are removed from it
+ */
+static void ReadThreadEvents(const ProfilerThreadBuffer_t& buffer, vector<ProfilerEvent_t>& events) {
+    size_t capacity = buffer.capacity;
+    size_t numEvents = buffer.numEvents.load(memory_order_acquire);
+    size_t firstEvent = (numEvents > capacity) ? numEvents - capacity : 0;
+
+    size_t firstCopiedEvent = events.size();
+    for (size_t i = firstEvent; i < numEvents; i++) {
+        const ProfilerEventSlot_t& slot = buffer.events[i % capacity];
+
+        ProfilerEvent_t event;
+        event.name = slot.name.load(memory_order_relaxed);
+        event.start = slot.start.load(memory_order_relaxed);
+        event.end = slot.end.load(memory_order_relaxed);
+        event.depth = slot.depth.load(memory_order_relaxed);
+        events.push_back(event);
+    }
+
+    // The thread kept recording during the copy, the oldest copied events may have been overwritten
+    atomic_thread_fence(memory_order_acquire);
+    size_t numWrittenEvents = buffer.numWrittenEvents.load(memory_order_relaxed);
+    if (numWrittenEvents > firstEvent + capacity) {
+        size_t numOverwrittenEvents = min(numWrittenEvents - capacity - firstEvent, numEvents - firstEvent);
+        events.erase(events.begin() + firstCopiedEvent, events.begin() + firstCopiedEvent + numOverwrittenEvents);
+    }
+}
+
+static void WriteJsonString(ofstream& file, const string& value) {
+    file << "\"";
+    for (size_t i = 0; i < value.size(); i++) {
+        char c = value[i];
+        if (c == '"' || c == '\\') {
+            file << '\\' << c;
+        } else if ((unsigned char)c < 0x20) {
+            file << ' ';
+        } else {
+            file << c;
+        }
+    }
+    file << "\"";
+}
+
+Profiler Profiler::instance_;
+
+Profiler::Profiler() : enabled_(true), maxEventsPerThread_(PROFILER_DEFAULT_MAX_EVENTS_PER_THREAD),
+                       startTime_(GetClockTime())
+{
+}
+
+Profiler::~Profiler() {
+}
+
+Profiler* Profiler::GetInstance() {
+    return &instance_;
+}
+
+void Profiler::SetEnabled(bool enabled) {
+    enabled_.store(enabled, memory_order_relaxed);
+}
+
+void Profiler::SetMaxEventsPerThread(size_t maxEvents) {
+    lock_guard<mutex> lock(threadBuffersMutex_);
+    maxEventsPerThread_ = maxEvents;
+}
+
+void Profiler::SetThreadName(const string& name) {
+    ProfilerThreadBuffer_t* buffer = GetThreadBuffer();
+
+    lock_guard<mutex> lock(threadBuffersMutex_);
+    buffer->name = name;
+}
+
+uint64_t Profiler::GetTime() const {
+    return GetClockTime() - startTime_;
+}
+
+void Profiler::AddEvent(const char* name, uint64_t start, uint64_t end, uint32_t depth) {
+    ProfilerThreadBuffer_t* buffer = GetThreadBuffer();
+
+    size_t capacity = buffer->capacity;
+    size_t numEvents = buffer->numEvents.load(memory_order_relaxed);
+    if (capacity == 0) {
+        buffer->numEvents.store(numEvents + 1, memory_order_relaxed);
+        buffer->numWrittenEvents.store(numEvents + 1, memory_order_relaxed);
+        return;
+    }
+
+    // Tell the readers which event is being written, the slot holding the oldest event once the buffer is full
+    buffer->numWrittenEvents.store(numEvents + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    ProfilerEventSlot_t& slot = buffer->events[numEvents % capacity];
+    slot.name.store(name, memory_order_relaxed);
+    slot.start.store(start, memory_order_relaxed);
+    slot.end.store(end, memory_order_relaxed);
+    slot.depth.store(depth, memory_order_relaxed);
+
+    // Publish the event to the threads reading the events
+    buffer->numEvents.store(numEvents + 1, memory_order_release);
+}
+
+vector<ProfilerEvent_t> Profiler::GetEvents(vector<size_t>* threadIndices) const {
+    vector<ProfilerEvent_t> events;
+    if (threadIndices != NULL) {
+        threadIndices->clear();
+    }
+
+    lock_guard<mutex> lock(threadBuffersMutex_);
+    for (size_t i = 0; i < threadBuffers_.size(); i++) {
+        const ProfilerThreadBuffer_t& buffer = *threadBuffers_[i];
+        size_t numPreviousEvents = events.size();
+        ReadThreadEvents(buffer, events);
+
+        if (threadIndices != NULL) {
+            threadIndices->insert(threadIndices->end(), events.size() - numPreviousEvents, buffer.threadIndex);
+        }
+    }
+
+    return events;
+}
+
+size_t Profiler::GetNumDroppedEvents() const {
+    size_t numDroppedEvents = 0;
+
+    lock_guard<mutex> lock(threadBuffersMutex_);
+    for (size_t i = 0; i < threadBuffers_.size(); i++) {
+        size_t numEvents = threadBuffers_[i]->numEvents.load(memory_order_relaxed);
+        size_t capacity = threadBuffers_[i]->capacity;
+        if (numEvents > capacity) {
+            numDroppedEvents += numEvents - capacity;
+        }
+    }
+
+    return numDroppedEvents;
+}
+
+void Profiler::Clear() {
+    lock_guard<mutex> lock(threadBuffersMutex_);
+    for (size_t i = 0; i < threadBuffers_.size(); i++) {
+        threadBuffers_[i]->numEvents.store(0, memory_order_relaxed);
+        threadBuffers_[i]->numWrittenEvents.store(0, memory_order_relaxed);
+    }
+}
+
+bool Profiler::ExportChromeTrace(const string& filename) const {
+    ofstream file(filename.c_str());
+    if (!file.is_open()) {
+        Logger::GetInstance()->Error("Couldn't open profiler trace file " + filename);
+        return false;
+    }
+
+    // The trace event timestamps are in microseconds
+    file << "{\"traceEvents\":[" << fixed << setprecision(3);
+    bool isFirstEvent = true;
+
+    lock_guard<mutex> lock(threadBuffersMutex_);
+    vector<ProfilerEvent_t> events;
+    for (size_t i = 0; i < threadBuffers_.size(); i++) {
+        const ProfilerThreadBuffer_t& buffer = *threadBuffers_[i];
+
+        if (!buffer.name.empty()) {
+            file << (isFirstEvent ? "\n" : ",\n");
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer.threadIndex << ",\"args\":{\"name\":";
+            WriteJsonString(file, buffer.name);
+            file << "}}";
+            isFirstEvent = false;
+        }
+
+        events.clear();
+        ReadThreadEvents(buffer, events);
+        for (size_t j = 0; j < events.size(); j++) {
+            const ProfilerEvent_t& event = events[j];
+            file << (isFirstEvent ? "\n" : ",\n");
+            file << "{\"name\":";
+            WriteJsonString(file, event.name);
+            file << ",\"ph\":\"X\",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << (event.end - event.start) / 1000.0 <<
+                    ",\"pid\":0,\"tid\":" << buffer.threadIndex << "}";
+            isFirstEvent = false;
+        }
+    }
+
+    file << "\n],\"displayTimeUnit\":\"ms\"}" << endl;
+
+    if (file.fail()) {
+        Logger::GetInstance()->Error("Couldn't write profiler trace file " + filename);
+        return false;
+    }
+
+    return true;
+}
+
+ProfilerThreadBuffer_t* Profiler::GetThreadBuffer() {
+    if (threadBuffer == nullptr) {
+        lock_guard<mutex> lock(threadBuffersMutex_);
+
+        ProfilerThreadBuffer_t* buffer = new ProfilerThreadBuffer_t;
+        buffer->threadIndex = threadBuffers_.size();
+        buffer->events.reset(new ProfilerEventSlot_t[maxEventsPerThread_]);
+        buffer->capacity = maxEventsPerThread_;
+        buffer->numEvents.store(0, memory_order_relaxed);
+        buffer->numWrittenEvents.store(0, memory_order_relaxed);
+        threadBuffers_.push_back(unique_ptr<ProfilerThreadBuffer_t>(buffer));
+
+        threadBuffer = buffer;
+    }
+
+    return threadBuffer;
+}
+
+ProfilerZone::ProfilerZone(const char* name) : name_(NULL), start_(0), depth_(0) {
+    Profiler* profiler = Profiler::GetInstance();
+    if (profiler->IsEnabled()) {
+        name_ = name;
+        depth_ = threadDepth++;
+        start_ = profiler->GetTime();
+    }
+}
+
+ProfilerZone::~ProfilerZone() {
+    if (name_ != NULL) {
+        Profiler* profiler = Profiler::GetInstance();
+        profiler->AddEvent(name_, start_, profiler->GetTime(), depth_);
+        threadDepth--;
+    }
+}
+
+}
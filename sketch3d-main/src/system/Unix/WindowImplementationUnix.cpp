@@ -21,7 +21,9 @@ WindowImplementationUnix::WindowImplementationUnix(const string& title, unsigned
 {
     Logger::GetInstance()->Info("Unix X window creation");
 
-    // Open a connection with the X server
+    // Open a connection with the X server. The window events are polled while the renderer may swap the buffers on its
+    // render thread, so Xlib has to lock the display
+    XInitThreads();
     display_ = XOpenDisplay(NULL);
     screen_ = DefaultScreen(display_);
     ::Window root = RootWindow(display_, screen_);
@@ -0,0 +1,167 @@
+#include <boost/test/unit_test.hpp>
+
+#include "math/CullingKernels.h"
+
+#include <stdlib.h>
+#include <vector>
+
+using namespace Sketch3D;
+
+// Not a multiple of 8, so that the kernels also go through their scalar tail
+static const size_t NUM_TEST_SPHERES = 203;
+
+static float RandomFloat(float minimum, float maximum)
+{
+    return minimum + (float)rand() / (float)RAND_MAX * (maximum - minimum);
+}
+
+/**
+ * Planes of the box [-10, 10]^3, with the normals pointing inside
+ */
+static void GenerateBoxPlanes(float* planes)
+{
+    const float normals[6][3] = {
+        { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }, { 1.0f, 0.0f, 0.0f },
+        { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }
+    };
+
+    for (size_t i = 0; i < 6; i++) {
+        planes[i * 4] = normals[i][0];
+        planes[i * 4 + 1] = normals[i][1];
+        planes[i * 4 + 2] = normals[i][2];
+        planes[i * 4 + 3] = 10.0f;
+    }
+}
+
+struct TestSpheres_t {
+    vector<float>   centersX;
+    vector<float>   centersY;
+    vector<float>   centersZ;
+    vector<float>   radii;
+    vector<uint8_t> planeHints;
+
+    SphereBatch_t GetBatch(bool useHints)
+    {
+        SphereBatch_t batch;
+        batch.centersX = &centersX[0];
+        batch.centersY = &centersY[0];
+        batch.centersZ = &centersZ[0];
+        batch.radii = &radii[0];
+        batch.planeHints = (useHints) ? &planeHints[0] : nullptr;
+        batch.numSpheres = radii.size();
+        return batch;
+    }
+};
+
+static TestSpheres_t GenerateSpheres(size_t numSpheres)
+{
+    TestSpheres_t spheres;
+    for (size_t i = 0; i < numSpheres; i++) {
+        spheres.centersX.push_back(RandomFloat(-20.0f, 20.0f));
+        spheres.centersY.push_back(RandomFloat(-20.0f, 20.0f));
+        spheres.centersZ.push_back(RandomFloat(-20.0f, 20.0f));
+        spheres.radii.push_back(RandomFloat(0.1f, 5.0f));
+        spheres.planeHints.push_back(0);
+    }
+
+    return spheres;
+}
+
+static bool IsVisible(const vector<uint32_t>& visibility, size_t sphere)
+{
+    return (visibility[sphere / 32] & (1u << (sphere % 32))) != 0;
+}
+
+static vector<const CullingKernels_t*> GetAllCullingKernels()
+{
+    vector<const CullingKernels_t*> kernels;
+    kernels.push_back(GetCullingKernels(CULLING_KERNELS_SCALAR));
+
+    const CullingKernels_t* sse2 = GetCullingKernels(CULLING_KERNELS_SSE2);
+    if (sse2 != nullptr) {
+        kernels.push_back(sse2);
+    }
+
+    const CullingKernels_t* avx = GetCullingKernels(CULLING_KERNELS_AVX);
+    if (avx != nullptr) {
+        kernels.push_back(avx);
+    }
+
+    return kernels;
+}
+
+BOOST_AUTO_TEST_CASE(test_culling_kernels_selection)
+{
+    const CullingKernels_t& selected = GetCullingKernels();
+    BOOST_REQUIRE(GetCullingKernels(selected.type) == &selected);
+    BOOST_REQUIRE(GetNumVisibilityWords(0) == 0);
+    BOOST_REQUIRE(GetNumVisibilityWords(32) == 1);
+    BOOST_REQUIRE(GetNumVisibilityWords(33) == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_culling_kernels_cull_spheres)
+{
+    float planes[24];
+    GenerateBoxPlanes(planes);
+
+    srand(42);
+    TestSpheres_t spheres = GenerateSpheres(NUM_TEST_SPHERES);
+
+    vector<const CullingKernels_t*> kernels = GetAllCullingKernels();
+    for (size_t i = 0; i < kernels.size(); i++) {
+        TestSpheres_t testSpheres = spheres;
+        vector<uint32_t> visibility(GetNumVisibilityWords(NUM_TEST_SPHERES), 0xFFFFFFFF);
+        kernels[i]->cullSpheres(planes, 6, testSpheres.GetBatch(false), &visibility[0]);
+
+        for (size_t j = 0; j < NUM_TEST_SPHERES; j++) {
+            bool isOutside = false;
+            for (size_t k = 0; k < 6; k++) {
+                const float* plane = planes + k * 4;
+                float distance = (plane[0] * spheres.centersX[j] + plane[1] * spheres.centersY[j]) +
+                                 (plane[2] * spheres.centersZ[j] + plane[3]);
+                isOutside = isOutside || distance < -spheres.radii[j];
+            }
+
+            BOOST_REQUIRE(IsVisible(visibility, j) == !isOutside);
+        }
+
+        // The bits past the last sphere are cleared
+        BOOST_REQUIRE((visibility.back() >> (NUM_TEST_SPHERES % 32)) == 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_culling_kernels_plane_hints)
+{
+    float planes[24];
+    GenerateBoxPlanes(planes);
+
+    srand(7);
+    TestSpheres_t spheres = GenerateSpheres(NUM_TEST_SPHERES);
+    vector<uint32_t> expected(GetNumVisibilityWords(NUM_TEST_SPHERES));
+    GetCullingKernels(CULLING_KERNELS_SCALAR)->cullSpheres(planes, 6, spheres.GetBatch(false), &expected[0]);
+
+    vector<const CullingKernels_t*> kernels = GetAllCullingKernels();
+    for (size_t i = 0; i < kernels.size(); i++) {
+        TestSpheres_t testSpheres = spheres;
+
+        // Invalid hints are ignored
+        testSpheres.planeHints[0] = 200;
+
+        // The hints only change the order of the tests, not the result
+        for (size_t frame = 0; frame < 2; frame++) {
+            vector<uint32_t> visibility(GetNumVisibilityWords(NUM_TEST_SPHERES));
+            kernels[i]->cullSpheres(planes, 6, testSpheres.GetBatch(true), &visibility[0]);
+            BOOST_REQUIRE(visibility == expected);
+        }
+
+        // Each rejected sphere remembers a plane that rejects it. The first one may have kept its invalid hint
+        for (size_t j = 1; j < NUM_TEST_SPHERES; j++) {
+            if (!IsVisible(expected, j)) {
+                const float* plane = planes + testSpheres.planeHints[j] * 4;
+                float distance = (plane[0] * spheres.centersX[j] + plane[1] * spheres.centersY[j]) +
+                                 (plane[2] * spheres.centersZ[j] + plane[3]);
+                BOOST_REQUIRE(distance < -spheres.radii[j]);
+            }
+        }
+    }
+}
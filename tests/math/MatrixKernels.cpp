@@ -0,0 +1,221 @@
+#include <boost/test/unit_test.hpp>
+
+#include "math/MatrixKernels.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace Sketch3D;
+
+static const size_t NUM_TEST_MATRICES = 64;
+
+// Relative comparison, since the SIMD inverse doesn't compute the same intermediate values as the scalar one
+static bool CompareTo(float a, float b, float tolerance)
+{
+    return fabs(a - b) <= tolerance * fmax(1.0f, fmax(fabs(a), fabs(b)));
+}
+
+static bool CompareTo(const float* a, const float* b, size_t size, float tolerance)
+{
+    for (size_t i = 0; i < size; i++) {
+        if (!CompareTo(a[i], b[i], tolerance)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Random matrices with a dominant diagonal, so that they are well conditioned for the inverse
+static void GenerateMatrix(float* m)
+{
+    for (size_t i = 0; i < 16; i++) {
+        m[i] = (float)rand() / (float)RAND_MAX * 2.0f - 1.0f;
+    }
+
+    for (size_t i = 0; i < 4; i++) {
+        m[i * 5] += 4.0f;
+    }
+}
+
+static vector<const MatrixKernels_t*> GetSimdKernels()
+{
+    vector<const MatrixKernels_t*> kernels;
+
+    const MatrixKernels_t* sse2 = GetMatrixKernels(MATRIX_KERNELS_SSE2);
+    if (sse2 != nullptr) {
+        kernels.push_back(sse2);
+    }
+
+    const MatrixKernels_t* avx = GetMatrixKernels(MATRIX_KERNELS_AVX);
+    if (avx != nullptr) {
+        kernels.push_back(avx);
+    }
+
+    return kernels;
+}
+
+BOOST_AUTO_TEST_CASE(test_matrix_kernels_selection)
+{
+    const MatrixKernels_t* scalar = GetMatrixKernels(MATRIX_KERNELS_SCALAR);
+    BOOST_REQUIRE(scalar != nullptr);
+    BOOST_REQUIRE(scalar->type == MATRIX_KERNELS_SCALAR);
+
+    // The selected kernels must be one of the supported implementations
+    const MatrixKernels_t& selected = GetMatrixKernels();
+    BOOST_REQUIRE(GetMatrixKernels(selected.type) == &selected);
+}
+
+BOOST_AUTO_TEST_CASE(test_matrix_kernels_multiply)
+{
+    const MatrixKernels_t* scalar = GetMatrixKernels(MATRIX_KERNELS_SCALAR);
+    vector<const MatrixKernels_t*> kernels = GetSimdKernels();
+
+    srand(42);
+    for (size_t i = 0; i < NUM_TEST_MATRICES; i++) {
+        float a[16], b[16], expected[16];
+        GenerateMatrix(a);
+        GenerateMatrix(b);
+        scalar->multiply(a, b, expected);
+
+        for (size_t j = 0; j < kernels.size(); j++) {
+            float result[16];
+            kernels[j]->multiply(a, b, result);
+            BOOST_REQUIRE(CompareTo(result, expected, 16, 1e-6f));
+
+            // The result can overwrite the inputs
+            float aliased[16];
+            memcpy(aliased, a, sizeof(a));
+            kernels[j]->multiply(aliased, b, aliased);
+            BOOST_REQUIRE(CompareTo(aliased, expected, 16, 1e-6f));
+
+            memcpy(aliased, b, sizeof(b));
+            kernels[j]->multiply(a, aliased, aliased);
+            BOOST_REQUIRE(CompareTo(aliased, expected, 16, 1e-6f));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_matrix_kernels_transpose)
+{
+    const MatrixKernels_t* scalar = GetMatrixKernels(MATRIX_KERNELS_SCALAR);
+    vector<const MatrixKernels_t*> kernels = GetSimdKernels();
+
+    srand(42);
+    for (size_t i = 0; i < NUM_TEST_MATRICES; i++) {
+        float m[16], expected[16];
+        GenerateMatrix(m);
+        scalar->transpose(m, expected);
+
+        for (size_t j = 0; j < kernels.size(); j++) {
+            float result[16];
+            kernels[j]->transpose(m, result);
+            BOOST_REQUIRE(memcmp(result, expected, sizeof(expected)) == 0);
+
+            memcpy(result, m, sizeof(m));
+            kernels[j]->transpose(result, result);
+            BOOST_REQUIRE(memcmp(result, expected, sizeof(expected)) == 0);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_matrix_kernels_inverse)
+{
+    const MatrixKernels_t* scalar = GetMatrixKernels(MATRIX_KERNELS_SCALAR);
+    vector<const MatrixKernels_t*> kernels = GetSimdKernels();
+
+    srand(42);
+    for (size_t i = 0; i < NUM_TEST_MATRICES; i++) {
+        float m[16], expected[16];
+        GenerateMatrix(m);
+        scalar->inverse(m, expected);
+
+        for (size_t j = 0; j < kernels.size(); j++) {
+            float result[16];
+            kernels[j]->inverse(m, result);
+            BOOST_REQUIRE(CompareTo(result, expected, 16, 1e-5f));
+
+            memcpy(result, m, sizeof(m));
+            kernels[j]->inverse(result, result);
+            BOOST_REQUIRE(CompareTo(result, expected, 16, 1e-5f));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_matrix_kernels_transform_vector)
+{
+    const MatrixKernels_t* scalar = GetMatrixKernels(MATRIX_KERNELS_SCALAR);
+    vector<const MatrixKernels_t*> kernels = GetSimdKernels();
+
+    srand(42);
+    for (size_t i = 0; i < NUM_TEST_MATRICES; i++) {
+        float m[16], v[4], expected[4], expectedRow[4];
+        GenerateMatrix(m);
+        for (size_t k = 0; k < 4; k++) {
+            v[k] = (float)rand() / (float)RAND_MAX * 20.0f - 10.0f;
+        }
+
+        scalar->transformVector(m, v, expected);
+        scalar->transformRowVector(v, m, expectedRow);
+
+        for (size_t j = 0; j < kernels.size(); j++) {
+            float result[4];
+            kernels[j]->transformVector(m, v, result);
+            BOOST_REQUIRE(CompareTo(result, expected, 4, 1e-6f));
+
+            kernels[j]->transformRowVector(v, m, result);
+            BOOST_REQUIRE(CompareTo(result, expectedRow, 4, 1e-6f));
+
+            memcpy(result, v, sizeof(v));
+            kernels[j]->transformVector(m, result, result);
+            BOOST_REQUIRE(CompareTo(result, expected, 4, 1e-6f));
+
+            memcpy(result, v, sizeof(v));
+            kernels[j]->transformRowVector(result, m, result);
+            BOOST_REQUIRE(CompareTo(result, expectedRow, 4, 1e-6f));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_matrix_kernels_batches)
+{
+    vector<const MatrixKernels_t*> kernels = GetSimdKernels();
+    kernels.push_back(GetMatrixKernels(MATRIX_KERNELS_SCALAR));
+
+    srand(42);
+    float a[16];
+    GenerateMatrix(a);
+
+    vector<float> matrices(NUM_TEST_MATRICES * 16);
+    for (size_t i = 0; i < NUM_TEST_MATRICES; i++) {
+        GenerateMatrix(&matrices[i * 16]);
+    }
+
+    for (size_t j = 0; j < kernels.size(); j++) {
+        vector<float> products(matrices.size());
+        vector<float> normals(matrices.size());
+        kernels[j]->multiplyBatch(a, &matrices[0], NUM_TEST_MATRICES, &products[0]);
+        kernels[j]->inverseTransposeBatch(&matrices[0], NUM_TEST_MATRICES, &normals[0]);
+
+        for (size_t i = 0; i < NUM_TEST_MATRICES; i++) {
+            float expected[16];
+            kernels[j]->multiply(a, &matrices[i * 16], expected);
+            BOOST_REQUIRE(CompareTo(&products[i * 16], expected, 16, 1e-6f));
+
+            kernels[j]->inverse(&matrices[i * 16], expected);
+            kernels[j]->transpose(expected, expected);
+            BOOST_REQUIRE(CompareTo(&normals[i * 16], expected, 16, 1e-5f));
+        }
+
+        // The results can overwrite the matrices
+        vector<float> aliased(matrices);
+        kernels[j]->multiplyBatch(a, &aliased[0], NUM_TEST_MATRICES, &aliased[0]);
+        BOOST_REQUIRE(CompareTo(&aliased[0], &products[0], aliased.size(), 1e-6f));
+
+        aliased = matrices;
+        kernels[j]->inverseTransposeBatch(&aliased[0], NUM_TEST_MATRICES, &aliased[0]);
+        BOOST_REQUIRE(CompareTo(&aliased[0], &normals[0], aliased.size(), 1e-5f));
+    }
+}
@@ -0,0 +1,165 @@
+#include <boost/test/unit_test.hpp>
+
+#include "math/Sphere.h"
+#include "math/Vector3.h"
+
+#include "render/BoundingVolumeHierarchy.h"
+#include "render/Renderer_Common.h"
+
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+using namespace Sketch3D;
+
+// Frustum shaped like the box [-10, 10]^3, with the normals pointing inside
+static FrustumPlanes_t CreateBoxFrustum() {
+    FrustumPlanes_t frustumPlanes;
+    frustumPlanes.nearPlane = Plane(Vector3(0.0f, 0.0f, 1.0f), 10.0f);
+    frustumPlanes.farPlane = Plane(Vector3(0.0f, 0.0f, -1.0f), 10.0f);
+    frustumPlanes.leftPlane = Plane(Vector3(1.0f, 0.0f, 0.0f), 10.0f);
+    frustumPlanes.rightPlane = Plane(Vector3(-1.0f, 0.0f, 0.0f), 10.0f);
+    frustumPlanes.bottomPlane = Plane(Vector3(0.0f, 1.0f, 0.0f), 10.0f);
+    frustumPlanes.topPlane = Plane(Vector3(0.0f, -1.0f, 0.0f), 10.0f);
+    return frustumPlanes;
+}
+
+static Node* FakeNode(size_t index) {
+    return reinterpret_cast<Node*>(index + 1);
+}
+
+static vector<Node*> BruteForceQuery(const FrustumPlanes_t& frustumPlanes, const vector<Sphere>& spheres) {
+    vector<Node*> visibleNodes;
+    for (size_t i = 0; i < spheres.size(); i++) {
+        const Plane* planes[6] = {
+            &frustumPlanes.nearPlane, &frustumPlanes.farPlane, &frustumPlanes.leftPlane,
+            &frustumPlanes.rightPlane, &frustumPlanes.bottomPlane, &frustumPlanes.topPlane
+        };
+
+        bool isOutside = false;
+        for (size_t j = 0; j < 6; j++) {
+            if (spheres[i].IntersectsPlane(*planes[j]) == RELATIVE_PLANE_POSITION_OUTSIDE) {
+                isOutside = true;
+            }
+        }
+
+        if (!isOutside) {
+            visibleNodes.push_back(FakeNode(i));
+        }
+    }
+
+    return visibleNodes;
+}
+
+BOOST_AUTO_TEST_CASE(test_bvh_query_matches_brute_force)
+{
+    BoundingVolumeHierarchy hierarchy;
+    vector<Sphere> spheres;
+    vector<BvhProxy_t> proxies;
+
+    for (int x = -20; x <= 20; x += 4) {
+        for (int y = -20; y <= 20; y += 4) {
+            for (int z = -20; z <= 20; z += 8) {
+                Sphere sphere(Vector3((float)x, (float)y, (float)z), 1.5f);
+                proxies.push_back(hierarchy.CreateProxy(sphere, FakeNode(spheres.size())));
+                spheres.push_back(sphere);
+            }
+        }
+    }
+
+    BOOST_REQUIRE(hierarchy.GetNumProxies() == spheres.size());
+
+    // A balanced tree is logarithmic in the number of leaves
+    BOOST_REQUIRE(hierarchy.GetHeight() < 20);
+
+    FrustumPlanes_t frustumPlanes = CreateBoxFrustum();
+    vector<Node*> visibleNodes;
+    hierarchy.Query(frustumPlanes, visibleNodes);
+    vector<Node*> expectedNodes = BruteForceQuery(frustumPlanes, spheres);
+
+    sort(visibleNodes.begin(), visibleNodes.end());
+    sort(expectedNodes.begin(), expectedNodes.end());
+    BOOST_REQUIRE(!expectedNodes.empty());
+    BOOST_REQUIRE(visibleNodes == expectedNodes);
+
+    // Move some nodes by a small and a large amount, then remove others
+    for (size_t i = 0; i < spheres.size(); i += 3) {
+        float offset = (i % 2 == 0) ? 0.05f : 15.0f;
+        spheres[i] = Sphere(spheres[i].GetCenter() + Vector3(offset, 0.0f, -offset), spheres[i].GetRadius());
+        hierarchy.MoveProxy(proxies[i], spheres[i]);
+    }
+
+    vector<Sphere> remainingSpheres(spheres.size(), Sphere(Vector3(1000.0f, 0.0f, 0.0f), 1.0f));
+    for (size_t i = 0; i < spheres.size(); i++) {
+        if (i % 5 == 0) {
+            hierarchy.DestroyProxy(proxies[i]);
+        } else {
+            remainingSpheres[i] = spheres[i];
+        }
+    }
+
+    visibleNodes.clear();
+    hierarchy.Query(frustumPlanes, visibleNodes);
+    expectedNodes = BruteForceQuery(frustumPlanes, remainingSpheres);
+
+    sort(visibleNodes.begin(), visibleNodes.end());
+    sort(expectedNodes.begin(), expectedNodes.end());
+    BOOST_REQUIRE(visibleNodes == expectedNodes);
+
+    vector<Node*> allNodes;
+    hierarchy.GetAllNodes(allNodes);
+    BOOST_REQUIRE(allNodes.size() == hierarchy.GetNumProxies());
+}
+
+BOOST_AUTO_TEST_CASE(test_bvh_parallel_culling_matches_brute_force)
+{
+    BoundingVolumeHierarchy hierarchy;
+    vector<Sphere> spheres;
+
+    // A wall of nodes straddling the left plane, so that enough leaves are left to test to split them between jobs
+    for (int y = 0; y < 150; y++) {
+        for (int z = 0; z < 150; z++) {
+            float offset = (float)((y + z) % 4) - 1.5f;
+            Sphere sphere(Vector3(-10.0f + offset, -9.0f + y * 0.12f, -9.0f + z * 0.12f), 1.0f);
+            hierarchy.CreateProxy(sphere, FakeNode(spheres.size()));
+            spheres.push_back(sphere);
+        }
+    }
+
+    FrustumPlanes_t frustumPlanes = CreateBoxFrustum();
+    vector<Node*> expectedNodes = BruteForceQuery(frustumPlanes, spheres);
+    sort(expectedNodes.begin(), expectedNodes.end());
+    BOOST_REQUIRE(!expectedNodes.empty());
+    BOOST_REQUIRE(expectedNodes.size() < spheres.size());
+
+    // The second query starts with the planes that rejected the leaves during the first one
+    for (size_t i = 0; i < 2; i++) {
+        vector<Node*> visibleNodes;
+        hierarchy.Query(frustumPlanes, visibleNodes);
+
+        sort(visibleNodes.begin(), visibleNodes.end());
+        BOOST_REQUIRE(visibleNodes == expectedNodes);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_bvh_small_moves_are_not_reinserted)
+{
+    BoundingVolumeHierarchy hierarchy;
+    BvhProxy_t proxy = hierarchy.CreateProxy(Sphere(Vector3(0.0f, 0.0f, 0.0f), 10.0f), FakeNode(0));
+
+    BOOST_REQUIRE(!hierarchy.MoveProxy(proxy, Sphere(Vector3(0.5f, 0.0f, 0.0f), 10.0f)));
+    BOOST_REQUIRE(hierarchy.MoveProxy(proxy, Sphere(Vector3(5.0f, 0.0f, 0.0f), 10.0f)));
+
+    // The exact sphere is used for the leaves even when the node wasn't reinserted
+    hierarchy.MoveProxy(proxy, Sphere(Vector3(5.0f, 0.0f, 0.0f), 10.5f));
+    vector<Node*> visibleNodes;
+    hierarchy.Query(CreateBoxFrustum(), visibleNodes);
+    BOOST_REQUIRE(visibleNodes.size() == 1);
+
+    hierarchy.DestroyProxy(proxy);
+    BOOST_REQUIRE(hierarchy.GetNumProxies() == 0);
+
+    visibleNodes.clear();
+    hierarchy.Query(CreateBoxFrustum(), visibleNodes);
+    BOOST_REQUIRE(visibleNodes.empty());
+}
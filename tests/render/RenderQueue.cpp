@@ -0,0 +1,94 @@
+#include <boost/test/unit_test.hpp>
+
+#include "render/RenderQueue.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+using namespace std;
+
+using namespace Sketch3D;
+
+static bool CompareKeys(const RenderQueueKey_t& lhs, const RenderQueueKey_t& rhs) {
+    return lhs.key < rhs.key;
+}
+
+static uint64_t RandomKey() {
+    return ((uint64_t)rand() << 48) ^ ((uint64_t)rand() << 24) ^ (uint64_t)rand();
+}
+
+/**
+ * Radix sorts the keys and checks that the items end up in the same order as with stable_sort
+ * @return The indices of the items, in sorted order
+ */
+static vector<size_t> CheckRadixSortIsStable(const vector<RenderQueueKey_t>& keys) {
+    vector<RenderQueueKey_t> expectedKeys(keys);
+    stable_sort(expectedKeys.begin(), expectedKeys.end(), CompareKeys);
+
+    vector<RenderQueueKey_t> sortedKeys(keys);
+    vector<RenderQueueKey_t> scratch(keys.size());
+    const RenderQueueKey_t* result = RenderQueue::RadixSortKeys(&sortedKeys[0], &scratch[0], keys.size());
+
+    vector<size_t> indices;
+    for (size_t i = 0; i < keys.size(); i++) {
+        BOOST_REQUIRE_EQUAL(result[i].key, expectedKeys[i].key);
+        BOOST_REQUIRE_EQUAL(result[i].index, expectedKeys[i].index);
+        indices.push_back(result[i].index);
+    }
+
+    return indices;
+}
+
+BOOST_AUTO_TEST_CASE(test_radix_sort_matches_stable_sort)
+{
+    srand(42);
+
+    // Few distinct keys, so that most of the keys have duplicates
+    vector<uint64_t> distinctKeys;
+    for (size_t i = 0; i < 16; i++) {
+        distinctKeys.push_back(RandomKey());
+    }
+
+    vector<RenderQueueKey_t> keys(1000);
+    for (size_t i = 0; i < keys.size(); i++) {
+        keys[i].key = distinctKeys[rand() % distinctKeys.size()];
+        keys[i].index = i;
+    }
+    CheckRadixSortIsStable(keys);
+
+    // Keys that only differ in their highest bytes, the passes of the lowest bytes are skipped
+    for (size_t i = 0; i < keys.size(); i++) {
+        keys[i].key = ((uint64_t)(rand() % 4) << 62) | ((uint64_t)(rand() % 8) << 48) | 0x1234;
+        keys[i].index = i;
+    }
+    CheckRadixSortIsStable(keys);
+
+    // All the keys are the same, every pass is skipped
+    for (size_t i = 0; i < keys.size(); i++) {
+        keys[i].key = 0x0123456789ABCDEFULL;
+    }
+    CheckRadixSortIsStable(keys);
+}
+
+BOOST_AUTO_TEST_CASE(test_radix_sort_keeps_order_of_previous_frame)
+{
+    srand(7);
+
+    vector<RenderQueueKey_t> keys(500);
+    for (size_t i = 0; i < keys.size(); i++) {
+        keys[i].key = RandomKey() % 64;
+        keys[i].index = i;
+    }
+    vector<size_t> itemsIndex = CheckRadixSortIsStable(keys);
+
+    // On the next frame, the keys are gathered in the order of the last frame and some of them changed. The items
+    // that share a key keep the order of the last frame rather than the order in which they were added
+    for (int frame = 0; frame < 4; frame++) {
+        for (size_t i = 0; i < keys.size(); i++) {
+            size_t idx = itemsIndex[i];
+            keys[i].key = (rand() % 4 == 0) ? RandomKey() % 64 : idx % 64;
+            keys[i].index = idx;
+        }
+        itemsIndex = CheckRadixSortIsStable(keys);
+    }
+}
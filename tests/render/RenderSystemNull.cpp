@@ -0,0 +1,280 @@
+#include <boost/test/unit_test.hpp>
+
+#include "math/Matrix4x4.h"
+
+#include "render/FrameStatistics.h"
+
+#include "render/Null/BufferObjectManagerNull.h"
+#include "render/Null/BufferObjectNull.h"
+#include "render/Null/RenderCommandLog.h"
+#include "render/Null/RenderStateCacheNull.h"
+#include "render/Null/ShaderNull.h"
+
+using namespace Sketch3D;
+
+BOOST_AUTO_TEST_CASE(test_null_shader_reflects_declared_uniforms)
+{
+    RenderCommandLog log;
+    ShaderNull shader(&log);
+
+    BOOST_REQUIRE(shader.SetSource("uniform mat4 modelViewProjection;\n"
+                                   "uniform highp vec3 lightPosition;\n"
+                                   "uniform Lights { vec4 colors[4]; };\n"
+                                   "vec3 uniformity;\n",
+                                   "uniform sampler2D texture0;\n"
+                                   "uniform mat4 modelViewProjection;\n"));
+
+    BOOST_REQUIRE(shader.GetUniformHandle("modelViewProjection") == 0);
+    BOOST_REQUIRE(shader.GetUniformHandle("lightPosition") == 1);
+    BOOST_REQUIRE(shader.GetUniformHandle("texture0") == 2);
+    BOOST_REQUIRE(shader.GetUniformHandle("Lights") == INVALID_UNIFORM_HANDLE);
+    BOOST_REQUIRE(shader.GetUniformHandle("uniformity") == INVALID_UNIFORM_HANDLE);
+    BOOST_REQUIRE(shader.GetUniformName(1) == "lightPosition");
+
+    BOOST_REQUIRE(shader.GetBuiltinUniformHandle(MODEL_VIEW_PROJECTION) == 0);
+    BOOST_REQUIRE(shader.GetBuiltinUniformHandle(MODEL) == INVALID_UNIFORM_HANDLE);
+    BOOST_REQUIRE(shader.UsesBuiltinUniform(MODEL_VIEW_PROJECTION));
+    BOOST_REQUIRE(!shader.UsesBuiltinUniform(TRANS_INV_MODEL_VIEW));
+    BOOST_REQUIRE(shader.GetBuiltinUniformMask() == ((1u << MODEL_VIEW_PROJECTION) | (1u << TEXTURE_0)));
+}
+
+BOOST_AUTO_TEST_CASE(test_null_shader_records_uniforms)
+{
+    RenderCommandLog log;
+    ShaderNull shader(&log);
+    shader.SetSource("uniform mat4 modelViewProjection;\n", "uniform float time;\n");
+
+    BOOST_REQUIRE(shader.SetUniformMatrix4x4("modelViewProjection", Matrix4x4::IDENTITY));
+    BOOST_REQUIRE(shader.SetUniformFloat(shader.GetUniformHandle("time"), 1.0f));
+    BOOST_REQUIRE(!shader.SetUniformFloat(INVALID_UNIFORM_HANDLE, 1.0f));
+
+    const vector<RecordedCommand_t>& commands = log.GetCommands();
+    BOOST_REQUIRE(commands.size() == 2);
+    BOOST_REQUIRE(commands[0].type == RECORDED_COMMAND_SET_UNIFORM);
+    BOOST_REQUIRE(commands[0].objectId == shader.GetId());
+    BOOST_REQUIRE(commands[0].arguments[0] == 0);
+    BOOST_REQUIRE(commands[0].arguments[1] == RECORDED_UNIFORM_MATRIX4X4);
+    BOOST_REQUIRE(commands[1].arguments[0] == 1);
+    BOOST_REQUIRE(commands[1].arguments[1] == RECORDED_UNIFORM_FLOAT);
+}
+
+BOOST_AUTO_TEST_CASE(test_shader_skips_unchanged_uniforms)
+{
+    RenderCommandLog log;
+    ShaderNull shader(&log);
+    shader.SetSource("uniform vec3 lightPosition;\nuniform vec3 offsets[4];\n", "uniform float time;\n");
+
+    UniformHandle_t lightPosition = shader.GetUniformHandle("lightPosition");
+    Vector3 offsets[] = { Vector3(1.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f) };
+
+    shader.SetUniformVector3(lightPosition, Vector3(1.0f, 2.0f, 3.0f));
+    shader.SetUniformVector3("lightPosition", Vector3(1.0f, 2.0f, 3.0f));
+    shader.SetUniformVector3(lightPosition, Vector3(1.0f, 2.0f, 4.0f));
+    shader.SetUniformVector3Array("offsets", offsets, 3);
+    shader.SetUniformVector3Array("offsets", offsets, 3);
+    shader.SetUniformVector3Array("offsets", offsets, 2);
+
+    BOOST_REQUIRE(log.GetCommands().size() == 4);
+    BOOST_REQUIRE(shader.GetNumIssuedUniformUploads() == 4);
+    BOOST_REQUIRE(shader.GetNumSkippedUniformUploads() == 2);
+
+    // A new program starts from the default values
+    shader.SetSource("uniform vec3 lightPosition;\n", "uniform float time;\n");
+    shader.SetUniformVector3("lightPosition", Vector3(1.0f, 2.0f, 4.0f));
+    BOOST_REQUIRE(log.GetCommands().size() == 5);
+
+    shader.ResetUniformUploadCounters();
+    BOOST_REQUIRE(shader.GetNumIssuedUniformUploads() == 0);
+    BOOST_REQUIRE(shader.GetNumSkippedUniformUploads() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_shader_reuses_shadow_of_arrays)
+{
+    RenderCommandLog log;
+    ShaderNull shader(&log);
+    shader.SetSource("uniform mat4 bones[2];\nuniform float time;\n", "uniform float time;\n");
+
+    UniformHandle_t bones = shader.GetUniformHandle("bones");
+    Matrix4x4 values[] = { Matrix4x4::IDENTITY, Matrix4x4::IDENTITY };
+
+    // The shadow of the array is sized for its declared length when the uniform is first set
+    shader.SetUniformMatrix4x4Array(bones, values, 1);
+    size_t shadowSize = shader.GetUniformShadowSize();
+    BOOST_REQUIRE(shadowSize == 2 * sizeof(Matrix4x4));
+
+    for (int i = 0; i < 1000; i++) {
+        shader.SetUniformMatrix4x4Array(bones, values, 1 + (i + 1) % 2);
+    }
+
+    BOOST_REQUIRE(shader.GetUniformShadowSize() == shadowSize);
+    BOOST_REQUIRE(shader.GetNumIssuedUniformUploads() == 1001);
+
+    shader.SetUniformMatrix4x4Array(bones, values, 1);
+    BOOST_REQUIRE(shader.GetNumSkippedUniformUploads() == 1);
+
+    // Values set with an empty array don't read the shadow data
+    shader.SetSource("uniform mat4 bones[2];\n", "uniform float time;\n");
+    shader.SetUniformMatrix4x4Array(bones, values, 0);
+    shader.SetUniformMatrix4x4Array(bones, values, 0);
+    BOOST_REQUIRE(shader.GetNumSkippedUniformUploads() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_null_buffer_object_records_draws)
+{
+    RenderCommandLog log;
+    VertexAttributesMap_t vertexAttributes;
+    vertexAttributes[VERTEX_ATTRIBUTES_POSITION] = 0;
+    BufferObjectNull bufferObject(&log, vertexAttributes);
+
+    vector<float> vertices(9, 0.0f);
+    unsigned short indices[] = { 0, 1, 2 };
+    BOOST_REQUIRE(bufferObject.SetVertexData(vertices, 0) == BUFFER_OBJECT_ERROR_NONE);
+    BOOST_REQUIRE(bufferObject.SetIndexData(indices, 3) == BUFFER_OBJECT_ERROR_NONE);
+
+    bufferObject.Render();
+    bufferObject.RenderInstances(vector<Matrix4x4>(5));
+
+    BOOST_REQUIRE(log.CountCommands(RECORDED_COMMAND_DRAW) == 1);
+    BOOST_REQUIRE(log.CountCommands(RECORDED_COMMAND_DRAW_INSTANCED) == 1);
+    BOOST_REQUIRE(log.GetCommands()[0].objectId == bufferObject.GetId());
+    BOOST_REQUIRE(log.GetCommands()[0].arguments[0] == 3);
+    BOOST_REQUIRE(log.GetCommands()[1].arguments[1] == 5);
+}
+
+BOOST_AUTO_TEST_CASE(test_frame_counters)
+{
+    RenderCommandLog log;
+    VertexAttributesMap_t vertexAttributes;
+    vertexAttributes[VERTEX_ATTRIBUTES_POSITION] = 0;
+    BufferObjectNull bufferObject(&log, vertexAttributes);
+
+    // The uploads of the buffer objects are counted in bytes
+    BufferUploadCounter::Reset();
+    vector<float> vertices(9, 0.0f);
+    unsigned short indices[] = { 0, 1, 2 };
+    bufferObject.SetVertexData(vertices, 0);
+    bufferObject.SetIndexData(indices, 3);
+    BOOST_REQUIRE(BufferUploadCounter::GetNumUploadedBytes() == 9 * sizeof(float) + 3 * sizeof(unsigned short));
+    BOOST_REQUIRE(bufferObject.GetIndexCount() == 3);
+
+    BufferUploadCounter::Reset();
+    BOOST_REQUIRE(BufferUploadCounter::GetNumUploadedBytes() == 0);
+
+    // Only the render states that reach the device are counted
+    RenderStateCacheNull renderStateCache(&log);
+    renderStateCache.ResetRenderStateChangeCounter();
+    renderStateCache.EnableBlending(true);
+    renderStateCache.EnableDepthTest(true);
+    renderStateCache.ApplyRenderStateChanges();
+    BOOST_REQUIRE(renderStateCache.GetNumRenderStateChanges() == 1);
+
+    RenderStateBlock_t block;
+    block.isDepthWriteEnabled = false;
+    renderStateCache.ApplyRenderStateBlock(renderStateCache.CreateRenderStateBlock(block));
+    BOOST_REQUIRE(renderStateCache.GetNumRenderStateChanges() == 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_multi_draw_draws_each_range)
+{
+    RenderCommandLog log;
+    BufferObjectManagerNull bufferObjectManager(&log);
+    VertexAttributesMap_t vertexAttributes;
+    vertexAttributes[VERTEX_ATTRIBUTES_POSITION] = 0;
+    BufferObject* first = bufferObjectManager.CreateBufferObject(vertexAttributes);
+    BufferObject* second = bufferObjectManager.CreateBufferObject(vertexAttributes);
+
+    MultiDrawCommand_t commands[2];
+    commands[0].bufferObject = first;
+    commands[0].firstInstance = 0;
+    commands[0].numInstances = 3;
+    commands[1].bufferObject = second;
+    commands[1].firstInstance = 3;
+    commands[1].numInstances = 2;
+    bufferObjectManager.RenderMultiDraw(commands, 2, vector<Matrix4x4>(5));
+
+    // Without multi-draw support, the buffer objects are drawn one after the other with their own instances
+    const vector<RecordedCommand_t>& recordedCommands = log.GetCommands();
+    BOOST_REQUIRE(recordedCommands.size() == 2);
+    BOOST_REQUIRE(recordedCommands[0].type == RECORDED_COMMAND_DRAW_INSTANCED);
+    BOOST_REQUIRE(recordedCommands[0].objectId == first->GetId());
+    BOOST_REQUIRE(recordedCommands[0].arguments[1] == 3);
+    BOOST_REQUIRE(recordedCommands[1].objectId == second->GetId());
+    BOOST_REQUIRE(recordedCommands[1].arguments[1] == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_null_render_state_cache_records_changes)
+{
+    RenderCommandLog log;
+    RenderStateCacheNull renderStateCache(&log);
+    log.Clear();
+
+    // Only the states that changed reach the device
+    renderStateCache.EnableBlending(true);
+    renderStateCache.EnableDepthWrite(true);
+    renderStateCache.ApplyRenderStateChanges();
+
+    BOOST_REQUIRE(log.GetCommands().size() == 1);
+    BOOST_REQUIRE(log.GetCommands()[0].objectId == RECORDED_RENDER_STATE_BLENDING);
+    BOOST_REQUIRE(log.GetCommands()[0].arguments[0] == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_render_state_blocks)
+{
+    RenderCommandLog log;
+    RenderStateCacheNull renderStateCache(&log);
+    log.Clear();
+
+    RenderStateBlock_t opaque;
+    RenderStateBlock_t transparent;
+    transparent.isBlendingEnabled = true;
+    transparent.isDepthWriteEnabled = false;
+    transparent.sourceBlendingFactor = BLENDING_FACTOR_SRC_ALPHA;
+    transparent.destinationBlendingFactor = BLENDING_FACTOR_ONE_MINUS_SRC_ALPHA;
+
+    // Identical blocks share the same handle
+    RenderStateBlockHandle_t opaqueBlock = renderStateCache.CreateRenderStateBlock(opaque);
+    RenderStateBlockHandle_t transparentBlock = renderStateCache.CreateRenderStateBlock(transparent);
+    BOOST_REQUIRE(opaqueBlock != transparentBlock);
+    BOOST_REQUIRE(renderStateCache.CreateRenderStateBlock(RenderStateBlock_t()) == opaqueBlock);
+    BOOST_REQUIRE(renderStateCache.GetNumRenderStateBlocks() == 2);
+
+    // The default states are already on the device
+    renderStateCache.ApplyRenderStateBlock(opaqueBlock);
+    BOOST_REQUIRE(log.GetCommands().empty());
+
+    // Only the blending, depth write and blending factors differ
+    renderStateCache.ApplyRenderStateBlock(transparentBlock);
+    BOOST_REQUIRE(log.GetCommands().size() == 3);
+    renderStateCache.ApplyRenderStateBlock(transparentBlock);
+    BOOST_REQUIRE(log.GetCommands().size() == 3);
+
+    // A state set individually is compared with the block applied afterwards
+    renderStateCache.SetCullingMethod(CULLING_METHOD_FRONT_FACE);
+    renderStateCache.ApplyRenderStateChanges();
+    log.Clear();
+    renderStateCache.ApplyRenderStateBlock(transparentBlock);
+    BOOST_REQUIRE(log.GetCommands().size() == 1);
+    BOOST_REQUIRE(log.GetCommands()[0].objectId == RECORDED_RENDER_STATE_CULLING_METHOD);
+
+    // The changes that weren't applied yet are replaced by the block
+    renderStateCache.EnableDepthTest(false);
+    renderStateCache.ApplyRenderStateBlock(transparentBlock);
+    renderStateCache.ApplyRenderStateChanges();
+    BOOST_REQUIRE(log.GetCommands().size() == 1);
+    BOOST_REQUIRE(renderStateCache.GetCurrentRenderState().isDepthTestEnabled);
+}
+
+BOOST_AUTO_TEST_CASE(test_command_log)
+{
+    RenderCommandLog log;
+    log.Record(RECORDED_COMMAND_CLEAR, RECORDED_NULL_OBJECT, 3);
+    log.Record(RECORDED_COMMAND_DRAW, 7, 36);
+    BOOST_REQUIRE(log.ToString() == "Clear - 3 0 0 0\nDraw 7 36 0 0 0\n");
+
+    log.SetEnabled(false);
+    log.Record(RECORDED_COMMAND_PRESENT);
+    BOOST_REQUIRE(log.GetCommands().size() == 2);
+
+    log.Clear();
+    BOOST_REQUIRE(log.GetCommands().empty());
+}
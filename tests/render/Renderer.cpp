@@ -0,0 +1,492 @@
+#include <boost/test/unit_test.hpp>
+
+#include "render/Material.h"
+#include "render/Mesh.h"
+#include "render/Node.h"
+#include "render/Renderer.h"
+#include "render/RenderQueue.h"
+#include "render/Shader.h"
+#include "render/Texture2D.h"
+
+#include "render/Null/RenderCommandLog.h"
+#include "render/Null/RenderSystemNull.h"
+
+using namespace Sketch3D;
+
+/**
+ * Creates a mesh made of one triangle. The mesh frees the arrays of the surface, but the surface must outlive it
+ */
+static Mesh* CreateTriangleMesh(SurfaceTriangles_t& surface) {
+    surface.numVertices = 3;
+    surface.vertices = new Vector3[3];
+    surface.vertices[0] = Vector3(-1.0f, 0.0f, 0.0f);
+    surface.vertices[1] = Vector3(1.0f, 0.0f, 0.0f);
+    surface.vertices[2] = Vector3(0.0f, 1.0f, 0.0f);
+    surface.numIndices = 3;
+    surface.indices = new unsigned short[3];
+    for (unsigned short i = 0; i < 3; i++) {
+        surface.indices[i] = i;
+    }
+
+    VertexAttributesMap_t vertexAttributes;
+    vertexAttributes[VERTEX_ATTRIBUTES_POSITION] = 0;
+
+    Mesh* mesh = new Mesh;
+    mesh->AddSurface(&surface);
+    mesh->Initialize(vertexAttributes);
+    return mesh;
+}
+
+/**
+ * Returns the renderer, initialized with the null render system the first time
+ */
+static Renderer* GetHeadlessRenderer() {
+    static bool isInitialized = false;
+    if (!isInitialized) {
+        RenderParameters_t renderParameters;
+        renderParameters.width = 64;
+        renderParameters.height = 64;
+        renderParameters.refreshRate = 0;
+        renderParameters.displayFormat = DISPLAY_FORMAT_X8R8G8B8;
+        renderParameters.depthStencilBits = DEPTH_STENCIL_BITS_D24X8;
+        isInitialized = Renderer::GetInstance()->InitializeHeadless(renderParameters);
+    }
+
+    return Renderer::GetInstance();
+}
+
+/**
+ * Draws a frame, the command log only holding the commands of that frame afterwards
+ */
+static void RenderFrame(Renderer* renderer, RenderCommandLog& log) {
+    log.Clear();
+
+    renderer->Clear();
+    renderer->StartRender();
+    renderer->Render();
+    renderer->EndRender();
+    renderer->PresentFrame();
+}
+
+BOOST_AUTO_TEST_CASE(test_frame_constants_are_uploaded_once_per_frame)
+{
+    Renderer* renderer = GetHeadlessRenderer();
+    RenderCommandLog& log = static_cast<RenderSystemNull*>(renderer->GetRenderSystem())->GetCommandLog();
+
+    // Two shaders reading the camera from the block, so that the queue switches between them
+    const string frameConstants = "layout(std140) uniform FrameConstants {\n"
+                                  "    mat4 view;\n"
+                                  "    mat4 projection;\n"
+                                  "    mat4 viewProjection;\n"
+                                  "    mat4 transInvView;\n"
+                                  "};\n";
+    Shader* firstShader = renderer->CreateShader();
+    Shader* secondShader = renderer->CreateShader();
+    BOOST_REQUIRE(firstShader->SetSource(frameConstants + "uniform mat4 model;\n", "uniform vec3 color;\n"));
+    BOOST_REQUIRE(secondShader->SetSource(frameConstants + "uniform mat4 model;\n", "uniform float time;\n"));
+    BOOST_REQUIRE((firstShader->GetBuiltinUniformMask() & FRAME_CONSTANTS_BUILTIN_UNIFORM_MASK) == 0);
+
+    Material firstMaterial(firstShader);
+    Material secondMaterial(secondShader);
+    SurfaceTriangles_t surface;
+    Mesh* mesh = CreateTriangleMesh(surface);
+
+    const size_t numNodes = 8;
+    Node nodes[numNodes];
+    for (size_t i = 0; i < numNodes; i++) {
+        nodes[i].SetMesh(mesh);
+        nodes[i].SetMaterial((i % 2 == 0) ? &firstMaterial : &secondMaterial);
+        nodes[i].SetPosition(Vector3((float)i, 0.0f, 0.0f));
+        renderer->GetSceneTree().AddNode(&nodes[i]);
+    }
+
+    renderer->PerspectiveProjection(45.0f, 1.0f, 1.0f, 100.0f);
+    for (int frame = 0; frame < 3; frame++) {
+        renderer->CameraLookAt(Vector3(3.5f, 0.0f, 20.0f + frame), Vector3(3.5f, 0.0f, 0.0f));
+        RenderFrame(renderer, log);
+
+        // The camera only reaches the shaders through the block
+        BOOST_REQUIRE(log.CountCommands(RECORDED_COMMAND_SET_FRAME_CONSTANTS) == 1);
+        BOOST_REQUIRE(log.CountCommands(RECORDED_COMMAND_BIND_SHADER) >= 2);
+        BOOST_REQUIRE(log.CountCommands(RECORDED_COMMAND_DRAW) + log.CountCommands(RECORDED_COMMAND_DRAW_INSTANCED) > 0);
+
+        const vector<RecordedCommand_t>& commands = log.GetCommands();
+        for (size_t i = 0; i < commands.size(); i++) {
+            if (commands[i].type == RECORDED_COMMAND_SET_UNIFORM) {
+                Shader* shader = (commands[i].objectId == firstShader->GetId()) ? firstShader : secondShader;
+                BOOST_REQUIRE(commands[i].arguments[0] == (size_t)shader->GetBuiltinUniformHandle(MODEL));
+            }
+        }
+    }
+
+    for (size_t i = 0; i < numNodes; i++) {
+        renderer->GetSceneTree().RemoveNode(&nodes[i]);
+    }
+    delete mesh;
+}
+
+BOOST_AUTO_TEST_CASE(test_draws_without_model_uniforms_are_merged)
+{
+    Renderer* renderer = GetHeadlessRenderer();
+    RenderCommandLog& log = static_cast<RenderSystemNull*>(renderer->GetRenderSystem())->GetCommandLog();
+
+    // The first shader reads the model matrix from the instance attributes, the second one from a uniform
+    Shader* attributeShader = renderer->CreateShader();
+    Shader* uniformShader = renderer->CreateShader();
+    BOOST_REQUIRE(attributeShader->SetSource("uniform mat4 viewProjection;\n", "uniform vec3 color;\n"));
+    BOOST_REQUIRE(uniformShader->SetSource("uniform mat4 modelViewProjection;\n", "uniform vec3 color;\n"));
+
+    Material attributeMaterial(attributeShader);
+    Material uniformMaterial(uniformShader);
+    SurfaceTriangles_t surfaces[2];
+    Mesh* meshes[] = { CreateTriangleMesh(surfaces[0]), CreateTriangleMesh(surfaces[1]) };
+
+    const size_t numNodes = 6;
+    Node nodes[numNodes];
+    for (size_t i = 0; i < numNodes; i++) {
+        nodes[i].SetMesh(meshes[i % 2]);
+        nodes[i].SetMaterial(&attributeMaterial);
+        nodes[i].SetPosition(Vector3((float)i, 0.0f, 0.0f));
+        renderer->GetSceneTree().AddNode(&nodes[i]);
+    }
+
+    renderer->PerspectiveProjection(45.0f, 1.0f, 1.0f, 100.0f);
+    renderer->CameraLookAt(Vector3(2.5f, 0.0f, 20.0f), Vector3(2.5f, 0.0f, 0.0f));
+
+    // The draws of each buffer object are submitted at once
+    RenderFrame(renderer, log);
+    BOOST_REQUIRE(log.CountCommands(RECORDED_COMMAND_DRAW) == 0);
+    BOOST_REQUIRE(log.CountCommands(RECORDED_COMMAND_DRAW_INSTANCED) == 2);
+
+    const vector<RecordedCommand_t>& commands = log.GetCommands();
+    for (size_t i = 0; i < commands.size(); i++) {
+        if (commands[i].type == RECORDED_COMMAND_DRAW_INSTANCED) {
+            BOOST_REQUIRE(commands[i].arguments[1] == numNodes / 2);
+        }
+    }
+
+    // Each model matrix has to be set before its draw
+    for (size_t i = 0; i < numNodes; i++) {
+        nodes[i].SetMaterial(&uniformMaterial);
+    }
+
+    RenderFrame(renderer, log);
+    BOOST_REQUIRE(log.CountCommands(RECORDED_COMMAND_DRAW) == numNodes);
+    BOOST_REQUIRE(log.CountCommands(RECORDED_COMMAND_DRAW_INSTANCED) == 0);
+
+    for (size_t i = 0; i < numNodes; i++) {
+        renderer->GetSceneTree().RemoveNode(&nodes[i]);
+    }
+    delete meshes[0];
+    delete meshes[1];
+}
+
+BOOST_AUTO_TEST_CASE(test_items_are_sorted_by_buffer_object_id)
+{
+    Renderer* renderer = GetHeadlessRenderer();
+    RenderCommandLog& log = static_cast<RenderSystemNull*>(renderer->GetRenderSystem())->GetCommandLog();
+
+    Shader* shader = renderer->CreateShader();
+    BOOST_REQUIRE(shader->SetSource("uniform mat4 modelViewProjection;\n", "uniform vec3 color;\n"));
+    Material material(shader);
+
+    SurfaceTriangles_t surfaces[2];
+    Mesh* meshes[] = { CreateTriangleMesh(surfaces[0]), CreateTriangleMesh(surfaces[1]) };
+
+    // The nodes of the second mesh are the closest to the camera, the depth only orders the items of the same mesh
+    const size_t numNodes = 6;
+    Node nodes[numNodes];
+    for (size_t i = 0; i < numNodes; i++) {
+        nodes[i].SetMesh(meshes[(i < numNodes / 2) ? 1 : 0]);
+        nodes[i].SetMaterial(&material);
+        nodes[i].SetPosition(Vector3(0.0f, 0.0f, (float)i));
+        renderer->GetSceneTree().AddNode(&nodes[i]);
+    }
+
+    renderer->PerspectiveProjection(45.0f, 1.0f, 1.0f, 100.0f);
+    renderer->CameraLookAt(Vector3(0.0f, 0.0f, -20.0f), Vector3(0.0f, 0.0f, 0.0f));
+    RenderFrame(renderer, log);
+
+    // The buffer objects are drawn in creation order rather than in the order of their addresses
+    vector<size_t> drawnBufferObjects;
+    const vector<RecordedCommand_t>& commands = log.GetCommands();
+    for (size_t i = 0; i < commands.size(); i++) {
+        if (commands[i].type == RECORDED_COMMAND_DRAW) {
+            drawnBufferObjects.push_back(commands[i].objectId);
+        }
+    }
+
+    BOOST_REQUIRE_EQUAL(drawnBufferObjects.size(), numNodes);
+    for (size_t i = 0; i < numNodes; i++) {
+        size_t mesh = (i < numNodes / 2) ? 0 : 1;
+        BOOST_REQUIRE_EQUAL(drawnBufferObjects[i], meshes[mesh]->GetBufferObject(0)->GetId());
+    }
+
+    for (size_t i = 0; i < numNodes; i++) {
+        renderer->GetSceneTree().RemoveNode(&nodes[i]);
+    }
+    delete meshes[0];
+    delete meshes[1];
+}
+
+BOOST_AUTO_TEST_CASE(test_render_queue_counts_state_changes)
+{
+    Renderer* renderer = GetHeadlessRenderer();
+    RenderCommandLog& log = static_cast<RenderSystemNull*>(renderer->GetRenderSystem())->GetCommandLog();
+
+    Shader* shader = renderer->CreateShader();
+    BOOST_REQUIRE(shader->SetSource("uniform mat4 modelViewProjection;\n", "uniform sampler2D texture0;\n"));
+    Material materials[] = { Material(shader), Material(shader) };
+
+    // Each mesh has its own buffer object and set of textures
+    Texture2D* textures[] = { renderer->CreateTexture2D(), renderer->CreateTexture2D() };
+    SurfaceTriangles_t surfaces[2];
+    Mesh* meshes[2];
+    for (size_t i = 0; i < 2; i++) {
+        surfaces[i].numTextures = 1;
+        surfaces[i].textures = new Texture2D*[1];
+        surfaces[i].textures[0] = textures[i];
+        meshes[i] = CreateTriangleMesh(surfaces[i]);
+    }
+
+    // Two nodes for each material and mesh, added so that consecutive nodes never share their states
+    const size_t numNodes = 8;
+    Node nodes[numNodes];
+    for (size_t i = 0; i < numNodes; i++) {
+        nodes[i].SetMesh(meshes[i % 2]);
+        nodes[i].SetMaterial(&materials[(i / 2) % 2]);
+        nodes[i].SetPosition(Vector3(0.0f, 0.0f, (float)i));
+        renderer->GetSceneTree().AddNode(&nodes[i]);
+    }
+
+    renderer->PerspectiveProjection(45.0f, 1.0f, 1.0f, 100.0f);
+    renderer->CameraLookAt(Vector3(0.0f, 0.0f, -20.0f), Vector3(0.0f, 0.0f, 0.0f));
+    RenderFrame(renderer, log);
+
+    // The items are sorted by material, then by textures and buffer object
+    RenderQueueStatistics_t statistics = renderer->GetRenderQueueStatistics();
+    BOOST_CHECK_EQUAL(statistics.numItems, numNodes);
+    BOOST_CHECK_EQUAL(statistics.numDrawCalls, numNodes);
+    BOOST_CHECK_EQUAL(statistics.numShaderChanges, 1);
+    BOOST_CHECK_EQUAL(statistics.numMaterialChanges, 2);
+    BOOST_CHECK_EQUAL(statistics.numTextureChanges, 4);
+    BOOST_CHECK_EQUAL(statistics.numBufferObjectChanges, 4);
+
+    for (size_t i = 0; i < numNodes; i++) {
+        renderer->GetSceneTree().RemoveNode(&nodes[i]);
+    }
+    delete meshes[0];
+    delete meshes[1];
+    delete textures[0];
+    delete textures[1];
+}
+
+BOOST_AUTO_TEST_CASE(test_render_queue_rejects_oversized_key_layouts)
+{
+    RenderQueue renderQueue;
+    RenderQueueKeyLayout_t layout = { 8, 8, 8, 8, 30 };
+    BOOST_REQUIRE(renderQueue.SetKeyLayout(layout));
+
+    // The layout doesn't fit in the key, or one of its components is wider than 32 bits
+    RenderQueueKeyLayout_t oversizedLayout = { 16, 16, 16, 16, 0 };
+    RenderQueueKeyLayout_t wideLayout = { 33, 0, 0, 0, 0 };
+    BOOST_CHECK(!renderQueue.SetKeyLayout(oversizedLayout));
+    BOOST_CHECK(!renderQueue.SetKeyLayout(wideLayout));
+
+    const RenderQueueKeyLayout_t& currentLayout = renderQueue.GetKeyLayout();
+    BOOST_CHECK_EQUAL(currentLayout.shaderBits, layout.shaderBits);
+    BOOST_CHECK_EQUAL(currentLayout.materialBits, layout.materialBits);
+    BOOST_CHECK_EQUAL(currentLayout.textureSetBits, layout.textureSetBits);
+    BOOST_CHECK_EQUAL(currentLayout.bufferObjectBits, layout.bufferObjectBits);
+    BOOST_CHECK_EQUAL(currentLayout.depthBits, layout.depthBits);
+}
+
+BOOST_AUTO_TEST_CASE(test_material_only_applies_changed_parameters)
+{
+    Renderer* renderer = GetHeadlessRenderer();
+    RenderCommandLog& log = static_cast<RenderSystemNull*>(renderer->GetRenderSystem())->GetCommandLog();
+
+    Shader* shader = renderer->CreateShader();
+    BOOST_REQUIRE(shader->SetSource("", "uniform vec3 color;\nuniform float intensity;\nuniform vec4 tint;\n"));
+
+    Material material(shader);
+    material.SetUniformVector3("color", Vector3(1.0f, 0.0f, 0.0f));
+    material.SetUniformFloat("intensity", 0.5f);
+    material.SetUniformVector4("tint", Vector4(1.0f, 1.0f, 1.0f, 1.0f));
+
+    log.Clear();
+    BOOST_REQUIRE(material.ApplyMaterial());
+    BOOST_REQUIRE_EQUAL(log.CountCommands(RECORDED_COMMAND_SET_UNIFORM), 3);
+    size_t appliedVersion = material.GetVersion();
+
+    // Nothing changed, the parameters don't even reach the shader
+    size_t numIssuedUploads = shader->GetNumIssuedUniformUploads();
+    size_t numSkippedUploads = shader->GetNumSkippedUniformUploads();
+    log.Clear();
+    BOOST_REQUIRE(material.ApplyMaterial(appliedVersion));
+    BOOST_CHECK_EQUAL(log.CountCommands(RECORDED_COMMAND_SET_UNIFORM), 0);
+    BOOST_CHECK_EQUAL(shader->GetNumIssuedUniformUploads(), numIssuedUploads);
+    BOOST_CHECK_EQUAL(shader->GetNumSkippedUniformUploads(), numSkippedUploads);
+
+    // Only the parameter that changed is uploaded again
+    material.SetUniformFloat("intensity", 0.75f);
+    log.Clear();
+    BOOST_REQUIRE(material.ApplyMaterial(appliedVersion));
+    BOOST_CHECK_EQUAL(shader->GetNumSkippedUniformUploads(), numSkippedUploads);
+
+    const vector<RecordedCommand_t>& commands = log.GetCommands();
+    BOOST_REQUIRE_EQUAL(log.CountCommands(RECORDED_COMMAND_SET_UNIFORM), 1);
+    for (size_t i = 0; i < commands.size(); i++) {
+        if (commands[i].type == RECORDED_COMMAND_SET_UNIFORM) {
+            BOOST_CHECK_EQUAL(commands[i].arguments[0], (size_t)shader->GetUniformHandle("intensity"));
+            BOOST_CHECK_EQUAL(commands[i].arguments[1], (size_t)RECORDED_UNIFORM_FLOAT);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_render_queues_stop_allocating)
+{
+    Renderer* renderer = GetHeadlessRenderer();
+    RenderCommandLog& log = static_cast<RenderSystemNull*>(renderer->GetRenderSystem())->GetCommandLog();
+
+    // Draws with and without per-model uniforms, so that both the command arena and the instance buffers are used
+    Shader* attributeShader = renderer->CreateShader();
+    Shader* uniformShader = renderer->CreateShader();
+    BOOST_REQUIRE(attributeShader->SetSource("uniform mat4 viewProjection;\n", "uniform vec3 color;\n"));
+    BOOST_REQUIRE(uniformShader->SetSource("uniform mat4 modelViewProjection;\n", "uniform vec3 color;\n"));
+    Material materials[] = { Material(attributeShader), Material(uniformShader) };
+
+    SurfaceTriangles_t surfaces[2];
+    Mesh* meshes[] = { CreateTriangleMesh(surfaces[0]), CreateTriangleMesh(surfaces[1]) };
+
+    const size_t numNodes = 64;
+    Node nodes[numNodes];
+    for (size_t i = 0; i < numNodes; i++) {
+        nodes[i].SetMesh(meshes[i % 2]);
+        nodes[i].SetMaterial(&materials[(i / 2) % 2]);
+        nodes[i].SetPosition(Vector3((float)(i % 8), (float)(i / 8), 0.0f));
+        renderer->GetSceneTree().AddNode(&nodes[i]);
+    }
+
+    renderer->PerspectiveProjection(45.0f, 1.0f, 1.0f, 100.0f);
+
+    // The buffers reach their steady state size during the first frames
+    const int numWarmUpFrames = 4;
+    for (int frame = 0; frame < numWarmUpFrames; frame++) {
+        renderer->CameraLookAt(Vector3(3.5f, 3.5f, 20.0f + frame), Vector3(3.5f, 3.5f, 0.0f));
+        RenderFrame(renderer, log);
+    }
+
+    size_t numHeapAllocations = renderer->GetNumRenderQueueHeapAllocations();
+    BOOST_REQUIRE(numHeapAllocations > 0);
+    for (int frame = 0; frame < 16; frame++) {
+        renderer->CameraLookAt(Vector3(3.5f, 3.5f, 20.0f - frame * 0.5f), Vector3(3.5f, 3.5f, 0.0f));
+        RenderFrame(renderer, log);
+
+        BOOST_REQUIRE(log.CountCommands(RECORDED_COMMAND_DRAW) > 0);
+        BOOST_REQUIRE(log.CountCommands(RECORDED_COMMAND_DRAW_INSTANCED) > 0);
+        BOOST_REQUIRE_EQUAL(renderer->GetNumRenderQueueHeapAllocations(), numHeapAllocations);
+    }
+
+    for (size_t i = 0; i < numNodes; i++) {
+        renderer->GetSceneTree().RemoveNode(&nodes[i]);
+    }
+    delete meshes[0];
+    delete meshes[1];
+}
+
+BOOST_AUTO_TEST_CASE(test_render_thread_draws_the_prepared_material_values)
+{
+    Renderer* renderer = GetHeadlessRenderer();
+    RenderCommandLog& log = static_cast<RenderSystemNull*>(renderer->GetRenderSystem())->GetCommandLog();
+
+    SurfaceTriangles_t surface;
+    Mesh* mesh = CreateTriangleMesh(surface);
+
+    BOOST_REQUIRE(renderer->EnableRenderThread(true));
+
+    // The render thread owns the render context, so the shader has to be created there
+    Shader* shader = nullptr;
+    bool isShaderCreated = false;
+    renderer->RunOnRenderThread([renderer, &shader, &isShaderCreated, &log] {
+        shader = renderer->CreateShader();
+        isShaderCreated = shader->SetSource("uniform mat4 modelViewProjection;\n", "uniform int frame;\n");
+        log.Clear();
+    });
+    BOOST_REQUIRE(isShaderCreated);
+    UniformHandle_t frameHandle = shader->GetUniformHandle("frame");
+    BOOST_REQUIRE(frameHandle != INVALID_UNIFORM_HANDLE);
+
+    Material material(shader);
+    const size_t numNodes = 4;
+    Node nodes[numNodes];
+    for (size_t i = 0; i < numNodes; i++) {
+        nodes[i].SetMesh(mesh);
+        nodes[i].SetMaterial(&material);
+        nodes[i].SetPosition(Vector3((float)i - 1.5f, 0.0f, 0.0f));
+        renderer->GetSceneTree().AddNode(&nodes[i]);
+    }
+
+    renderer->PerspectiveProjection(45.0f, 1.0f, 1.0f, 100.0f);
+    renderer->CameraLookAt(Vector3(0.0f, 0.0f, 10.0f), Vector3(0.0f, 0.0f, 0.0f));
+
+    const int numFrames = 8;
+    const int numWarmUpFrames = 4;
+    size_t numHeapAllocations = 0;
+    for (int frame = 0; frame < numFrames; frame++) {
+        material.SetUniformInt("frame", frame);
+
+        renderer->Clear();
+        renderer->StartRender();
+        renderer->Render();
+        renderer->EndRender();
+
+        // The packet has its own copy of the material, which the application can already change for the next frame
+        material.SetUniformInt("frame", -1);
+        renderer->PresentFrame();
+
+        // The statistics are those of the frame drawn before this one
+        if (frame > 0) {
+            BOOST_REQUIRE_EQUAL(renderer->GetRenderQueueStatistics().numDrawCalls, numNodes);
+        }
+
+        if (frame == numWarmUpFrames - 1) {
+            numHeapAllocations = renderer->GetNumRenderQueueHeapAllocations();
+        }
+    }
+
+    BOOST_REQUIRE_EQUAL(renderer->GetNumRenderQueueHeapAllocations(), numHeapAllocations);
+
+    // Stopping the render thread draws the last presented frame first
+    BOOST_REQUIRE(renderer->EnableRenderThread(false));
+
+    // Each frame uploads the value that the uniform had when its packet was prepared, once before its first draw
+    int frame = 0;
+    size_t numUploads = 0;
+    size_t numDraws = 0;
+    const vector<RecordedCommand_t>& commands = log.GetCommands();
+    for (size_t i = 0; i < commands.size(); i++) {
+        const RecordedCommand_t& command = commands[i];
+        if (command.type == RECORDED_COMMAND_SET_UNIFORM && command.objectId == shader->GetId() &&
+            command.arguments[0] == (size_t)frameHandle)
+        {
+            BOOST_REQUIRE_EQUAL((int)command.arguments[2], frame);
+            BOOST_REQUIRE_EQUAL(numDraws, 0);
+            numUploads += 1;
+        } else if (command.type == RECORDED_COMMAND_DRAW) {
+            numDraws += 1;
+        } else if (command.type == RECORDED_COMMAND_PRESENT) {
+            BOOST_REQUIRE_EQUAL(numUploads, 1);
+            BOOST_REQUIRE_EQUAL(numDraws, numNodes);
+            numUploads = 0;
+            numDraws = 0;
+            frame += 1;
+        }
+    }
+    BOOST_REQUIRE_EQUAL(frame, numFrames);
+
+    for (size_t i = 0; i < numNodes; i++) {
+        renderer->GetSceneTree().RemoveNode(&nodes[i]);
+    }
+    delete mesh;
+}
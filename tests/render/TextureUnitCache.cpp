@@ -0,0 +1,63 @@
+#include <boost/test/unit_test.hpp>
+
+#include "render/TextureUnitCache.h"
+
+using namespace Sketch3D;
+
+BOOST_AUTO_TEST_CASE(test_texture_unit_cache_keeps_bound_textures)
+{
+    TextureUnitCache cache(4);
+    size_t textureUnit;
+
+    BOOST_REQUIRE(cache.Acquire(10, textureUnit));
+    BOOST_REQUIRE(textureUnit == 0);
+    BOOST_REQUIRE(cache.Acquire(11, textureUnit));
+    BOOST_REQUIRE(textureUnit == 1);
+
+    // Already bound textures stay on their unit
+    BOOST_REQUIRE(!cache.Acquire(10, textureUnit));
+    BOOST_REQUIRE(textureUnit == 0);
+    BOOST_REQUIRE(!cache.Acquire(11, textureUnit));
+    BOOST_REQUIRE(textureUnit == 1);
+
+    BOOST_REQUIRE(cache.GetNumBinds() == 2);
+    BOOST_REQUIRE(cache.GetNumHits() == 2);
+    BOOST_REQUIRE(cache.GetNumEvictions() == 0);
+
+    cache.Clear();
+    BOOST_REQUIRE(cache.Acquire(11, textureUnit));
+    BOOST_REQUIRE(textureUnit == 0);
+
+    cache.ResetCounters();
+    BOOST_REQUIRE(cache.GetNumBinds() == 0);
+    BOOST_REQUIRE(cache.GetNumHits() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_texture_unit_cache_evicts_least_recently_used)
+{
+    TextureUnitCache cache(3);
+    size_t textureUnit;
+
+    cache.Acquire(1, textureUnit);
+    cache.Acquire(2, textureUnit);
+    cache.Acquire(3, textureUnit);
+
+    // Texture 1 is used again, so texture 2 is the least recently used
+    cache.Acquire(1, textureUnit);
+    BOOST_REQUIRE(cache.Acquire(4, textureUnit));
+    BOOST_REQUIRE(textureUnit == 1);
+    BOOST_REQUIRE(cache.GetNumEvictions() == 1);
+
+    // The evicted texture has to be bound again, in place of texture 3
+    BOOST_REQUIRE(cache.Acquire(2, textureUnit));
+    BOOST_REQUIRE(textureUnit == 2);
+    BOOST_REQUIRE(!cache.Acquire(1, textureUnit));
+    BOOST_REQUIRE(textureUnit == 0);
+    BOOST_REQUIRE(cache.GetNumEvictions() == 2);
+
+    // Without texture units, the textures are always bound to the first one
+    TextureUnitCache emptyCache;
+    BOOST_REQUIRE(emptyCache.Acquire(1, textureUnit));
+    BOOST_REQUIRE(emptyCache.Acquire(1, textureUnit));
+    BOOST_REQUIRE(textureUnit == 0);
+}
@@ -0,0 +1,86 @@
+#include <boost/test/unit_test.hpp>
+
+#include "system/JobSystem.h"
+
+#include <atomic>
+#include <vector>
+using namespace std;
+
+using namespace Sketch3D;
+
+BOOST_AUTO_TEST_CASE(test_job_system_run) {
+    JobSystem* jobSystem = JobSystem::GetInstance();
+
+    atomic<size_t> numRunJobs(0);
+    JobCounter counter;
+    for (size_t i = 0; i < 1000; i++) {
+        jobSystem->Run([&numRunJobs] () { numRunJobs += 1; }, &counter);
+    }
+
+    jobSystem->Wait(counter);
+    BOOST_CHECK(counter.IsDone());
+    BOOST_CHECK_EQUAL(numRunJobs.load(), 1000);
+}
+
+BOOST_AUTO_TEST_CASE(test_job_system_parallel_for) {
+    vector<size_t> values(10007, 0);
+
+    JobSystem::GetInstance()->ParallelFor(0, values.size(), 64, [&values] (size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            values[i] += i;
+        }
+    });
+
+    for (size_t i = 0; i < values.size(); i++) {
+        BOOST_REQUIRE_EQUAL(values[i], i);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_job_system_dependencies) {
+    JobSystem* jobSystem = JobSystem::GetInstance();
+
+    // Every job of the second stage must see the results of all the jobs of the first stage
+    const size_t numJobs = 64;
+    vector<size_t> firstStage(numJobs, 0);
+    atomic<size_t> numMissingResults(0);
+
+    JobCounter firstStageCounter;
+    JobCounter secondStageCounter;
+    for (size_t i = 0; i < numJobs; i++) {
+        jobSystem->Run([&firstStage, i] () { firstStage[i] = i + 1; }, &firstStageCounter);
+    }
+
+    for (size_t i = 0; i < numJobs; i++) {
+        jobSystem->Run([&firstStage, &numMissingResults] () {
+            for (size_t j = 0; j < firstStage.size(); j++) {
+                if (firstStage[j] != j + 1) {
+                    numMissingResults += 1;
+                }
+            }
+        }, &secondStageCounter, &firstStageCounter);
+    }
+
+    jobSystem->Wait(secondStageCounter);
+    BOOST_CHECK(firstStageCounter.IsDone());
+    BOOST_CHECK_EQUAL(numMissingResults.load(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_job_system_nested_jobs) {
+    JobSystem* jobSystem = JobSystem::GetInstance();
+
+    // Jobs waiting for the jobs they started run them in the meantime
+    atomic<size_t> numRunJobs(0);
+    JobCounter counter;
+    for (size_t i = 0; i < 16; i++) {
+        jobSystem->Run([jobSystem, &numRunJobs] () {
+            JobCounter nestedCounter;
+            for (size_t j = 0; j < 16; j++) {
+                jobSystem->Run([&numRunJobs] () { numRunJobs += 1; }, &nestedCounter);
+            }
+            jobSystem->Wait(nestedCounter);
+        }, &counter);
+    }
+
+    jobSystem->Wait(counter);
+    BOOST_CHECK_EQUAL(numRunJobs.load(), 16 * 16);
+}
@@ -0,0 +1,88 @@
+#include <boost/test/unit_test.hpp>
+
+#include "system/Logger.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+using namespace std;
+
+using namespace Sketch3D;
+
+static string ReadLog() {
+    Logger::GetInstance()->Flush();
+
+    ifstream file("Log.html");
+    return string((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+}
+
+static size_t CountOccurrences(const string& text, const string& pattern) {
+    size_t count = 0;
+    for (size_t position = text.find(pattern); position != string::npos; position = text.find(pattern, position + 1)) {
+        count += 1;
+    }
+
+    return count;
+}
+
+static size_t numEvaluatedMessages = 0;
+
+static string EvaluateMessage(const string& message) {
+    numEvaluatedMessages += 1;
+    return message;
+}
+
+BOOST_AUTO_TEST_CASE(test_logger_writes_messages) {
+    Logger::GetInstance()->Warning("Logger test warning");
+    LOG_ERROR("Logger test error");
+
+    string log = ReadLog();
+    BOOST_CHECK(log.find("[WARNING] ") != string::npos);
+    BOOST_CHECK_EQUAL(CountOccurrences(log, "Logger test warning"), 1);
+    BOOST_CHECK_EQUAL(CountOccurrences(log, "Logger test error"), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_logger_filtered_level) {
+    Logger::GetInstance()->SetLoggerLevel(LOGGER_LEVEL_INFO);
+    numEvaluatedMessages = 0;
+
+    LOG_DEBUG(EvaluateMessage("Logger test filtered"));
+    LOG_INFO(EvaluateMessage("Logger test kept"));
+
+    BOOST_CHECK_EQUAL(numEvaluatedMessages, 1);
+
+    string log = ReadLog();
+    BOOST_CHECK_EQUAL(CountOccurrences(log, "Logger test filtered"), 0);
+    BOOST_CHECK_EQUAL(CountOccurrences(log, "Logger test kept"), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_logger_repeated_messages) {
+    for (size_t i = 0; i < 100; i++) {
+        LOG_WARNING("Logger test repeated");
+    }
+
+    BOOST_CHECK_EQUAL(CountOccurrences(ReadLog(), "Logger test repeated"), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_logger_threads) {
+    thread worker([] () {
+        for (size_t i = 0; i < 10; i++) {
+            LOG_INFO("Logger test thread " + to_string(i));
+        }
+    });
+    worker.join();
+
+    // The buffer of the thread that exited is reused
+    thread secondWorker([] () {
+        LOG_INFO("Logger test second thread");
+    });
+    secondWorker.join();
+
+    string log = ReadLog();
+    for (size_t i = 0; i < 10; i++) {
+        BOOST_CHECK_EQUAL(CountOccurrences(log, "Logger test thread " + to_string(i) + "<"), 1);
+    }
+    BOOST_CHECK_EQUAL(CountOccurrences(log, "Logger test second thread"), 1);
+    BOOST_CHECK_EQUAL(Logger::GetInstance()->GetNumDroppedMessages(), 0);
+}
@@ -0,0 +1,164 @@
+#include <boost/test/unit_test.hpp>
+
+#include "system/Profiler.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+using namespace Sketch3D;
+
+/**
+ * Returns a path in the temporary directory of the system, so that the tests don't write in the working directory
+ */
+static string GetTemporaryPath(const string& filename) {
+    const char* variables[] = { "TMPDIR", "TEMP", "TMP" };
+    for (size_t i = 0; i < 3; i++) {
+        const char* directory = getenv(variables[i]);
+        if (directory != NULL && directory[0] != '\0') {
+            return string(directory) + "/" + filename;
+        }
+    }
+
+    return "/tmp/" + filename;
+}
+
+BOOST_AUTO_TEST_CASE(test_profiler_nested_zones) {
+    Profiler* profiler = Profiler::GetInstance();
+    profiler->Clear();
+
+    {
+        ProfilerZone outerZone("Outer");
+        {
+            ProfilerZone innerZone("Inner");
+        }
+    }
+
+    vector<ProfilerEvent_t> events = profiler->GetEvents();
+    BOOST_REQUIRE_EQUAL(events.size(), 2);
+
+    // The inner zone is closed first
+    BOOST_CHECK_EQUAL(string(events[0].name), "Inner");
+    BOOST_CHECK_EQUAL(events[0].depth, 1);
+    BOOST_CHECK_EQUAL(string(events[1].name), "Outer");
+    BOOST_CHECK_EQUAL(events[1].depth, 0);
+
+    BOOST_CHECK(events[1].start <= events[0].start);
+    BOOST_CHECK(events[0].end <= events[1].end);
+}
+
+BOOST_AUTO_TEST_CASE(test_profiler_disabled) {
+    Profiler* profiler = Profiler::GetInstance();
+    profiler->Clear();
+
+    profiler->SetEnabled(false);
+    {
+        ProfilerZone zone("Disabled");
+    }
+    profiler->SetEnabled(true);
+
+    BOOST_CHECK(profiler->GetEvents().empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_profiler_threads) {
+    Profiler* profiler = Profiler::GetInstance();
+    profiler->Clear();
+
+    // A new thread gets a buffer of 4 events
+    profiler->SetMaxEventsPerThread(4);
+
+    static const char* workerZones[] = { "Worker0", "Worker1", "Worker2", "Worker3", "Worker4", "Worker5" };
+    thread worker([] () {
+        for (size_t i = 0; i < 6; i++) {
+            ProfilerZone zone(workerZones[i]);
+        }
+    });
+    worker.join();
+
+    {
+        ProfilerZone zone("Main");
+    }
+
+    vector<size_t> threadIndices;
+    vector<ProfilerEvent_t> events = profiler->GetEvents(&threadIndices);
+    BOOST_REQUIRE_EQUAL(events.size(), 5);
+    BOOST_REQUIRE_EQUAL(threadIndices.size(), 5);
+    BOOST_CHECK_EQUAL(profiler->GetNumDroppedEvents(), 2);
+
+    // The oldest events of the worker were overwritten by the latest ones
+    size_t numWorkerEvents = 0;
+    size_t workerThreadIndex = 0;
+    size_t mainThreadIndex = 0;
+    for (size_t i = 0; i < events.size(); i++) {
+        if (string(events[i].name) != "Main") {
+            BOOST_CHECK_EQUAL(string(events[i].name), workerZones[numWorkerEvents + 2]);
+            numWorkerEvents += 1;
+            workerThreadIndex = threadIndices[i];
+        } else {
+            mainThreadIndex = threadIndices[i];
+        }
+    }
+
+    BOOST_CHECK_EQUAL(numWorkerEvents, 4);
+    BOOST_CHECK(workerThreadIndex != mainThreadIndex);
+}
+
+BOOST_AUTO_TEST_CASE(test_profiler_read_while_recording) {
+    Profiler* profiler = Profiler::GetInstance();
+    profiler->Clear();
+    profiler->SetMaxEventsPerThread(16);
+
+    // The worker keeps overwriting its buffer, each event starting one tick after the previous one
+    atomic<bool> stopWorker(false);
+    thread worker([profiler, &stopWorker] () {
+        for (uint64_t time = 0; !stopWorker.load(); time++) {
+            profiler->AddEvent("Recording", time, time + 1, 0);
+        }
+    });
+
+    // The events that the worker overwrote while they were read are left out
+    for (size_t i = 0; i < 1000; i++) {
+        vector<ProfilerEvent_t> events = profiler->GetEvents();
+        BOOST_REQUIRE(events.size() <= 16);
+
+        for (size_t j = 0; j < events.size(); j++) {
+            BOOST_REQUIRE_EQUAL(events[j].end, events[j].start + 1);
+            if (j > 0) {
+                BOOST_REQUIRE_EQUAL(events[j].start, events[j - 1].start + 1);
+            }
+        }
+    }
+
+    stopWorker.store(true);
+    worker.join();
+}
+
+BOOST_AUTO_TEST_CASE(test_profiler_chrome_trace) {
+    Profiler* profiler = Profiler::GetInstance();
+    profiler->Clear();
+    profiler->SetThreadName("Main \"thread\"");
+
+    {
+        ProfilerZone zone("Export");
+    }
+
+    string filename = GetTemporaryPath("Sketch3D_ProfilerTest.json");
+    BOOST_REQUIRE(profiler->ExportChromeTrace(filename));
+
+    string trace;
+    {
+        ifstream file(filename.c_str());
+        trace.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    }
+    remove(filename.c_str());
+
+    BOOST_CHECK_EQUAL(trace.find("{\"traceEvents\":["), 0);
+    BOOST_CHECK(trace.find("\"name\":\"Export\",\"ph\":\"X\"") != string::npos);
+    BOOST_CHECK(trace.find("\"args\":{\"name\":\"Main \\\"thread\\\"\"}") != string::npos);
+}